@@ -1145,6 +1145,11 @@ macro(process_options)
   if(${NS3_LOG} OR (${build_profile} STREQUAL "debug"))
     add_definitions(-DNS3_LOG_ENABLE)
   endif()
+  # Compile out the logs of the components which call NS_LOG_HOT_PATH,
+  # i.e. those in the hot paths of the simulations
+  if(${NS3_FAST_LOG})
+    add_definitions(-DNS3_FAST_LOG)
+  endif()
   # Force enable ns-3 asserts in debug builds and if requested for other build
   # types
   if(${NS3_ASSERT} OR (${build_profile} STREQUAL "debug"))
@@ -61,8 +61,39 @@ OpenGymDataContainer::DoInitialize (void)
   //NS_LOG_FUNCTION (this);
 }
 
+ns3opengym::DataContainer
+OpenGymDataContainer::GetDataContainerPbMsg(Ptr<OpenGymSharedMemory> shm)
+{
+  return GetDataContainerPbMsg();
+}
+
+/*
+Fill the Box either with a view of the shared memory region, which stays valid
+until the next state is sent to the agent, or with a copy of the repeated field
+*/
+template <typename T, typename R>
+static Ptr<OpenGymBoxContainer<T> >
+CreateBox(const ns3opengym::BoxDataContainer &boxContainerPbMsg, const R &field, Ptr<OpenGymSharedMemory> shm)
+{
+  Ptr<OpenGymBoxContainer<T> > box = CreateObject<OpenGymBoxContainer<T> >();
+  if (boxContainerPbMsg.shmdata()) {
+    const uint8_t *src = 0;
+    if (shm) {
+      src = shm->Get(boxContainerPbMsg.shmoffset(), boxContainerPbMsg.shmlength() * sizeof(T));
+    }
+    if (src == 0) {
+      NS_LOG_WARN("Box data not found in shared memory");
+      return box;
+    }
+    box->SetDataView(reinterpret_cast<const T *>(src), boxContainerPbMsg.shmlength());
+  } else {
+    box->SetData(std::vector<T>(field.begin(), field.end()));
+  }
+  return box;
+}
+
 Ptr<OpenGymDataContainer>
-OpenGymDataContainer::CreateFromDataContainerPbMsg(ns3opengym::DataContainer &dataContainerPbMsg)
+OpenGymDataContainer::CreateFromDataContainerPbMsg(ns3opengym::DataContainer &dataContainerPbMsg, Ptr<OpenGymSharedMemory> shm)
 {
   Ptr<OpenGymDataContainer> actDataContainer;
 
@@ -81,39 +112,19 @@ OpenGymDataContainer::CreateFromDataContainerPbMsg(ns3opengym::DataContainer &da
     dataContainerPbMsg.data().UnpackTo(&boxContainerPbMsg);
 
     if (boxContainerPbMsg.dtype() == ns3opengym::INT) {
-      Ptr<OpenGymBoxContainer<int32_t> > box = CreateObject<OpenGymBoxContainer<int32_t> >();
-      std::vector<int32_t> myData;
-      myData.assign(boxContainerPbMsg.intdata().begin(), boxContainerPbMsg.intdata().end());
-      box->SetData(myData);
-      actDataContainer = box;
+      actDataContainer = CreateBox<int32_t>(boxContainerPbMsg, boxContainerPbMsg.intdata(), shm);
 
     } else if (boxContainerPbMsg.dtype() == ns3opengym::UINT) {
-      Ptr<OpenGymBoxContainer<uint32_t> > box = CreateObject<OpenGymBoxContainer<uint32_t> >();
-      std::vector<uint32_t> myData;
-      myData.assign(boxContainerPbMsg.uintdata().begin(), boxContainerPbMsg.uintdata().end());
-      box->SetData(myData);
-      actDataContainer = box;
+      actDataContainer = CreateBox<uint32_t>(boxContainerPbMsg, boxContainerPbMsg.uintdata(), shm);
 
     } else if (boxContainerPbMsg.dtype() == ns3opengym::FLOAT) {
-      Ptr<OpenGymBoxContainer<float> > box = CreateObject<OpenGymBoxContainer<float> >();
-      std::vector<float> myData;
-      myData.assign(boxContainerPbMsg.floatdata().begin(), boxContainerPbMsg.floatdata().end());
-      box->SetData(myData);
-      actDataContainer = box;
+      actDataContainer = CreateBox<float>(boxContainerPbMsg, boxContainerPbMsg.floatdata(), shm);
 
     } else if (boxContainerPbMsg.dtype() == ns3opengym::DOUBLE) {
-      Ptr<OpenGymBoxContainer<double> > box = CreateObject<OpenGymBoxContainer<double> >();
-      std::vector<double> myData;
-      myData.assign(boxContainerPbMsg.doubledata().begin(), boxContainerPbMsg.doubledata().end());
-      box->SetData(myData);
-      actDataContainer = box;
+      actDataContainer = CreateBox<double>(boxContainerPbMsg, boxContainerPbMsg.doubledata(), shm);
 
     } else {
-      Ptr<OpenGymBoxContainer<float> > box = CreateObject<OpenGymBoxContainer<float> >();
-      std::vector<float> myData;
-      myData.assign(boxContainerPbMsg.floatdata().begin(), boxContainerPbMsg.floatdata().end());
-      box->SetData(myData);
-      actDataContainer = box;
+      actDataContainer = CreateBox<float>(boxContainerPbMsg, boxContainerPbMsg.floatdata(), shm);
     }
   }
   else if (dataContainerPbMsg.type() == ns3opengym::Tuple)
@@ -129,7 +140,7 @@ OpenGymDataContainer::CreateFromDataContainerPbMsg(ns3opengym::DataContainer &da
     std::vector< ns3opengym::DataContainer >::iterator it;
     for(it=elements.begin();it!=elements.end();++it)
     {
-      Ptr<OpenGymDataContainer> subData = OpenGymDataContainer::CreateFromDataContainerPbMsg(*it);
+      Ptr<OpenGymDataContainer> subData = OpenGymDataContainer::CreateFromDataContainerPbMsg(*it, shm);
       tupleData->Add(subData);
     }
 
@@ -148,7 +159,7 @@ OpenGymDataContainer::CreateFromDataContainerPbMsg(ns3opengym::DataContainer &da
     std::vector< ns3opengym::DataContainer >::iterator it;
     for(it=elements.begin();it!=elements.end();++it)
     {
-      Ptr<OpenGymDataContainer> subSpace = OpenGymDataContainer::CreateFromDataContainerPbMsg(*it);
+      Ptr<OpenGymDataContainer> subSpace = OpenGymDataContainer::CreateFromDataContainerPbMsg(*it, shm);
       dictData->Add((*it).name(), subSpace);
     }
 
@@ -264,6 +275,12 @@ OpenGymTupleContainer::DoInitialize (void)
 
 ns3opengym::DataContainer
 OpenGymTupleContainer::GetDataContainerPbMsg()
+{
+  return GetDataContainerPbMsg(Ptr<OpenGymSharedMemory> ());
+}
+
+ns3opengym::DataContainer
+OpenGymTupleContainer::GetDataContainerPbMsg(Ptr<OpenGymSharedMemory> shm)
 {
   ns3opengym::DataContainer dataContainerPbMsg;
   dataContainerPbMsg.set_type(ns3opengym::Tuple);
@@ -274,7 +291,7 @@ OpenGymTupleContainer::GetDataContainerPbMsg()
   for (it=m_tuple.begin(); it!=m_tuple.end(); ++it)
   {
     Ptr<OpenGymDataContainer> subSpace = *it;
-    ns3opengym::DataContainer subDataContainer = subSpace->GetDataContainerPbMsg();
+    ns3opengym::DataContainer subDataContainer = subSpace->GetDataContainerPbMsg(shm);
 
     tupleContainerPbMsg.add_element()->CopyFrom(subDataContainer);
   }
@@ -360,6 +377,12 @@ OpenGymDictContainer::DoInitialize (void)
 
 ns3opengym::DataContainer
 OpenGymDictContainer::GetDataContainerPbMsg()
+{
+  return GetDataContainerPbMsg(Ptr<OpenGymSharedMemory> ());
+}
+
+ns3opengym::DataContainer
+OpenGymDictContainer::GetDataContainerPbMsg(Ptr<OpenGymSharedMemory> shm)
 {
   ns3opengym::DataContainer dataContainerPbMsg;
   dataContainerPbMsg.set_type(ns3opengym::Dict);
@@ -372,7 +395,7 @@ OpenGymDictContainer::GetDataContainerPbMsg()
     std::string name = it->first;
     Ptr<OpenGymDataContainer> subSpace = it->second;
 
-    ns3opengym::DataContainer subDataContainer = subSpace->GetDataContainerPbMsg();
+    ns3opengym::DataContainer subDataContainer = subSpace->GetDataContainerPbMsg(shm);
     subDataContainer.set_name(name);
 
     dictContainerPbMsg.add_element()->CopyFrom(subDataContainer);
@@ -25,6 +25,8 @@
 #include "ns3/object.h"
 #include "ns3/type-name.h"
 #include "messages.pb.h"
+#include "opengym_shm.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -37,7 +39,15 @@ public:
   static TypeId GetTypeId ();
 
   virtual ns3opengym::DataContainer GetDataContainerPbMsg() = 0;
-  static Ptr<OpenGymDataContainer> CreateFromDataContainerPbMsg(ns3opengym::DataContainer &dataContainer);
+  /**
+   * Box data is written to shm, when not null and large enough, instead of
+   * the message.
+   * \param shm the shared memory region, or 0
+   * \return the message
+   */
+  virtual ns3opengym::DataContainer GetDataContainerPbMsg(Ptr<OpenGymSharedMemory> shm);
+  static Ptr<OpenGymDataContainer> CreateFromDataContainerPbMsg(ns3opengym::DataContainer &dataContainer,
+                                                                Ptr<OpenGymSharedMemory> shm = 0);
 
   virtual void Print(std::ostream& where) const = 0;
   friend std::ostream& operator<< (std::ostream& os, const Ptr<OpenGymDataContainer> container)
@@ -62,6 +72,7 @@ public:
 
   static TypeId GetTypeId ();
 
+  using OpenGymDataContainer::GetDataContainerPbMsg;
   virtual ns3opengym::DataContainer GetDataContainerPbMsg();
 
   virtual void Print(std::ostream& where) const;
@@ -94,6 +105,7 @@ public:
   static TypeId GetTypeId ();
 
   virtual ns3opengym::DataContainer GetDataContainerPbMsg();
+  virtual ns3opengym::DataContainer GetDataContainerPbMsg(Ptr<OpenGymSharedMemory> shm);
 
   virtual void Print(std::ostream& where) const;
   friend std::ostream& operator<< (std::ostream& os, const Ptr<OpenGymBoxContainer> container)
@@ -107,6 +119,23 @@ public:
 
   bool SetData(std::vector<T> data);
   std::vector<T> GetData();
+  /**
+   * Refer to data owned by someone else instead of copying it, e.g. the
+   * action half of the shared memory region. The data must stay valid as
+   * long as the container is read, which for actions means until the next
+   * state is sent to the agent. SetData and AddValue end the view.
+   * \param data the first element
+   * \param size the number of elements
+   */
+  void SetDataView(const T *data, uint32_t size);
+  /**
+   * \return the first element, either owned or viewed, without copy
+   */
+  const T * GetDataPointer() const;
+  /**
+   * \return the number of elements
+   */
+  uint32_t GetSize() const;
 
   std::vector<uint32_t> GetShape();
 
@@ -117,9 +146,13 @@ protected:
 
 private:
   void SetDtype();
+  template <typename U>
+  bool CopyToSharedMemory(Ptr<OpenGymSharedMemory> shm, ns3opengym::BoxDataContainer &boxContainerPbMsg);
 	std::vector<uint32_t> m_shape;
 	ns3opengym::Dtype m_dtype;
 	std::vector<T> m_data;
+  const T *m_view;      //!< viewed data, or 0 when m_data is used
+  uint32_t m_viewSize;  //!< number of viewed elements
 };
 
 template <typename T>
@@ -137,13 +170,17 @@ OpenGymBoxContainer<T>::GetTypeId (void)
 
 template <typename T>
 OpenGymBoxContainer<T>::OpenGymBoxContainer()
+  : m_view (0),
+    m_viewSize (0)
 {
  SetDtype();
 }
 
 template <typename T>
 OpenGymBoxContainer<T>::OpenGymBoxContainer(std::vector<uint32_t> shape):
-	m_shape(shape)
+	m_shape(shape),
+  m_view (0),
+  m_viewSize (0)
 {
   SetDtype();
 }
@@ -217,10 +254,68 @@ OpenGymBoxContainer<T>::GetDataContainerPbMsg()
   return dataContainerPbMsg;
 }
 
+template <typename T>
+ns3opengym::DataContainer
+OpenGymBoxContainer<T>::GetDataContainerPbMsg(Ptr<OpenGymSharedMemory> shm)
+{
+  if (!shm || !shm->IsOpen()) {
+    return GetDataContainerPbMsg();
+  }
+
+  ns3opengym::DataContainer dataContainerPbMsg;
+  ns3opengym::BoxDataContainer boxContainerPbMsg;
+
+  std::vector<uint32_t> shape = GetShape();
+  *boxContainerPbMsg.mutable_shape() = {shape.begin(), shape.end()};
+  boxContainerPbMsg.set_dtype(m_dtype);
+
+  bool copied;
+  if (m_dtype == ns3opengym::INT) {
+    copied = CopyToSharedMemory<int32_t>(shm, boxContainerPbMsg);
+  } else if (m_dtype == ns3opengym::UINT) {
+    copied = CopyToSharedMemory<uint32_t>(shm, boxContainerPbMsg);
+  } else if (m_dtype == ns3opengym::DOUBLE) {
+    copied = CopyToSharedMemory<double>(shm, boxContainerPbMsg);
+  } else {
+    copied = CopyToSharedMemory<float>(shm, boxContainerPbMsg);
+  }
+  if (!copied) {
+    // does not fit, fall back to the message
+    return GetDataContainerPbMsg();
+  }
+
+  dataContainerPbMsg.set_type(ns3opengym::Box);
+  dataContainerPbMsg.mutable_data()->PackFrom(boxContainerPbMsg);
+  return dataContainerPbMsg;
+}
+
+template <typename T>
+template <typename U>
+bool
+OpenGymBoxContainer<T>::CopyToSharedMemory(Ptr<OpenGymSharedMemory> shm, ns3opengym::BoxDataContainer &boxContainerPbMsg)
+{
+  uint64_t offset = 0;
+  U *dst = reinterpret_cast<U *>(shm->Allocate(GetSize() * sizeof(U), offset));
+  if (dst == 0) {
+    return false;
+  }
+  const T *src = GetDataPointer();
+  std::copy(src, src + GetSize(), dst);
+  boxContainerPbMsg.set_shmdata(true);
+  boxContainerPbMsg.set_shmoffset(offset);
+  boxContainerPbMsg.set_shmlength(GetSize());
+  return true;
+}
+
 template <typename T>
 bool
 OpenGymBoxContainer<T>::AddValue(T value)
 {
+  if (m_view != 0) {
+    m_data.assign(m_view, m_view + m_viewSize);
+    m_view = 0;
+    m_viewSize = 0;
+  }
   m_data.push_back(value);
   return true;
 }
@@ -230,9 +325,9 @@ T
 OpenGymBoxContainer<T>::GetValue(uint32_t idx)
 {
   T data = 0;
-  if (idx < m_data.size())
+  if (idx < GetSize())
   {
-    data = m_data.at(idx);
+    data = GetDataPointer()[idx];
   }
   return data;
 }
@@ -241,10 +336,35 @@ template <typename T>
 bool
 OpenGymBoxContainer<T>::SetData(std::vector<T> data)
 {
-  m_data = data;
+  m_data = std::move (data);
+  m_view = 0;
+  m_viewSize = 0;
   return true;
 }
 
+template <typename T>
+void
+OpenGymBoxContainer<T>::SetDataView(const T *data, uint32_t size)
+{
+  m_data.clear();
+  m_view = data;
+  m_viewSize = size;
+}
+
+template <typename T>
+const T *
+OpenGymBoxContainer<T>::GetDataPointer() const
+{
+  return m_view != 0 ? m_view : m_data.data();
+}
+
+template <typename T>
+uint32_t
+OpenGymBoxContainer<T>::GetSize() const
+{
+  return m_view != 0 ? m_viewSize : m_data.size();
+}
+
 template <typename T>
 std::vector<uint32_t>
 OpenGymBoxContainer<T>::GetShape()
@@ -256,7 +376,8 @@ template <typename T>
 std::vector<T>
 OpenGymBoxContainer<T>::GetData()
 {
-  return m_data;
+  const T *data = GetDataPointer();
+  return std::vector<T> (data, data + GetSize());
 }
 
 template <typename T>
@@ -264,12 +385,12 @@ void
 OpenGymBoxContainer<T>::Print(std::ostream& where) const
 {
   where << "[";
-  for (auto i = m_data.begin(); i != m_data.end(); ++i)
+  const T *begin = GetDataPointer();
+  const T *end = begin + GetSize();
+  for (const T *i = begin; i != end; ++i)
   {
     where << std::to_string(*i);
-    auto i2 = i;
-    i2++;
-    if (i2 != m_data.end())
+    if (i + 1 != end)
       where << ", ";
   }
   where << "]";
@@ -285,6 +406,7 @@ public:
   static TypeId GetTypeId ();
 
   virtual ns3opengym::DataContainer GetDataContainerPbMsg();
+  virtual ns3opengym::DataContainer GetDataContainerPbMsg(Ptr<OpenGymSharedMemory> shm);
 
   virtual void Print(std::ostream& where) const;
   friend std::ostream& operator<< (std::ostream& os, const Ptr<OpenGymTupleContainer> container)
@@ -314,6 +436,7 @@ public:
   static TypeId GetTypeId ();
 
   virtual ns3opengym::DataContainer GetDataContainerPbMsg();
+  virtual ns3opengym::DataContainer GetDataContainerPbMsg(Ptr<OpenGymSharedMemory> shm);
 
   virtual void Print(std::ostream& where) const;
   friend std::ostream& operator<< ( std::ostream& os, const Ptr<OpenGymDictContainer> container)
@@ -3,4 +3,9 @@ from gym.envs.registration import register
 register(
     id='ns3-v0',
     entry_point='ns3gym.ns3env:Ns3Env',
-)
\ No newline at end of file
+)
+
+register(
+    id='ns3-vector-v0',
+    entry_point='ns3gym.ns3env:Ns3VectorEnv',
+)
@@ -2,6 +2,7 @@ import os
 import sys
 import zmq
 import time
+import mmap
 
 import numpy as np
 
@@ -75,6 +76,11 @@ class Ns3ZmqBridge(object):
         self.extraInfo = None
         self.newStateRx = False
 
+        # shared memory region for Box data, mapped if the simulation offers one
+        self.shm = None
+        self.shmActOffset = 0
+        self.shmActCursor = 0
+
     def close(self):
         try:
             if not self.envStopped:
@@ -153,6 +159,15 @@ class Ns3ZmqBridge(object):
         self._action_space = self._create_space(simInitMsg.actSpace)
         self._observation_space = self._create_space(simInitMsg.obsSpace)
 
+        if simInitMsg.shmPath:
+            try:
+                with open(simInitMsg.shmPath, 'r+b') as f:
+                    self.shm = mmap.mmap(f.fileno(), simInitMsg.shmSize)
+                self.shmActOffset = int(simInitMsg.shmActOffset)
+            except Exception as e:
+                print("Cannot map shared memory {}: {}, Box data is sent over ZMQ".format(simInitMsg.shmPath, e))
+                self.shm = None
+
         reply = pb.SimInitAck()
         reply.done = True
         reply.stopSimReq = False
@@ -207,6 +222,7 @@ class Ns3ZmqBridge(object):
 
     def send_actions(self, actions):
         reply = pb.EnvActMsg()
+        self.shmActCursor = self.shmActOffset
 
         actionMsg = self._pack_data(actions, self._action_space)
         reply.actData.CopyFrom(actionMsg)
@@ -241,6 +257,12 @@ class Ns3ZmqBridge(object):
             dataContainerPb.data.Unpack(boxContainerPb)
             # print(boxContainerPb.shape, boxContainerPb.dtype, boxContainerPb.uintData)
 
+            if boxContainerPb.shmData and self.shm is not None:
+                # one copy out of the shared memory, the region is rewritten at the next step
+                return np.frombuffer(self.shm, dtype=self._shm_dtype(boxContainerPb.dtype),
+                                     count=boxContainerPb.shmLength,
+                                     offset=boxContainerPb.shmOffset).copy()
+
             if boxContainerPb.dtype == pb.INT:
                 data = boxContainerPb.intData
             elif boxContainerPb.dtype == pb.UINT:
@@ -305,23 +327,24 @@ class Ns3ZmqBridge(object):
 
             if (spaceDesc.dtype in ['int', 'int8', 'int16', 'int32', 'int64']):
                 boxContainerPb.dtype = pb.INT
-                boxContainerPb.intData.extend(actions)
-
             elif (spaceDesc.dtype in ['uint', 'uint8', 'uint16', 'uint32', 'uint64']):
                 boxContainerPb.dtype = pb.UINT
-                boxContainerPb.uintData.extend(actions)
-
             elif (spaceDesc.dtype in ['float', 'float32', 'float64']):
                 boxContainerPb.dtype = pb.FLOAT
-                boxContainerPb.floatData.extend(actions)
-
             elif (spaceDesc.dtype in ['double']):
                 boxContainerPb.dtype = pb.DOUBLE
-                boxContainerPb.doubleData.extend(actions)
-
             else:
                 boxContainerPb.dtype = pb.FLOAT
-                boxContainerPb.floatData.extend(actions)
+
+            if not self._pack_shm(actions, boxContainerPb):
+                if boxContainerPb.dtype == pb.INT:
+                    boxContainerPb.intData.extend(actions)
+                elif boxContainerPb.dtype == pb.UINT:
+                    boxContainerPb.uintData.extend(actions)
+                elif boxContainerPb.dtype == pb.DOUBLE:
+                    boxContainerPb.doubleData.extend(actions)
+                else:
+                    boxContainerPb.floatData.extend(actions)
 
             dataContainer.data.Pack(boxContainerPb)
 
@@ -355,7 +378,111 @@ class Ns3ZmqBridge(object):
         return dataContainer
 
 
+    def _shm_dtype(self, dtype):
+        if dtype == pb.INT:
+            return np.int32
+        elif dtype == pb.UINT:
+            return np.uint32
+        elif dtype == pb.DOUBLE:
+            return np.float64
+        return np.float32
+
+    def _pack_shm(self, actions, boxContainerPb):
+        if self.shm is None:
+            return False
+        data = np.ascontiguousarray(actions, dtype=self._shm_dtype(boxContainerPb.dtype)).ravel()
+        offset = self.shmActCursor
+        if offset + data.nbytes > len(self.shm):
+            return False
+        np.frombuffer(self.shm, dtype=data.dtype, count=data.size, offset=offset)[:] = data
+        # keep every Box 8-byte aligned
+        self.shmActCursor = offset + (data.nbytes + 7) // 8 * 8
+        boxContainerPb.shmData = True
+        boxContainerPb.shmOffset = offset
+        boxContainerPb.shmLength = data.size
+        return True
+
+
+class Ns3VectorZmqBridge(Ns3ZmqBridge):
+    """Bridge to a vector env: states and actions of all the envs are exchanged as one batch"""
+    def __init__(self, port=0, startSim=True, simSeed=0, simArgs={}, debug=False):
+        super(Ns3VectorZmqBridge, self).__init__(port, startSim, simSeed, simArgs, debug)
+        self.numEnvs = 1
+
+    def initialize_env(self, stepInterval):
+        request = self.socket.recv()
+        simInitMsg = pb.SimInitMsg()
+        simInitMsg.ParseFromString(request)
+
+        self.simPid = int(simInitMsg.simProcessId)
+        self.wafPid = int(simInitMsg.wafShellProcessId)
+        self.numEnvs = max(1, int(simInitMsg.numEnvs))
+        self._action_space = self._create_space(simInitMsg.actSpace)
+        self._observation_space = self._create_space(simInitMsg.obsSpace)
+
+        reply = pb.SimInitAck()
+        reply.done = True
+        reply.stopSimReq = False
+        replyMsg = reply.SerializeToString()
+        self.socket.send(replyMsg)
+        return True
+
+    def rx_env_state(self):
+        if self.newStateRx:
+            return
+
+        request = self.socket.recv()
+        envStateBatchMsg = pb.EnvStateBatchMsg()
+        envStateBatchMsg.ParseFromString(request)
+        states = envStateBatchMsg.state
+
+        self.obsData = [self._create_data(s.obsData) for s in states]
+        self.reward = [s.reward for s in states]
+        self.gameOver = [s.isGameOver for s in states]
+        self.gameOverReason = [s.reason for s in states]
+        self.extraInfo = [s.info if s.info else {} for s in states]
+
+        # the batch is over once every env is over
+        if all(self.gameOver):
+            if all(r == pb.EnvStateMsg.SimulationEnd for r in self.gameOverReason):
+                self.envStopped = True
+            else:
+                self.forceEnvStop = True
+            self.send_close_command()
+
+        self.newStateRx = True
+
+    def send_close_command(self):
+        reply = pb.EnvActBatchMsg()
+        reply.stopSimReq = True
+
+        replyMsg = reply.SerializeToString()
+        self.socket.send(replyMsg)
+        self.newStateRx = False
+        return True
+
+    def send_actions(self, actions):
+        reply = pb.EnvActBatchMsg()
+        for action in actions:
+            act = reply.act.add()
+            act.actData.CopyFrom(self._pack_data(action, self._action_space))
+
+        reply.stopSimReq = False
+        if self.forceEnvStop:
+            reply.stopSimReq = True
+
+        replyMsg = reply.SerializeToString()
+        self.socket.send(replyMsg)
+        self.newStateRx = False
+        return True
+
+    def is_game_over(self):
+        return list(self.gameOver)
+
+
 class Ns3Env(gym.Env):
+    bridgeClass = Ns3ZmqBridge
+
     def __init__(self, stepTime=0, port=0, startSim=True, simSeed=0, simArgs={}, debug=False):
         self.stepTime = stepTime
         self.port = port
@@ -373,7 +500,7 @@ class Ns3Env(gym.Env):
         self.state = None
         self.steps_beyond_done = None
 
-        self.ns3ZmqBridge = Ns3ZmqBridge(self.port, self.startSim, self.simSeed, self.simArgs, self.debug)
+        self.ns3ZmqBridge = self.bridgeClass(self.port, self.startSim, self.simSeed, self.simArgs, self.debug)
         self.has_initialized = False
 
     def init(self):
@@ -416,7 +543,7 @@ class Ns3Env(gym.Env):
             self.ns3ZmqBridge = None
 
         self.envDirty = False
-        self.ns3ZmqBridge = Ns3ZmqBridge(self.port, self.startSim, self.simSeed, self.simArgs, self.debug)
+        self.ns3ZmqBridge = self.bridgeClass(self.port, self.startSim, self.simSeed, self.simArgs, self.debug)
         self.ns3ZmqBridge.initialize_env(self.stepTime)
         self.action_space = self.ns3ZmqBridge.get_action_space()
         self.observation_space = self.ns3ZmqBridge.get_observation_space()
@@ -444,3 +571,19 @@ class Ns3Env(gym.Env):
 
         if self.viewer:
             self.viewer.close()
+
+
+class Ns3VectorEnv(Ns3Env):
+    """Several instances of the simulation script stepped as one batch.
+
+    The script has to fork its instances with OpenGymVectorEnv::Fork. Observations,
+    rewards, done flags and infos are lists with one entry per env, and step takes
+    a list of actions.
+    """
+    bridgeClass = Ns3VectorZmqBridge
+
+    def get_num_envs(self):
+        return self.ns3ZmqBridge.numEnvs
+
+    def get_random_action(self):
+        return [self.action_space.sample() for _ in range(self.get_num_envs())]
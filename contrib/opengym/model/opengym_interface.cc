@@ -24,10 +24,14 @@
 #include "ns3/log.h"
 #include "ns3/config.h"
 #include "ns3/simulator.h"
+#include "ns3/simulation-checkpoint.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
 #include "opengym_interface.h"
 #include "opengym_env.h"
 #include "container.h"
 #include "spaces.h"
+#include "opengym_shm.h"
 #include "messages.pb.h"
 
 namespace ns3 {
@@ -44,6 +48,20 @@ OpenGymInterface::GetTypeId (void)
     .SetParent<Object> ()
     .SetGroupName ("OpenGym")
     .AddConstructor<OpenGymInterface> ()
+    .AddAttribute ("SharedMemoryPath",
+                   "File mapped in memory to exchange Box observations and actions "
+                   "with the agent without serializing them, e.g., /dev/shm/ns3gym. "
+                   "Empty to send all the data in the ZMQ messages.",
+                   StringValue (""),
+                   MakeStringAccessor (&OpenGymInterface::m_shmPath),
+                   MakeStringChecker ())
+    .AddAttribute ("SharedMemorySize",
+                   "Size in bytes of the shared memory file, half for the observations "
+                   "and half for the actions. Box data that does not fit is sent in the "
+                   "ZMQ messages.",
+                   UintegerValue (16 * 1024 * 1024),
+                   MakeUintegerAccessor (&OpenGymInterface::m_shmSize),
+                   MakeUintegerChecker<uint64_t> ())
     ;
   return tid;
 }
@@ -79,7 +97,8 @@ OpenGymInterface::Delete (void)
 
 OpenGymInterface::OpenGymInterface(uint32_t port):
   m_port(port), m_zmq_context(1), m_zmq_socket(m_zmq_context, ZMQ_REQ),
-  m_simEnd(false), m_stopEnvRequested(false), m_initSimMsgSent(false)
+  m_simEnd(false), m_stopEnvRequested(false), m_initSimMsgSent(false),
+  m_shmSize(0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -93,6 +112,10 @@ void
 OpenGymInterface::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_shm) {
+    m_shm->Dispose();
+    m_shm = 0;
+  }
 }
 
 void
@@ -186,6 +209,18 @@ OpenGymInterface::Init()
     simInitMsg.mutable_actspace()->CopyFrom(spaceDesc);
   }
 
+  if (!m_shmPath.empty()) {
+    m_shm = CreateObject<OpenGymSharedMemory> ();
+    if (m_shm->Open(m_shmPath, m_shmSize)) {
+      simInitMsg.set_shmpath(m_shm->GetPath());
+      simInitMsg.set_shmsize(m_shm->GetSize());
+      simInitMsg.set_shmactoffset(m_shm->GetActionOffset());
+    } else {
+      NS_LOG_UNCOND("Cannot map " << m_shmPath << ", Box data is sent over ZMQ");
+      m_shm = 0;
+    }
+  }
+
   // send init msg to python
   zmq::message_t request(simInitMsg.ByteSizeLong());;
   simInitMsg.SerializeToArray(request.data(), simInitMsg.ByteSizeLong());
@@ -204,6 +239,8 @@ OpenGymInterface::Init()
   if (stopSim) {
     NS_LOG_DEBUG("---Stop requested: " << stopSim);
     m_stopEnvRequested = true;
+    // do not fork further episodes from a checkpoint
+    SimulationCheckpoint::Stop();
     Simulator::Stop();
     Simulator::Destroy ();
     std::exit(0);
@@ -233,7 +270,10 @@ OpenGymInterface::NotifyCurrentState()
   // observation
   ns3opengym::DataContainer obsDataContainerPbMsg;
   if (obsDataContainer) {
-    obsDataContainerPbMsg = obsDataContainer->GetDataContainerPbMsg();
+    if (m_shm) {
+      m_shm->Rewind();
+    }
+    obsDataContainerPbMsg = obsDataContainer->GetDataContainerPbMsg(m_shm);
     envStateMsg.mutable_obsdata()->CopyFrom(obsDataContainerPbMsg);
   }
   // reward
@@ -273,6 +313,8 @@ OpenGymInterface::NotifyCurrentState()
   if (stopSim) {
     NS_LOG_DEBUG("---Stop requested: " << stopSim);
     m_stopEnvRequested = true;
+    // do not fork further episodes from a checkpoint
+    SimulationCheckpoint::Stop();
     Simulator::Stop();
     Simulator::Destroy ();
     std::exit(0);
@@ -280,7 +322,7 @@ OpenGymInterface::NotifyCurrentState()
 
   // first step after reset is called without actions, just to get current state
   ns3opengym::DataContainer actDataContainerPbMsg = envActMsg.actdata();
-  Ptr<OpenGymDataContainer> actDataContainer = OpenGymDataContainer::CreateFromDataContainerPbMsg(actDataContainerPbMsg);
+  Ptr<OpenGymDataContainer> actDataContainer = OpenGymDataContainer::CreateFromDataContainerPbMsg(actDataContainerPbMsg, m_shm);
   ExecuteActions(actDataContainer);
 
 }
@@ -30,6 +30,7 @@ namespace ns3 {
 class OpenGymSpace;
 class OpenGymDataContainer;
 class OpenGymEnv;
+class OpenGymSharedMemory;
 
 class OpenGymInterface : public Object
 {
@@ -82,6 +83,11 @@ private:
   bool m_stopEnvRequested;
   bool m_initSimMsgSent;
 
+  // Box data exchanged through a memory mapped file when the path is set
+  std::string m_shmPath;
+  uint64_t m_shmSize;
+  Ptr<OpenGymSharedMemory> m_shm;
+
   Callback< Ptr<OpenGymSpace> > m_actionSpaceCb;
   Callback< Ptr<OpenGymSpace> > m_observationSpaceCb;
   Callback< bool > m_gameOverCb;
@@ -0,0 +1,173 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ns3/log.h"
+#include "opengym_shm.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("OpenGymSharedMemory");
+
+NS_OBJECT_ENSURE_REGISTERED (OpenGymSharedMemory);
+
+// every Box starts on an 8-byte boundary so that the agent can map it
+// as a typed array in place
+static const uint64_t SHM_ALIGNMENT = 8;
+
+TypeId
+OpenGymSharedMemory::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::OpenGymSharedMemory")
+    .SetParent<Object> ()
+    .SetGroupName ("OpenGym")
+    .AddConstructor<OpenGymSharedMemory> ()
+    ;
+  return tid;
+}
+
+OpenGymSharedMemory::OpenGymSharedMemory ()
+  : m_fd (-1), m_base (0), m_size (0), m_cursor (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+OpenGymSharedMemory::~OpenGymSharedMemory ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+OpenGymSharedMemory::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+OpenGymSharedMemory::Open (std::string path, uint64_t size)
+{
+  NS_LOG_FUNCTION (this << path << size);
+  Close ();
+
+  size -= size % (2 * SHM_ALIGNMENT);
+  if (size == 0) {
+    NS_LOG_WARN ("Shared memory size too small");
+    return false;
+  }
+
+  int fd = ::open (path.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  if (fd < 0) {
+    NS_LOG_WARN ("Cannot open " << path << ": " << std::strerror (errno));
+    return false;
+  }
+  if (::ftruncate (fd, size) != 0) {
+    NS_LOG_WARN ("Cannot resize " << path << ": " << std::strerror (errno));
+    ::close (fd);
+    ::unlink (path.c_str ());
+    return false;
+  }
+  void *base = ::mmap (0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    NS_LOG_WARN ("Cannot map " << path << ": " << std::strerror (errno));
+    ::close (fd);
+    ::unlink (path.c_str ());
+    return false;
+  }
+
+  m_path = path;
+  m_fd = fd;
+  m_base = static_cast<uint8_t *> (base);
+  m_size = size;
+  m_cursor = 0;
+  return true;
+}
+
+void
+OpenGymSharedMemory::Close ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_base == 0) {
+    return;
+  }
+  ::munmap (m_base, m_size);
+  ::close (m_fd);
+  // the agent keeps its own mapping alive
+  ::unlink (m_path.c_str ());
+  m_base = 0;
+  m_fd = -1;
+  m_size = 0;
+  m_cursor = 0;
+}
+
+bool
+OpenGymSharedMemory::IsOpen () const
+{
+  return m_base != 0;
+}
+
+std::string
+OpenGymSharedMemory::GetPath () const
+{
+  return m_path;
+}
+
+uint64_t
+OpenGymSharedMemory::GetSize () const
+{
+  return m_size;
+}
+
+uint64_t
+OpenGymSharedMemory::GetActionOffset () const
+{
+  return m_size / 2;
+}
+
+void
+OpenGymSharedMemory::Rewind ()
+{
+  m_cursor = 0;
+}
+
+uint8_t *
+OpenGymSharedMemory::Allocate (uint64_t bytes, uint64_t &offset)
+{
+  uint64_t aligned = (bytes + SHM_ALIGNMENT - 1) / SHM_ALIGNMENT * SHM_ALIGNMENT;
+  if (m_base == 0 || aligned > GetActionOffset () - m_cursor) {
+    return 0;
+  }
+  offset = m_cursor;
+  m_cursor += aligned;
+  return m_base + offset;
+}
+
+const uint8_t *
+OpenGymSharedMemory::Get (uint64_t offset, uint64_t bytes) const
+{
+  if (m_base == 0 || offset > m_size || bytes > m_size - offset) {
+    return 0;
+  }
+  return m_base + offset;
+}
+
+} // end of namespace ns3
@@ -0,0 +1,108 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OPENGYM_SHM_H
+#define OPENGYM_SHM_H
+
+#include "ns3/object.h"
+
+namespace ns3 {
+
+/**
+ * Memory mapped file shared with the agent, used to exchange Box data
+ * without serializing it into the ZMQ messages.
+ *
+ * The region is split in two halves. The simulator writes observations
+ * in the first one and the agent writes actions in the second one; the
+ * protobuf messages only carry the offset and length of each Box. Since
+ * the exchange is lockstep (REQ/REP), each half is simply rewound before
+ * every message.
+ */
+class OpenGymSharedMemory : public Object
+{
+public:
+  OpenGymSharedMemory ();
+  virtual ~OpenGymSharedMemory ();
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+
+  /**
+   * Create (or truncate) the file and map it.
+   * \param path the path of the file
+   * \param size the size of the region, in bytes
+   * \return false on failure
+   */
+  bool Open (std::string path, uint64_t size);
+  /**
+   * Unmap the region and remove the file.
+   */
+  void Close ();
+  /**
+   * \return true if the region is mapped
+   */
+  bool IsOpen () const;
+
+  /**
+   * \return the path of the file
+   */
+  std::string GetPath () const;
+  /**
+   * \return the size of the region, in bytes
+   */
+  uint64_t GetSize () const;
+  /**
+   * \return the offset of the half written by the agent
+   */
+  uint64_t GetActionOffset () const;
+
+  /**
+   * Restart writing at the beginning of the observation half.
+   */
+  void Rewind ();
+  /**
+   * Reserve bytes in the observation half.
+   * \param bytes the number of bytes to reserve
+   * \param [out] offset the offset of the reserved bytes in the region
+   * \return the reserved bytes, or 0 if they do not fit
+   */
+  uint8_t * Allocate (uint64_t bytes, uint64_t &offset);
+  /**
+   * Access bytes anywhere in the region.
+   * \param offset the offset of the bytes in the region
+   * \param bytes the number of bytes
+   * \return the bytes, or 0 if they are out of range
+   */
+  const uint8_t * Get (uint64_t offset, uint64_t bytes) const;
+
+protected:
+  // Inherited
+  virtual void DoDispose (void);
+
+private:
+  std::string m_path; //!< path of the mapped file
+  int m_fd;           //!< file descriptor of the mapped file
+  uint8_t *m_base;    //!< start of the mapped region
+  uint64_t m_size;    //!< size of the mapped region
+  uint64_t m_cursor;  //!< next free byte of the observation half
+};
+
+} // end of namespace ns3
+
+#endif /* OPENGYM_SHM_H */
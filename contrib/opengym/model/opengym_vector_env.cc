@@ -0,0 +1,319 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <zmq.hpp>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/rng-seed-manager.h"
+#include "opengym_vector_env.h"
+#include "messages.pb.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("OpenGymVectorEnv");
+
+bool OpenGymVectorEnv::m_isWorker = false;
+uint32_t OpenGymVectorEnv::m_index = 0;
+uint32_t OpenGymVectorEnv::m_workerPort = 0;
+int OpenGymVectorEnv::m_exitStatus = 0;
+
+bool
+OpenGymVectorEnv::Fork (uint32_t nEnvs, uint32_t agentPort)
+{
+  NS_LOG_FUNCTION (nEnvs << agentPort);
+  NS_ABORT_MSG_IF (nEnvs == 0, "A vector env needs at least one environment");
+  NS_ABORT_MSG_IF (m_isWorker, "Vector envs cannot be nested");
+
+  int portPipe[2];
+  if (pipe (portPipe) != 0) {
+    NS_FATAL_ERROR ("Vector env: pipe failed: " << std::strerror (errno));
+  }
+
+  // do not let the workers inherit and print again buffered output
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (nullptr);
+
+  uint32_t baseRun = RngSeedManager::GetRun ();
+  std::vector<pid_t> workers;
+  for (uint32_t i = 0; i < nEnvs; i++) {
+    pid_t pid = fork ();
+    if (pid < 0) {
+      NS_FATAL_ERROR ("Vector env: fork failed: " << std::strerror (errno));
+    }
+    if (pid == 0) {
+      ::close (portPipe[1]);
+      // wait until the broker listens
+      uint32_t port = 0;
+      if (::read (portPipe[0], &port, sizeof (port)) != sizeof (port)) {
+        NS_FATAL_ERROR ("Vector env: broker port not received");
+      }
+      ::close (portPipe[0]);
+      m_isWorker = true;
+      m_index = i;
+      m_workerPort = port;
+      RngSeedManager::SetRun (baseRun + i);
+      return true;
+    }
+    workers.push_back (pid);
+  }
+  ::close (portPipe[0]);
+
+  RunBroker (workers, agentPort, portPipe[1]);
+
+  int failed = 0;
+  for (uint32_t i = 0; i < workers.size (); i++) {
+    int status = 0;
+    if (waitpid (workers.at (i), &status, 0) < 0 || !WIFEXITED (status) || WEXITSTATUS (status) != 0) {
+      NS_LOG_UNCOND ("Vector env: worker " << i << " failed");
+      failed++;
+    }
+  }
+  m_exitStatus = failed ? 1 : 0;
+  return false;
+}
+
+bool
+OpenGymVectorEnv::IsWorker ()
+{
+  return m_isWorker;
+}
+
+uint32_t
+OpenGymVectorEnv::GetIndex ()
+{
+  return m_index;
+}
+
+uint32_t
+OpenGymVectorEnv::GetWorkerPort ()
+{
+  return m_workerPort;
+}
+
+int
+OpenGymVectorEnv::GetExitStatus ()
+{
+  return m_exitStatus;
+}
+
+/*
+Receive one message from a worker (REQ -> ROUTER envelope)
+*/
+static bool
+RecvFromWorker (zmq::socket_t &socket, std::string &identity, zmq::message_t &payload)
+{
+  zmq::pollitem_t item = {(void*)socket, 0, ZMQ_POLLIN, 0};
+  if (zmq_poll (&item, 1, 1000) <= 0 || !(item.revents & ZMQ_POLLIN)) {
+    return false;
+  }
+  zmq::message_t id;
+  zmq::message_t empty;
+  (void) socket.recv (id, zmq::recv_flags::none);
+  (void) socket.recv (empty, zmq::recv_flags::none);
+  (void) socket.recv (payload, zmq::recv_flags::none);
+  identity.assign (static_cast<const char*> (id.data ()), id.size ());
+  return true;
+}
+
+static void
+SendToWorker (zmq::socket_t &socket, const std::string &identity, const std::string &payload)
+{
+  zmq::message_t id (identity.data (), identity.size ());
+  zmq::message_t empty (0);
+  zmq::message_t msg (payload.data (), payload.size ());
+  socket.send (id, zmq::send_flags::sndmore);
+  socket.send (empty, zmq::send_flags::sndmore);
+  socket.send (msg, zmq::send_flags::none);
+}
+
+/*
+Return the index of a worker that exited while the broker waits for it, or -1
+*/
+static int
+FindDeadWorker (const std::vector<pid_t> &workers, const std::vector<bool> &waiting)
+{
+  for (uint32_t i = 0; i < workers.size (); i++) {
+    int status;
+    if (waiting.at (i) && waitpid (workers.at (i), &status, WNOHANG) == workers.at (i)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void
+OpenGymVectorEnv::RunBroker (std::vector<pid_t> workers, uint32_t agentPort, int portFd)
+{
+  NS_LOG_FUNCTION (workers.size () << agentPort);
+  uint32_t n = workers.size ();
+
+  zmq::context_t context (1);
+  zmq::socket_t workerSocket (context, ZMQ_ROUTER);
+  workerSocket.bind ("tcp://127.0.0.1:*");
+  char endpoint[256];
+  size_t endpointSize = sizeof (endpoint);
+  zmq_getsockopt ((void*)workerSocket, ZMQ_LAST_ENDPOINT, endpoint, &endpointSize);
+  std::string ep (endpoint);
+  uint32_t port = std::stoul (ep.substr (ep.rfind (':') + 1));
+  for (uint32_t i = 0; i < n; i++) {
+    if (::write (portFd, &port, sizeof (port)) != sizeof (port)) {
+      NS_FATAL_ERROR ("Vector env: cannot send the broker port to the workers");
+    }
+  }
+  ::close (portFd);
+
+  zmq::socket_t agentSocket (context, ZMQ_REQ);
+  std::string connectAddr = "tcp://localhost:" + std::to_string (agentPort);
+  agentSocket.connect (connectAddr);
+  NS_LOG_UNCOND ("vector env proc id: " << ::getpid () << " hosting " << n
+                 << " envs, waiting for agt to connect on port: " << connectAddr);
+
+  std::map<pid_t, uint32_t> indexOfPid;
+  for (uint32_t i = 0; i < n; i++) {
+    indexOfPid[workers.at (i)] = i;
+  }
+
+  // init: identify the workers by their process id and forward one init msg
+  std::vector<std::string> identities (n);
+  std::vector<bool> waiting (n, true);
+  ns3opengym::SimInitMsg simInitMsg;
+  uint32_t nInit = 0;
+  while (nInit < n) {
+    std::string identity;
+    zmq::message_t payload;
+    if (!RecvFromWorker (workerSocket, identity, payload)) {
+      int dead = FindDeadWorker (workers, waiting);
+      NS_ABORT_MSG_IF (dead >= 0, "Vector env: worker " << dead << " exited before init");
+      continue;
+    }
+    ns3opengym::SimInitMsg workerInitMsg;
+    workerInitMsg.ParseFromArray (payload.data (), payload.size ());
+    std::map<pid_t, uint32_t>::iterator it = indexOfPid.find (workerInitMsg.simprocessid ());
+    NS_ABORT_MSG_IF (it == indexOfPid.end (), "Vector env: init from unknown process " << workerInitMsg.simprocessid ());
+    NS_ABORT_MSG_IF (!workerInitMsg.shmpath ().empty (), "Vector env: shared memory is not supported by vector envs");
+    identities.at (it->second) = identity;
+    waiting.at (it->second) = false;
+    if (it->second == 0) {
+      simInitMsg = workerInitMsg;
+    }
+    nInit++;
+  }
+  simInitMsg.set_simprocessid (::getpid ());
+  simInitMsg.set_wafshellprocessid (::getppid ());
+  simInitMsg.set_numenvs (n);
+
+  std::string request;
+  simInitMsg.SerializeToString (&request);
+  zmq::message_t initRequest (request.data (), request.size ());
+  agentSocket.send (initRequest, zmq::send_flags::none);
+  zmq::message_t initReply;
+  (void) agentSocket.recv (initReply, zmq::recv_flags::none);
+  std::string initAck (static_cast<const char*> (initReply.data ()), initReply.size ());
+  for (uint32_t i = 0; i < n; i++) {
+    SendToWorker (workerSocket, identities.at (i), initAck);
+  }
+  ns3opengym::SimInitAck simInitAck;
+  simInitAck.ParseFromString (initAck);
+  if (simInitAck.stopsimreq ()) {
+    return;
+  }
+
+  std::map<std::string, uint32_t> indexOfIdentity;
+  for (uint32_t i = 0; i < n; i++) {
+    indexOfIdentity[identities.at (i)] = i;
+  }
+
+  // steps: one batch per round of worker states
+  std::vector<ns3opengym::EnvStateMsg> states (n);
+  std::vector<bool> ended (n, false);
+  uint32_t nActive = n;
+  while (nActive > 0) {
+    for (uint32_t i = 0; i < n; i++) {
+      waiting.at (i) = !ended.at (i);
+    }
+    uint32_t nWaiting = nActive;
+    while (nWaiting > 0) {
+      std::string identity;
+      zmq::message_t payload;
+      if (!RecvFromWorker (workerSocket, identity, payload)) {
+        int dead = FindDeadWorker (workers, waiting);
+        if (dead >= 0) {
+          NS_LOG_UNCOND ("Vector env: worker " << dead << " exited unexpectedly");
+          states.at (dead).set_isgameover (true);
+          states.at (dead).set_reason (ns3opengym::EnvStateMsg::SimulationEnd);
+          waiting.at (dead) = false;
+          ended.at (dead) = true;
+          nWaiting--;
+          nActive--;
+        }
+        continue;
+      }
+      uint32_t idx = indexOfIdentity.at (identity);
+      states.at (idx).ParseFromArray (payload.data (), payload.size ());
+      waiting.at (idx) = false;
+      nWaiting--;
+    }
+
+    ns3opengym::EnvStateBatchMsg stateBatch;
+    for (uint32_t i = 0; i < n; i++) {
+      *stateBatch.add_state () = states.at (i);
+    }
+    stateBatch.SerializeToString (&request);
+    zmq::message_t batchRequest (request.data (), request.size ());
+    agentSocket.send (batchRequest, zmq::send_flags::none);
+
+    zmq::message_t batchReply;
+    (void) agentSocket.recv (batchReply, zmq::recv_flags::none);
+    ns3opengym::EnvActBatchMsg actBatch;
+    actBatch.ParseFromArray (batchReply.data (), batchReply.size ());
+
+    for (uint32_t i = 0; i < n; i++) {
+      if (ended.at (i)) {
+        continue;
+      }
+      ns3opengym::EnvActMsg act;
+      if ((int) i < actBatch.act_size ()) {
+        act = actBatch.act (i);
+      }
+      if (actBatch.stopsimreq ()) {
+        act.set_stopsimreq (true);
+      }
+      std::string reply;
+      act.SerializeToString (&reply);
+      SendToWorker (workerSocket, identities.at (i), reply);
+
+      bool simEnd = states.at (i).isgameover ()
+        && states.at (i).reason () == ns3opengym::EnvStateMsg::SimulationEnd;
+      if (act.stopsimreq () || simEnd) {
+        // the worker exits after this reply, keep reporting its last state
+        states.at (i).set_isgameover (true);
+        states.at (i).set_reason (ns3opengym::EnvStateMsg::SimulationEnd);
+        ended.at (i) = true;
+        nActive--;
+      }
+    }
+  }
+}
+
+} // end of namespace ns3
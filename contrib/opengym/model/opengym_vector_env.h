@@ -0,0 +1,89 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OPENGYM_VECTOR_ENV_H
+#define OPENGYM_VECTOR_ENV_H
+
+#include <stdint.h>
+#include <vector>
+#include <sys/types.h>
+
+namespace ns3 {
+
+/**
+ * Host several independent environments behind a single agent connection.
+ *
+ * Fork () is called at the start of the simulation script, after the
+ * command line has been parsed and the seed has been set but before any
+ * simulation object is created. The process forks one worker per
+ * environment, each with its own simulator, node set and RNG run
+ * (the run of the calling process plus the worker index), so module
+ * loading and TypeId registration are paid once and the workers step
+ * in parallel on all the cores.
+ *
+ * The calling process becomes a broker: it connects to the agent,
+ * collects the init message and every state of the workers, and exchanges
+ * them with the agent as a single batch (EnvStateBatchMsg / EnvActBatchMsg)
+ * per step. Workers must therefore notify the same number of times; once a
+ * worker has ended, its last state is repeated in the following batches.
+ * Fork () returns false in the broker once all the workers have ended, and
+ * the script is expected to return GetExitStatus () from main without
+ * simulating anything.
+ *
+ * Each worker returns true from Fork () and talks to the broker through a
+ * regular OpenGymInterface bound to GetWorkerPort ().
+ */
+class OpenGymVectorEnv
+{
+public:
+  /**
+   * Fork the workers and run the broker until they have all ended.
+   * \param nEnvs the number of workers
+   * \param agentPort the port of the agent
+   * \return true in the workers, false in the broker
+   */
+  static bool Fork (uint32_t nEnvs, uint32_t agentPort);
+
+  /**
+   * \return true in a worker
+   */
+  static bool IsWorker ();
+  /**
+   * \return the index of the worker
+   */
+  static uint32_t GetIndex ();
+  /**
+   * \return the port of the broker, to be used for the OpenGymInterface of
+   *         the worker
+   */
+  static uint32_t GetWorkerPort ();
+  /**
+   * \return the exit status of the broker, non zero if a worker failed
+   */
+  static int GetExitStatus ();
+
+private:
+  static void RunBroker (std::vector<pid_t> workers, uint32_t agentPort, int portFd);
+
+  static bool m_isWorker;       //!< true in a worker
+  static uint32_t m_index;      //!< index of the worker
+  static uint32_t m_workerPort; //!< port of the broker
+  static int m_exitStatus;      //!< exit status of the broker
+};
+
+} // end of namespace ns3
+
+#endif /* OPENGYM_VECTOR_ENV_H */
@@ -5,6 +5,14 @@
 
 // An essential include is test.h
 #include "ns3/test.h"
+#include "ns3/container.h"
+#include "ns3/opengym_shm.h"
+#include "ns3/opengym_vector_env.h"
+#include "ns3/messages.pb.h"
+#include <zmq.hpp>
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
 
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
@@ -46,6 +54,231 @@ OpengymTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// Box data exchanged through the shared memory region must round trip
+class OpengymSharedMemoryTestCase : public TestCase
+{
+public:
+  OpengymSharedMemoryTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+OpengymSharedMemoryTestCase::OpengymSharedMemoryTestCase ()
+  : TestCase ("Opengym Box data round trip through shared memory")
+{
+}
+
+void
+OpengymSharedMemoryTestCase::DoRun (void)
+{
+  std::string path = "/tmp/ns3gym-test-" + std::to_string (::getpid ());
+  Ptr<OpenGymSharedMemory> shm = CreateObject<OpenGymSharedMemory> ();
+  NS_TEST_ASSERT_MSG_EQ (shm->Open (path, 4096), true, "Cannot map " << path);
+
+  std::vector<uint32_t> shape = {3,};
+  Ptr<OpenGymBoxContainer<float> > floats = CreateObject<OpenGymBoxContainer<float> > (shape);
+  Ptr<OpenGymBoxContainer<int32_t> > ints = CreateObject<OpenGymBoxContainer<int32_t> > (shape);
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      floats->AddValue (0.5f * i);
+      ints->AddValue (-1 * (int32_t) i);
+    }
+  // too large for the observation half, must fall back to the message
+  Ptr<OpenGymBoxContainer<double> > large = CreateObject<OpenGymBoxContainer<double> > ();
+  large->SetData (std::vector<double> (1000, 1.5));
+
+  Ptr<OpenGymDictContainer> dict = CreateObject<OpenGymDictContainer> ();
+  dict->Add ("floats", floats);
+  dict->Add ("ints", ints);
+  dict->Add ("large", large);
+
+  shm->Rewind ();
+  ns3opengym::DataContainer msg = dict->GetDataContainerPbMsg (shm);
+  ns3opengym::DictDataContainer dictMsg;
+  msg.data ().UnpackTo (&dictMsg);
+  NS_TEST_ASSERT_MSG_EQ (dictMsg.element_size (), 3, "Unexpected number of elements");
+  for (int i = 0; i < dictMsg.element_size (); i++)
+    {
+      ns3opengym::BoxDataContainer boxMsg;
+      dictMsg.element (i).data ().UnpackTo (&boxMsg);
+      bool inShm = dictMsg.element (i).name () != "large";
+      NS_TEST_ASSERT_MSG_EQ (boxMsg.shmdata (), inShm, "Unexpected storage of " << dictMsg.element (i).name ());
+      NS_TEST_ASSERT_MSG_EQ ((boxMsg.floatdata_size () + boxMsg.intdata_size () + boxMsg.doubledata_size () == 0), inShm,
+                             "Box data must not be duplicated in the message");
+    }
+
+  Ptr<OpenGymDictContainer> copy = DynamicCast<OpenGymDictContainer> (OpenGymDataContainer::CreateFromDataContainerPbMsg (msg, shm));
+  NS_TEST_ASSERT_MSG_NE (copy, 0, "Cannot rebuild the dict");
+  std::vector<float> f = DynamicCast<OpenGymBoxContainer<float> > (copy->Get ("floats"))->GetData ();
+  std::vector<int32_t> n = DynamicCast<OpenGymBoxContainer<int32_t> > (copy->Get ("ints"))->GetData ();
+  std::vector<double> d = DynamicCast<OpenGymBoxContainer<double> > (copy->Get ("large"))->GetData ();
+  NS_TEST_ASSERT_MSG_EQ ((f == floats->GetData ()), true, "Float data differs");
+  NS_TEST_ASSERT_MSG_EQ ((n == ints->GetData ()), true, "Int data differs");
+  NS_TEST_ASSERT_MSG_EQ ((d == large->GetData ()), true, "Double data differs");
+
+  // Box data found in the region is viewed, not copied
+  uint64_t offset = shm->GetActionOffset ();
+  const uint8_t *region = shm->Get (offset, shm->GetSize () - offset) - offset;
+  Ptr<OpenGymBoxContainer<float> > viewed = DynamicCast<OpenGymBoxContainer<float> > (copy->Get ("floats"));
+  const uint8_t *viewedData = reinterpret_cast<const uint8_t *> (viewed->GetDataPointer ());
+  NS_TEST_ASSERT_MSG_EQ ((viewedData >= region && viewedData < region + shm->GetSize ()), true,
+                         "Box data must be viewed in the shared memory region");
+  NS_TEST_ASSERT_MSG_EQ (viewed->GetSize (), 3, "Unexpected size of the viewed data");
+  NS_TEST_ASSERT_MSG_EQ (viewed->GetValue (2), 1.0f, "Unexpected viewed value");
+  viewed->AddValue (2.0f);
+  NS_TEST_ASSERT_MSG_EQ (viewed->GetSize (), 4, "AddValue must copy the viewed data");
+  NS_TEST_ASSERT_MSG_NE (viewed->GetDataPointer (), reinterpret_cast<const float *> (viewedData),
+                         "AddValue must end the view");
+
+  shm->Close ();
+  NS_TEST_ASSERT_MSG_EQ (::access (path.c_str (), F_OK), -1, "The file must be removed on close");
+}
+
+// The broker of a vector env must batch the states of its workers and return
+// its status instead of exiting
+class OpengymVectorEnvTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param failingWorker whether the second worker exits with an error
+   */
+  OpengymVectorEnvTestCase (bool failingWorker);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Run the broker and the workers, in the process forked by DoRun.
+   * \param portFd read end of the pipe carrying the port of the agent
+   */
+  void RunVectorEnv (int portFd);
+
+  bool m_failingWorker; //!< whether the second worker exits with an error
+};
+
+OpengymVectorEnvTestCase::OpengymVectorEnvTestCase (bool failingWorker)
+  : TestCase (std::string ("Opengym vector env") + (failingWorker ? " with a failing worker" : "")),
+    m_failingWorker (failingWorker)
+{
+}
+
+void
+OpengymVectorEnvTestCase::RunVectorEnv (int portFd)
+{
+  uint32_t port = 0;
+  if (::read (portFd, &port, sizeof (port)) != sizeof (port))
+    {
+      _exit (2);
+    }
+  ::close (portFd);
+  if (!OpenGymVectorEnv::Fork (2, port))
+    {
+      _exit (OpenGymVectorEnv::GetExitStatus ());
+    }
+
+  // a bare REQ socket stands for the OpenGymInterface of the worker
+  zmq::context_t context (1);
+  zmq::socket_t socket (context, ZMQ_REQ);
+  socket.connect ("tcp://localhost:" + std::to_string (OpenGymVectorEnv::GetWorkerPort ()));
+  std::string request;
+  ns3opengym::SimInitMsg initMsg;
+  initMsg.set_simprocessid (::getpid ());
+  initMsg.SerializeToString (&request);
+  zmq::message_t initRequest (request.data (), request.size ());
+  socket.send (initRequest, zmq::send_flags::none);
+  zmq::message_t initReply;
+  (void) socket.recv (initReply, zmq::recv_flags::none);
+
+  ns3opengym::EnvStateMsg stateMsg;
+  stateMsg.set_reward (OpenGymVectorEnv::GetIndex ());
+  stateMsg.set_isgameover (true);
+  stateMsg.set_reason (ns3opengym::EnvStateMsg::SimulationEnd);
+  stateMsg.SerializeToString (&request);
+  zmq::message_t stateRequest (request.data (), request.size ());
+  socket.send (stateRequest, zmq::send_flags::none);
+  zmq::message_t actReply;
+  (void) socket.recv (actReply, zmq::recv_flags::none);
+  _exit (m_failingWorker && OpenGymVectorEnv::GetIndex () == 1 ? 1 : 0);
+}
+
+void
+OpengymVectorEnvTestCase::DoRun (void)
+{
+  int portPipe[2];
+  NS_TEST_ASSERT_MSG_EQ (pipe (portPipe), 0, "Cannot create the port pipe");
+  // the forked processes never return to the test runner
+  std::cout.flush ();
+  std::fflush (nullptr);
+  pid_t broker = fork ();
+  NS_TEST_ASSERT_MSG_NE (broker, -1, "Cannot fork the broker");
+  if (broker == 0)
+    {
+      ::close (portPipe[1]);
+      RunVectorEnv (portPipe[0]);
+    }
+  ::close (portPipe[0]);
+
+  // the test case is the agent
+  zmq::context_t context (1);
+  zmq::socket_t agent (context, ZMQ_REP);
+  int timeout = 10000;
+  zmq_setsockopt ((void*)agent, ZMQ_RCVTIMEO, &timeout, sizeof (timeout));
+  agent.bind ("tcp://127.0.0.1:*");
+  char endpoint[256];
+  size_t endpointSize = sizeof (endpoint);
+  zmq_getsockopt ((void*)agent, ZMQ_LAST_ENDPOINT, endpoint, &endpointSize);
+  std::string ep (endpoint);
+  uint32_t port = std::stoul (ep.substr (ep.rfind (':') + 1));
+  bool portSent = ::write (portPipe[1], &port, sizeof (port)) == sizeof (port);
+  ::close (portPipe[1]);
+
+  bool exchanged = false;
+  zmq::message_t initRequest;
+  if (portSent && agent.recv (initRequest, zmq::recv_flags::none))
+    {
+      ns3opengym::SimInitMsg initMsg;
+      initMsg.ParseFromArray (initRequest.data (), initRequest.size ());
+      NS_TEST_EXPECT_MSG_EQ (initMsg.numenvs (), 2, "Unexpected number of envs");
+      NS_TEST_EXPECT_MSG_EQ (initMsg.simprocessid (), (uint64_t) broker, "The init message must come from the broker");
+      std::string reply;
+      ns3opengym::SimInitAck initAck;
+      initAck.set_done (true);
+      initAck.SerializeToString (&reply);
+      zmq::message_t initReply (reply.data (), reply.size ());
+      agent.send (initReply, zmq::send_flags::none);
+
+      zmq::message_t stateRequest;
+      if (agent.recv (stateRequest, zmq::recv_flags::none))
+        {
+          ns3opengym::EnvStateBatchMsg stateBatch;
+          stateBatch.ParseFromArray (stateRequest.data (), stateRequest.size ());
+          NS_TEST_EXPECT_MSG_EQ (stateBatch.state_size (), 2, "The batch must hold one state per env");
+          for (int i = 0; i < stateBatch.state_size (); i++)
+            {
+              NS_TEST_EXPECT_MSG_EQ (stateBatch.state (i).reward (), i, "The states must be ordered by worker index");
+            }
+          ns3opengym::EnvActBatchMsg actBatch;
+          actBatch.add_act ();
+          actBatch.add_act ();
+          actBatch.SerializeToString (&reply);
+          zmq::message_t actReply (reply.data (), reply.size ());
+          agent.send (actReply, zmq::send_flags::none);
+          exchanged = true;
+        }
+    }
+  if (!exchanged)
+    {
+      kill (broker, SIGKILL);
+    }
+
+  int status = 0;
+  NS_TEST_ASSERT_MSG_EQ (waitpid (broker, &status, 0), broker, "Cannot wait for the broker");
+  NS_TEST_ASSERT_MSG_EQ (exchanged, true, "No batch received from the broker");
+  NS_TEST_ASSERT_MSG_EQ (WIFEXITED (status), true, "The broker must exit normally");
+  NS_TEST_ASSERT_MSG_EQ (WEXITSTATUS (status), (m_failingWorker ? 1 : 0), "Unexpected status of the broker");
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +294,9 @@ OpengymTestSuite::OpengymTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new OpengymTestCase1, TestCase::QUICK);
+  AddTestCase (new OpengymSharedMemoryTestCase, TestCase::QUICK);
+  AddTestCase (new OpengymVectorEnvTestCase (false), TestCase::QUICK);
+  AddTestCase (new OpengymVectorEnvTestCase (true), TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -0,0 +1,209 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//
+//  This example runs a multi-AP scenario with the MultithreadedSimulatorImpl.
+//
+//  nAps BSSs are laid out on a line, distance meters apart, and share a
+//  YansWifiChannel on the same frequency channel. Each BSS has nStas
+//  stations, within a few meters of their AP, which continuously send
+//  packets to their AP. The nodes of a BSS are kept in the same partition,
+//  the BSSs being spread over the threads, and the lookahead is the
+//  smallest propagation delay between nodes of different partitions, as
+//  computed by YansWifiChannel::GetLookahead.
+//
+//  With --threads=0, the scenario is run by the DefaultSimulatorImpl, for
+//  comparison:
+//    ./ns3 run "wifi-multithreaded --threads=0"
+//    ./ns3 run "wifi-multithreaded --threads=4"
+//
+//  The lookahead is only about 3.3 ns per meter between the BSSs, so that
+//  the threads mostly wait for each other at the window boundaries: do not
+//  expect the multithreaded run to be faster unless the BSSs are far apart
+//  and busy.
+//
+
+#include "ns3/command-line.h"
+#include "ns3/config.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/ssid.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/node-list.h"
+#include "ns3/packet-socket-helper.h"
+#include "ns3/packet-socket-client.h"
+#include "ns3/packet-socket-server.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace ns3;
+
+/// Bytes received by each node, only updated in the partition of the node
+std::vector<uint64_t> bytesReceived;
+
+uint32_t
+ContextToNodeId (std::string context)
+{
+  std::string sub = context.substr (10);
+  uint32_t pos = sub.find ("/Application");
+  return atoi (sub.substr (0, pos).c_str ());
+}
+
+void
+SocketRx (std::string context, Ptr<const Packet> p, const Address &addr)
+{
+  bytesReceived[ContextToNodeId (context)] += p->GetSize ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t threads = 2;
+  uint32_t nAps = 4;
+  uint32_t nStas = 4;
+  double distance = 50.0; // meters
+  double duration = 2.0; // seconds
+  uint32_t payloadSize = 1000; // bytes
+  double interval = 0.001; // seconds
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("threads", "Number of threads, 0 for the sequential simulator", threads);
+  cmd.AddValue ("nAps", "Number of BSSs", nAps);
+  cmd.AddValue ("nStas", "Number of stations per BSS", nStas);
+  cmd.AddValue ("distance", "Distance between the APs (m)", distance);
+  cmd.AddValue ("duration", "Duration of simulation (s)", duration);
+  cmd.AddValue ("interval", "Inter packet interval (s)", interval);
+  cmd.Parse (argc, argv);
+
+  if (threads > 0)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+      Config::SetDefault ("ns3::MultithreadedSimulatorImpl::ThreadCount", UintegerValue (threads));
+    }
+
+  NodeContainer apNodes;
+  apNodes.Create (nAps);
+  std::vector<NodeContainer> staNodes (nAps);
+
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  YansWifiPhyHelper phy;
+  phy.SetChannel (channel);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate24Mbps"),
+                                "ControlMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (apNodes);
+
+  for (uint32_t i = 0; i < nAps; i++)
+    {
+      staNodes[i].Create (nStas);
+      packetSocket.Install (staNodes[i]);
+      Ssid ssid = Ssid ("bss-" + std::to_string (i));
+      mac.SetType ("ns3::ApWifiMac", "Ssid", SsidValue (ssid));
+      NetDeviceContainer apDevice = wifi.Install (phy, mac, apNodes.Get (i));
+      mac.SetType ("ns3::StaWifiMac", "Ssid", SsidValue (ssid));
+      NetDeviceContainer staDevices = wifi.Install (phy, mac, staNodes[i]);
+
+      Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+      positionAlloc->Add (Vector (i * distance, 0.0, 0.0));
+      for (uint32_t j = 0; j < nStas; j++)
+        {
+          positionAlloc->Add (Vector (i * distance + (j % 2 == 0 ? 2.0 : -2.0), 1.0 + j, 0.0));
+        }
+      mobility.SetPositionAllocator (positionAlloc);
+      mobility.Install (apNodes.Get (i));
+      mobility.Install (staNodes[i]);
+
+      for (uint32_t j = 0; j < nStas; j++)
+        {
+          PacketSocketAddress socketAddr;
+          socketAddr.SetSingleDevice (staDevices.Get (j)->GetIfIndex ());
+          socketAddr.SetPhysicalAddress (apDevice.Get (0)->GetAddress ());
+          socketAddr.SetProtocol (1);
+          Ptr<PacketSocketClient> client = CreateObject<PacketSocketClient> ();
+          client->SetRemote (socketAddr);
+          client->SetAttribute ("PacketSize", UintegerValue (payloadSize));
+          client->SetAttribute ("MaxPackets", UintegerValue (0));
+          client->SetAttribute ("Interval", TimeValue (Seconds (interval)));
+          client->SetStartTime (Seconds (0.5));
+          staNodes[i].Get (j)->AddApplication (client);
+        }
+      PacketSocketAddress socketAddr;
+      socketAddr.SetSingleDevice (apDevice.Get (0)->GetIfIndex ());
+      socketAddr.SetProtocol (1);
+      Ptr<PacketSocketServer> server = CreateObject<PacketSocketServer> ();
+      server->SetLocal (socketAddr);
+      apNodes.Get (i)->AddApplication (server);
+    }
+  bytesReceived.assign (NodeList::GetNNodes (), 0);
+  Config::Connect ("/NodeList/*/ApplicationList/*/$ns3::PacketSocketServer/Rx", MakeCallback (&SocketRx));
+
+  Ptr<MultithreadedSimulatorImpl> simulator = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  if (simulator != 0)
+    {
+      // keep each BSS in a partition
+      for (uint32_t i = 0; i < nAps; i++)
+        {
+          uint32_t partition = i * simulator->GetNPartitions () / nAps;
+          simulator->SetPartition (apNodes.Get (i)->GetId (), partition);
+          for (uint32_t j = 0; j < nStas; j++)
+            {
+              simulator->SetPartition (staNodes[i].Get (j)->GetId (), partition);
+            }
+        }
+      Time lookahead = channel->GetLookahead ();
+      std::cout << "Lookahead: " << lookahead.As (Time::NS) << std::endl;
+      simulator->SetAttribute ("Lookahead", TimeValue (lookahead));
+    }
+
+  Simulator::Stop (Seconds (duration));
+  auto start = std::chrono::steady_clock::now ();
+  Simulator::Run ();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - start;
+  std::cout << "Events: " << Simulator::GetEventCount ()
+            << ", wall clock time: " << elapsed.count () << " s";
+  if (simulator != 0)
+    {
+      std::cout << ", windows: " << simulator->GetNWindows ();
+    }
+  std::cout << std::endl;
+  Simulator::Destroy ();
+
+  for (uint32_t i = 0; i < nAps; i++)
+    {
+      double throughput = static_cast<double> (bytesReceived[apNodes.Get (i)->GetId ()]) * 8 / 1e6 / (duration - 0.5);
+      std::cout << "Throughput for BSS " << i << ": " << throughput << " Mbit/s" << std::endl;
+    }
+
+  return 0;
+}
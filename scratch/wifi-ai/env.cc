@@ -24,6 +24,8 @@
 #include "ns3/ipv4-global-routing-helper.h"
 #include "ns3/s1g-ofdm-phy.h"
 #include "ns3/ppv-error-rate-model.h"
+#include "ns3/simulation-checkpoint.h"
+#include "ns3/wifi-binary-trace-helper.h"
 #include "mygym.h"
 
 #define UDP_IP_WIFI_HEADER_SIZE 64
@@ -32,49 +34,25 @@ using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("wifi-test");
 
-void cb_rx_drop(Ptr<const Packet> packet){
-  LlcSnapHeader llc;
-  auto copy = packet->Copy();
-  copy->RemoveHeader (llc);
-  Ipv4Header head;
-  copy->PeekHeader (head);
-
-  NS_LOG_UNCOND("cb_rx_drop:" << (Simulator::Now()).GetMicroSeconds() << "," << head.GetSource() << "," << head.GetDestination()<<"," << packet->GetSize());
-
-}
-void cb_rx_succ(Ptr<const Packet> packet){
-  LlcSnapHeader llc;
-  auto copy = packet->Copy();
-  copy->RemoveHeader (llc);
-  Ipv4Header head;
-  copy->PeekHeader (head);
-
-  NS_LOG_UNCOND("cb_rx_succ:" << (Simulator::Now()).GetMicroSeconds() << "," << head.GetSource() << "," << head.GetDestination()<<"," << packet->GetSize());
-
+// The interface of the snapshot holder, as inherited by a branch. Its ZMQ
+// socket must be neither used nor closed by the branch: terminating the ZMQ
+// context waits for I/O threads which do not exist after fork(2). The holder
+// is thus never destroyed, not even at exit.
+static Ptr<OpenGymInterface> &g_inheritedInterface = *new Ptr<OpenGymInterface> ();
+
+void start_episode(Ptr<MyGymEnv> env, Ptr<OpenGymInterface> snapshotInterface, uint32_t port, uint32_t episode){
+  std::cout << "Episode " << episode << " forked at " << (Simulator::Now()).GetMicroSeconds() << std::endl;
+  // talk to the agent on a fresh connection
+  g_inheritedInterface = snapshotInterface;
+  env->SetOpenGymInterface(CreateObject<OpenGymInterface> (port));
+  env->Notify();
 }
 
-void cb_asso(uint16_t /* AID */ a, Mac48Address b){
-  NS_LOG_UNCOND("AssociatedSta:" << a << ":" << b  <<  " time:" << (Simulator::Now()).GetMicroSeconds() );
-}
-void cb_deasso(uint16_t /* AID */ a, Mac48Address b){
-  NS_LOG_UNCOND("DeassociatedSta:" << a << ":" << b  <<  " time:" << (Simulator::Now()).GetMicroSeconds() );
-}
-void cb_tx_start(Ptr<const Packet> packet, double power){
-    WifiMacHeader head;
-    packet->PeekHeader (head);
-    Mac48Address src = head.GetAddr2 ();
-    if (head.GetType () == WIFI_MAC_DATA)
-      {
-          NS_LOG_UNCOND("cb_tx_start:" << (Simulator::Now()).GetMicroSeconds() << "," << head.GetAddr2 () << "," << head.GetAddr1 () <<"," << packet->GetSize() << "," << head.GetSequenceNumber());
-      }
-}
-void cb_tx_ended(Ptr<const Packet> packet){
-    WifiMacHeader head;
-    packet->PeekHeader (head);
-    if (head.GetType () == WIFI_MAC_DATA)
-      {
-          NS_LOG_UNCOND("cb_tx_end:" << (Simulator::Now()).GetMicroSeconds() << "," << head.GetAddr2 () << "," << head.GetAddr1 ()<<"," << packet->GetSize() << "," << head.GetSequenceNumber());
-      }
+void notify_periodically(Ptr<MyGymEnv> env, Time interval, Time end){
+  env->Notify();
+  if (Simulator::Now() + interval < end) {
+      Simulator::Schedule(interval, &notify_periodically, env, interval, end);
+  }
 }
 
 int main (int argc, char *argv[])
@@ -102,6 +80,18 @@ int main (int argc, char *argv[])
 
 
   bool verbose = false;
+  std::string traceFile ("");
+  std::string metricsFile ("");
+  Time metricsInterval = MilliSeconds (100);
+  Time obsInterval = Seconds (0);
+
+  bool forkEpisodes = false;
+  uint32_t maxEpisodes = 0;
+  std::string shmPath ("");
+  uint32_t nEnvs = 1;
+  bool tabulatedPer = true;
+  bool staticAssociation = false;
+  bool updateMcs = false;
 
   CommandLine cmd (__FILE__);
   cmd.AddValue ("phyMode", "Wifi Phy mode", phyMode);
@@ -113,11 +103,40 @@ int main (int argc, char *argv[])
   cmd.AddValue ("openGymPort", "Port number for OpenGym env. Default: 5555", openGymPort);
   cmd.AddValue ("simSeed", "Seed for random generator. Default: 1", simSeed);
   cmd.AddValue ("simTime", "simulation time", simTime);
+  cmd.AddValue ("forkEpisodes", "Simulate the warmup once and fork every episode from a checkpoint taken at the test start", forkEpisodes);
+  cmd.AddValue ("shmPath", "File mapped in memory to exchange the observations and actions with the agent, empty to use ZMQ only", shmPath);
+  cmd.AddValue ("tabulatedPer", "Read the PPV error rates from precomputed tables", tabulatedPer);
+  cmd.AddValue ("staticAssociation", "Associate every STA with its strongest AP at time zero instead of scanning", staticAssociation);
+  cmd.AddValue ("updateMcs", "Select the data mode of every STA again each time the agent sets the losses", updateMcs);
+  cmd.AddValue ("nEnvs", "Number of environments stepped as one batch by the agent", nEnvs);
+  cmd.AddValue ("traceFile", "Binary trace of the STA transmissions and of the AP receptions and associations, empty to disable", traceFile);
+  cmd.AddValue ("metricsFile", "Binary file of the per-STA metrics sampled during the test, empty to disable", metricsFile);
+  cmd.AddValue ("metricsInterval", "Time between two samples of the per-STA metrics written to metricsFile", metricsInterval);
+  cmd.AddValue ("obsInterval", "Time between two observations sent to the agent during the test, 0 to observe at the end only", obsInterval);
+  cmd.AddValue ("maxEpisodes", "Maximum number of forked episodes, 0 to fork until the agent stops", maxEpisodes);
   cmd.Parse (argc, argv);
   RngSeedManager::SetSeed (1);
   RngSeedManager::SetRun(simSeed);
+  NS_ABORT_MSG_IF (forkEpisodes && nEnvs > 1, "forkEpisodes and nEnvs cannot be combined");
+  // the episodes forked from a checkpoint would share the trace file
+  NS_ABORT_MSG_IF (forkEpisodes && !traceFile.empty (), "forkEpisodes and traceFile cannot be combined");
+  NS_ABORT_MSG_IF (forkEpisodes && !metricsFile.empty (), "forkEpisodes and metricsFile cannot be combined");
+  if (nEnvs > 1) {
+      if (!OpenGymVectorEnv::Fork (nEnvs, openGymPort)) {
+          // the broker, all the workers have ended
+          return OpenGymVectorEnv::GetExitStatus ();
+      }
+      openGymPort = OpenGymVectorEnv::GetWorkerPort ();
+      if (!traceFile.empty ()) {
+          traceFile += "." + std::to_string (OpenGymVectorEnv::GetIndex ());
+      }
+      if (!metricsFile.empty ()) {
+          metricsFile += "." + std::to_string (OpenGymVectorEnv::GetIndex ());
+      }
+  }
 
-  double time_for_test_start = (double) n_sta * 0.5 + 10 - 0.01;
+  // without scanning, no warmup is needed before the test
+  double time_for_test_start = staticAssociation ? 1 - 0.01 : (double) n_sta * 0.5 + 10 - 0.01;
   double time_for_test_end = time_for_test_start + simTime + 0.01;
   Time interval = MicroSeconds(interval_in_us);
 
@@ -168,21 +187,31 @@ int main (int argc, char *argv[])
   wifiPhy.Set ("ChannelSettings", StringValue ("{0, 1, BAND_S1GHZ, 0}"));
   wifiPhy.Set ("CcaEdThreshold", DoubleValue (-75.) );
   wifiPhy.SetPcapDataLinkType (WifiPhyHelper::DLT_IEEE802_11_RADIO);
-  wifiPhy.SetErrorRateModel("ns3::PpvErrorRateModel");
+  wifiPhy.SetErrorRateModel("ns3::PpvErrorRateModel", "Tabulated", BooleanValue (tabulatedPer));
   wifiPhy.SetPreambleDetectionModel ("ns3::ThresholdPreambleDetectionModel",
                                      "MinimumRssi", DoubleValue (-95.));
 
   Ptr<MatrixPropagationLossModel> lossModel = CreateObject<MatrixPropagationLossModel> ();
   lossModel->SetDefaultLoss (200); // set default loss to 200 dB (no link)
+  // dense loss matrix: AP nodes take indices [0, n_ap), STA nodes [n_ap, n_ap + n_sta)
+  for (int i = 0; i < n_ap; i++) {
+      lossModel->AssignIndex (ap_nodes.Get (i)->GetObject<MobilityModel> ());
+  }
+  for (int i = 0; i < n_sta; i++) {
+      lossModel->AssignIndex (sta_nodes.Get (i)->GetObject<MobilityModel> ());
+  }
+  Config::SetDefault ("OpenGymInterface::SharedMemoryPath", StringValue (shmPath));
   Ptr<OpenGymInterface> openGymInterface = CreateObject<OpenGymInterface> (openGymPort);
   Ptr<MyGymEnv> myGymEnv = CreateObject<MyGymEnv> (n_ap,n_sta, lossModel);
   myGymEnv->m_staNodes.Add(sta_nodes);
   myGymEnv->m_apNodes.Add(ap_nodes);
 
   Ptr<YansWifiChannel> yanswc = CreateObject <YansWifiChannel> ();
+  yanswc->SetAttribute ("ReceiverCulling", BooleanValue (true));
   yanswc->SetPropagationLossModel (lossModel);
   yanswc->SetPropagationDelayModel (CreateObject <ConstantSpeedPropagationDelayModel> ());
   wifiPhy.SetChannel (yanswc);
+  myGymEnv->m_channel = yanswc;
 
   // Add a mac and disable rate control
   WifiMacHelper wifiMac;
@@ -209,7 +238,10 @@ int main (int argc, char *argv[])
   }
 
   // setup sta
+  Ptr<TwtScheduleManager> twtScheduleManager = CreateObject<TwtScheduleManager> ();
+  myGymEnv->m_twtScheduleManager = twtScheduleManager;
   wifiMac.SetType ("ns3::StaWifiMac",
+                   "TwtScheduleManager", PointerValue (twtScheduleManager),
                    "Ssid", SsidValue (ssid),
                    "QosSupported", BooleanValue (false),
                    "WaitBeaconTimeout", TimeValue (MilliSeconds (200)),
@@ -226,26 +258,17 @@ int main (int argc, char *argv[])
         v->SetTxPowerEnd(0.);
         auto z = DynamicCast<StaWifiMac>(w->GetMac());
         z->GetTxop()->GetWifiMacQueue()->SetMaxSize(QueueSize("5p"));
-        z->SetAttribute ("scanningstartoffset", TimeValue (MilliSeconds(500)* (j+1)));
+        if (!staticAssociation) {
+            z->SetAttribute ("scanningstartoffset", TimeValue (MilliSeconds(500)* (j+1)));
+        }
     }
 
-    if (verbose) {
-        for (uint32_t i = 0; i < n_sta; i++) {
-            auto m = staDevice.Get(i);
-            auto w = m->GetObject<WifiNetDevice>();
-            auto v = DynamicCast<WifiPhy>(w->GetPhy());
-            v->TraceConnectWithoutContext("PhyTxBegin", MakeCallback(&cb_tx_start));
-            v->TraceConnectWithoutContext("PhyTxEnd", MakeCallback(&cb_tx_ended));
-        }
-        for (int i = 0; i < n_ap; ++i) {
-            auto m = apDevice.Get(i);
-            auto w = m->GetObject<WifiNetDevice>();
-            auto v = w->GetMac();
-            v->TraceConnectWithoutContext("MacRx", MakeCallback(&cb_rx_succ));
-            v->TraceConnectWithoutContext("MacRxDrop", MakeCallback(&cb_rx_drop));
-            v->TraceConnectWithoutContext("AssociatedSta", MakeCallback(&cb_asso));
-            v->TraceConnectWithoutContext("DeAssociatedSta", MakeCallback(&cb_deasso));
-        }
+    WifiBinaryTraceHelper trace;
+    if (!traceFile.empty ()) {
+        trace.Open (traceFile);
+        trace.EnablePhyTx (staDevice);
+        trace.EnableMacRx (apDevice);
+        trace.EnableAssociation (apDevice);
     }
 
   myGymEnv->m_staDevices.Add(staDevice);
@@ -324,10 +347,27 @@ int main (int argc, char *argv[])
     sta_r->AddHostRouteTo (server_to_gate_intf.GetAddress(0),staInterface.Get(i).second);
     sta_r->AddHostRouteTo (server_to_gate_intf.GetAddress(1),staInterface.Get(i).second);
   }
+  // per-STA metrics of the test, observed by the agent and sampled to a file
+  Ptr<StaMetricsRegistry> metrics = CreateObject<StaMetricsRegistry> (n_sta);
+  metrics->ConnectServers (ServerApps);
+  metrics->ConnectDevices (staDevice);
+  Simulator::Schedule (Seconds (time_for_test_start), &StaMetricsRegistry::Start, metrics);
+  Simulator::Schedule (Seconds (time_for_test_end), &StaMetricsRegistry::Stop, metrics);
+  if (!metricsFile.empty ()) {
+      Simulator::Schedule (Seconds (time_for_test_start), &StaMetricsRegistry::EnableFileOutput, metrics,
+                           metricsFile, metricsInterval);
+  }
+  myGymEnv->m_metrics = metrics;
+  if (obsInterval.IsStrictlyPositive ()) {
+      Simulator::Schedule (Seconds (time_for_test_start) + obsInterval, &notify_periodically, myGymEnv,
+                           obsInterval, Seconds (time_for_test_end));
+  }
+
     // Notify before arp, mcs, association start, because these processes need path loss
     myGymEnv->SetOpenGymInterface(openGymInterface);
     myGymEnv->Notify();
     // Set up ARP
+  std::vector<uint32_t> staAp;
   for (int j = 0; j < n_sta; j++) {
       std::vector<double> gain_list;
       for (int i = 0; i < n_ap; i++){
@@ -339,6 +379,7 @@ int main (int argc, char *argv[])
       }
       auto result = std::max_element(gain_list.begin(), gain_list.end());
       int ind = std::distance(gain_list.begin(), result);
+      staAp.push_back(ind);
       Mac48Address addr = Mac48Address::ConvertFrom(apDevice.Get (ind)->GetAddress());
       Ptr<ArpCache> arp = CreateObject<ArpCache>();
       arp->SetAliveTimeout(Seconds(3600 * 24 * 365));
@@ -360,58 +401,57 @@ int main (int argc, char *argv[])
       }
       std::cout<< "STA: " << j << ", arp: " << addr << std::endl;
   }
+  if (staticAssociation) {
+      WifiHelper::Associate(staDevice, apDevice, staAp);
+  }
 
     // setup sta mcs
+    Ptr<PpvErrorRateModel> ppv = CreateObject<PpvErrorRateModel>();
+    ppv->SetAttribute("Tabulated", BooleanValue (tabulatedPer));
+    Ptr<WifiPhy> staPhy = staDevice.Get(0)->GetObject<WifiNetDevice>()->GetPhy();
+    uint16_t bw = staPhy->GetChannelWidth();
+    std::vector<WifiMode> modes;
+    auto bandtable = S1gOfdmPhy::GetModulationBandLookupTable();
+    for (auto it = bandtable.begin(); it != bandtable.end(); it++) {
+        if (it->second == bw) {
+            modes.push_back(WifiMode(it->first));
+        }
+    }
+    WifiTxVector txVector;
+    txVector.SetChannelWidth(bw);
+    McsSelectionHelper mcsSelection;
+    mcsSelection.SetErrorRateModel(ppv);
+    mcsSelection.SetModes(modes);
+    mcsSelection.SetTxVector(txVector);
+    mcsSelection.SetPacketSize(packetSize + UDP_IP_WIFI_HEADER_SIZE);
+    mcsSelection.SetTxPower(staPhy->GetTxPowerStart());
+    mcsSelection.SetNoiseFigure(20.);
+    // the STAs out of coverage keep the default mode of the scenario
+    mcsSelection.SetFallbackMode(WifiMode("S1gOfdmRate0_30MbpsBW1MHz"));
+    auto selections = mcsSelection.Select(lossModel, sta_nodes, ap_nodes);
     for (uint32_t j = 0; j < n_sta; j++) {
-          double max_gain = -std::numeric_limits<double>::infinity();
-          uint32_t max_i = 0;
-          for (uint32_t i = 0; i < n_ap; i++) {
-              double gain = lossModel->CalcRxPower(0, ap_nodes.Get(i)->GetObject<MobilityModel>(),
-                                                   sta_nodes.Get(j)->GetObject<MobilityModel>());
-              if (gain >= max_gain) {
-                  max_gain = gain;
-                  max_i = i;
-              }
-          }
-          WifiTxVector txVector;
-          Ptr<PpvErrorRateModel> ppv = CreateObject<PpvErrorRateModel>();
-          auto table = S1gOfdmPhy::GetModulationLookupTable();
-          auto bandtable = S1gOfdmPhy::GetModulationBandLookupTable();
-          auto m = staDevice.Get(j);
-          auto w = m->GetObject<WifiNetDevice>();
-          auto v = DynamicCast<WifiPhy>(w->GetPhy());
-          uint16_t bw = v->GetChannelWidth();
-          double pw = v->GetTxPowerStart();
-          double nf = DbToRatio(20.);
-          std::string max_mode ("S1gOfdmRate0_30MbpsBW1MHz");
-          uint64_t max_rate = 0;
-          double BOLTZMANN = 1.3803e-23;
-          double Nt = BOLTZMANN * 290 * bw * 1e6;
-          double noiseFloor = nf * Nt;
-
-          for (auto it = bandtable.begin(); it != bandtable.end(); it++) {
-              if (it->second == bw) {
-                  txVector.SetMode(it->first);
-                  txVector.SetChannelWidth(bw);
-                  double ps = ppv->GetChunkSuccessRate(WifiMode(it->first), txVector,
-                                                       std::pow(10.0, (pw + max_gain - WToDbm(noiseFloor)) / 10.0),
-                                                       (packetSize + UDP_IP_WIFI_HEADER_SIZE) * 8);
-                  uint64_t rate = S1gOfdmPhy::GetDataRate(it->first, bw);
-                  if (rate >= max_rate and ps > (1.-1e-5)) {
-                      max_rate = rate;
-                      max_mode = it->first;
-                  }
-              }
-          }
-          auto a = DynamicCast<StaWifiMac>(w->GetMac());
-          a->GetWifiRemoteStationManager()->SetAttribute("DataMode", StringValue (max_mode));
-          std::cout << "STA:" << j << "-" << "AP:" << max_i << ", Gain: " << max_gain << "\n\t\t noiseFloor:" << WToDbm(noiseFloor) << " phyMode:" << max_mode << std::endl;
-      }
+        auto w = staDevice.Get(j)->GetObject<WifiNetDevice>();
+        w->GetRemoteStationManager()->SetAttribute("DataMode", StringValue (selections[j].mode.GetUniqueName()));
+        std::cout << "STA:" << j << "-" << "AP:" << selections[j].ap << ", Gain: " << selections[j].gainDb
+                  << "\n\t\t SNR:" << RatioToDb(selections[j].snr) << " phyMode:" << selections[j].mode << std::endl;
+    }
+    myGymEnv->m_mcsSelection = mcsSelection;
+    myGymEnv->m_updateMcs = updateMcs;
   Simulator::Stop (Seconds (time_for_test_end+0.1));
+  if (forkEpisodes) {
+      SimulationCheckpoint::SetBranchCallback (MakeBoundCallback (&start_episode, myGymEnv, openGymInterface, openGymPort));
+      SimulationCheckpoint::Schedule (Seconds (time_for_test_start), maxEpisodes);
+  }
   std::cout<< "Sim Start" << std::endl;
 
   Simulator::Run ();
 
+  if (forkEpisodes && !SimulationCheckpoint::IsBranch ()) {
+      std::cout<< "Checkpoint done, episodes: " << SimulationCheckpoint::GetNBranches () << std::endl;
+      Simulator::Destroy ();
+      return 0;
+  }
+
 
   for (int i = 0; i < n_sta; ++i) {
     auto m = staDevice.Get(i);
@@ -70,6 +70,12 @@ MyGymEnv::GetObservationSpace()
   space->Add("aoi", aoi);
   space->Add("thr", thr);
   space->Add("del", thr);
+  if (m_metrics) {
+      // the whole table of the registry, one row per metric
+      std::vector<uint32_t> shape_metrics = {m_metrics->GetNRows (), (uint32_t)m_n_sta};
+      Ptr<OpenGymBoxSpace> metrics = CreateObject<OpenGymBoxSpace> (0., 1000000000., shape_metrics, dtype);
+      space->Add("metrics", metrics);
+  }
 
 //  NS_LOG_UNCOND ("MyGetObservationSpace: " << space);
   return space;
@@ -137,7 +143,21 @@ MyGymEnv::GetObservation()
   Ptr<OpenGymBoxContainer<float> > pm_2 = CreateObject<OpenGymBoxContainer<float> >(shape_pm);
   Ptr<OpenGymBoxContainer<float> > pm_3 = CreateObject<OpenGymBoxContainer<float> >(shape_pm);
 //  Ptr<OpenGymBoxContainer<float> > pm_4 = CreateObject<OpenGymBoxContainer<float> >(shape_pm);
-  if (is_simulation_end){
+  Ptr<OpenGymDictContainer> data = CreateObject<OpenGymDictContainer> ();
+  if (m_metrics){
+    // sampled at any time, not only at the end of the simulation
+    const std::vector<float> &table = m_metrics->Sample ();
+    auto row = [&table, this] (uint32_t r) {
+      return std::vector<float> (table.begin () + r * m_n_sta, table.begin () + (r + 1) * m_n_sta);
+    };
+    pm_1->SetData (row (StaMetricsRegistry::AOI));
+    pm_2->SetData (row (StaMetricsRegistry::THROUGHPUT));
+    pm_3->SetData (row (StaMetricsRegistry::DELAY));
+    std::vector<uint32_t> shape_metrics = {m_metrics->GetNRows (), (uint32_t)m_n_sta};
+    Ptr<OpenGymBoxContainer<float> > metrics = CreateObject<OpenGymBoxContainer<float> >(shape_metrics);
+    metrics->SetData (table);
+    data->Add("metrics",metrics);
+  } else if (is_simulation_end){
     for (uint32_t j = 0; j < m_n_sta; j++){
       float aoi = DynamicCast<UdpServer>(m_serverApps.Get(j))->GetLastAoI_us();
       pm_1->AddValue(aoi);
@@ -154,7 +174,6 @@ MyGymEnv::GetObservation()
     }
   }
 
-  Ptr<OpenGymDictContainer> data = CreateObject<OpenGymDictContainer> ();
   data->Add("aoi",pm_1);
   data->Add("thr",pm_2);
   data->Add("del",pm_3);
@@ -201,13 +220,16 @@ MyGymEnv::ExecuteActions(Ptr<OpenGymDataContainer> action)
   Ptr<OpenGymBoxContainer<float> > loss_sta_ap = DynamicCast<OpenGymBoxContainer<float> >(dict->Get("loss_sta_ap"));
   Ptr<OpenGymBoxContainer<float> > loss_sta_sta = DynamicCast<OpenGymBoxContainer<float> >(dict->Get("loss_sta_sta"));
 
-  int counter = 0;
-
+  // Indices are assigned to the AP nodes first, then to the STA nodes, so the
+  // three action blocks are scattered into one dense matrix and loaded at once.
+  uint32_t n = m_n_ap + m_n_sta;
+  NS_ASSERT (lm->GetNIndices () == n);
+  std::vector<float> loss (n * n);
 
+  int counter = 0;
   for (uint32_t i = 0; i < m_n_ap; i++){
     for (uint32_t j = 0; j < m_n_ap; j++){
-      lm->SetLoss (m_apNodes.Get (i)->GetObject<MobilityModel> (), m_apNodes.Get (j)->GetObject<MobilityModel> (), loss_ap_ap->GetValue(counter),
-                   false);
+      loss[i * n + j] = loss_ap_ap->GetValue(counter);
       counter++;
     }
   }
@@ -215,8 +237,9 @@ MyGymEnv::ExecuteActions(Ptr<OpenGymDataContainer> action)
 
   for (uint32_t i = 0; i < m_n_sta; i++){
     for (uint32_t j = 0; j < m_n_ap; j++){
-      lm->SetLoss (m_staNodes.Get (i)->GetObject<MobilityModel> (), m_apNodes.Get (j)->GetObject<MobilityModel> (), loss_sta_ap->GetValue(counter),
-                     true);
+      float v = loss_sta_ap->GetValue(counter);
+      loss[(m_n_ap + i) * n + j] = v;
+      loss[j * n + m_n_ap + i] = v;
       counter++;
     }
   }
@@ -224,19 +247,45 @@ MyGymEnv::ExecuteActions(Ptr<OpenGymDataContainer> action)
 
   for (uint32_t i = 0; i < m_n_sta; i++){
     for (uint32_t j = 0; j < m_n_sta; j++){
-      lm->SetLoss (m_staNodes.Get (i)->GetObject<MobilityModel> (), m_staNodes.Get (j)->GetObject<MobilityModel> (), loss_sta_sta->GetValue(counter),
-                   false);
+      loss[(m_n_ap + i) * n + m_n_ap + j] = loss_sta_sta->GetValue(counter);
       counter++;
     }
   }
   counter = 0;
 
+  lm->SetLossMatrix (loss.data (), n, n);
+  if (m_channel) {
+      m_channel->InvalidateNeighbors ();
+  }
+  if (m_updateMcs) {
+      // follow the new losses with the data mode of every STA
+      auto selections = m_mcsSelection.Select (lm, m_staNodes, m_apNodes);
+      for (uint32_t i = 0; i < m_n_sta; i++) {
+          m_staDevices.Get(i)->GetObject<WifiNetDevice>()->GetRemoteStationManager()
+              ->SetAttribute("DataMode", StringValue (selections[i].mode.GetUniqueName()));
+      }
+  }
 
   Ptr<OpenGymBoxContainer<float> > twtstarttime = DynamicCast<OpenGymBoxContainer<float> >(dict->Get("twtstarttime"));
   Ptr<OpenGymBoxContainer<float> > twtoffset = DynamicCast<OpenGymBoxContainer<float> >(dict->Get("twtoffset"));
   Ptr<OpenGymBoxContainer<float> > twtduration = DynamicCast<OpenGymBoxContainer<float> >(dict->Get("twtduration"));
   Ptr<OpenGymBoxContainer<float> > twtperiodicity = DynamicCast<OpenGymBoxContainer<float> >(dict->Get("twtperiodicity"));
 
+  if (m_twtScheduleManager) {
+      // one batch update, the new schedules apply from now on
+      std::vector<Ptr<WifiMac> > macs;
+      std::vector<TwtScheduleManager::Schedule> schedules;
+      for (uint32_t i = 0; i < m_n_sta; i++) {
+          macs.push_back(m_staDevices.Get(i)->GetObject<WifiNetDevice>()->GetMac());
+          schedules.push_back({MicroSeconds(twtstarttime->GetValue(i)),
+                               MicroSeconds(twtoffset->GetValue(i)),
+                               MicroSeconds(twtduration->GetValue(i)),
+                               MicroSeconds(twtperiodicity->GetValue(i))});
+      }
+      m_twtScheduleManager->SetSchedules(macs, schedules);
+      return true;
+  }
+
     for (uint32_t i = 0; i < m_n_sta; i++)
     {
       auto m = m_staDevices.Get(i);
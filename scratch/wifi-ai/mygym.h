@@ -9,7 +9,11 @@
 #include <ns3/net-device-container.h>
 #include <ns3/application-container.h>
 #include <ns3/propagation-loss-model.h>
+#include <ns3/yans-wifi-channel.h>
+#include <ns3/twt-schedule-manager.h>
+#include <ns3/mcs-selection-helper.h>
 #include "ns3/opengym-module.h"
+#include "sta-metrics.h"
 #include "ns3/nstime.h"
 
 namespace ns3 {
@@ -35,6 +39,11 @@ public:
   NodeContainer m_staNodes;
   NetDeviceContainer m_staDevices;
   ApplicationContainer m_serverApps;
+  Ptr<YansWifiChannel> m_channel;
+  Ptr<TwtScheduleManager> m_twtScheduleManager;
+  McsSelectionHelper m_mcsSelection;
+  Ptr<StaMetricsRegistry> m_metrics;
+  bool m_updateMcs = false;
   bool is_simulation_end;
 
 
@@ -0,0 +1,256 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "sta-metrics.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/udp-server.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-remote-station-manager.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("StaMetricsRegistry");
+
+NS_OBJECT_ENSURE_REGISTERED (StaMetricsRegistry);
+
+TypeId
+StaMetricsRegistry::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::StaMetricsRegistry")
+    .SetParent<Object> ()
+    .SetGroupName ("OpenGym")
+  ;
+  return tid;
+}
+
+StaMetricsRegistry::StaMetricsRegistry (uint32_t nStas)
+  : m_nStas (nStas),
+    m_counters (N_COUNTERS * nStas, 0),
+    m_binWidth (MilliSeconds (10)),
+    m_nBins (10),
+    m_running (false)
+{
+  NS_LOG_FUNCTION (this << nStas);
+  m_delays.assign (m_nBins * m_nStas, 0);
+}
+
+StaMetricsRegistry::~StaMetricsRegistry ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+StaMetricsRegistry::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_writeEvent.Cancel ();
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+  Object::DoDispose ();
+}
+
+void
+StaMetricsRegistry::SetDelayHistogram (Time binWidth, uint32_t nBins)
+{
+  NS_LOG_FUNCTION (this << binWidth << nBins);
+  NS_ABORT_MSG_IF (!binWidth.IsStrictlyPositive () || nBins == 0, "Invalid delay histogram");
+  NS_ABORT_MSG_IF (m_file.is_open (), "The delay histogram is already written to a file");
+  m_binWidth = binWidth;
+  m_nBins = nBins;
+  m_delays.assign (m_nBins * m_nStas, 0);
+}
+
+void
+StaMetricsRegistry::ConnectServers (ApplicationContainer servers)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (servers.GetN () != m_nStas, "Expected one server per STA");
+  for (uint32_t i = 0; i < m_nStas; i++)
+    {
+      Ptr<UdpServer> server = DynamicCast<UdpServer> (servers.Get (i));
+      NS_ABORT_MSG_UNLESS (server, "Not a UdpServer");
+      server->TraceConnectWithoutContext ("Rx", MakeCallback (&StaMetricsRegistry::ServerRx, this).Bind (i));
+    }
+}
+
+void
+StaMetricsRegistry::ConnectDevices (NetDeviceContainer devices)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (devices.GetN () != m_nStas, "Expected one device per STA");
+  for (uint32_t i = 0; i < m_nStas; i++)
+    {
+      Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (devices.Get (i));
+      NS_ABORT_MSG_UNLESS (device, "Not a wifi device");
+      Ptr<WifiMac> mac = device->GetMac ();
+      for (AcIndex ac : {AC_BE_NQOS, AC_BE, AC_BK, AC_VI, AC_VO})
+        {
+          Ptr<WifiMacQueue> queue = mac->GetTxopQueue (ac);
+          if (queue != nullptr)
+            {
+              queue->TraceConnectWithoutContext ("Drop", MakeCallback (&StaMetricsRegistry::QueueDrop, this).Bind (i));
+            }
+        }
+      device->GetRemoteStationManager ()
+        ->TraceConnectWithoutContext ("MacTxDataFailed", MakeCallback (&StaMetricsRegistry::TxDataFailed, this).Bind (i));
+      Ptr<WifiPhy> phy = device->GetPhy ();
+      phy->TraceConnectWithoutContext ("PhyTxPsduBegin",
+                                       MakeCallback (&StaMetricsRegistry::PhyTxBegin, this).Bind (i).Bind (phy->GetPhyBand ()));
+    }
+}
+
+void
+StaMetricsRegistry::Start (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_start = Simulator::Now ();
+  m_running = true;
+  std::fill (m_counters.begin (), m_counters.end (), 0);
+  std::fill (m_delays.begin (), m_delays.end (), 0);
+  // the age of information grows from the start of the window
+  std::fill_n (m_counters.begin () + LAST_TX * m_nStas, m_nStas, m_start.ToDouble (Time::US));
+}
+
+void
+StaMetricsRegistry::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = Simulator::Now ();
+  m_running = false;
+  if (m_file.is_open () && m_writeEvent.IsRunning ())
+    {
+      // the last sample covers the whole window
+      m_writeEvent.Cancel ();
+      WriteSample ();
+      m_writeEvent.Cancel ();
+      m_file.flush ();
+    }
+}
+
+uint32_t
+StaMetricsRegistry::GetNRows (void) const
+{
+  return N_ROWS + m_nBins;
+}
+
+uint32_t
+StaMetricsRegistry::GetNStas (void) const
+{
+  return m_nStas;
+}
+
+const std::vector<float>&
+StaMetricsRegistry::Sample (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_table.resize (GetNRows () * m_nStas);
+
+  double end = (m_running ? Simulator::Now () : m_stop).ToDouble (Time::US);
+  double elapsed = std::max (end - m_start.ToDouble (Time::US), 0.0);
+  float *row = m_table.data ();
+
+  for (uint32_t i = 0; i < m_nStas; i++)
+    {
+      // close the area below the age of information at the end of the window
+      double age = end - At (LAST_TX, i);
+      row[AOI * m_nStas + i] = (elapsed > 0 ? (At (AOI_AREA, i) + age * age / 2) / elapsed : 0);
+      row[THROUGHPUT * m_nStas + i] = (elapsed > 0 ? At (RX_PACKETS, i) / elapsed * 1e6 : 0);
+      row[DELAY * m_nStas + i] = (At (RX_PACKETS, i) > 0 ? At (DELAY_SUM, i) / At (RX_PACKETS, i) : 0);
+      row[QUEUE_DROPS * m_nStas + i] = At (N_QUEUE_DROPS, i);
+      row[RETRIES * m_nStas + i] = At (N_RETRIES, i);
+      row[AIRTIME * m_nStas + i] = At (AIRTIME_SUM, i);
+    }
+  std::copy (m_delays.begin (), m_delays.end (), row + N_ROWS * m_nStas);
+
+  return m_table;
+}
+
+void
+StaMetricsRegistry::EnableFileOutput (std::string filename, Time interval)
+{
+  NS_LOG_FUNCTION (this << filename << interval);
+  NS_ABORT_MSG_IF (!interval.IsStrictlyPositive (), "The sampling interval must be strictly positive");
+  m_file.open (filename, std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_UNLESS (m_file.is_open (), "Cannot create the metrics file " << filename);
+  uint32_t shape[2] = {GetNRows (), m_nStas};
+  m_file.write (reinterpret_cast<const char *> (shape), sizeof (shape));
+  m_interval = interval;
+  m_writeEvent.Cancel ();
+  m_writeEvent = Simulator::Schedule (m_interval, &StaMetricsRegistry::WriteSample, this);
+}
+
+void
+StaMetricsRegistry::WriteSample (void)
+{
+  NS_LOG_FUNCTION (this);
+  const std::vector<float> &table = Sample ();
+  double now = Simulator::Now ().GetSeconds ();
+  m_file.write (reinterpret_cast<const char *> (&now), sizeof (now));
+  m_file.write (reinterpret_cast<const char *> (table.data ()), table.size () * sizeof (float));
+  m_writeEvent = Simulator::Schedule (m_interval, &StaMetricsRegistry::WriteSample, this);
+}
+
+void
+StaMetricsRegistry::ServerRx (uint32_t sta, Ptr<const Packet> packet)
+{
+  if (!m_running || packet->GetSize () == 0)
+    {
+      return;
+    }
+  SeqTsHeader seqTs;
+  packet->PeekHeader (seqTs);
+  Time delay = Simulator::Now () - seqTs.GetTs ();
+  double sent = seqTs.GetTs ().ToDouble (Time::US);
+  double delayUs = delay.ToDouble (Time::US);
+
+  At (RX_PACKETS, sta)++;
+  At (DELAY_SUM, sta) += delayUs;
+  // a packet older than the last received one does not reduce the age of information
+  double interval = sent - At (LAST_TX, sta);
+  if (interval > 0)
+    {
+      At (AOI_AREA, sta) += interval * interval / 2 + interval * delayUs;
+      At (LAST_TX, sta) = sent;
+    }
+  uint32_t bin = std::min<int64_t> (delay.GetTimeStep () / m_binWidth.GetTimeStep (), m_nBins - 1);
+  m_delays[bin * m_nStas + sta]++;
+}
+
+void
+StaMetricsRegistry::QueueDrop (uint32_t sta, Ptr<const WifiMacQueueItem> item)
+{
+  if (m_running)
+    {
+      At (N_QUEUE_DROPS, sta)++;
+    }
+}
+
+void
+StaMetricsRegistry::TxDataFailed (uint32_t sta, Mac48Address address)
+{
+  if (m_running)
+    {
+      At (N_RETRIES, sta)++;
+    }
+}
+
+void
+StaMetricsRegistry::PhyTxBegin (uint32_t sta, WifiPhyBand band, WifiConstPsduMap psdus,
+                                WifiTxVector txVector, double txPowerW)
+{
+  if (m_running)
+    {
+      At (AIRTIME_SUM, sta) += WifiPhy::CalculateTxDuration (psdus, txVector, band).ToDouble (Time::US);
+    }
+}
+
+} // namespace ns3
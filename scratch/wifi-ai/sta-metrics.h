@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef STA_METRICS_H
+#define STA_METRICS_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/mac48-address.h"
+#include "ns3/net-device-container.h"
+#include "ns3/application-container.h"
+#include "ns3/wifi-psdu.h"
+#include "ns3/wifi-ppdu.h"
+#include "ns3/wifi-tx-vector.h"
+#include "ns3/wifi-phy-band.h"
+#include <fstream>
+#include <vector>
+
+namespace ns3 {
+
+class Packet;
+class WifiMacQueueItem;
+
+/**
+ * Per-STA metrics of the wifi-ai scenario, accumulated from trace sources
+ * into a table whose rows are the metrics and whose columns are the STAs.
+ *
+ * The raw counters are stored row by row in a contiguous array and are
+ * updated by the trace sinks in constant time. Sample () converts them in one
+ * pass into a table of floats with the rows below, followed by one row per
+ * bin of the delay histogram, which can be handed as a whole to a gym Box
+ * container or appended to a file at a fixed interval.
+ *
+ * The metrics cover the window that starts with the last call to Start () and
+ * ends with the call to Stop () or, if the window is still open, at the time
+ * of the sample.
+ */
+class StaMetricsRegistry : public Object
+{
+public:
+  /// The rows of the sampled table that do not belong to the delay histogram
+  enum Row : uint32_t
+  {
+    AOI = 0,      //!< average age of information, in microseconds
+    THROUGHPUT,   //!< received packets per second
+    DELAY,        //!< average delay of the received packets, in microseconds
+    QUEUE_DROPS,  //!< MPDUs dropped by the MAC queues of the STA
+    RETRIES,      //!< failed transmissions of data frames by the STA
+    AIRTIME,      //!< time spent transmitting by the STA, in microseconds
+    N_ROWS
+  };
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \param nStas the number of STAs
+   */
+  StaMetricsRegistry (uint32_t nStas = 0);
+  virtual ~StaMetricsRegistry ();
+
+  /**
+   * Set the bins of the delay histogram. The last bin also counts the delays
+   * beyond the last bin. Resets the histogram.
+   *
+   * \param binWidth the width of a bin
+   * \param nBins the number of bins
+   */
+  void SetDelayHistogram (Time binWidth, uint32_t nBins);
+
+  /**
+   * Feed the AoI, throughput and delay of every STA from the Rx trace of the
+   * UDP server receiving its packets.
+   *
+   * \param servers the UdpServer of every STA, in the order of the STAs
+   */
+  void ConnectServers (ApplicationContainer servers);
+  /**
+   * Feed the queue drops, retries and airtime of every STA from the traces
+   * of its MAC queues, remote station manager and PHY.
+   *
+   * \param devices the WifiNetDevice of every STA, in the order of the STAs
+   */
+  void ConnectDevices (NetDeviceContainer devices);
+
+  /**
+   * Reset the counters and open the measurement window at the current time.
+   */
+  void Start (void);
+  /**
+   * Close the measurement window at the current time. The counters are no
+   * longer updated. If the table is written to a file, a last sample is
+   * appended and the file is flushed.
+   */
+  void Stop (void);
+
+  /**
+   * \return the number of rows of the sampled table
+   */
+  uint32_t GetNRows (void) const;
+  /**
+   * \return the number of STAs, i.e., the number of columns of the sampled table
+   */
+  uint32_t GetNStas (void) const;
+
+  /**
+   * Compute the table of the metrics at the current time. The table is stored
+   * row by row: the value of row r for STA i is at index r * GetNStas () + i.
+   *
+   * \return the table, valid until the next call
+   */
+  const std::vector<float>& Sample (void);
+
+  /**
+   * Append a sample of the table to the given file every interval. The file
+   * starts with the number of rows and the number of STAs (two uint32_t);
+   * every sample is the time in seconds (a double) followed by the table.
+   * The delay histogram cannot be changed afterwards.
+   *
+   * \param filename the name of the file
+   * \param interval the time between two samples
+   */
+  void EnableFileOutput (std::string filename, Time interval);
+
+protected:
+  void DoDispose (void) override;
+
+private:
+  /// The raw counters, stored row by row
+  enum Counter : uint32_t
+  {
+    RX_PACKETS = 0,    //!< received packets
+    DELAY_SUM,         //!< sum of the delays, in microseconds
+    AOI_AREA,          //!< area below the age of information, in square microseconds
+    LAST_TX,           //!< sending time of the last received packet, in microseconds
+    N_QUEUE_DROPS,     //!< dropped MPDUs
+    N_RETRIES,         //!< failed data transmissions
+    AIRTIME_SUM,       //!< transmission time, in microseconds
+    N_COUNTERS
+  };
+
+  /**
+   * \param counter the counter
+   * \param sta the index of the STA
+   * \return a reference to the counter of the given STA
+   */
+  double& At (Counter counter, uint32_t sta)
+  {
+    return m_counters[counter * m_nStas + sta];
+  }
+
+  /**
+   * Trace sink for the Rx trace of a UdpServer.
+   *
+   * \param sta the index of the STA
+   * \param packet the received packet, starting with the SeqTsHeader
+   */
+  void ServerRx (uint32_t sta, Ptr<const Packet> packet);
+  /**
+   * Trace sink for the Drop trace of a MAC queue.
+   *
+   * \param sta the index of the STA
+   * \param item the dropped MPDU
+   */
+  void QueueDrop (uint32_t sta, Ptr<const WifiMacQueueItem> item);
+  /**
+   * Trace sink for the MacTxDataFailed trace of a remote station manager.
+   *
+   * \param sta the index of the STA
+   * \param address the receiver of the data frame
+   */
+  void TxDataFailed (uint32_t sta, Mac48Address address);
+  /**
+   * Trace sink for the PhyTxPsduBegin trace of a PHY.
+   *
+   * \param sta the index of the STA
+   * \param band the band of the PHY of the STA
+   * \param psdus the transmitted PSDUs
+   * \param txVector the TXVECTOR of the transmission
+   * \param txPowerW the transmit power, in watts
+   */
+  void PhyTxBegin (uint32_t sta, WifiPhyBand band, WifiConstPsduMap psdus,
+                   WifiTxVector txVector, double txPowerW);
+  /**
+   * Append a sample of the table to the output file and schedule the next one.
+   */
+  void WriteSample (void);
+
+  uint32_t m_nStas;                ///< number of STAs
+  std::vector<double> m_counters;  ///< raw counters, N_COUNTERS rows of m_nStas values
+  std::vector<uint32_t> m_delays;  ///< delay histogram, one row of m_nStas values per bin
+  Time m_binWidth;                 ///< width of a bin of the delay histogram
+  uint32_t m_nBins;                ///< number of bins of the delay histogram
+  std::vector<float> m_table;      ///< last sampled table
+  Time m_start;                    ///< start of the measurement window
+  Time m_stop;                     ///< end of the measurement window, if closed
+  bool m_running;                  ///< whether the measurement window is open
+  std::ofstream m_file;            ///< output file
+  Time m_interval;                 ///< interval between samples written to the file
+  EventId m_writeEvent;            ///< event writing the next sample
+};
+
+} // namespace ns3
+
+#endif /* STA_METRICS_H */
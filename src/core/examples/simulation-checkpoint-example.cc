@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-module.h"
+
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup core-examples
+ * Fork branches from a SimulationCheckpoint and check that they resume
+ * from the snapshot state.
+ *
+ * A counter is incremented before and after the checkpoint, and each
+ * branch adds its own offset to it. The branches report their state to
+ * the snapshot holder through a pipe before exiting, and the snapshot
+ * holder aborts if the reports are not the expected ones. As it forks,
+ * this check runs as an example, in its own process, rather than in the
+ * test runner.
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("SimulationCheckpointExample");
+
+namespace {
+
+/// Record of the state seen by a branch at the end of its run
+struct BranchReport
+{
+  uint32_t index;   //!< branch index
+  int counter;      //!< value of g_counter
+  int64_t nowUs;    //!< simulation time, in microseconds
+};
+
+int g_counter = 0;         //!< state altered before and after the checkpoint
+uint32_t g_stopBranch = 0; //!< index of the branch that calls Stop ()
+int g_reportFd = -1;       //!< write end of the report pipe
+
+/** Increment the counter. */
+void
+Increment (void)
+{
+  g_counter++;
+}
+
+/**
+ * Branch callback.
+ * \param index the branch index
+ */
+void
+StartBranch (uint32_t index)
+{
+  g_counter += 10 * (index + 1);
+  if (index == g_stopBranch)
+    {
+      SimulationCheckpoint::Stop ();
+    }
+}
+
+/** Report the branch state to the snapshot holder and exit. */
+void
+Report (void)
+{
+  if (!SimulationCheckpoint::IsBranch ())
+    {
+      return;
+    }
+  BranchReport report;
+  report.index = SimulationCheckpoint::GetBranchIndex ();
+  report.counter = g_counter;
+  report.nowUs = Simulator::Now ().GetMicroSeconds ();
+  ssize_t written = write (g_reportFd, &report, sizeof (report));
+  _exit (written == sizeof (report) ? 0 : 1);
+}
+
+}  // unnamed namespace
+
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t maxBranches = 3;
+  g_stopBranch = 100;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("maxBranches", "Maximum number of branches, 0 for no limit", maxBranches);
+  cmd.AddValue ("stopBranch", "Index of the branch that stops the checkpoint", g_stopBranch);
+  cmd.Parse (argc, argv);
+
+  uint32_t expectedBranches = g_stopBranch + 1;
+  if (maxBranches != 0)
+    {
+      expectedBranches = std::min (expectedBranches, maxBranches);
+    }
+
+  int reportPipe[2];
+  NS_ABORT_MSG_IF (pipe (reportPipe) != 0, "Cannot create the report pipe");
+  g_reportFd = reportPipe[1];
+
+  SimulationCheckpoint::SetBranchCallback (MakeCallback (&StartBranch));
+  Simulator::Schedule (MilliSeconds (500), &Increment);
+  SimulationCheckpoint::Schedule (Seconds (1), maxBranches);
+  Simulator::Schedule (MilliSeconds (1500), &Increment);
+  Simulator::Schedule (Seconds (2), &Report);
+  Simulator::Run ();
+
+  NS_ABORT_MSG_IF (SimulationCheckpoint::IsBranch (), "Only the snapshot holder returns from Run");
+  NS_ABORT_MSG_IF (Simulator::Now () != Seconds (1), "The snapshot holder must stop at the checkpoint");
+  NS_ABORT_MSG_IF (g_counter != 1, "Branches must not alter the snapshot");
+  NS_ABORT_MSG_IF (SimulationCheckpoint::GetNBranches () != expectedBranches,
+                   "Unexpected number of branches: " << SimulationCheckpoint::GetNBranches ());
+  Simulator::Destroy ();
+
+  close (reportPipe[1]);
+  for (uint32_t i = 0; i < expectedBranches; ++i)
+    {
+      BranchReport report;
+      NS_ABORT_MSG_IF (read (reportPipe[0], &report, sizeof (report)) != sizeof (report),
+                       "Missing report of branch " << i);
+      std::cout << "Branch " << report.index << " ended at " << report.nowUs
+                << " us with counter " << report.counter << std::endl;
+      NS_ABORT_MSG_IF (report.index != i, "Unexpected branch index");
+      NS_ABORT_MSG_IF (report.counter != 2 + 10 * static_cast<int> (i + 1), "Unexpected branch state");
+      NS_ABORT_MSG_IF (report.nowUs != 2000000, "Unexpected branch end time");
+    }
+  BranchReport extra;
+  NS_ABORT_MSG_IF (read (reportPipe[0], &extra, sizeof (extra)) != 0, "Unexpected extra branch");
+  close (reportPipe[0]);
+
+  return 0;
+}
@@ -24,8 +24,12 @@
 #include "scheduler.h"
 #include "assert.h"
 #include "log.h"
+#include "string.h"
+#include "abort.h"
 
+#include <chrono>
 #include <cmath>
+#include <fstream>
 
 
 /**
@@ -40,6 +44,7 @@ namespace ns3 {
 // number of calls that are made to these functions and the possibility
 // of causing recursions leading to stack overflow
 NS_LOG_COMPONENT_DEFINE ("DefaultSimulatorImpl");
+NS_LOG_HOT_PATH ();
 
 NS_OBJECT_ENSURE_REGISTERED (DefaultSimulatorImpl);
 
@@ -50,6 +55,30 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("EventTraceFile",
+                   "If not empty, the name of a file to record the operations "
+                   "on the event list into, to replay them with utils/bench-scheduler.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::SetEventTraceFile,
+                                       &DefaultSimulatorImpl::GetEventTraceFile),
+                   MakeStringChecker ())
+    .AddAttribute ("EventProfileFile",
+                   "If not empty, profile the event handlers and write the number "
+                   "of runs and the wall clock time of each handler and of each "
+                   "context into this file at Simulator::Destroy, sorted by "
+                   "decreasing wall clock time.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::SetEventProfileFile,
+                                       &DefaultSimulatorImpl::GetEventProfileFile),
+                   MakeStringChecker ())
+    .AddAttribute ("EventProfileFoldedFile",
+                   "If not empty, profile the event handlers and write the wall "
+                   "clock time of each handler in each context into this file at "
+                   "Simulator::Destroy, as folded stacks for flamegraph.pl.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::SetEventProfileFoldedFile,
+                                       &DefaultSimulatorImpl::GetEventProfileFoldedFile),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -64,7 +93,7 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
   m_eventCount = 0;
-  m_eventsWithContextEmpty = true;
+  m_eventsWithContext = 0;
   m_mainThreadId = std::this_thread::get_id ();
 }
 
@@ -85,6 +114,8 @@ DefaultSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
+  m_eventTrace.reset ();
+  m_eventProfiler.reset ();
   SimulatorImpl::DoDispose ();
 }
 void
@@ -101,6 +132,7 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  WriteEventProfile ();
 }
 
 void
@@ -120,6 +152,97 @@ DefaultSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
   m_events = scheduler;
 }
 
+void
+DefaultSimulatorImpl::SetEventTraceFile (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_eventTraceFile = filename;
+  m_eventTrace.reset ();
+  if (!filename.empty ())
+    {
+      m_eventTrace.reset (new EventTraceWriter (filename));
+    }
+}
+
+std::string
+DefaultSimulatorImpl::GetEventTraceFile (void) const
+{
+  return m_eventTraceFile;
+}
+
+void
+DefaultSimulatorImpl::TraceEvent (EventTraceRecord::Op op, const Scheduler::Event &ev)
+{
+  m_eventTrace->Write (op, m_currentTs, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+DefaultSimulatorImpl::SetEventProfileFile (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_eventProfileFile = filename;
+  if (!filename.empty () && !m_eventProfiler)
+    {
+      m_eventProfiler.reset (new EventProfiler ());
+    }
+}
+
+std::string
+DefaultSimulatorImpl::GetEventProfileFile (void) const
+{
+  return m_eventProfileFile;
+}
+
+void
+DefaultSimulatorImpl::SetEventProfileFoldedFile (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_eventProfileFoldedFile = filename;
+  if (!filename.empty () && !m_eventProfiler)
+    {
+      m_eventProfiler.reset (new EventProfiler ());
+    }
+}
+
+std::string
+DefaultSimulatorImpl::GetEventProfileFoldedFile (void) const
+{
+  return m_eventProfileFoldedFile;
+}
+
+void
+DefaultSimulatorImpl::ProfileEvent (const Scheduler::Event &ev)
+{
+  auto start = std::chrono::steady_clock::now ();
+  ev.impl->Invoke ();
+  auto elapsed = std::chrono::steady_clock::now () - start;
+  m_eventProfiler->Record (typeid (*ev.impl), ev.impl->GetHandlerId (), ev.key.m_context,
+                           std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ());
+}
+
+void
+DefaultSimulatorImpl::WriteEventProfile (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_eventProfiler)
+    {
+      return;
+    }
+  if (!m_eventProfileFile.empty ())
+    {
+      std::ofstream os (m_eventProfileFile);
+      NS_ABORT_MSG_UNLESS (os.is_open (), "Cannot create event profile file " << m_eventProfileFile);
+      m_eventProfiler->WriteTable (os);
+    }
+  if (!m_eventProfileFoldedFile.empty ())
+    {
+      std::ofstream os (m_eventProfileFoldedFile);
+      NS_ABORT_MSG_UNLESS (os.is_open (), "Cannot create event profile file " << m_eventProfileFoldedFile);
+      m_eventProfiler->WriteFolded (os);
+    }
+  m_eventProfiler.reset ();
+}
+
 // System ID for non-distributed simulation is always zero
 uint32_t
 DefaultSimulatorImpl::GetSystemId (void) const
@@ -131,6 +254,10 @@ void
 DefaultSimulatorImpl::ProcessOneEvent (void)
 {
   Scheduler::Event next = m_events->RemoveNext ();
+  if (m_eventTrace)
+    {
+      TraceEvent (EventTraceRecord::RUN, next);
+    }
 
   PreEventHook (EventId (next.impl, next.key.m_ts, 
                          next.key.m_context, next.key.m_uid));
@@ -143,7 +270,14 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_eventProfiler)
+    {
+      ProfileEvent (next);
+    }
+  else
+    {
+      next.impl->Invoke ();
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -158,30 +292,39 @@ DefaultSimulatorImpl::IsFinished (void) const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  if (m_eventsWithContext.load (std::memory_order_relaxed) == 0)
     {
       return;
     }
 
-  // swap queues
-  EventsWithContext eventsWithContext;
-  {
-    std::unique_lock lock {m_eventsWithContextMutex};
-    m_eventsWithContext.swap (eventsWithContext);
-    m_eventsWithContextEmpty = true;
-  }
-  while (!eventsWithContext.empty ())
+  // take all the events at once, and restore the order they were
+  // scheduled in
+  EventWithContext *head = m_eventsWithContext.exchange (0, std::memory_order_acquire);
+  EventWithContext *first = 0;
+  while (head != 0)
+    {
+      EventWithContext *next = head->next;
+      head->next = first;
+      first = head;
+      head = next;
+    }
+  while (first != 0)
     {
-      EventWithContext event = eventsWithContext.front ();
-      eventsWithContext.pop_front ();
+      EventWithContext *event = first;
+      first = first->next;
       Scheduler::Event ev;
-      ev.impl = event.event;
-      ev.key.m_ts = m_currentTs + event.timestamp;
-      ev.key.m_context = event.context;
+      ev.impl = event->event;
+      ev.key.m_ts = m_currentTs + event->timestamp;
+      ev.key.m_context = event->context;
       ev.key.m_uid = m_uid;
       m_uid++;
       m_unscheduledEvents++;
       m_events->Insert (ev);
+      if (m_eventTrace)
+        {
+          TraceEvent (EventTraceRecord::INSERT, ev);
+        }
+      delete event;
     }
 }
 
@@ -239,6 +382,10 @@ DefaultSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
   m_uid++;
   m_unscheduledEvents++;
   m_events->Insert (ev);
+  if (m_eventTrace)
+    {
+      TraceEvent (EventTraceRecord::INSERT, ev);
+    }
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
 
@@ -258,19 +405,23 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       m_uid++;
       m_unscheduledEvents++;
       m_events->Insert (ev);
+      if (m_eventTrace)
+        {
+          TraceEvent (EventTraceRecord::INSERT, ev);
+        }
     }
   else
     {
-      EventWithContext ev;
-      ev.context = context;
+      EventWithContext *ev = new EventWithContext;
+      ev->context = context;
       // Current time added in ProcessEventsWithContext()
-      ev.timestamp = delay.GetTimeStep ();
-      ev.event = event;
-      {
-        std::unique_lock lock {m_eventsWithContextMutex};
-        m_eventsWithContext.push_back (ev);
-        m_eventsWithContextEmpty = false;
-      }
+      ev->timestamp = delay.GetTimeStep ();
+      ev->event = event;
+      ev->next = m_eventsWithContext.load (std::memory_order_relaxed);
+      while (!m_eventsWithContext.compare_exchange_weak (ev->next, ev,
+                                                         std::memory_order_release,
+                                                         std::memory_order_relaxed))
+        {}
     }
 }
 
@@ -341,6 +492,10 @@ DefaultSimulatorImpl::Remove (const EventId &id)
   event.key.m_context = id.GetContext ();
   event.key.m_uid = id.GetUid ();
   m_events->Remove (event);
+  if (m_eventTrace)
+    {
+      TraceEvent (EventTraceRecord::REMOVE, event);
+    }
   event.impl->Cancel ();
   // whenever we remove an event from the event list, we have to unref it.
   event.impl->Unref ();
@@ -354,6 +509,24 @@ DefaultSimulatorImpl::Cancel (const EventId &id)
   if (!IsExpired (id))
     {
       id.PeekEventImpl ()->Cancel ();
+      if (id.GetUid () == EventId::UID::DESTROY)
+        {
+          return;
+        }
+      Scheduler::Event event;
+      event.impl = id.PeekEventImpl ();
+      event.key.m_ts = id.GetTs ();
+      event.key.m_context = id.GetContext ();
+      event.key.m_uid = id.GetUid ();
+      if (m_eventTrace)
+        {
+          TraceEvent (EventTraceRecord::CANCEL, event);
+        }
+      if (m_events->Cancel (event))
+        {
+          // the scheduler took over the event list reference
+          m_unscheduledEvents--;
+        }
     }
 }
 
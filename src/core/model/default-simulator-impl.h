@@ -22,8 +22,13 @@
 #define DEFAULT_SIMULATOR_IMPL_H
 
 #include "simulator-impl.h"
+#include "scheduler.h"
+#include "event-trace.h"
+#include "event-profiler.h"
+#include <atomic>
 #include <list>
-#include <mutex>
+#include <memory>
+#include <string>
 #include <thread>
 
 /**
@@ -85,9 +90,60 @@ private:
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
 
+  /**
+   * Start recording the operations on the event list.
+   * \param filename the name of the trace file, or an empty string to
+   *        stop recording
+   */
+  void SetEventTraceFile (std::string filename);
+  /**
+   * \return the name of the trace file, or an empty string if the
+   *         operations on the event list are not recorded
+   */
+  std::string GetEventTraceFile (void) const;
+  /**
+   * Record an operation on the event list.
+   * \param op the operation
+   * \param ev the event
+   */
+  void TraceEvent (EventTraceRecord::Op op, const Scheduler::Event &ev);
+  /**
+   * Profile the event handlers, and write their statistics as a table at
+   * Destroy ().
+   * \param filename the name of the file to write the table into, or an
+   *        empty string not to write it
+   */
+  void SetEventProfileFile (std::string filename);
+  /**
+   * \return the name of the file to write the table of the event handlers
+   *         into, or an empty string
+   */
+  std::string GetEventProfileFile (void) const;
+  /**
+   * Profile the event handlers, and write their statistics as folded
+   * stacks at Destroy ().
+   * \param filename the name of the file to write the folded stacks into,
+   *        or an empty string not to write them
+   */
+  void SetEventProfileFoldedFile (std::string filename);
+  /**
+   * \return the name of the file to write the folded stacks of the event
+   *         handlers into, or an empty string
+   */
+  std::string GetEventProfileFoldedFile (void) const;
+  /**
+   * Run an event handler, recording its wall clock time.
+   * \param ev the event
+   */
+  void ProfileEvent (const Scheduler::Event &ev);
+  /** Write the statistics of the event handlers, and stop profiling. */
+  void WriteEventProfile (void);
+
   /** Wrap an event with its execution context. */
   struct EventWithContext
   {
+    /** The event scheduled before this one. */
+    EventWithContext *next;
     /** The event context. */
     uint32_t context;
     /** Event timestamp. */
@@ -95,17 +151,12 @@ private:
     /** The event implementation. */
     EventImpl *event;
   };
-  /** Container type for the events from a different context. */
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
   /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * The events scheduled by other threads, as a lock-free stack, the most
+   * recent first: the threads push their events with a compare-and-swap,
+   * and ProcessEventsWithContext() takes them all with one exchange.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
-  std::mutex m_eventsWithContextMutex;
+  std::atomic<EventWithContext *> m_eventsWithContext;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
@@ -134,6 +185,17 @@ private:
 
   /** Main execution thread. */
   std::thread::id m_mainThreadId;
+
+  /** The name of the event trace file. */
+  std::string m_eventTraceFile;
+  /** The event trace, null unless recording. */
+  std::unique_ptr<EventTraceWriter> m_eventTrace;
+  /** The name of the file to write the profile of the event handlers into. */
+  std::string m_eventProfileFile;
+  /** The name of the file to write the folded stacks of the event handlers into. */
+  std::string m_eventProfileFoldedFile;
+  /** The profile of the event handlers, null unless profiling. */
+  std::unique_ptr<EventProfiler> m_eventProfiler;
 };
 
 } // namespace ns3
@@ -66,4 +66,10 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+EventImpl::HandlerId
+EventImpl::GetHandlerId (void) const
+{
+  return HandlerId ();
+}
+
 } // namespace ns3
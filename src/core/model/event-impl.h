@@ -20,8 +20,11 @@
 #ifndef EVENT_IMPL_H
 #define EVENT_IMPL_H
 
+#include <array>
+#include <cstring>
 #include <stdint.h>
 #include "simple-ref-count.h"
+#include "event-memory-pool.h"
 
 /**
  * \file
@@ -66,6 +69,37 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * The object representation of the function or method pointer called
+   * by an event, which tells apart the handlers sharing an EventImpl type.
+   */
+  typedef std::array<unsigned char, 2 * sizeof (void *)> HandlerId;
+  /**
+   * \returns The function or method pointer bound by MakeEvent, or all
+   *          zeros if the type of the event is enough to identify its
+   *          handler (e.g., a lambda).
+   */
+  virtual HandlerId GetHandlerId (void) const;
+
+  /**
+   * Allocate the memory of an event from the EventMemoryPool.
+   * \param [in] size The size of the event.
+   * \returns The memory of the event.
+   */
+  static void * operator new (std::size_t size)
+  {
+    return EventMemoryPool::Allocate (size);
+  }
+  /**
+   * Return the memory of an event to the EventMemoryPool.
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size)
+  {
+    EventMemoryPool::Deallocate (p, size);
+  }
+
 protected:
   /**
    * Implementation for Invoke().
@@ -75,6 +109,20 @@ protected:
    */
   virtual void Notify (void) = 0;
 
+  /**
+   * \tparam F \deduced The type of the function or method pointer.
+   * \param [in] function The function or method pointer.
+   * \returns The object representation of the pointer.
+   */
+  template <typename F>
+  static HandlerId ToHandlerId (F function)
+  {
+    static_assert (sizeof (F) <= sizeof (HandlerId), "Function pointer too large for a HandlerId");
+    HandlerId id {};
+    std::memcpy (id.data (), &function, sizeof (F));
+    return id;
+  }
+
 private:
   bool m_cancel;  /**< Has this event been cancelled. */
 };
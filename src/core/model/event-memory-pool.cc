@@ -0,0 +1,334 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-memory-pool.h"
+#include "log.h"
+
+#include <atomic>
+#include <new>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventMemoryPool implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventMemoryPool");
+
+namespace {
+
+/** Size class granularity, which is also the alignment of the blocks. */
+const std::size_t GRANULE = 16;
+/** Number of size classes. */
+const std::size_t N_CLASSES = EventMemoryPool::MAX_SIZE / GRANULE;
+/** Size of a slab, in bytes. */
+const std::size_t SLAB_SIZE = 64 * 1024;
+
+/** A block in a free list. */
+struct FreeBlock
+{
+  FreeBlock *next; //!< next free block of the same size class
+};
+
+struct Pool;
+
+/**
+ * The header in front of each pooled block, which tells the pool the block
+ * must be returned to, whatever the thread that frees it.
+ */
+struct BlockHeader
+{
+  Pool *owner;       //!< the pool the block was carved from, null if it comes from the heap
+  std::size_t index; //!< the size class of the block
+};
+
+/** Size of the header, rounded up to keep the blocks aligned. */
+const std::size_t HEADER_SIZE = GRANULE;
+static_assert (sizeof (BlockHeader) <= HEADER_SIZE, "BlockHeader does not fit in a granule");
+
+/**
+ * \param p a block returned by EventMemoryPool::Allocate
+ * \return the header of the block
+ */
+BlockHeader *
+GetHeader (void *p)
+{
+  return reinterpret_cast<BlockHeader *> (static_cast<char *> (p) - HEADER_SIZE);
+}
+
+/** The pool of a thread. */
+struct Pool
+{
+  FreeBlock *freeLists[N_CLASSES] {}; //!< one free list per size class
+  std::atomic<FreeBlock *> remoteFree {nullptr}; //!< blocks freed by other threads
+  std::vector<char *> slabs;          //!< slabs reserved by the pool
+  char *cursor {nullptr};             //!< start of the unused part of the last slab
+  char *end {nullptr};                //!< end of the last slab
+  EventMemoryPool::Stats stats;       //!< counters
+
+  /**
+   * Carve a block out of the last slab, reserving a new slab if needed.
+   * \param size the size of the block, a multiple of GRANULE
+   * \return the block
+   */
+  void * Carve (std::size_t size)
+  {
+    if (cursor == nullptr || static_cast<std::size_t> (end - cursor) < size)
+      {
+        char *slab = static_cast<char *> (::operator new (SLAB_SIZE));
+        slabs.push_back (slab);
+        cursor = slab;
+        end = slab + SLAB_SIZE;
+        stats.slabs++;
+        stats.bytesReserved += SLAB_SIZE;
+      }
+    void *p = cursor;
+    cursor += size;
+    return p;
+  }
+
+  /**
+   * Put a block back in its free list. Called by the thread of the pool.
+   * \param block the block
+   * \param index the size class of the block
+   */
+  void Free (FreeBlock *block, std::size_t index)
+  {
+    stats.deallocations++;
+    stats.live--;
+    block->next = freeLists[index];
+    freeLists[index] = block;
+  }
+
+  /**
+   * Hand a block over to the thread of the pool. Called by other threads.
+   * \param block the block
+   */
+  void FreeRemote (FreeBlock *block)
+  {
+    FreeBlock *head = remoteFree.load (std::memory_order_relaxed);
+    do
+      {
+        block->next = head;
+      }
+    while (!remoteFree.compare_exchange_weak (head, block, std::memory_order_release,
+                                              std::memory_order_relaxed));
+  }
+
+  /** Move the blocks freed by other threads to the free lists. */
+  void CollectRemote (void)
+  {
+    FreeBlock *block = remoteFree.exchange (nullptr, std::memory_order_acquire);
+    while (block != nullptr)
+      {
+        FreeBlock *next = block->next;
+        Free (block, GetHeader (block)->index);
+        block = next;
+      }
+  }
+
+  /** Free all the slabs and forget about the blocks carved out of them. */
+  void FreeSlabs (void)
+  {
+    for (char *slab : slabs)
+      {
+        ::operator delete (slab);
+      }
+    slabs.clear ();
+    for (std::size_t i = 0; i < N_CLASSES; i++)
+      {
+        freeLists[i] = nullptr;
+      }
+    cursor = nullptr;
+    end = nullptr;
+    stats.slabs = 0;
+    stats.bytesReserved = 0;
+  }
+};
+
+/** Marks the pool of a thread whose pool has been destroyed at thread exit. */
+Pool * const DESTROYED = reinterpret_cast<Pool *> (1);
+
+/** The pool of the calling thread, null until first used. */
+thread_local Pool *t_pool = nullptr;
+
+/** Free the pool of a thread when the thread exits, if possible. */
+struct PoolGuard
+{
+  ~PoolGuard ()
+  {
+    if (t_pool == nullptr || t_pool == DESTROYED)
+      {
+        return;
+      }
+    t_pool->CollectRemote ();
+    if (t_pool->stats.live == 0)
+      {
+        t_pool->FreeSlabs ();
+        delete t_pool;
+        t_pool = DESTROYED;
+      }
+    // otherwise some pooled event is still alive and will be returned to
+    // the remote list later on: keep the pool
+  }
+  bool armed {false}; //!< whether the destructor has been registered
+};
+
+/** The guard of the pool of the calling thread. */
+thread_local PoolGuard t_guard;
+
+/**
+ * \return the pool of the calling thread, or DESTROYED
+ */
+Pool *
+GetPool (void)
+{
+  if (t_pool == nullptr)
+    {
+      t_pool = new Pool;
+      t_guard.armed = true;
+    }
+  return t_pool;
+}
+
+} // unnamed namespace
+
+void *
+EventMemoryPool::Allocate (std::size_t size)
+{
+  Pool *pool = GetPool ();
+  if (size > MAX_SIZE)
+    {
+      if (pool != DESTROYED)
+        {
+          pool->stats.allocations++;
+          pool->stats.heapAllocations++;
+        }
+      return ::operator new (size);
+    }
+  std::size_t index = size == 0 ? 0 : (size - 1) / GRANULE;
+  BlockHeader *header;
+  if (pool == DESTROYED)
+    {
+      header = static_cast<BlockHeader *> (::operator new (HEADER_SIZE + size));
+      header->owner = nullptr;
+      header->index = index;
+      return reinterpret_cast<char *> (header) + HEADER_SIZE;
+    }
+  pool->stats.allocations++;
+  pool->stats.live++;
+  if (pool->freeLists[index] == nullptr)
+    {
+      pool->CollectRemote ();
+    }
+  FreeBlock *block = pool->freeLists[index];
+  if (block != nullptr)
+    {
+      pool->freeLists[index] = block->next;
+      pool->stats.freeListHits++;
+      return block;
+    }
+  header = static_cast<BlockHeader *> (pool->Carve (HEADER_SIZE + (index + 1) * GRANULE));
+  header->owner = pool;
+  header->index = index;
+  return reinterpret_cast<char *> (header) + HEADER_SIZE;
+}
+
+void
+EventMemoryPool::Deallocate (void *p, std::size_t size)
+{
+  if (size > MAX_SIZE)
+    {
+      if (t_pool != nullptr && t_pool != DESTROYED)
+        {
+          t_pool->stats.deallocations++;
+        }
+      ::operator delete (p);
+      return;
+    }
+  BlockHeader *header = GetHeader (p);
+  Pool *owner = header->owner;
+  if (owner == nullptr)
+    {
+      // allocated from the heap after the pool of its thread was destroyed
+      ::operator delete (header);
+    }
+  else if (owner == t_pool)
+    {
+      owner->Free (static_cast<FreeBlock *> (p), header->index);
+    }
+  else
+    {
+      // allocated by another thread, whose pool reclaims the block on its
+      // next allocation miss
+      owner->FreeRemote (static_cast<FreeBlock *> (p));
+    }
+}
+
+void
+EventMemoryPool::Release (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (t_pool == nullptr || t_pool == DESTROYED)
+    {
+      return;
+    }
+  t_pool->CollectRemote ();
+  const Stats &stats = t_pool->stats;
+  NS_LOG_INFO ("allocations=" << stats.allocations
+               << " freeListHits=" << stats.freeListHits
+               << " heapAllocations=" << stats.heapAllocations
+               << " slabs=" << stats.slabs
+               << " live=" << stats.live);
+  if (stats.live != 0)
+    {
+      // blocks carved out of the slabs are still in use
+      NS_LOG_LOGIC ("keep " << stats.slabs << " slabs");
+      return;
+    }
+  t_pool->FreeSlabs ();
+}
+
+EventMemoryPool::Stats
+EventMemoryPool::GetStats (void)
+{
+  Pool *pool = GetPool ();
+  if (pool == DESTROYED)
+    {
+      return Stats ();
+    }
+  return pool->stats;
+}
+
+void
+EventMemoryPool::ResetStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Pool *pool = GetPool ();
+  if (pool == DESTROYED)
+    {
+      return;
+    }
+  pool->stats.allocations = 0;
+  pool->stats.deallocations = 0;
+  pool->stats.freeListHits = 0;
+  pool->stats.heapAllocations = 0;
+}
+
+} // namespace ns3
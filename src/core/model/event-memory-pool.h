@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_MEMORY_POOL_H
+#define EVENT_MEMORY_POOL_H
+
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventMemoryPool declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup events
+ *
+ * \brief Size-class slab allocator backing every EventImpl.
+ *
+ * EventImpl overrides operator new and operator delete to allocate from
+ * this pool, so that scheduling an event does not go through malloc in
+ * the steady state. The arguments bound by MakeEvent (and the lambdas
+ * passed to Simulator::Schedule) are stored inline in the EventImpl
+ * subclass, hence they are pooled together with the event itself.
+ *
+ * Objects are rounded up to a multiple of 16 bytes and served from one
+ * free list per size class. Free lists are refilled by carving blocks out
+ * of large slabs; objects larger than the largest size class are
+ * allocated from the heap.
+ *
+ * Each thread owns its own pool, so that events created from another
+ * thread (e.g., by the realtime simulator) need no locking. Each block
+ * starts with a 16 byte header naming the pool it was carved from, so
+ * that a block freed by another thread than its allocator goes back to
+ * its own pool: it is pushed onto a lock-free list of that pool, which
+ * its thread moves to its free lists on its next allocation miss.
+ * Simulator::Destroy releases the slabs of the calling thread once no
+ * event allocated from them is alive anymore; slabs are retained for
+ * reuse if some events are still referenced (e.g., by a stale EventId).
+ */
+class EventMemoryPool
+{
+public:
+  /** Allocation counters of the pool of the calling thread. */
+  struct Stats
+  {
+    uint64_t allocations {0};      //!< number of allocations
+    uint64_t deallocations {0};    //!< number of deallocations
+    uint64_t freeListHits {0};     //!< allocations served from a free list
+    uint64_t heapAllocations {0};  //!< allocations too large for the pool
+    uint64_t slabs {0};            //!< number of slabs currently reserved
+    uint64_t bytesReserved {0};    //!< memory currently held by the slabs
+    int64_t live {0};              //!< number of pooled objects currently alive
+  };
+
+  /**
+   * Allocate memory for an event.
+   *
+   * \param [in] size The size of the object.
+   * \return Memory suitably aligned for any object of the given size.
+   */
+  static void * Allocate (std::size_t size);
+
+  /**
+   * Return the memory of an event to the pool.
+   *
+   * \param [in] p The memory returned by Allocate ().
+   * \param [in] size The size that was passed to Allocate ().
+   */
+  static void Deallocate (void *p, std::size_t size);
+
+  /**
+   * Release the slabs of the pool of the calling thread, if no pooled
+   * object allocated from them is still alive. Called by
+   * Simulator::Destroy.
+   */
+  static void Release (void);
+
+  /**
+   * \return The counters of the pool of the calling thread.
+   */
+  static Stats GetStats (void);
+
+  /**
+   * Reset the allocation counters of the pool of the calling thread.
+   * The live object count and the slab counters are not affected.
+   */
+  static void ResetStats (void);
+
+  /** Largest object size served by the pool, in bytes. */
+  static const std::size_t MAX_SIZE = 512;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_MEMORY_POOL_H */
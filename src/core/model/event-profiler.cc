@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "simulator.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+#if defined (__linux__) || defined (__APPLE__)
+#include <dlfcn.h>
+#define NS3_EVENT_PROFILER_DLADDR
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * Demangle a name.
+ * \param [in] name The mangled name.
+ * \returns The demangled name, or the name if it cannot be demangled.
+ */
+static std::string
+Demangle (const char *name)
+{
+  std::string demangled = name;
+#if (__GNUC__ >= 3)
+  int status;
+  char *buffer = abi::__cxa_demangle (name, NULL, NULL, &status);
+  if (status == 0)
+    {
+      demangled = buffer;
+    }
+  std::free (buffer);
+#endif
+  return demangled;
+}
+
+std::string
+EventProfiler::GetHandlerName (const std::type_info &type, const EventImpl::HandlerId &handler)
+{
+  // A function pointer, and with the Itanium C++ ABI a pointer to a
+  // non-virtual method, starts with the address of the code.
+  void *address;
+  std::memcpy (&address, handler.data (), sizeof (address));
+#ifdef NS3_EVENT_PROFILER_DLADDR
+  Dl_info info;
+  if (address != 0 && dladdr (address, &info) != 0
+      && info.dli_sname != 0 && info.dli_saddr == address)
+    {
+      std::string name = Demangle (info.dli_sname);
+      std::replace (name.begin (), name.end (), ';', ',');
+      return name;
+    }
+#endif
+
+  std::string name = Demangle (type.name ());
+
+  // The events created by MakeEvent are local classes, named
+  // "ns3::MakeEvent<template arguments>(parameters)::EventMemberImplN";
+  // the parameters, i.e., the types of the function and of its bound
+  // arguments, are enough to identify them.
+  const std::string prefix = "ns3::MakeEvent";
+  std::size_t start = name.find (prefix);
+  if (start != std::string::npos)
+    {
+      int depth = 0;
+      std::size_t open = std::string::npos;
+      for (std::size_t i = start + prefix.size (); i < name.size (); i++)
+        {
+          if (name[i] == '<' || name[i] == '(')
+            {
+              if (depth == 0 && name[i] == '(')
+                {
+                  open = i;
+                }
+              depth++;
+            }
+          else if ((name[i] == '>' || name[i] == ')') && --depth == 0 && open != std::string::npos)
+            {
+              name = name.substr (open + 1, i - open - 1);
+              break;
+            }
+        }
+    }
+  if (handler != EventImpl::HandlerId ())
+    {
+      // the symbol was not found, e.g., for a virtual method
+      std::ostringstream oss;
+      oss << " @";
+      for (unsigned char byte : handler)
+        {
+          oss << std::hex << std::setw (2) << std::setfill ('0') << +byte;
+        }
+      name += oss.str ();
+    }
+  // ';' separates the frames of the folded stacks
+  std::replace (name.begin (), name.end (), ';', ',');
+  return name;
+}
+
+std::vector<EventProfiler::Entry>
+EventProfiler::GetEntries (bool byContext) const
+{
+  // Merge by name, as a type may have several std::type_info objects
+  // across shared libraries.
+  std::map<std::pair<std::string, uint32_t>, Stats> merged;
+  std::map<std::pair<const std::type_info *, EventImpl::HandlerId>, std::string> names;
+  for (const auto &item : m_stats)
+    {
+      auto handler = std::make_pair (item.first.type, item.first.handler);
+      auto name = names.find (handler);
+      if (name == names.end ())
+        {
+          name = names.insert ({handler, GetHandlerName (*item.first.type, item.first.handler)}).first;
+        }
+      uint32_t context = byContext ? item.first.context : Simulator::NO_CONTEXT;
+      Stats &stats = merged[{name->second, context}];
+      stats.count += item.second.count;
+      stats.nanoseconds += item.second.nanoseconds;
+    }
+
+  std::vector<Entry> entries;
+  entries.reserve (merged.size ());
+  for (const auto &item : merged)
+    {
+      entries.push_back ({item.first.first, item.first.second, item.second.count, item.second.nanoseconds});
+    }
+  std::stable_sort (entries.begin (), entries.end (),
+                    [] (const Entry &a, const Entry &b) { return a.nanoseconds > b.nanoseconds; });
+  return entries;
+}
+
+/**
+ * \ingroup simulator
+ * Name a context in the tables and the folded stacks.
+ * \param [in] context The context.
+ * \returns The name of the context.
+ */
+static std::string
+ContextName (uint32_t context)
+{
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return "no-context";
+    }
+  return "context-" + std::to_string (context);
+}
+
+void
+EventProfiler::WriteTable (std::ostream &os) const
+{
+  std::vector<Entry> handlers = GetEntries (false);
+  uint64_t totalCount = 0;
+  uint64_t totalNs = 0;
+  for (const Entry &entry : handlers)
+    {
+      totalCount += entry.count;
+      totalNs += entry.nanoseconds;
+    }
+
+  std::map<uint32_t, Stats> byContext;
+  for (const auto &item : m_stats)
+    {
+      Stats &stats = byContext[item.first.context];
+      stats.count += item.second.count;
+      stats.nanoseconds += item.second.nanoseconds;
+    }
+  std::vector<Entry> contexts;
+  for (const auto &item : byContext)
+    {
+      contexts.push_back ({"", item.first, item.second.count, item.second.nanoseconds});
+    }
+  std::stable_sort (contexts.begin (), contexts.end (),
+                    [] (const Entry &a, const Entry &b) { return a.nanoseconds > b.nanoseconds; });
+
+  auto percent = [totalNs] (uint64_t ns) {
+      return totalNs == 0 ? 0.0 : 100.0 * ns / totalNs;
+    };
+  std::ios::fmtflags flags = os.flags ();
+  os << std::fixed << std::setprecision (2);
+  os << "Event handlers: " << totalCount << " events, "
+     << totalNs / 1e6 << " ms" << std::endl;
+  os << std::setw (12) << "ms" << std::setw (8) << "%" << std::setw (12) << "count"
+     << std::setw (12) << "ns/event" << "  handler" << std::endl;
+  for (const Entry &entry : handlers)
+    {
+      os << std::setw (12) << entry.nanoseconds / 1e6
+         << std::setw (8) << percent (entry.nanoseconds)
+         << std::setw (12) << entry.count
+         << std::setw (12) << static_cast<double> (entry.nanoseconds) / entry.count
+         << "  " << entry.handler << std::endl;
+    }
+  os << std::endl;
+  os << std::setw (12) << "ms" << std::setw (8) << "%" << std::setw (12) << "count"
+     << std::setw (12) << "ns/event" << "  context" << std::endl;
+  for (const Entry &entry : contexts)
+    {
+      os << std::setw (12) << entry.nanoseconds / 1e6
+         << std::setw (8) << percent (entry.nanoseconds)
+         << std::setw (12) << entry.count
+         << std::setw (12) << static_cast<double> (entry.nanoseconds) / entry.count
+         << "  " << ContextName (entry.context) << std::endl;
+    }
+  os.flags (flags);
+}
+
+void
+EventProfiler::WriteFolded (std::ostream &os) const
+{
+  for (const Entry &entry : GetEntries (true))
+    {
+      os << ContextName (entry.context) << ";" << entry.handler
+         << " " << entry.nanoseconds << std::endl;
+    }
+}
+
+} // namespace ns3
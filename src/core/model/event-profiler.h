@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "event-impl.h"
+
+#include <cstring>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * Accumulate the number of runs and the wall clock time spent in the
+ * event handlers, per handler and per context, as recorded by
+ * DefaultSimulatorImpl when its EventProfileFile or
+ * EventProfileFoldedFile attribute is set.
+ *
+ * The handlers are told apart by the dynamic type of their EventImpl,
+ * i.e., by the instantiation of MakeEvent which created them, and by the
+ * function or method pointer it bound (see EventImpl::GetHandlerId), so
+ * that the methods of a class with the same signature get an entry each.
+ */
+class EventProfiler
+{
+public:
+  /** The statistics of a handler. */
+  struct Entry
+  {
+    std::string handler;   //!< the name of the handler
+    uint32_t context;      //!< the context, or Simulator::NO_CONTEXT for all the contexts
+    uint64_t count;        //!< the number of runs of the handler
+    uint64_t nanoseconds;  //!< the wall clock time spent in the handler
+  };
+
+  /**
+   * Account for a run of a handler.
+   * \param [in] type The dynamic type of the event.
+   * \param [in] handler The function or method pointer called by the event.
+   * \param [in] context The context of the event.
+   * \param [in] nanoseconds The wall clock time spent in the handler.
+   */
+  void Record (const std::type_info &type, const EventImpl::HandlerId &handler,
+               uint32_t context, uint64_t nanoseconds)
+  {
+    Stats &stats = m_stats[Key {&type, handler, context}];
+    stats.count++;
+    stats.nanoseconds += nanoseconds;
+  }
+
+  /**
+   * \param [in] byContext Whether to break down the statistics of a
+   *        handler by context.
+   * \return The statistics, by decreasing wall clock time.
+   */
+  std::vector<Entry> GetEntries (bool byContext) const;
+  /**
+   * Write the statistics of the handlers, then those of the contexts, as
+   * tables sorted by decreasing wall clock time.
+   * \param [in] os The output stream.
+   */
+  void WriteTable (std::ostream &os) const;
+  /**
+   * Write the statistics in the folded stack format of flamegraph.pl:
+   * one "context;handler nanoseconds" line per handler and context.
+   * \param [in] os The output stream.
+   */
+  void WriteFolded (std::ostream &os) const;
+
+  /**
+   * \param [in] type The dynamic type of an event.
+   * \param [in] handler The function or method pointer called by the event.
+   * \return The name of the function or method if its symbol is found,
+   *         otherwise the demangled name of the type, reduced to the
+   *         types of the parameters of MakeEvent for the events it
+   *         created, followed by the address of the handler if any.
+   */
+  static std::string GetHandlerName (const std::type_info &type,
+                                     const EventImpl::HandlerId &handler = EventImpl::HandlerId ());
+
+private:
+  /** A handler run in a context. */
+  struct Key
+  {
+    const std::type_info *type;     //!< the dynamic type of the event
+    EventImpl::HandlerId handler;   //!< the function or method called by the event
+    uint32_t context;               //!< the context of the event
+    /**
+     * \param [in] o The other key.
+     * \return Whether the keys are equal.
+     */
+    bool operator== (const Key &o) const
+    {
+      return type == o.type && handler == o.handler && context == o.context;
+    }
+  };
+  /** Hash of a Key. */
+  struct KeyHash
+  {
+    /**
+     * \param [in] key The key.
+     * \return The hash of the key.
+     */
+    std::size_t operator() (const Key &key) const
+    {
+      std::size_t function;
+      std::memcpy (&function, key.handler.data (), sizeof (function));
+      return std::hash<const void *> () (key.type) ^ function
+             ^ (std::size_t (key.context) * 0x9e3779b97f4a7c15ULL);
+    }
+  };
+  /** The statistics of a handler run in a context. */
+  struct Stats
+  {
+    uint64_t count {0};        //!< the number of runs
+    uint64_t nanoseconds {0};  //!< the wall clock time
+  };
+
+  /** The statistics, by handler and context. */
+  std::unordered_map<Key, Stats, KeyHash> m_stats;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
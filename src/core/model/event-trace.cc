@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-trace.h"
+#include "fatal-error.h"
+#include "log.h"
+
+#include <cstring>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::EventTraceWriter and ns3::EventTraceReader implementations.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventTrace");
+
+const char EventTraceWriter::MAGIC[8] = {'n', 's', '3', 'e', 'v', 't', 'r', '1'};
+
+namespace {
+
+/** Size of the write buffer, in records. */
+const std::size_t BUFFER_RECORDS = 4096;
+
+} // unnamed namespace
+
+EventTraceWriter::EventTraceWriter (std::string filename)
+  : m_buffer (BUFFER_RECORDS * RECORD_SIZE),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file.is_open ())
+    {
+      NS_FATAL_ERROR ("Cannot create the event trace file " << filename);
+    }
+  m_file.write (MAGIC, sizeof (MAGIC));
+}
+
+EventTraceWriter::~EventTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+}
+
+void
+EventTraceWriter::Write (EventTraceRecord::Op op, uint64_t now, uint64_t ts, uint32_t context, uint32_t uid)
+{
+  if (m_size == m_buffer.size ())
+    {
+      Flush ();
+    }
+  char *p = &m_buffer[m_size];
+  *p = static_cast<char> (op);
+  std::memcpy (p + 1, &context, 4);
+  std::memcpy (p + 5, &uid, 4);
+  std::memcpy (p + 9, &now, 8);
+  std::memcpy (p + 17, &ts, 8);
+  m_size += RECORD_SIZE;
+}
+
+void
+EventTraceWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.write (m_buffer.data (), m_size);
+  m_file.flush ();
+  m_size = 0;
+}
+
+EventTraceReader::EventTraceReader (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_file.open (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!m_file.is_open ())
+    {
+      NS_FATAL_ERROR ("Cannot open the event trace file " << filename);
+    }
+  char magic[sizeof (EventTraceWriter::MAGIC)];
+  if (!m_file.read (magic, sizeof (magic))
+      || std::memcmp (magic, EventTraceWriter::MAGIC, sizeof (magic)) != 0)
+    {
+      NS_FATAL_ERROR (filename << " is not an event trace file");
+    }
+}
+
+bool
+EventTraceReader::Read (EventTraceRecord &record)
+{
+  char buffer[EventTraceWriter::RECORD_SIZE];
+  if (!m_file.read (buffer, sizeof (buffer)))
+    {
+      return false;
+    }
+  record.op = static_cast<EventTraceRecord::Op> (buffer[0]);
+  std::memcpy (&record.context, buffer + 1, 4);
+  std::memcpy (&record.uid, buffer + 5, 4);
+  std::memcpy (&record.now, buffer + 9, 8);
+  std::memcpy (&record.ts, buffer + 17, 8);
+  return true;
+}
+
+} // namespace ns3
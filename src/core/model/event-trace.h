@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::EventTraceRecord, ns3::EventTraceWriter and ns3::EventTraceReader
+ * declarations.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ *
+ * An operation on the event list, as recorded by
+ * DefaultSimulatorImpl when its EventTraceFile attribute is set.
+ */
+struct EventTraceRecord
+{
+  /** The operation on the event list. */
+  enum Op : uint8_t
+  {
+    INSERT = 0,  //!< an event is scheduled
+    RUN = 1,     //!< the next event is removed from the event list to be run
+    REMOVE = 2,  //!< an event is removed with Simulator::Remove
+    CANCEL = 3   //!< an event is cancelled with Simulator::Cancel
+  };
+
+  Op op;             //!< the operation
+  uint32_t context;  //!< the context of the event
+  uint32_t uid;      //!< the uid of the event
+  uint64_t now;      //!< the simulation time of the operation, in time steps
+  uint64_t ts;       //!< the timestamp of the event, in time steps
+};
+
+/**
+ * \ingroup scheduler
+ *
+ * Write a binary event trace.
+ *
+ * The file starts with an 8 byte magic string, followed by one 25 byte
+ * record per operation: op (1 byte), context (4 bytes), uid (4 bytes),
+ * now (8 bytes) and ts (8 bytes), in host byte order.
+ */
+class EventTraceWriter
+{
+public:
+  /**
+   * Create the trace file. Aborts if the file cannot be created.
+   * \param [in] filename The name of the trace file.
+   */
+  EventTraceWriter (std::string filename);
+  /** Destructor, flushes the trace. */
+  ~EventTraceWriter ();
+
+  /**
+   * Append a record to the trace.
+   * \param [in] op The operation.
+   * \param [in] now The current simulation time.
+   * \param [in] ts The timestamp of the event.
+   * \param [in] context The context of the event.
+   * \param [in] uid The uid of the event.
+   */
+  void Write (EventTraceRecord::Op op, uint64_t now, uint64_t ts, uint32_t context, uint32_t uid);
+  /** Write the buffered records to the file. */
+  void Flush (void);
+
+  /** Magic string at the beginning of the trace files. */
+  static const char MAGIC[8];
+  /** Size of a record in the trace files, in bytes. */
+  static const std::size_t RECORD_SIZE = 25;
+
+private:
+  std::ofstream m_file;        //!< the trace file
+  std::vector<char> m_buffer;  //!< records not written yet
+  std::size_t m_size;          //!< number of bytes used in the buffer
+};
+
+/**
+ * \ingroup scheduler
+ *
+ * Read a binary event trace written by EventTraceWriter.
+ */
+class EventTraceReader
+{
+public:
+  /**
+   * Open a trace file. Aborts if the file cannot be read or is not an
+   * event trace.
+   * \param [in] filename The name of the trace file.
+   */
+  EventTraceReader (std::string filename);
+
+  /**
+   * Read the next record.
+   * \param [out] record The record.
+   * \returns \c false at the end of the trace.
+   */
+  bool Read (EventTraceRecord &record);
+
+private:
+  std::ifstream m_file;  //!< the trace file
+};
+
+} // namespace ns3
+
+#endif /* EVENT_TRACE_H */
@@ -0,0 +1,299 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "uinteger.h"
+#include "log.h"
+#include <algorithm>
+#include <functional>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+    .AddAttribute ("MaxBucketSize",
+                   "A bucket holding more events than this is split into a new rung.",
+                   UintegerValue (50),
+                   MakeUintegerAccessor (&LadderScheduler::m_maxBucketSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxRungs",
+                   "The maximum number of rungs of the ladder.",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&LadderScheduler::m_maxRungs),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0),
+    m_topMin (0),
+    m_topMax (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+LadderScheduler::GetNRungs (void) const
+{
+  return static_cast<uint32_t> (m_rungs.size ());
+}
+
+uint32_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  uint32_t i = 0;
+  for (; i < m_rungs.size (); i++)
+    {
+      const Rung &rung = m_rungs[i];
+      if (rung.current < rung.buckets.size ()
+          && ts >= rung.start + rung.current * rung.width)
+        {
+          break;
+        }
+    }
+  return i;
+}
+
+uint32_t
+LadderScheduler::GetBucket (const Rung &rung, uint64_t ts)
+{
+  uint64_t index = (ts - rung.start) / rung.width;
+  return static_cast<uint32_t> (std::min<uint64_t> (index, rung.buckets.size () - 1));
+}
+
+void
+LadderScheduler::SpawnRung (uint64_t start, uint64_t width, Bucket &events)
+{
+  NS_LOG_FUNCTION (this << start << width << events.size ());
+  Rung rung;
+  rung.start = start;
+  rung.width = std::max<uint64_t> (1, (width + events.size () - 1) / events.size ());
+  rung.current = 0;
+  rung.count = static_cast<uint32_t> (events.size ());
+  rung.buckets.resize ((width + rung.width - 1) / rung.width);
+  for (const Scheduler::Event &ev : events)
+    {
+      rung.buckets[GetBucket (rung, ev.key.m_ts)].push_back (ev);
+    }
+  m_rungs.push_back (std::move (rung));
+}
+
+void
+LadderScheduler::InsertBottom (const Scheduler::Event &ev)
+{
+  // Bottom is sorted in decreasing order
+  m_bottom.insert (std::upper_bound (m_bottom.begin (), m_bottom.end (), ev,
+                                     std::greater<Scheduler::Event> ()),
+                   ev);
+  if (m_bottom.size () > m_maxBucketSize
+      && m_rungs.size () < m_maxRungs
+      && m_bottom.front ().key.m_ts > m_bottom.back ().key.m_ts)
+    {
+      uint64_t start = m_bottom.back ().key.m_ts;
+      uint64_t width = m_bottom.front ().key.m_ts - start + 1;
+      Bucket events;
+      events.swap (m_bottom);
+      SpawnRung (start, width, events);
+      Refill ();
+    }
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  while (m_bottom.empty ())
+    {
+      while (!m_rungs.empty () && m_rungs.back ().count == 0)
+        {
+          m_rungs.pop_back ();
+        }
+      if (m_rungs.empty ())
+        {
+          if (m_top.empty ())
+            {
+              return;
+            }
+          // start a new epoch with the events of Top
+          if (m_topMin == m_topMax)
+            {
+              m_bottom.swap (m_top);
+              std::sort (m_bottom.begin (), m_bottom.end (), std::greater<Scheduler::Event> ());
+              m_topStart = m_topMax + 1;
+              return;
+            }
+          Bucket events;
+          events.swap (m_top);
+          SpawnRung (m_topMin, m_topMax - m_topMin + 1, events);
+          const Rung &first = m_rungs.front ();
+          m_topStart = first.start + first.buckets.size () * first.width;
+          continue;
+        }
+      Rung &rung = m_rungs.back ();
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      uint64_t start = rung.start + rung.current * rung.width;
+      uint64_t width = rung.width;
+      Bucket events;
+      events.swap (rung.buckets[rung.current]);
+      rung.current++;
+      rung.count -= static_cast<uint32_t> (events.size ());
+      if (events.size () > m_maxBucketSize && m_rungs.size () < m_maxRungs && width > 1)
+        {
+          SpawnRung (start, width, events);
+          continue;
+        }
+      std::sort (events.begin (), events.end (), std::greater<Scheduler::Event> ());
+      m_bottom.swap (events);
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ts;
+          m_topMax = ts;
+        }
+      else
+        {
+          m_topMin = std::min (m_topMin, ts);
+          m_topMax = std::max (m_topMax, ts);
+        }
+      m_top.push_back (ev);
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i < m_rungs.size ())
+        {
+          Rung &rung = m_rungs[i];
+          rung.buckets[GetBucket (rung, ts)].push_back (ev);
+          rung.count++;
+        }
+      else
+        {
+          InsertBottom (ev);
+        }
+    }
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  // Bottom is refilled as soon as it gets empty
+  return m_bottom.empty ();
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_bottom.empty ());
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_bottom.empty ());
+  Scheduler::Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  Bucket *bucket = &m_bottom;
+  Rung *rung = nullptr;
+  if (ts >= m_topStart)
+    {
+      bucket = &m_top;
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i < m_rungs.size ())
+        {
+          rung = &m_rungs[i];
+          bucket = &rung->buckets[GetBucket (*rung, ts)];
+        }
+    }
+  auto it = std::find (bucket->begin (), bucket->end (), ev);
+  NS_ASSERT_MSG (it != bucket->end (), "Event " << ev.key.m_uid << " not found");
+  if (bucket == &m_bottom)
+    {
+      m_bottom.erase (it);
+    }
+  else
+    {
+      // Top and the buckets are not sorted
+      *it = bucket->back ();
+      bucket->pop_back ();
+      if (rung != nullptr)
+        {
+          rung->count--;
+        }
+    }
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+}
+
+} // namespace ns3
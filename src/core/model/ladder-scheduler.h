@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This class implements the Ladder Queue of W. T. Tang, R. S. M. Goh and
+ * I. L.-J. Thng, "Ladder Queue: An O(1) Priority Queue Structure for
+ * Large-Scale Discrete Event Simulation", ACM TOMACS 15(3), 2005.
+ *
+ * Events are kept in three tiers:
+ *  - Top: an unsorted list of the events beyond the current epoch;
+ *  - Ladder: a stack of rungs, each an array of buckets of equal width,
+ *    a rung being spawned out of a bucket of the rung above when the
+ *    bucket holds more than MaxBucketSize events;
+ *  - Bottom: a short sorted list of the earliest events.
+ *
+ * An event is appended to Top, to the bucket of the first rung covering
+ * its timestamp, or inserted in Bottom. Events are removed from Bottom;
+ * when it is empty, it is refilled by sorting the first non-empty bucket
+ * of the last rung, after splitting the bucket into a new rung while it
+ * is too large. When the ladder is empty, Top is spread on a new first
+ * rung whose bucket width is derived from the range of the events in
+ * Top. The rung width thus adapts to the timestamp distribution, which
+ * makes the scheduler insensitive to skewed distributions (e.g., dense
+ * bursts within a slot time alongside periodic events far in the future).
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | Constant        | Append to Top or to a bucket
+ * IsEmpty()    | Constant        | Bottom refilled eagerly
+ * PeekNext()   | Constant        | Bottom sorted
+ * Remove()     | Linear          | Search in a bucket, Top or Bottom
+ * RemoveNext() | Constant        | Bucket sort into Bottom
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                             | Reason
+ * :-------- | :--------------------------------- | :-----
+ * Overhead  | 12 x `sizeof (*)`<br/>(96 bytes)   | Top, Bottom, rungs
+ * Per Event | 0                                  | Events stored in `std::vector` directly
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  /**
+   * \return The number of rungs currently in the ladder.
+   */
+  uint32_t GetNRungs (void) const;
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** A list of events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    uint64_t start;               //!< timestamp of the start of the first bucket
+    uint64_t width;               //!< width of the buckets
+    uint32_t current;             //!< index of the first bucket not yet consumed
+    uint32_t count;               //!< number of events in the rung
+    std::vector<Bucket> buckets;  //!< the buckets
+  };
+
+  /**
+   * \param ts a timestamp
+   * \return the index of the rung to insert an event at this timestamp
+   *         into, or the number of rungs if the event belongs to Bottom
+   */
+  uint32_t FindRung (uint64_t ts) const;
+  /**
+   * \param rung a rung
+   * \param ts a timestamp covered by the rung
+   * \return the index of the bucket of the rung covering the timestamp
+   */
+  static uint32_t GetBucket (const Rung &rung, uint64_t ts);
+  /**
+   * Append a rung to the ladder and spread events on it.
+   * \param start the start of the first bucket
+   * \param width the width covered by the rung
+   * \param events the events to spread on the rung
+   */
+  void SpawnRung (uint64_t start, uint64_t width, Bucket &events);
+  /** Insert an event in Bottom, splitting Bottom into a rung if too large. */
+  void InsertBottom (const Scheduler::Event &ev);
+  /** Refill Bottom from the ladder or Top if it is empty. */
+  void Refill (void);
+
+  Bucket m_top;               //!< Top, unsorted
+  uint64_t m_topStart;        //!< smallest timestamp of the events in Top
+  uint64_t m_topMin;          //!< smallest timestamp in Top
+  uint64_t m_topMax;          //!< largest timestamp in Top
+  std::vector<Rung> m_rungs;  //!< the ladder, the last rung being the finest
+  Bucket m_bottom;            //!< Bottom, sorted with the earliest event at the back
+  uint32_t m_maxBucketSize;   //!< bucket size above which a bucket is split
+  uint32_t m_maxRungs;        //!< maximum number of rungs
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
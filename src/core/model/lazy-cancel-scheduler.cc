@@ -0,0 +1,217 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "lazy-cancel-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "double.h"
+#include "uinteger.h"
+#include "log.h"
+#include <algorithm>
+#include <functional>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LazyCancelScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LazyCancelScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LazyCancelScheduler);
+
+TypeId
+LazyCancelScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LazyCancelScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LazyCancelScheduler> ()
+    .AddAttribute ("MaxDeadRatio",
+                   "The heap is rebuilt without the cancelled events when "
+                   "their number exceeds this ratio times the number of live events.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&LazyCancelScheduler::m_maxDeadRatio),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("MinCompactionSize",
+                   "The heap is never rebuilt while it holds less than this number of events.",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&LazyCancelScheduler::m_minCompactionSize),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+LazyCancelScheduler::LazyCancelScheduler ()
+  : m_compactions (0),
+    m_discarded (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LazyCancelScheduler::~LazyCancelScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+LazyCancelScheduler::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  // the simulator removes the live events, the tombstones are ours
+  for (const Scheduler::Event &ev : m_heap)
+    {
+      if (IsTombstone (ev))
+        {
+          ev.impl->Unref ();
+        }
+    }
+  m_heap.clear ();
+  m_tombstones.clear ();
+  Scheduler::DoDispose ();
+}
+
+LazyCancelScheduler::Stats
+LazyCancelScheduler::GetStats (void) const
+{
+  Stats stats;
+  stats.dead = static_cast<uint32_t> (m_tombstones.size ());
+  stats.live = static_cast<uint32_t> (m_heap.size ()) - stats.dead;
+  stats.compactions = m_compactions;
+  stats.discarded = m_discarded;
+  return stats;
+}
+
+double
+LazyCancelScheduler::GetDeadRatio (void) const
+{
+  if (m_heap.empty ())
+    {
+      return 0;
+    }
+  return static_cast<double> (m_tombstones.size ()) / m_heap.size ();
+}
+
+bool
+LazyCancelScheduler::IsTombstone (const Scheduler::Event &ev) const
+{
+  return ev.impl->IsCancelled () && m_tombstones.count (ev.key.m_uid) > 0;
+}
+
+void
+LazyCancelScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  m_heap.push_back (ev);
+  std::push_heap (m_heap.begin (), m_heap.end (), std::greater<Scheduler::Event> ());
+}
+
+bool
+LazyCancelScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  // tombstones never stay at the top of the heap, hence a heap holding
+  // tombstones only is empty
+  return m_heap.empty ();
+}
+
+Scheduler::Event
+LazyCancelScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_heap.front ();
+}
+
+Scheduler::Event
+LazyCancelScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::pop_heap (m_heap.begin (), m_heap.end (), std::greater<Scheduler::Event> ());
+  Scheduler::Event ev = m_heap.back ();
+  m_heap.pop_back ();
+  PurgeTop ();
+  return ev;
+}
+
+void
+LazyCancelScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  auto it = std::find (m_heap.begin (), m_heap.end (), ev);
+  NS_ASSERT (it != m_heap.end ());
+  m_heap.erase (it);
+  std::make_heap (m_heap.begin (), m_heap.end (), std::greater<Scheduler::Event> ());
+  PurgeTop ();
+}
+
+bool
+LazyCancelScheduler::Cancel (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!m_heap.empty () && ev.impl->IsCancelled ());
+  m_tombstones.insert (ev.key.m_uid);
+  if (m_heap.front () == ev)
+    {
+      PurgeTop ();
+    }
+  else if (m_heap.size () >= m_minCompactionSize
+           && m_tombstones.size () > m_maxDeadRatio * (m_heap.size () - m_tombstones.size ()))
+    {
+      Compact ();
+    }
+  return true;
+}
+
+void
+LazyCancelScheduler::PurgeTop (void)
+{
+  while (!m_heap.empty () && IsTombstone (m_heap.front ()))
+    {
+      std::pop_heap (m_heap.begin (), m_heap.end (), std::greater<Scheduler::Event> ());
+      Scheduler::Event ev = m_heap.back ();
+      m_heap.pop_back ();
+      m_tombstones.erase (ev.key.m_uid);
+      ev.impl->Unref ();
+      m_discarded++;
+    }
+}
+
+void
+LazyCancelScheduler::Compact (void)
+{
+  NS_LOG_FUNCTION (this << m_heap.size () << m_tombstones.size ());
+  auto last = std::remove_if (m_heap.begin (), m_heap.end (),
+                              [this] (const Scheduler::Event &ev)
+                              {
+                                if (!IsTombstone (ev))
+                                  {
+                                    return false;
+                                  }
+                                ev.impl->Unref ();
+                                return true;
+                              });
+  std::size_t removed = m_heap.end () - last;
+  NS_ASSERT_MSG (removed == m_tombstones.size (), "Tombstones missing from the heap");
+  m_heap.erase (last, m_heap.end ());
+  m_discarded += removed;
+  m_tombstones.clear ();
+  std::make_heap (m_heap.begin (), m_heap.end (), std::greater<Scheduler::Event> ());
+  m_compactions++;
+}
+
+} // namespace ns3
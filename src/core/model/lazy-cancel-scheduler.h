@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LAZY_CANCEL_SCHEDULER_H
+#define LAZY_CANCEL_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::LazyCancelScheduler class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a binary heap event scheduler which compacts cancelled events
+ *
+ * Simulator::Cancel only marks an event as cancelled and leaves it in
+ * the event list until its time comes. Models which cancel most of the
+ * timers they arm (e.g., MAC timeouts) thus fill the event list with
+ * dead entries, which make every heap operation slower.
+ *
+ * This scheduler takes over the events cancelled through
+ * Scheduler::Cancel and keeps them in the heap as tombstones, which are
+ * skipped as soon as they reach the top of the heap. When the number of
+ * tombstones exceeds the MaxDeadRatio attribute times the number of live
+ * events, the heap is rebuilt without them, so that its size stays
+ * proportional to the number of live events. Since a rebuild is
+ * triggered only after a number of cancellations proportional to the
+ * size of the heap, its cost is amortized over these cancellations.
+ *
+ * Events cancelled without notifying the scheduler (e.g., by a
+ * simulator implementation which does not call Scheduler::Cancel) are
+ * handled as in any other scheduler.
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time  | Reason
+ * :----------- | :--------------- | :-----
+ * Cancel()     | Constant         | Tombstone, amortized rebuild
+ * Insert()     | Logarithmic      | `std::push_heap()`
+ * IsEmpty()    | Constant         | `std::vector::empty()`
+ * PeekNext()   | Constant         | `std::vector::front()`
+ * Remove()     | Linear           | `std::find()` and `std::make_heap()`
+ * RemoveNext() | Logarithmic      | `std::pop_heap()`
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | 10 x `sizeof (*)`<br/>(80 bytes) | `std::vector`, `std::unordered_set`
+ * Per Event | 0                                | Events stored in `std::vector` directly
+ */
+class LazyCancelScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LazyCancelScheduler ();
+  /** Destructor. */
+  virtual ~LazyCancelScheduler ();
+
+  /** Occupancy of the event list. */
+  struct Stats
+  {
+    uint32_t live;         //!< number of live events
+    uint32_t dead;         //!< number of tombstones in the heap
+    uint64_t compactions;  //!< number of heap rebuilds
+    uint64_t discarded;    //!< number of tombstones discarded so far
+  };
+
+  /**
+   * \return The occupancy of the event list.
+   */
+  Stats GetStats (void) const;
+
+  /**
+   * \return The fraction of the heap entries which are tombstones.
+   */
+  double GetDeadRatio (void) const;
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+  virtual bool Cancel (const Scheduler::Event &ev);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \param ev an event of the heap
+   * \return true if the event is a tombstone
+   */
+  bool IsTombstone (const Scheduler::Event &ev) const;
+  /** Discard the tombstones at the top of the heap. */
+  void PurgeTop (void);
+  /** Rebuild the heap without the tombstones. */
+  void Compact (void);
+
+  std::vector<Scheduler::Event> m_heap;    //!< the heap, with the earliest event at the front
+  std::unordered_set<uint32_t> m_tombstones; //!< uids of the cancelled events in the heap
+  double m_maxDeadRatio;                   //!< tombstone to live event ratio triggering a rebuild
+  uint32_t m_minCompactionSize;            //!< minimum heap size for a rebuild
+  uint64_t m_compactions;                  //!< number of heap rebuilds
+  uint64_t m_discarded;                    //!< number of tombstones discarded
+};
+
+} // namespace ns3
+
+#endif /* LAZY_CANCEL_SCHEDULER_H */
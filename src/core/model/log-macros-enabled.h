@@ -165,6 +165,18 @@
 #define NS_LOG_CONDITION
 #endif
 
+#ifdef NS3_FAST_LOG
+/**
+ * \ingroup logging
+ * Skip the log statements of the files which call NS_LOG_HOT_PATH.
+ * The check is a constant expression, so the statements are compiled
+ * out.
+ */
+#define NS_LOG_HOT_PATH_CONDITION  if (LogIsHotPath (g_log)) {} else
+#else
+#define NS_LOG_HOT_PATH_CONDITION
+#endif
+
 /**
  * \ingroup logging
  *
@@ -186,6 +198,7 @@
  */
 #define NS_LOG(level, msg)                                      \
   NS_LOG_CONDITION                                              \
+  NS_LOG_HOT_PATH_CONDITION                                     \
   do {                                                          \
       if (g_log.IsEnabled (level))                              \
         {                                                       \
@@ -208,6 +221,7 @@
  */
 #define NS_LOG_FUNCTION_NOARGS()                                \
   NS_LOG_CONDITION                                              \
+  NS_LOG_HOT_PATH_CONDITION                                     \
   do {                                                          \
       if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
         {                                                       \
@@ -243,6 +257,7 @@
  */
 #define NS_LOG_FUNCTION(parameters)                             \
   NS_LOG_CONDITION                                              \
+  NS_LOG_HOT_PATH_CONDITION                                     \
   do                                                            \
     {                                                           \
       if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
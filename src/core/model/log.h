@@ -216,6 +216,21 @@ void LogComponentDisableAll (enum LogLevel level);
 #define NS_LOG_COMPONENT_DEFINE_MASK(name, mask)                \
   static ns3::LogComponent g_log = ns3::LogComponent (name, __FILE__, mask)
 
+/**
+ * Compile out the logs of this file when built with NS3_FAST_LOG (the
+ * \c fast build profile), for the components in the hot paths of the
+ * simulations. The log statements are still compiled, hence checked,
+ * but never run.
+ *
+ * This macro should be placed right after NS_LOG_COMPONENT_DEFINE.
+ */
+#define NS_LOG_HOT_PATH()                                       \
+  static constexpr bool                                         \
+  LogIsHotPath (const ns3::LogComponent &)                      \
+  {                                                             \
+    return true;                                                \
+  }
+
 /**
  * Declare a reference to a Log component.
  *
@@ -442,6 +457,20 @@ private:
  */
 LogComponent & GetLogComponent (const std::string name);
 
+/**
+ * Tell whether the logs of a component are compiled out under
+ * NS3_FAST_LOG. NS_LOG_HOT_PATH overloads it for the log component of
+ * the file which calls it.
+ *
+ * \return \c false
+ */
+template <typename T>
+constexpr bool
+LogIsHotPath (const T &)
+{
+  return false;
+}
+
 /**
  * Insert `, ` when streaming function arguments.
  */
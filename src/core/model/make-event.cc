@@ -51,6 +51,10 @@ EventImpl * MakeEvent (void (*f)(void))
     {
       (*m_function)();
     }
+    virtual HandlerId GetHandlerId (void) const
+    {
+      return ToHandlerId (m_function);
+    }
 
   private:
     F m_function;
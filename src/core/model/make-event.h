@@ -328,6 +328,8 @@ EventImpl * MakeEvent (T function);
 #include "event-impl.h"
 #include "type-traits.h"
 
+#include <type_traits>
+
 namespace ns3 {
 
 /**
@@ -385,6 +387,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)();
     }
+    virtual HandlerId GetHandlerId (void) const
+    {
+      return ToHandlerId (m_function);
+    }
     OBJ m_obj;
     MEM m_function;
   } *ev = new EventMemberImpl0 (obj, mem_ptr);
@@ -415,6 +421,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1);
     }
+    virtual HandlerId GetHandlerId (void) const
+    {
+      return ToHandlerId (m_function);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -446,6 +456,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2);
     }
+    virtual HandlerId GetHandlerId (void) const
+    {
+      return ToHandlerId (m_function);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -479,6 +493,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual HandlerId GetHandlerId (void) const
+    {
+      return ToHandlerId (m_function);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -514,6 +532,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4)
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual HandlerId GetHandlerId (void) const
+    {
+      return ToHandlerId (m_function);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -552,6 +574,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj,
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual HandlerId GetHandlerId (void) const
+    {
+      return ToHandlerId (m_function);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -592,6 +618,10 @@ EventImpl * MakeEvent (MEM mem_ptr, OBJ obj,
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
+    virtual HandlerId GetHandlerId (void) const
+    {
+      return ToHandlerId (m_function);
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -628,6 +658,10 @@ EventImpl * MakeEvent (void (*f)(U1), T1 a1)
     {
       (*m_function)(m_a1);
     }
+    virtual HandlerId GetHandlerId (void) const
+    {
+      return ToHandlerId (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
   } *ev = new EventFunctionImpl1 (f, a1);
@@ -659,6 +693,10 @@ EventImpl * MakeEvent (void (*f)(U1,U2), T1 a1, T2 a2)
     {
       (*m_function)(m_a1, m_a2);
     }
+    virtual HandlerId GetHandlerId (void) const
+    {
+      return ToHandlerId (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -693,6 +731,10 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3), T1 a1, T2 a2, T3 a3)
     {
       (*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual HandlerId GetHandlerId (void) const
+    {
+      return ToHandlerId (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -729,6 +771,10 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4), T1 a1, T2 a2, T3 a3, T4 a4)
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual HandlerId GetHandlerId (void) const
+    {
+      return ToHandlerId (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -767,6 +813,10 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5), T1 a1, T2 a2, T3 a3, T4 a4, T5
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual HandlerId GetHandlerId (void) const
+    {
+      return ToHandlerId (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -807,6 +857,10 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5,U6), T1 a1, T2 a2, T3 a3, T4 a4,
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
+    virtual HandlerId GetHandlerId (void) const
+    {
+      return ToHandlerId (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -836,6 +890,18 @@ private:
     {
       m_function();
     }
+    virtual HandlerId GetHandlerId (void) const
+    {
+      // a lambda has a type of its own, unlike a function
+      if constexpr (std::is_pointer<T>::value)
+        {
+          return ToHandlerId (m_function);
+        }
+      else
+        {
+          return HandlerId ();
+        }
+    }
     T m_function;
   } *ev = new EventImplFunctional (function);
   return ev;
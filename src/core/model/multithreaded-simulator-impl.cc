@@ -0,0 +1,771 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+#include "simulator.h"
+
+#include "assert.h"
+#include "abort.h"
+#include "log.h"
+#include "uinteger.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3 {
+
+// Logging in the event processing path is avoided, as it is not
+// serialized across the threads of the partitions.
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+thread_local MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::g_current = 0;
+thread_local MultithreadedSimulatorImpl *MultithreadedSimulatorImpl::g_running = 0;
+
+namespace {
+
+/** Timestamp larger than the timestamp of any event. */
+const uint64_t NO_TS = std::numeric_limits<uint64_t>::max ();
+
+} // unnamed namespace
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Core")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("ThreadCount",
+                   "The number of partitions, each run by its own thread; "
+                   "0 for the number of hardware threads. Fixed once the "
+                   "simulator is created.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_nThreads),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Lookahead",
+                   "A lower bound of the delay of the events scheduled from a "
+                   "partition into another one. Must be positive if there are "
+                   "several partitions.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::m_lookahead),
+                   MakeTimeChecker (Seconds (0)))
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_nThreads (0),
+    m_currentTs (0),
+    m_running (false),
+    m_stopped (false),
+    m_repartition (false),
+    m_stopTs (NO_TS),
+    m_nWindows (0),
+    m_externalSeq (0),
+    m_barrierCount (0),
+    m_barrierGeneration (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (auto &p : m_partitions)
+    {
+      DrainMailbox (p.get ());
+      while (!p->events->IsEmpty ())
+        {
+          Scheduler::Event next = p->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      p->events = 0;
+    }
+  m_partitions.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (true)
+    {
+      Ptr<EventImpl> ev;
+      {
+        std::unique_lock lock {m_destroyEventsMutex};
+        if (m_destroyEvents.empty ())
+          {
+            break;
+          }
+        ev = m_destroyEvents.front ().PeekEventImpl ();
+        m_destroyEvents.pop_front ();
+      }
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::CreatePartitions (void)
+{
+  if (!m_partitions.empty ())
+    {
+      return;
+    }
+  uint32_t n = m_nThreads;
+  if (n == 0)
+    {
+      n = std::max (1U, std::thread::hardware_concurrency ());
+    }
+  NS_LOG_FUNCTION (this << n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      std::unique_ptr<Partition> p (new Partition);
+      p->mailbox = 0;
+      p->index = i;
+      p->currentTs = m_currentTs;
+      p->currentContext = Simulator::NO_CONTEXT;
+      p->currentUid = EventId::UID::INVALID;
+      p->uid = EventId::UID::VALID + i;
+      p->eventCount = 0;
+      p->unscheduledEvents = 0;
+      p->seq = 0;
+      p->windowEnd = NO_TS;
+      m_partitions.push_back (std::move (p));
+    }
+  m_next.resize (n);
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  NS_ABORT_MSG_IF (m_running, "Cannot change the scheduler while the simulation runs");
+  CreatePartitions ();
+  m_schedulerFactory = schedulerFactory;
+  for (auto &p : m_partitions)
+    {
+      Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+      if (p->events != 0)
+        {
+          while (!p->events->IsEmpty ())
+            {
+              scheduler->Insert (p->events->RemoveNext ());
+            }
+        }
+      p->events = scheduler;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetPartition (uint32_t context, uint32_t partition)
+{
+  NS_LOG_FUNCTION (this << context << partition);
+  NS_ABORT_MSG_IF (m_running, "Cannot change the partition of a context while the simulation runs");
+  NS_ABORT_MSG_IF (context == Simulator::NO_CONTEXT, "The events without context run in partition 0");
+  NS_ABORT_MSG_UNLESS (partition < GetNPartitions (),
+                       "Partition " << partition << " out of " << GetNPartitions ());
+  if (context >= m_partitionOf.size ())
+    {
+      m_partitionOf.resize (context + 1, GetNPartitions ());
+    }
+  m_partitionOf[context] = partition;
+  m_repartition = true;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  return LookupPartition (context)->index;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetNPartitions (void) const
+{
+  return static_cast<uint32_t> (m_partitions.size ());
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookahead (void) const
+{
+  return m_lookahead;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetNWindows (void) const
+{
+  return m_nWindows;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetCurrentPartition (void) const
+{
+  Partition *p = GetCurrent ();
+  return p == 0 ? GetNPartitions () : p->index;
+}
+
+MultithreadedSimulatorImpl *
+MultithreadedSimulatorImpl::GetRunning (void)
+{
+  return g_running;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::LookupPartition (uint32_t context) const
+{
+  uint32_t n = GetNPartitions ();
+  if (context < m_partitionOf.size () && m_partitionOf[context] < n)
+    {
+      return m_partitions[m_partitionOf[context]].get ();
+    }
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return m_partitions[0].get ();
+    }
+  return m_partitions[context % n].get ();
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetCurrent (void) const
+{
+  return g_running == this ? g_current : 0;
+}
+
+void
+MultithreadedSimulatorImpl::Repartition (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Scheduler::Event> events;
+  for (auto &p : m_partitions)
+    {
+      while (!p->events->IsEmpty ())
+        {
+          events.push_back (p->events->RemoveNext ());
+        }
+      p->unscheduledEvents = 0;
+    }
+  // the uids are interleaved across partitions, hence they stay unique,
+  // and they are kept for the EventIds to remain valid
+  for (const Scheduler::Event &ev : events)
+    {
+      Partition *p = LookupPartition (ev.key.m_context);
+      p->events->Insert (ev);
+      p->unscheduledEvents++;
+    }
+  // the moved events may carry uids larger than the next uid of their new
+  // partition: the events scheduled later on at the same time must come
+  // after them, and must not be taken for expired once they have run
+  uint32_t next = 0;
+  for (auto &p : m_partitions)
+    {
+      next = std::max (next, p->uid);
+    }
+  uint32_t n = GetNPartitions ();
+  for (auto &p : m_partitions)
+    {
+      p->uid = next + (n + (EventId::UID::VALID + p->index) % n - next % n) % n;
+    }
+  m_repartition = false;
+}
+
+EventId
+MultithreadedSimulatorImpl::Insert (Partition *p, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = p->uid;
+  p->uid += GetNPartitions ();
+  p->unscheduledEvents++;
+  p->events->Insert (ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::Post (Partition *p, Message *msg)
+{
+  Message *head = p->mailbox.load (std::memory_order_relaxed);
+  do
+    {
+      msg->next = head;
+    }
+  while (!p->mailbox.compare_exchange_weak (head, msg,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed));
+}
+
+void
+MultithreadedSimulatorImpl::DrainMailbox (Partition *p)
+{
+  Message *head = p->mailbox.exchange (0, std::memory_order_acquire);
+  if (head == 0)
+    {
+      return;
+    }
+  std::vector<Message *> messages;
+  for (Message *msg = head; msg != 0; msg = msg->next)
+    {
+      if (msg->relative)
+        {
+          msg->ts += p->currentTs;
+          msg->relative = false;
+        }
+      messages.push_back (msg);
+    }
+  // the order of the messages in the mailbox depends on the scheduling
+  // of the threads: sort them so that their uids do not
+  std::sort (messages.begin (), messages.end (),
+             [] (const Message *a, const Message *b)
+             {
+               if (a->ts != b->ts)
+                 {
+                   return a->ts < b->ts;
+                 }
+               if (a->source != b->source)
+                 {
+                   return a->source < b->source;
+                 }
+               return a->seq < b->seq;
+             });
+  for (Message *msg : messages)
+    {
+      Insert (p, msg->ts, msg->context, msg->event);
+      delete msg;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Barrier (void)
+{
+  uint32_t generation = m_barrierGeneration.load (std::memory_order_acquire);
+  if (m_barrierCount.fetch_add (1, std::memory_order_acq_rel) + 1 == GetNPartitions ())
+    {
+      m_barrierCount.store (0, std::memory_order_relaxed);
+      m_barrierGeneration.fetch_add (1, std::memory_order_release);
+      return;
+    }
+  while (m_barrierGeneration.load (std::memory_order_acquire) == generation)
+    {
+      std::this_thread::yield ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::RunPartition (Partition *p)
+{
+  g_running = this;
+  g_current = p;
+  uint32_t n = GetNPartitions ();
+  uint64_t lookahead = m_lookahead.GetTimeStep ();
+  while (true)
+    {
+      // No partition runs events here: the mailboxes and the stop time
+      // are stable until the barrier.
+      DrainMailbox (p);
+      m_next[p->index] = p->events->IsEmpty () ? NO_TS : p->events->PeekNext ().key.m_ts;
+      uint64_t stopTs = m_stopTs.load (std::memory_order_relaxed);
+      Barrier ();
+
+      uint64_t start = *std::min_element (m_next.begin (), m_next.end ());
+      if (start == NO_TS || start >= stopTs)
+        {
+          break;
+        }
+      // a stop requested during the window takes effect at its end,
+      // whatever the progress of the other partitions
+      uint64_t end = stopTs;
+      if (n > 1 && start < NO_TS - lookahead)
+        {
+          end = std::min (end, start + lookahead);
+        }
+      p->windowEnd = end;
+      if (p->index == 0)
+        {
+          m_nWindows++;
+        }
+
+      while (!p->events->IsEmpty ())
+        {
+          uint64_t ts = p->events->PeekNext ().key.m_ts;
+          // a single partition has no window to wait for
+          if (ts >= end || (n == 1 && ts >= m_stopTs.load (std::memory_order_relaxed)))
+            {
+              break;
+            }
+          Scheduler::Event next = p->events->RemoveNext ();
+          PreEventHook (EventId (next.impl, next.key.m_ts,
+                                 next.key.m_context, next.key.m_uid));
+          NS_ASSERT (next.key.m_ts >= p->currentTs);
+          p->unscheduledEvents--;
+          p->eventCount++;
+          p->currentTs = next.key.m_ts;
+          p->currentContext = next.key.m_context;
+          p->currentUid = next.key.m_uid;
+          next.impl->Invoke ();
+          next.impl->Unref ();
+        }
+      Barrier ();
+    }
+  g_current = 0;
+  g_running = 0;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t n = GetNPartitions ();
+  NS_ABORT_MSG_IF (n > 1 && !m_lookahead.IsStrictlyPositive (),
+                   "The Lookahead must be positive to run several partitions");
+  if (m_repartition)
+    {
+      Repartition ();
+    }
+  m_running = true;
+  m_stopped = false;
+  std::vector<std::thread> threads;
+  for (uint32_t i = 1; i < n; i++)
+    {
+      threads.emplace_back (&MultithreadedSimulatorImpl::RunPartition, this, m_partitions[i].get ());
+    }
+  RunPartition (m_partitions[0].get ());
+  for (std::thread &thread : threads)
+    {
+      thread.join ();
+    }
+  m_running = false;
+
+  int unscheduledEvents = 0;
+  bool empty = true;
+  for (auto &p : m_partitions)
+    {
+      m_currentTs = std::max (m_currentTs, p->currentTs);
+      unscheduledEvents += p->unscheduledEvents;
+      empty = empty && p->events->IsEmpty ();
+    }
+  uint64_t stopTs = m_stopTs.exchange (NO_TS);
+  if (stopTs != NO_TS)
+    {
+      // the stop time was reached, as if a Stop event had been run
+      m_currentTs = std::max (m_currentTs, stopTs);
+      m_stopped = true;
+    }
+  for (auto &p : m_partitions)
+    {
+      if (p->currentTs < m_currentTs)
+        {
+          p->currentTs = m_currentTs;
+          p->currentUid = EventId::UID::INVALID;
+        }
+    }
+  NS_LOG_LOGIC ("stopped at " << m_currentTs << " after " << m_nWindows << " windows");
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  NS_ASSERT (!empty || unscheduledEvents == 0);
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stopped)
+    {
+      return true;
+    }
+  for (auto &p : m_partitions)
+    {
+      if (!p->events->IsEmpty () || p->mailbox.load () != 0)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::StopAt (uint64_t ts)
+{
+  Partition *p = GetCurrent ();
+  if (p != 0 && GetNPartitions () > 1)
+    {
+      ts = std::max (ts, p->windowEnd);
+    }
+  uint64_t current = m_stopTs.load ();
+  while (ts < current && !m_stopTs.compare_exchange_weak (current, ts))
+    {
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  StopAt (Now ().GetTimeStep ());
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::Stop(): Negative delay");
+  StopAt ((delay + Now ()).GetTimeStep ());
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+  Partition *p = GetCurrent ();
+  if (p != 0)
+    {
+      return Insert (p, p->currentTs + delay.GetTimeStep (), p->currentContext, event);
+    }
+  NS_ASSERT_MSG (!m_running, "Simulator::Schedule Thread-unsafe invocation!");
+  return Insert (LookupPartition (Simulator::NO_CONTEXT), m_currentTs + delay.GetTimeStep (),
+                 Simulator::NO_CONTEXT, event);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  Partition *target = LookupPartition (context);
+  Partition *p = GetCurrent ();
+  if (p == target)
+    {
+      Insert (p, p->currentTs + delay.GetTimeStep (), context, event);
+    }
+  else if (p != 0)
+    {
+      NS_ABORT_MSG_IF (delay < m_lookahead,
+                       "Event for context " << context << " in partition " << target->index
+                       << " scheduled from partition " << p->index << " with a delay of "
+                       << delay << ", below the lookahead of " << m_lookahead);
+      Message *msg = new Message;
+      msg->ts = p->currentTs + delay.GetTimeStep ();
+      msg->context = context;
+      msg->source = p->index;
+      msg->seq = p->seq++;
+      msg->relative = false;
+      msg->event = event;
+      Post (target, msg);
+    }
+  else if (!m_running)
+    {
+      Insert (target, m_currentTs + delay.GetTimeStep (), context, event);
+    }
+  else
+    {
+      // From a thread outside the simulation: the delay is counted from
+      // the time of the target partition when the event is inserted.
+      Message *msg = new Message;
+      msg->ts = delay.GetTimeStep ();
+      msg->context = context;
+      msg->source = GetNPartitions ();
+      msg->seq = m_externalSeq++;
+      msg->relative = true;
+      msg->event = event;
+      Post (target, msg);
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (Time (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  EventId id (Ptr<EventImpl> (event, false), Now ().GetTimeStep (), 0xffffffff, EventId::UID::DESTROY);
+  std::unique_lock lock {m_destroyEventsMutex};
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  Partition *p = GetCurrent ();
+  return TimeStep (p != 0 ? p->currentTs : m_currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  return TimeStep (id.GetTs ()) - Now ();
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == EventId::UID::DESTROY)
+    {
+      std::unique_lock lock {m_destroyEventsMutex};
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (id.PeekEventImpl () == 0)
+    {
+      return;
+    }
+  Partition *p = LookupPartition (id.GetContext ());
+  NS_ABORT_MSG_IF (m_running && p != GetCurrent (), "Cannot remove an event of another partition");
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  p->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+  p->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (id.PeekEventImpl () == 0)
+    {
+      return;
+    }
+  Partition *p = 0;
+  if (id.GetUid () != EventId::UID::DESTROY)
+    {
+      // the state of the event and the event list of another partition
+      // are written by its thread while the simulation runs
+      p = LookupPartition (id.GetContext ());
+      NS_ABORT_MSG_IF (m_running && p != GetCurrent (), "Cannot cancel an event of another partition");
+    }
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+      if (p == 0)
+        {
+          return;
+        }
+      Scheduler::Event event;
+      event.impl = id.PeekEventImpl ();
+      event.key.m_ts = id.GetTs ();
+      event.key.m_context = id.GetContext ();
+      event.key.m_uid = id.GetUid ();
+      if (p->events->Cancel (event))
+        {
+          // the scheduler took over the event list reference
+          p->unscheduledEvents--;
+        }
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == EventId::UID::DESTROY)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      std::unique_lock lock {m_destroyEventsMutex};
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  if (id.PeekEventImpl () == 0)
+    {
+      return true;
+    }
+  const Partition *p = LookupPartition (id.GetContext ());
+  return id.GetTs () < p->currentTs
+         || (id.GetTs () == p->currentTs && id.GetUid () <= p->currentUid)
+         || id.PeekEventImpl ()->IsCancelled ();
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  Partition *p = GetCurrent ();
+  return p != 0 ? p->currentContext : Simulator::NO_CONTEXT;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount (void) const
+{
+  uint64_t count = 0;
+  for (auto &p : m_partitions)
+    {
+      count += p->eventCount;
+    }
+  return count;
+}
+
+} // namespace ns3
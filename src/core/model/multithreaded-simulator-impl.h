@@ -0,0 +1,275 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+#include "object-factory.h"
+#include "nstime.h"
+#include "ptr.h"
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MultithreadedSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * A shared memory parallel simulator implementation.
+ *
+ * The execution contexts (i.e., the node ids) are spread over partitions,
+ * each of which owns an event list and is run by its own thread. By
+ * default, context \c c is assigned to partition <tt>c % ThreadCount</tt>;
+ * SetPartition allows to keep the nodes which interact closely (e.g., a
+ * BSS) in the same partition. Events without context run in partition 0.
+ *
+ * The partitions are synchronized conservatively: the simulation
+ * progresses by windows which start at the earliest pending event of all
+ * the partitions and span the Lookahead, which must be a lower bound of
+ * the delay of the events a partition schedules into another one (e.g.,
+ * the smallest propagation delay between nodes of different partitions,
+ * see YansWifiChannel::GetLookahead). The partitions process the events
+ * of a window concurrently, and Simulator::ScheduleWithContext posts
+ * the events for another partition in the lock-free mailbox of that
+ * partition, to be inserted in its event list between two windows. The
+ * events posted in a mailbox are sorted by timestamp, sending partition
+ * and sending order before being inserted, so that a simulation runs the
+ * same events in the same order whatever the scheduling of the threads.
+ *
+ * The models must only interact across partitions with
+ * Simulator::ScheduleWithContext and must not share mutable state across
+ * partitions otherwise; in particular, an event can only be cancelled or
+ * removed by its own partition while the simulation runs.
+ *
+ * A Simulator::Stop called by an event takes effect at the first window
+ * boundary at or after the requested time, so that all the partitions
+ * stop after the same events; called before Run, it takes effect
+ * exactly.
+ *
+ * Each window ends with the partitions waiting for each other twice at a
+ * barrier, which spins (yielding the processor) rather than blocking. A
+ * speedup over the DefaultSimulatorImpl thus requires windows holding many
+ * events, which wireless scenarios seldom provide: the propagation delay
+ * between nodes 50 m apart, hence the lookahead, is about 167 ns, which
+ * is shorter than most of the delays a Wi-Fi model schedules. Such
+ * scenarios usually run slower than with the DefaultSimulatorImpl.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  /**
+   * Assign a context to a partition. Must not be called while the
+   * simulation runs.
+   * \param [in] context The context, usually a node id.
+   * \param [in] partition The partition, smaller than GetNPartitions.
+   */
+  void SetPartition (uint32_t context, uint32_t partition);
+  /**
+   * \param [in] context A context.
+   * \returns The partition the events of this context run in.
+   */
+  uint32_t GetPartition (uint32_t context) const;
+  /** \returns The number of partitions, i.e., of threads. */
+  uint32_t GetNPartitions (void) const;
+  /** \returns The lookahead. */
+  Time GetLookahead (void) const;
+  /** \returns The number of windows run so far. */
+  uint64_t GetNWindows (void) const;
+  /**
+   * \returns The partition run by the calling thread, or
+   *          GetNPartitions () if it does not run a partition.
+   */
+  uint32_t GetCurrentPartition (void) const;
+  /**
+   * \returns The running simulator if the calling thread runs one of
+   *          its partitions, or null otherwise.
+   */
+  static MultithreadedSimulatorImpl * GetRunning (void);
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event posted to the mailbox of a partition. */
+  struct Message
+  {
+    Message *next;      //!< the next message in the mailbox
+    uint64_t ts;        //!< the timestamp, or the delay if relative
+    uint32_t context;   //!< the context of the event
+    uint32_t source;    //!< the sending partition
+    uint64_t seq;       //!< the sending order within the sending partition
+    bool relative;      //!< true if posted by a thread outside the simulation
+    EventImpl *event;   //!< the event
+  };
+
+  /** A partition of the simulation. */
+  struct Partition
+  {
+    Ptr<Scheduler> events;          //!< the event list
+    std::atomic<Message *> mailbox; //!< the events posted by the other partitions
+    uint32_t index;                 //!< the index of the partition
+    uint64_t currentTs;             //!< timestamp of the current event
+    uint32_t currentContext;        //!< context of the current event
+    uint32_t currentUid;            //!< uid of the current event
+    uint32_t uid;                   //!< next event uid, uids being interleaved across partitions
+    uint64_t eventCount;            //!< number of events run
+    int unscheduledEvents;          //!< number of events in the event list
+    uint64_t seq;                   //!< number of messages posted
+    uint64_t windowEnd;             //!< end of the current window, excluded
+  };
+
+  /**
+   * \param [in] context A context.
+   * \returns The partition the events of this context run in.
+   */
+  Partition * LookupPartition (uint32_t context) const;
+  /** \returns The partition run by the calling thread, if any. */
+  Partition * GetCurrent (void) const;
+  /**
+   * Insert an event in the event list of a partition.
+   * \param [in] p The partition.
+   * \param [in] ts The timestamp of the event.
+   * \param [in] context The context of the event.
+   * \param [in] event The event.
+   * \returns The event identifier.
+   */
+  EventId Insert (Partition *p, uint64_t ts, uint32_t context, EventImpl *event);
+  /**
+   * Post an event to the mailbox of a partition.
+   * \param [in] p The partition.
+   * \param [in] msg The event.
+   */
+  static void Post (Partition *p, Message *msg);
+  /**
+   * Move the events posted to the mailbox of a partition into its event list.
+   * \param [in] p The partition.
+   */
+  void DrainMailbox (Partition *p);
+  /**
+   * Run a partition until the end of the simulation.
+   * \param [in] p The partition.
+   */
+  void RunPartition (Partition *p);
+  /** Wait until all the partitions reach this point. */
+  void Barrier (void);
+  /** Create the partitions if they do not exist yet. */
+  void CreatePartitions (void);
+  /**
+   * Move the pending events to the partition of their context, after
+   * SetPartition changed the partition of some contexts.
+   */
+  void Repartition (void);
+  /**
+   * Stop the simulation before the events at or after a timestamp,
+   * rounded up to the end of the current window if called by an event
+   * while several partitions run.
+   * \param [in] ts The timestamp.
+   */
+  void StopAt (uint64_t ts);
+
+  /** The partitions. */
+  std::vector<std::unique_ptr<Partition> > m_partitions;
+  /** The partition of each context, or GetNPartitions () if not assigned. */
+  std::vector<uint32_t> m_partitionOf;
+  /** The number of partitions, 0 for the number of hardware threads. */
+  uint32_t m_nThreads;
+  /** The lookahead. */
+  Time m_lookahead;
+  /** The factory of the event lists. */
+  ObjectFactory m_schedulerFactory;
+  /** Timestamp of the last event run, outside of Run. */
+  uint64_t m_currentTs;
+  /** True while the simulation runs. */
+  bool m_running;
+  /** True if the last Run was stopped by Simulator::Stop. */
+  bool m_stopped;
+  /** True if SetPartition was called since the last Run. */
+  bool m_repartition;
+  /** The timestamp of the events after which the simulation stops. */
+  std::atomic<uint64_t> m_stopTs;
+  /** The timestamp of the next event of each partition, for the current window. */
+  std::vector<uint64_t> m_next;
+  /** The number of windows run. */
+  uint64_t m_nWindows;
+  /** Number of messages posted by threads outside the simulation. */
+  std::atomic<uint64_t> m_externalSeq;
+
+  /** The number of partitions which reached the barrier. */
+  std::atomic<uint32_t> m_barrierCount;
+  /** The barrier generation, incremented each time it is released. */
+  std::atomic<uint32_t> m_barrierGeneration;
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Mutex protecting the events to run at Destroy. */
+  mutable std::mutex m_destroyEventsMutex;
+
+  /** The partition run by the calling thread. */
+  static thread_local Partition *g_current;
+  /** The simulator whose partition is run by the calling thread. */
+  static thread_local MultithreadedSimulatorImpl *g_running;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
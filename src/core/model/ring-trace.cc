@@ -0,0 +1,404 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ring-trace.h"
+#include "simulator.h"
+#include "fatal-error.h"
+#include "assert.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+/**
+ * \file
+ * \ingroup logging
+ * ns3::RingTracePoint, ns3::RingTrace and ns3::RingTraceReader
+ * implementations.
+ */
+
+namespace ns3 {
+
+namespace {
+
+/** The magic string at the start of the trace files. */
+const char MAGIC[8] = {'N', 'S', '3', 'R', 'I', 'N', 'G', '1'};
+
+/** The ring buffer of a thread. */
+struct Buffer
+{
+  std::vector<RingTraceRecord> records;  //!< the records
+  uint64_t count;                        //!< the number of records written
+};
+
+/** The trace points, the ring buffers and the settings of the trace. */
+struct Registry
+{
+  std::mutex mutex;                               //!< protects the fields below
+  std::vector<RingTracePoint *> points;           //!< the trace points, by id
+  std::vector<std::unique_ptr<Buffer> > buffers;  //!< the ring buffers of the threads
+  uint32_t capacity {1 << 16};                    //!< the number of records of the buffers
+};
+
+/** \returns The registry of the trace. */
+Registry &
+GetRegistry (void)
+{
+  static Registry registry;
+  return registry;
+}
+
+/** Incremented when the buffers are cleared, to renew those of the threads. */
+std::atomic<uint32_t> g_generation {1};
+/** The ring buffer of the calling thread. */
+thread_local Buffer *t_buffer = nullptr;
+/** The value of g_generation when t_buffer was created. */
+thread_local uint32_t t_generation = 0;
+
+/**
+ * \param [in] pattern A trace point name, or a prefix followed by '*'.
+ * \param [in] name The name of a trace point.
+ * \returns Whether the name matches the pattern.
+ */
+bool
+Matches (const std::string &pattern, const std::string &name)
+{
+  if (!pattern.empty () && pattern.back () == '*')
+    {
+      return name.compare (0, pattern.size () - 1, pattern, 0, pattern.size () - 1) == 0;
+    }
+  return name == pattern;
+}
+
+/**
+ * Write a string preceded by its length.
+ * \param [in] os The output stream.
+ * \param [in] s The string.
+ */
+void
+WriteString (std::ostream &os, const std::string &s)
+{
+  uint16_t length = static_cast<uint16_t> (s.size ());
+  os.write (reinterpret_cast<const char *> (&length), sizeof (length));
+  os.write (s.data (), length);
+}
+
+/**
+ * Read a string preceded by its length.
+ * \param [in] is The input stream.
+ * \returns The string.
+ */
+std::string
+ReadString (std::istream &is)
+{
+  uint16_t length = 0;
+  is.read (reinterpret_cast<char *> (&length), sizeof (length));
+  std::string s (length, '\0');
+  is.read (&s[0], length);
+  return s;
+}
+
+} // unnamed namespace
+
+static_assert (sizeof (RingTraceRecord) == 40, "Unexpected RingTraceRecord size");
+
+double
+RingTraceRecord::GetDouble (uint32_t i) const
+{
+  switch (GetType (i))
+    {
+    case DOUBLE:
+      {
+        double d;
+        std::memcpy (&d, &args[i], sizeof (d));
+        return d;
+      }
+    case INT:
+      return static_cast<double> (GetInt (i));
+    default:
+      return static_cast<double> (GetUint (i));
+    }
+}
+
+RingTracePoint::RingTracePoint (std::string name, std::string argNames)
+  : m_enabled (false),
+    m_name (name),
+    m_argNames (argNames)
+{
+  Registry &registry = GetRegistry ();
+  std::unique_lock lock {registry.mutex};
+  NS_ASSERT_MSG (registry.points.size () < 0xffff, "Too many RingTrace points");
+  m_id = static_cast<uint16_t> (registry.points.size ());
+  registry.points.push_back (this);
+}
+
+void
+RingTracePoint::Enable (void)
+{
+  m_enabled.store (true, std::memory_order_relaxed);
+}
+
+void
+RingTracePoint::Disable (void)
+{
+  m_enabled.store (false, std::memory_order_relaxed);
+}
+
+uint16_t
+RingTracePoint::GetId (void) const
+{
+  return m_id;
+}
+
+std::string
+RingTracePoint::GetName (void) const
+{
+  return m_name;
+}
+
+std::string
+RingTracePoint::GetArgNames (void) const
+{
+  return m_argNames;
+}
+
+void
+RingTrace::Enable (std::string name)
+{
+  Registry &registry = GetRegistry ();
+  std::unique_lock lock {registry.mutex};
+  for (RingTracePoint *point : registry.points)
+    {
+      if (Matches (name, point->GetName ()))
+        {
+          point->Enable ();
+        }
+    }
+}
+
+void
+RingTrace::Disable (std::string name)
+{
+  Registry &registry = GetRegistry ();
+  std::unique_lock lock {registry.mutex};
+  for (RingTracePoint *point : registry.points)
+    {
+      if (Matches (name, point->GetName ()))
+        {
+          point->Disable ();
+        }
+    }
+}
+
+void
+RingTrace::SetCapacity (uint32_t records)
+{
+  NS_ASSERT_MSG (records > 0 && records <= (1u << 31), "Invalid RingTrace capacity " << records);
+  uint32_t capacity = 1;
+  while (capacity < records)
+    {
+      capacity <<= 1;
+    }
+  {
+    Registry &registry = GetRegistry ();
+    std::unique_lock lock {registry.mutex};
+    registry.capacity = capacity;
+  }
+  Clear ();
+}
+
+uint32_t
+RingTrace::GetCapacity (void)
+{
+  Registry &registry = GetRegistry ();
+  std::unique_lock lock {registry.mutex};
+  return registry.capacity;
+}
+
+void
+RingTrace::Clear (void)
+{
+  Registry &registry = GetRegistry ();
+  std::unique_lock lock {registry.mutex};
+  registry.buffers.clear ();
+  // the threads create a new buffer on their next record
+  g_generation++;
+}
+
+RingTraceRecord &
+RingTrace::NextRecord (const RingTracePoint &point)
+{
+  uint32_t generation = g_generation.load (std::memory_order_relaxed);
+  if (t_generation != generation)
+    {
+      Registry &registry = GetRegistry ();
+      std::unique_lock lock {registry.mutex};
+      std::unique_ptr<Buffer> buffer (new Buffer);
+      buffer->records.resize (registry.capacity);
+      buffer->count = 0;
+      t_buffer = buffer.get ();
+      t_generation = generation;
+      registry.buffers.push_back (std::move (buffer));
+    }
+  RingTraceRecord &record = t_buffer->records[t_buffer->count & (t_buffer->records.size () - 1)];
+  t_buffer->count++;
+  record.ts = Simulator::Now ().GetTimeStep ();
+  record.context = Simulator::GetContext ();
+  record.point = point.GetId ();
+  return record;
+}
+
+void
+RingTrace::Dump (std::string filename)
+{
+  Registry &registry = GetRegistry ();
+  std::unique_lock lock {registry.mutex};
+  std::vector<RingTraceRecord> records;
+  for (const auto &buffer : registry.buffers)
+    {
+      uint64_t size = buffer->records.size ();
+      uint64_t first = buffer->count > size ? buffer->count - size : 0;
+      for (uint64_t i = first; i < buffer->count; i++)
+        {
+          records.push_back (buffer->records[i & (size - 1)]);
+        }
+    }
+  std::stable_sort (records.begin (), records.end (),
+                    [] (const RingTraceRecord &a, const RingTraceRecord &b) { return a.ts < b.ts; });
+
+  std::ofstream os (filename.c_str (), std::ios::out | std::ios::binary);
+  if (!os.is_open ())
+    {
+      NS_FATAL_ERROR ("Cannot create the ring trace file " << filename);
+    }
+  os.write (MAGIC, sizeof (MAGIC));
+  uint32_t nPoints = registry.points.size ();
+  os.write (reinterpret_cast<const char *> (&nPoints), sizeof (nPoints));
+  for (const RingTracePoint *point : registry.points)
+    {
+      uint16_t id = point->GetId ();
+      os.write (reinterpret_cast<const char *> (&id), sizeof (id));
+      WriteString (os, point->GetName ());
+      WriteString (os, point->GetArgNames ());
+    }
+  uint64_t nRecords = records.size ();
+  os.write (reinterpret_cast<const char *> (&nRecords), sizeof (nRecords));
+  os.write (reinterpret_cast<const char *> (records.data ()), records.size () * sizeof (RingTraceRecord));
+}
+
+RingTraceReader::RingTraceReader (std::string filename)
+  : m_nRecords (0)
+{
+  m_is.open (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!m_is.is_open ())
+    {
+      NS_FATAL_ERROR ("Cannot open the ring trace file " << filename);
+    }
+  char magic[sizeof (MAGIC)];
+  if (!m_is.read (magic, sizeof (magic))
+      || std::memcmp (magic, MAGIC, sizeof (magic)) != 0)
+    {
+      NS_FATAL_ERROR (filename << " is not a ring trace file");
+    }
+  uint32_t nPoints = 0;
+  m_is.read (reinterpret_cast<char *> (&nPoints), sizeof (nPoints));
+  for (uint32_t i = 0; i < nPoints && m_is; i++)
+    {
+      uint16_t id = 0;
+      m_is.read (reinterpret_cast<char *> (&id), sizeof (id));
+      if (id >= m_names.size ())
+        {
+          m_names.resize (id + 1);
+          m_argNames.resize (id + 1);
+        }
+      m_names[id] = ReadString (m_is);
+      m_argNames[id] = ReadString (m_is);
+    }
+  m_is.read (reinterpret_cast<char *> (&m_nRecords), sizeof (m_nRecords));
+  if (!m_is)
+    {
+      NS_FATAL_ERROR ("Truncated ring trace file " << filename);
+    }
+}
+
+bool
+RingTraceReader::Read (RingTraceRecord &record)
+{
+  if (m_nRecords == 0
+      || !m_is.read (reinterpret_cast<char *> (&record), sizeof (record)))
+    {
+      return false;
+    }
+  m_nRecords--;
+  return true;
+}
+
+std::string
+RingTraceReader::GetPointName (uint16_t point) const
+{
+  return point < m_names.size () ? m_names[point] : "";
+}
+
+std::string
+RingTraceReader::GetArgNames (uint16_t point) const
+{
+  return point < m_argNames.size () ? m_argNames[point] : "";
+}
+
+void
+RingTraceReader::Print (std::ostream &os, const RingTraceRecord &record) const
+{
+  os << TimeStep (record.ts).As (Time::S) << " ";
+  if (record.context == Simulator::NO_CONTEXT)
+    {
+      os << "- ";
+    }
+  else
+    {
+      os << record.context << " ";
+    }
+  os << GetPointName (record.point) << " (";
+  std::string names = GetArgNames (record.point);
+  std::size_t start = 0;
+  for (uint32_t i = 0; i < record.nArgs; i++)
+    {
+      std::size_t end = names.find (',', start);
+      if (i > 0)
+        {
+          os << ", ";
+        }
+      if (start < names.size ())
+        {
+          os << names.substr (start, end - start) << "=";
+        }
+      start = end == std::string::npos ? names.size () : end + 1;
+      switch (record.GetType (i))
+        {
+        case RingTraceRecord::DOUBLE:
+          os << record.GetDouble (i);
+          break;
+        case RingTraceRecord::INT:
+          os << record.GetInt (i);
+          break;
+        default:
+          os << record.GetUint (i);
+          break;
+        }
+    }
+  os << ")";
+}
+
+} // namespace ns3
@@ -0,0 +1,352 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_TRACE_H
+#define RING_TRACE_H
+
+#include "nstime.h"
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup logging
+ * ns3::RingTracePoint, ns3::RingTrace and ns3::RingTraceReader
+ * declarations, and the NS_RING_TRACE macros.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup logging
+ *
+ * A record of the binary ring trace: the trace point, the simulation time
+ * and context, and up to MAX_ARGS numeric arguments.
+ */
+struct RingTraceRecord
+{
+  /** The maximum number of arguments of a record. */
+  static const uint32_t MAX_ARGS = 3;
+
+  /** The type of an argument. */
+  enum ArgType : uint8_t
+  {
+    UINT = 0,    //!< unsigned integer, enum, bool or pointer
+    INT = 1,     //!< signed integer, or Time in time steps
+    DOUBLE = 2   //!< floating point
+  };
+
+  int64_t ts;                //!< the simulation time, in time steps
+  uint32_t context;          //!< the simulation context
+  uint16_t point;            //!< the id of the trace point
+  uint8_t nArgs;             //!< the number of arguments
+  uint8_t types;             //!< the types of the arguments, 2 bits each
+  uint64_t args[MAX_ARGS];   //!< the arguments
+
+  /**
+   * \param [in] i The index of an argument.
+   * \returns The type of the argument.
+   */
+  ArgType GetType (uint32_t i) const
+  {
+    return static_cast<ArgType> ((types >> (2 * i)) & 0x3);
+  }
+  /**
+   * \param [in] i The index of an argument.
+   * \returns The argument, converted to a double.
+   */
+  double GetDouble (uint32_t i) const;
+  /**
+   * \param [in] i The index of an argument of type INT.
+   * \returns The argument.
+   */
+  int64_t GetInt (uint32_t i) const
+  {
+    return static_cast<int64_t> (args[i]);
+  }
+  /**
+   * \param [in] i The index of an argument of type UINT.
+   * \returns The argument.
+   */
+  uint64_t GetUint (uint32_t i) const
+  {
+    return args[i];
+  }
+};
+
+/**
+ * \ingroup logging
+ *
+ * A named trace point of the binary ring trace, defined with
+ * NS_RING_TRACE_DEFINE and written with NS_RING_TRACE. The trace points
+ * are disabled until enabled with RingTrace::Enable.
+ */
+class RingTracePoint
+{
+public:
+  /**
+   * Register a trace point.
+   * \param [in] name The name of the trace point, e.g. "Class::Method".
+   * \param [in] argNames The names of the arguments, separated by commas.
+   */
+  RingTracePoint (std::string name, std::string argNames);
+
+  /** \returns Whether the trace point is enabled. */
+  bool IsEnabled (void) const
+  {
+    return m_enabled.load (std::memory_order_relaxed);
+  }
+  /** Enable the trace point. */
+  void Enable (void);
+  /** Disable the trace point. */
+  void Disable (void);
+  /** \returns The id of the trace point, as written in the records. */
+  uint16_t GetId (void) const;
+  /** \returns The name of the trace point. */
+  std::string GetName (void) const;
+  /** \returns The names of the arguments, separated by commas. */
+  std::string GetArgNames (void) const;
+
+private:
+  std::atomic<bool> m_enabled;  //!< whether the trace point is enabled
+  uint16_t m_id;                //!< the id of the trace point
+  std::string m_name;           //!< the name of the trace point
+  std::string m_argNames;       //!< the names of the arguments
+};
+
+/**
+ * \ingroup logging
+ *
+ * A binary trace of fixed size records, kept in memory in a ring buffer
+ * per thread, the newest records overwriting the oldest ones.
+ *
+ * Unlike the logs, the trace points are cheap enough to be left in the
+ * hot paths: a disabled trace point costs a relaxed atomic load, and an
+ * enabled one a few nanoseconds to store its record. The records are
+ * written to a file with Dump() and read with RingTraceReader:
+ * \code
+ *   RingTrace::Enable ("YansWifiChannel::*");
+ *   Simulator::Run ();
+ *   RingTrace::Dump ("trace.bin");
+ * \endcode
+ */
+class RingTrace
+{
+public:
+  /**
+   * Enable the trace points.
+   * \param [in] name The name of a trace point, a prefix of the names
+   *        followed by '*', or "*" for all the trace points.
+   */
+  static void Enable (std::string name);
+  /**
+   * Disable the trace points.
+   * \param [in] name The name of a trace point, a prefix of the names
+   *        followed by '*', or "*" for all the trace points.
+   */
+  static void Disable (std::string name);
+  /**
+   * Set the number of records of the ring buffers, rounded up to a power
+   * of two, and clear the trace.
+   * \param [in] records The number of records per thread.
+   */
+  static void SetCapacity (uint32_t records);
+  /** \returns The number of records of the ring buffers. */
+  static uint32_t GetCapacity (void);
+  /**
+   * Drop the records of all the threads. No thread may write records
+   * meanwhile.
+   */
+  static void Clear (void);
+  /**
+   * Write the records of all the threads, ordered by simulation time,
+   * along with the names of the trace points. No thread may write
+   * records meanwhile.
+   *
+   * The file starts with an 8 byte magic string and the number of trace
+   * points (4 bytes); each trace point is written as its id (2 bytes)
+   * and the length (2 bytes) and characters of its name and of the names
+   * of its arguments. They are followed by the number of records (8
+   * bytes), then by one 40 byte RingTraceRecord per record, in host byte
+   * order.
+   *
+   * \param [in] filename The name of the file. Aborts if the file cannot
+   *        be created.
+   */
+  static void Dump (std::string filename);
+
+  /**
+   * Write a record of a trace point. Use NS_RING_TRACE, which only calls
+   * this method if the trace point is enabled.
+   * \tparam Ts \deduced The types of the arguments.
+   * \param [in] point The trace point.
+   * \param [in] args The arguments: numbers, enums, pointers or Time.
+   */
+  template <typename... Ts>
+  static void Write (const RingTracePoint &point, Ts... args);
+
+private:
+  /**
+   * \param [in] point The trace point.
+   * \returns The record to write in the ring buffer of the calling
+   *          thread, with the time, context and trace point set.
+   */
+  static RingTraceRecord & NextRecord (const RingTracePoint &point);
+
+  /**
+   * Set an argument of a record.
+   * \tparam T \deduced The type of the argument.
+   * \param [in] record The record.
+   * \param [in] i The index of the argument.
+   * \param [in] value The argument.
+   */
+  template <typename T>
+  static void SetArg (RingTraceRecord &record, uint32_t i, T value);
+  /**
+   * Set a Time argument of a record, as a number of time steps.
+   * \param [in] record The record.
+   * \param [in] i The index of the argument.
+   * \param [in] value The argument.
+   */
+  static void SetArg (RingTraceRecord &record, uint32_t i, Time value)
+  {
+    SetArg (record, i, value.GetTimeStep ());
+  }
+};
+
+/**
+ * \ingroup logging
+ *
+ * Read the records written by RingTrace::Dump.
+ */
+class RingTraceReader
+{
+public:
+  /**
+   * Open the trace and read the trace points. Aborts if the file cannot
+   * be read.
+   * \param [in] filename The name of the trace file.
+   */
+  RingTraceReader (std::string filename);
+
+  /**
+   * Read the next record.
+   * \param [out] record The record.
+   * \returns \c false at the end of the trace.
+   */
+  bool Read (RingTraceRecord &record);
+  /**
+   * \param [in] point The id of a trace point.
+   * \returns The name of the trace point.
+   */
+  std::string GetPointName (uint16_t point) const;
+  /**
+   * \param [in] point The id of a trace point.
+   * \returns The names of the arguments of the trace point, separated by
+   *          commas.
+   */
+  std::string GetArgNames (uint16_t point) const;
+  /**
+   * Print a record as text: time, context, trace point and arguments.
+   * \param [in] os The output stream.
+   * \param [in] record The record.
+   */
+  void Print (std::ostream &os, const RingTraceRecord &record) const;
+
+private:
+  std::ifstream m_is;                          //!< the trace file
+  uint64_t m_nRecords;                         //!< the number of records left
+  std::vector<std::string> m_names;            //!< the names of the trace points, by id
+  std::vector<std::string> m_argNames;         //!< the names of the arguments, by id
+};
+
+template <typename T>
+void
+RingTrace::SetArg (RingTraceRecord &record, uint32_t i, T value)
+{
+  RingTraceRecord::ArgType type;
+  if constexpr (std::is_floating_point<T>::value)
+    {
+      double d = value;
+      std::memcpy (&record.args[i], &d, sizeof (d));
+      type = RingTraceRecord::DOUBLE;
+    }
+  else if constexpr (std::is_pointer<T>::value)
+    {
+      record.args[i] = reinterpret_cast<uintptr_t> (value);
+      type = RingTraceRecord::UINT;
+    }
+  else if constexpr (std::is_enum<T>::value || std::is_unsigned<T>::value)
+    {
+      record.args[i] = static_cast<uint64_t> (value);
+      type = RingTraceRecord::UINT;
+    }
+  else
+    {
+      static_assert (std::is_integral<T>::value, "Unsupported RingTrace argument type");
+      record.args[i] = static_cast<uint64_t> (static_cast<int64_t> (value));
+      type = RingTraceRecord::INT;
+    }
+  record.types |= static_cast<uint8_t> (type << (2 * i));
+}
+
+template <typename... Ts>
+void
+RingTrace::Write (const RingTracePoint &point, Ts... args)
+{
+  static_assert (sizeof... (Ts) <= RingTraceRecord::MAX_ARGS, "Too many RingTrace arguments");
+  RingTraceRecord &record = NextRecord (point);
+  record.nArgs = sizeof... (Ts);
+  record.types = 0;
+  uint32_t i = 0;
+  (SetArg (record, i++, args), ...);
+}
+
+} // namespace ns3
+
+/**
+ * \ingroup logging
+ * Define a trace point of the binary ring trace.
+ * \param [in] var The name of the trace point variable.
+ * \param [in] name The name of the trace point, e.g. "Class::Method".
+ * \param [in] argNames The names of the arguments, separated by commas.
+ */
+#define NS_RING_TRACE_DEFINE(var, name, argNames) \
+  static ns3::RingTracePoint var (name, argNames)
+
+/**
+ * \ingroup logging
+ * Write a record of a trace point, if it is enabled. The arguments are
+ * only evaluated if the trace point is enabled.
+ * \param [in] var The trace point variable.
+ */
+#define NS_RING_TRACE(var, ...)                      \
+  do                                                 \
+    {                                                \
+      if (var.IsEnabled ())                          \
+        {                                            \
+          ns3::RingTrace::Write (var, __VA_ARGS__);  \
+        }                                            \
+    }                                                \
+  while (false)
+
+#endif /* RING_TRACE_H */
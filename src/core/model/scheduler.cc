@@ -49,4 +49,11 @@ Scheduler::GetTypeId (void)
   return tid;
 }
 
+bool
+Scheduler::Cancel (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  return false;
+}
+
 } // namespace ns3
@@ -110,6 +110,22 @@ class EventImpl;
  *      <td class="markdownTableBodyLeft"> 0 </td>
  * </tr>
  * <tr class="markdownTableBody">
+ *      <td class="markdownTableBodyLeft"> LadderScheduler </td>
+ *      <td class="markdownTableBodyLeft"> `std::vector` tiers and rungs </td>
+ *      <td class="markdownTableBodyLeft"> Constant </td>
+ *      <td class="markdownTableBodyLeft"> Constant </td>
+ *      <td class="markdownTableBodyLeft"> 96 bytes </td>
+ *      <td class="markdownTableBodyLeft"> 0 </td>
+ * </tr>
+ * <tr class="markdownTableBody">
+ *      <td class="markdownTableBodyLeft"> LazyCancelScheduler </td>
+ *      <td class="markdownTableBodyLeft"> Heap on `std::vector` </td>
+ *      <td class="markdownTableBodyLeft"> Logarithmic  </td>
+ *      <td class="markdownTableBodyLeft"> Logarithmic </td>
+ *      <td class="markdownTableBodyLeft"> 80 bytes </td>
+ *      <td class="markdownTableBodyLeft"> 0 </td>
+ * </tr>
+ * <tr class="markdownTableBody">
  *      <td class="markdownTableBodyLeft"> ListScheduler </td>
  *      <td class="markdownTableBodyLeft"> `std::list` </td>
  *      <td class="markdownTableBodyLeft"> Linear </td>
@@ -224,6 +240,21 @@ public:
    * \param [in] ev The event to remove
    */
   virtual void Remove (const Event &ev) = 0;
+  /**
+   * Notify the scheduler that an event of the event list has been
+   * cancelled.
+   *
+   * By default the cancelled event is left in the event list and is
+   * returned by RemoveNext as any other event. A scheduler may instead
+   * take it over, in which case the event is no longer part of the event
+   * list: it is neither returned by RemoveNext nor passed to Remove, and
+   * the scheduler releases the reference held by the event list when it
+   * discards the event.
+   *
+   * \param [in] ev The cancelled event.
+   * \returns \c true if the scheduler took over the event.
+   */
+  virtual bool Cancel (const Event &ev);
 };
 
 /**
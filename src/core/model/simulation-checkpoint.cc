@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "simulation-checkpoint.h"
+#include "simulator.h"
+#include "log.h"
+#include "fatal-error.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::SimulationCheckpoint implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SimulationCheckpoint");
+
+namespace {
+
+/** Checkpoint state shared by the snapshot holder and its branches. */
+struct CheckpointState
+{
+  SimulationCheckpoint::BranchCallback branchCb;     //!< run in each branch
+  SimulationCheckpoint::ContinueCallback continueCb; //!< run in the holder
+  uint32_t maxBranches {0};  //!< maximum number of branches, 0 if unlimited
+  uint32_t nBranches {0};    //!< number of branches that have exited
+  bool isBranch {false};     //!< true in the branches
+  uint32_t branchIndex {0};  //!< index of the branch
+  int stopFd {-1};           //!< write end of the stop pipe, in the branches
+};
+
+/**
+ * \return The checkpoint state of this process.
+ */
+CheckpointState &
+GetState (void)
+{
+  static CheckpointState state;
+  return state;
+}
+
+} // unnamed namespace
+
+void
+SimulationCheckpoint::Schedule (Time at, uint32_t maxBranches)
+{
+  NS_LOG_FUNCTION (at << maxBranches);
+  NS_ASSERT_MSG (!GetState ().isBranch, "Nested checkpoints are not supported");
+  GetState ().maxBranches = maxBranches;
+  GetState ().nBranches = 0;
+  Simulator::Schedule (at, &SimulationCheckpoint::Fork);
+}
+
+void
+SimulationCheckpoint::SetBranchCallback (BranchCallback cb)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  GetState ().branchCb = cb;
+}
+
+void
+SimulationCheckpoint::SetContinueCallback (ContinueCallback cb)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  GetState ().continueCb = cb;
+}
+
+bool
+SimulationCheckpoint::IsBranch (void)
+{
+  return GetState ().isBranch;
+}
+
+uint32_t
+SimulationCheckpoint::GetBranchIndex (void)
+{
+  return GetState ().branchIndex;
+}
+
+uint32_t
+SimulationCheckpoint::GetNBranches (void)
+{
+  return GetState ().nBranches;
+}
+
+void
+SimulationCheckpoint::Stop (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  CheckpointState &state = GetState ();
+  if (!state.isBranch || state.stopFd < 0)
+    {
+      return;
+    }
+  char c = 1;
+  ssize_t written;
+  do
+    {
+      written = write (state.stopFd, &c, 1);
+    }
+  while (written < 0 && errno == EINTR);
+}
+
+void
+SimulationCheckpoint::Fork (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  CheckpointState &state = GetState ();
+
+  while (true)
+    {
+      int stopPipe[2];
+      if (pipe (stopPipe) != 0)
+        {
+          NS_FATAL_ERROR ("Checkpoint: pipe failed: " << std::strerror (errno));
+        }
+
+      // do not let the branch inherit and print again buffered output
+      std::cout.flush ();
+      std::cerr.flush ();
+      std::fflush (nullptr);
+
+      pid_t pid = fork ();
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("Checkpoint: fork failed: " << std::strerror (errno));
+        }
+      if (pid == 0)
+        {
+          close (stopPipe[0]);
+          state.isBranch = true;
+          state.branchIndex = state.nBranches;
+          state.stopFd = stopPipe[1];
+          NS_LOG_LOGIC ("branch " << state.branchIndex << " starts at " << Simulator::Now ());
+          if (!state.branchCb.IsNull ())
+            {
+              state.branchCb (state.branchIndex);
+            }
+          return;
+        }
+
+      close (stopPipe[1]);
+      int status = 0;
+      while (waitpid (pid, &status, 0) < 0)
+        {
+          if (errno != EINTR)
+            {
+              NS_FATAL_ERROR ("Checkpoint: waitpid failed: " << std::strerror (errno));
+            }
+        }
+      int exitStatus = WIFEXITED (status) ? WEXITSTATUS (status) : 128 + WTERMSIG (status);
+
+      char c;
+      bool stopRequested = read (stopPipe[0], &c, 1) == 1;
+      close (stopPipe[0]);
+
+      uint32_t index = state.nBranches++;
+      NS_LOG_LOGIC ("branch " << index << " exited with status " << exitStatus
+                              << (stopRequested ? ", stop requested" : ""));
+
+      bool again = !stopRequested
+        && (state.maxBranches == 0 || state.nBranches < state.maxBranches);
+      if (again && !state.continueCb.IsNull ())
+        {
+          again = state.continueCb (index, exitStatus);
+        }
+      if (!again)
+        {
+          break;
+        }
+    }
+
+  // the snapshot itself never runs past the checkpoint
+  Simulator::Stop ();
+}
+
+} // namespace ns3
@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SIMULATION_CHECKPOINT_H
+#define SIMULATION_CHECKPOINT_H
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::SimulationCheckpoint declaration.
+ */
+
+#include "callback.h"
+#include "nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ *
+ * \brief Snapshot a running simulation and fork branches from it.
+ *
+ * At the checkpoint time the simulation process is frozen and used as a
+ * snapshot: the whole simulator state (event queue, objects, random number
+ * streams) is captured by forking the process. Each forked child is a
+ * branch that continues the simulation from the checkpoint as if nothing
+ * had happened, while the snapshot holder waits for it to exit and then
+ * forks the next branch. A warmup phase that precedes the checkpoint
+ * (e.g., scanning and association) is thus simulated only once, no
+ * matter how many branches are run from it.
+ *
+ * The branch callback runs in each child right after the fork, and is
+ * the place to alter the state of the branch, e.g., to apply a new action
+ * or to open a fresh connection to an external agent (sockets and other
+ * handles opened before the checkpoint are shared with the snapshot
+ * holder and must not be used by the branch). Branches start from
+ * identical random number generator states.
+ *
+ * Once the last branch has exited, Simulator::Run returns in the
+ * snapshot holder, which can tell itself apart from the branches with
+ * IsBranch ():
+ *
+ * \code
+ *     SimulationCheckpoint::SetBranchCallback (MakeCallback (&ApplyNewAction));
+ *     SimulationCheckpoint::Schedule (Seconds (10), 100);
+ *     Simulator::Run ();
+ *     if (!SimulationCheckpoint::IsBranch ())
+ *       {
+ *         // snapshot holder, all branches have run
+ *         Simulator::Destroy ();
+ *         return 0;
+ *       }
+ *     // branch: collect the results of the measured window
+ * \endcode
+ *
+ * This relies on fork(2) and is only available on POSIX systems.
+ */
+class SimulationCheckpoint
+{
+public:
+  /**
+   * Callback invoked in the child process of each branch, with the
+   * index of the branch.
+   */
+  typedef Callback<void, uint32_t> BranchCallback;
+
+  /**
+   * Callback invoked in the snapshot holder after a branch has exited,
+   * with the index of the branch and its exit status. Returning false
+   * stops forking new branches.
+   */
+  typedef Callback<bool, uint32_t, int> ContinueCallback;
+
+  /**
+   * Schedule the checkpoint.
+   *
+   * \param [in] at The delay, relative to now, of the checkpoint.
+   * \param [in] maxBranches The maximum number of branches to fork from
+   *             the checkpoint, or 0 to fork until a branch calls
+   *             Stop () or the continue callback returns false.
+   */
+  static void Schedule (Time at, uint32_t maxBranches = 0);
+
+  /**
+   * \param [in] cb The callback invoked in each branch after the fork.
+   */
+  static void SetBranchCallback (BranchCallback cb);
+
+  /**
+   * \param [in] cb The callback invoked in the snapshot holder after
+   *             each branch has exited.
+   */
+  static void SetContinueCallback (ContinueCallback cb);
+
+  /**
+   * \return true if the calling process is a branch forked from the
+   *         checkpoint.
+   */
+  static bool IsBranch (void);
+
+  /**
+   * \return The index of the calling branch, starting from 0.
+   */
+  static uint32_t GetBranchIndex (void);
+
+  /**
+   * \return The number of branches that have exited, as seen by the
+   *         snapshot holder.
+   */
+  static uint32_t GetNBranches (void);
+
+  /**
+   * Called from a branch to ask the snapshot holder not to fork any
+   * more branch once the calling one has exited.
+   */
+  static void Stop (void);
+
+private:
+  /** Hold the snapshot and fork the branches. */
+  static void Fork (void);
+};
+
+} // namespace ns3
+
+#endif /* SIMULATION_CHECKPOINT_H */
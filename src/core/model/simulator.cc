@@ -23,6 +23,7 @@
 #include "scheduler.h"
 #include "map-scheduler.h"
 #include "event-impl.h"
+#include "event-memory-pool.h"
 #include "des-metrics.h"
 
 #include "ptr.h"
@@ -152,6 +153,7 @@ Simulator::Destroy (void)
   (*pimpl)->Destroy ();
   (*pimpl)->Unref ();
   *pimpl = 0;
+  EventMemoryPool::Release ();
 }
 
 void
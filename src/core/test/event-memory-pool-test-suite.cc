@@ -0,0 +1,245 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/event-memory-pool.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * EventMemoryPool test suite.
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+
+/**
+ * \ingroup core-tests
+ * Check the blocks handed out by the pool: alignment, reuse of freed
+ * blocks and fallback to the heap for large objects.
+ */
+class EventMemoryPoolBlocksTestCase : public TestCase
+{
+public:
+  EventMemoryPoolBlocksTestCase ();
+  virtual void DoRun (void);
+};
+
+EventMemoryPoolBlocksTestCase::EventMemoryPoolBlocksTestCase ()
+  : TestCase ("Check the blocks handed out by the event memory pool")
+{}
+
+void
+EventMemoryPoolBlocksTestCase::DoRun (void)
+{
+  EventMemoryPool::ResetStats ();
+  int64_t live = EventMemoryPool::GetStats ().live;
+
+  std::vector<void *> blocks;
+  std::vector<std::size_t> sizes;
+  for (std::size_t size = 1; size <= EventMemoryPool::MAX_SIZE; size += 7)
+    {
+      void *p = EventMemoryPool::Allocate (size);
+      NS_TEST_EXPECT_MSG_EQ (reinterpret_cast<uintptr_t> (p) % 16, 0, "Misaligned block of size " << size);
+      std::memset (p, static_cast<int> (size), size);
+      blocks.push_back (p);
+      sizes.push_back (size);
+    }
+  NS_TEST_EXPECT_MSG_EQ (EventMemoryPool::GetStats ().live, live + static_cast<int64_t> (blocks.size ()),
+                         "Unexpected number of live objects");
+  for (std::size_t i = 0; i < blocks.size (); i++)
+    {
+      const unsigned char *p = static_cast<const unsigned char *> (blocks[i]);
+      for (std::size_t j = 0; j < sizes[i]; j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (p[j], static_cast<unsigned char> (sizes[i]), "Overlapping blocks");
+        }
+      EventMemoryPool::Deallocate (blocks[i], sizes[i]);
+    }
+  NS_TEST_EXPECT_MSG_EQ (EventMemoryPool::GetStats ().live, live, "Unexpected number of live objects");
+
+  // a freed block is reused for an object of the same size class
+  void *p = EventMemoryPool::Allocate (40);
+  EventMemoryPool::Deallocate (p, 40);
+  uint64_t hits = EventMemoryPool::GetStats ().freeListHits;
+  void *q = EventMemoryPool::Allocate (33);
+  NS_TEST_EXPECT_MSG_EQ (q, p, "The freed block has not been reused");
+  NS_TEST_EXPECT_MSG_EQ (EventMemoryPool::GetStats ().freeListHits, hits + 1, "Free list not used");
+  EventMemoryPool::Deallocate (q, 33);
+
+  // large objects come from the heap
+  uint64_t heap = EventMemoryPool::GetStats ().heapAllocations;
+  p = EventMemoryPool::Allocate (EventMemoryPool::MAX_SIZE + 1);
+  NS_TEST_EXPECT_MSG_EQ (EventMemoryPool::GetStats ().heapAllocations, heap + 1, "Large object not allocated from the heap");
+  NS_TEST_EXPECT_MSG_EQ (EventMemoryPool::GetStats ().live, live, "Large objects are not pooled");
+  EventMemoryPool::Deallocate (p, EventMemoryPool::MAX_SIZE + 1);
+
+  EventMemoryPool::Stats stats = EventMemoryPool::GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.allocations, stats.deallocations, "Unbalanced allocations");
+}
+
+/**
+ * \ingroup core-tests
+ * Check that a chain of scheduled events recycles the memory of the
+ * expired events and that the pool survives Simulator::Destroy.
+ */
+class EventMemoryPoolSimulatorTestCase : public TestCase
+{
+public:
+  EventMemoryPoolSimulatorTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Schedule the next event of the chain.
+   * \param remaining the number of events still to schedule
+   * \param payload an argument bound to the event
+   */
+  void Step (uint32_t remaining, double payload);
+
+  uint32_t m_count; //!< number of events run
+};
+
+EventMemoryPoolSimulatorTestCase::EventMemoryPoolSimulatorTestCase ()
+  : TestCase ("Check that scheduled events are allocated from the event memory pool"),
+    m_count (0)
+{}
+
+void
+EventMemoryPoolSimulatorTestCase::Step (uint32_t remaining, double payload)
+{
+  m_count++;
+  if (remaining > 0)
+    {
+      Simulator::Schedule (MicroSeconds (1), &EventMemoryPoolSimulatorTestCase::Step, this,
+                           remaining - 1, payload);
+    }
+}
+
+void
+EventMemoryPoolSimulatorTestCase::DoRun (void)
+{
+  const uint32_t nEvents = 1000;
+  for (uint32_t run = 0; run < 2; run++)
+    {
+      m_count = 0;
+      Simulator::Schedule (MicroSeconds (1), &EventMemoryPoolSimulatorTestCase::Step, this,
+                           nEvents - 1, 1.0);
+      EventMemoryPool::ResetStats ();
+      Simulator::Run ();
+      EventMemoryPool::Stats stats = EventMemoryPool::GetStats ();
+      NS_TEST_EXPECT_MSG_EQ (m_count, nEvents, "Unexpected number of events run");
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (stats.allocations, nEvents - 1, "Events not allocated from the pool");
+      // each event is scheduled while the previous one is running, then
+      // the latter is freed, hence all but the first allocations are
+      // served from the free list
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (stats.freeListHits, nEvents - 2, "Freed events not recycled");
+      Simulator::Destroy ();
+    }
+}
+
+
+/**
+ * \ingroup core-tests
+ * Check that the blocks freed by another thread than their allocator go
+ * back to the pool of the allocator, which then does not grow when one
+ * thread keeps freeing the events of another.
+ */
+class EventMemoryPoolThreadsTestCase : public TestCase
+{
+public:
+  EventMemoryPoolThreadsTestCase ();
+  virtual void DoRun (void);
+};
+
+EventMemoryPoolThreadsTestCase::EventMemoryPoolThreadsTestCase ()
+  : TestCase ("Check that blocks freed by another thread return to their pool")
+{}
+
+void
+EventMemoryPoolThreadsTestCase::DoRun (void)
+{
+  const uint32_t nRounds = 100;
+  const uint32_t nBlocks = 100;
+  EventMemoryPool::Stats owner;
+  EventMemoryPool::Stats other;
+  std::thread allocator ([&] ()
+    {
+      for (uint32_t round = 0; round < nRounds; round++)
+        {
+          std::vector<void *> blocks;
+          for (uint32_t i = 0; i < nBlocks; i++)
+            {
+              blocks.push_back (EventMemoryPool::Allocate (40));
+            }
+          std::thread deallocator ([&] ()
+            {
+              for (void *p : blocks)
+                {
+                  EventMemoryPool::Deallocate (p, 40);
+                }
+              other = EventMemoryPool::GetStats ();
+            });
+          deallocator.join ();
+        }
+      EventMemoryPool::Release ();
+      owner = EventMemoryPool::GetStats ();
+    });
+  allocator.join ();
+
+  NS_TEST_EXPECT_MSG_EQ (other.deallocations, 0, "Blocks must not migrate to the pool of the deallocator");
+  NS_TEST_EXPECT_MSG_EQ (other.slabs, 0, "The deallocator must not reserve slabs");
+  NS_TEST_EXPECT_MSG_EQ (owner.allocations, nRounds * nBlocks, "Unexpected number of allocations");
+  NS_TEST_EXPECT_MSG_EQ (owner.deallocations, nRounds * nBlocks, "The blocks must return to their pool");
+  NS_TEST_EXPECT_MSG_EQ (owner.freeListHits, (nRounds - 1) * nBlocks, "The returned blocks must be reused");
+  NS_TEST_EXPECT_MSG_EQ (owner.live, 0, "Unexpected number of live objects");
+  NS_TEST_EXPECT_MSG_EQ (owner.slabs, 0, "The slabs must be released once all the blocks are back");
+}
+
+
+/**
+ * \ingroup core-tests
+ * EventMemoryPool test suite.
+ */
+class EventMemoryPoolTestSuite : public TestSuite
+{
+public:
+  EventMemoryPoolTestSuite ()
+    : TestSuite ("event-memory-pool")
+  {
+    AddTestCase (new EventMemoryPoolBlocksTestCase ());
+    AddTestCase (new EventMemoryPoolSimulatorTestCase ());
+    AddTestCase (new EventMemoryPoolThreadsTestCase ());
+  }
+};
+
+/**
+ * \ingroup core-tests
+ * EventMemoryPoolTestSuite instance variable.
+ */
+static EventMemoryPoolTestSuite g_eventMemoryPoolTestSuite;
+
+
+}    // namespace tests
+
+}  // namespace ns3
@@ -15,6 +15,8 @@ cpp_examples = [
     ("main-random-variable", "True", "False"),
     ("sample-random-variable", "True", "True"),
     ("test-string-value-formatting", "True", "True"),
+    ("simulation-checkpoint-example", "True", "False"),
+    ("simulation-checkpoint-example --maxBranches=0 --stopBranch=1", "True", "False"),
 ]
 
 # A list of Python examples to run in order to ensure that they remain
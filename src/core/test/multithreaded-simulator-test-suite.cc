@@ -0,0 +1,338 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/test.h"
+
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator-tests
+ * MultithreadedSimulatorImpl test suite.
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+
+/**
+ * \ingroup simulator-tests
+ * Exchange events between contexts spread over several partitions, and
+ * check that the events run are those of a sequential simulation.
+ *
+ * The events of a context only touch the state of that context and
+ * derive what they schedule from their own arguments, so that the set
+ * of events run does not depend on the order of the events scheduled
+ * at the same time.
+ */
+class MultithreadedSimulatorTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param threads the number of threads
+   */
+  MultithreadedSimulatorTestCase (uint32_t threads);
+  virtual void DoRun (void);
+
+private:
+  /** An event run: timestamp, context and value. */
+  typedef std::tuple<int64_t, uint32_t, uint32_t> Record;
+
+  /** The state of a context. */
+  struct Context
+  {
+    std::vector<Record> log;  //!< the events run
+    uint32_t misplaced;       //!< number of events run in the wrong partition
+  };
+
+  /**
+   * Run the scenario.
+   * \param impl the simulator implementation
+   * \param stop the stop time, or zero to run until there are no events
+   * \param fromEvent whether the stop is requested by an event at the stop time
+   * \return the events run by each context
+   */
+  std::vector<std::vector<Record> > RunScenario (Ptr<SimulatorImpl> impl, Time stop, bool fromEvent = false);
+  /**
+   * Receive a value from another context.
+   * \param value the value
+   * \param hops the number of hops left
+   */
+  void Receive (uint32_t value, uint32_t hops);
+  /**
+   * A local event.
+   * \param value the value
+   */
+  void Local (uint32_t value);
+  /**
+   * Record an event in the log of its context.
+   * \param value the value
+   */
+  void Log (uint32_t value);
+
+  uint32_t m_threads;              //!< the number of threads
+  std::vector<Context> m_contexts; //!< the state of each context
+  Ptr<MultithreadedSimulatorImpl> m_impl; //!< the multithreaded simulator, if used
+
+  static const uint32_t N_CONTEXTS = 16;    //!< the number of contexts
+  static const uint32_t HOPS = 40;          //!< the number of hops of each chain
+};
+
+MultithreadedSimulatorTestCase::MultithreadedSimulatorTestCase (uint32_t threads)
+  : TestCase ("Check the events run with " + std::to_string (threads) + " threads"),
+    m_threads (threads)
+{}
+
+void
+MultithreadedSimulatorTestCase::Log (uint32_t value)
+{
+  uint32_t context = Simulator::GetContext ();
+  Context &c = m_contexts[context];
+  c.log.push_back (std::make_tuple (Simulator::Now ().GetTimeStep (), context, value));
+  if (m_impl != 0 && m_impl->GetCurrentPartition () != m_impl->GetPartition (context))
+    {
+      c.misplaced++;
+    }
+}
+
+void
+MultithreadedSimulatorTestCase::Local (uint32_t value)
+{
+  Log (value);
+}
+
+void
+MultithreadedSimulatorTestCase::Receive (uint32_t value, uint32_t hops)
+{
+  Log (value);
+  if (hops == 0)
+    {
+      return;
+    }
+  uint32_t x = value * 1103515245 + 12345;
+  Simulator::Schedule (NanoSeconds (x % 100), &MultithreadedSimulatorTestCase::Local, this, x);
+  EventId id = Simulator::Schedule (NanoSeconds (x % 700), &MultithreadedSimulatorTestCase::Local, this, ~x);
+  if (x & 0x10000)
+    {
+      Simulator::Cancel (id);
+    }
+  else if (x & 0x20000)
+    {
+      Simulator::Remove (id);
+    }
+  uint32_t next = (x >> 8) % N_CONTEXTS;
+  Simulator::ScheduleWithContext (next, MicroSeconds (1) + NanoSeconds (x % 500),
+                                  &MultithreadedSimulatorTestCase::Receive, this, x, hops - 1);
+}
+
+std::vector<std::vector<MultithreadedSimulatorTestCase::Record> >
+MultithreadedSimulatorTestCase::RunScenario (Ptr<SimulatorImpl> impl, Time stop, bool fromEvent)
+{
+  m_contexts.assign (N_CONTEXTS, Context ());
+  m_impl = DynamicCast<MultithreadedSimulatorImpl> (impl);
+  Simulator::SetImplementation (impl);
+  for (uint32_t i = 0; i < N_CONTEXTS; i++)
+    {
+      Simulator::ScheduleWithContext (i, NanoSeconds (i * 10),
+                                      &MultithreadedSimulatorTestCase::Receive, this, i, HOPS);
+    }
+  if (m_impl != 0)
+    {
+      // move the contexts after their first event was scheduled
+      for (uint32_t i = 0; i < N_CONTEXTS; i += 3)
+        {
+          m_impl->SetPartition (i, (i / 3) % m_impl->GetNPartitions ());
+        }
+    }
+  if (fromEvent)
+    {
+      Simulator::Schedule (stop, static_cast<void (*) (void)> (&Simulator::Stop));
+    }
+  else if (!stop.IsZero ())
+    {
+      Simulator::Stop (stop);
+    }
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::IsFinished (), true, "the simulation is not over");
+  if (fromEvent)
+    {
+      // up to the end of the window of the stop event
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (Simulator::Now (), stop, "stopped too early");
+      NS_TEST_EXPECT_MSG_LT_OR_EQ (Simulator::Now (), stop + MicroSeconds (1), "stopped too late");
+    }
+  else if (!stop.IsZero ())
+    {
+      NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), stop, "wrong stop time");
+    }
+  if (m_impl != 0)
+    {
+      NS_TEST_EXPECT_MSG_GT (m_impl->GetNWindows (), 0, "no window run");
+    }
+  Simulator::Destroy ();
+  m_impl = 0;
+
+  std::vector<std::vector<Record> > logs;
+  for (Context &c : m_contexts)
+    {
+      NS_TEST_EXPECT_MSG_EQ (c.misplaced, 0, "events run in the wrong partition");
+      logs.push_back (c.log);
+    }
+  return logs;
+}
+
+void
+MultithreadedSimulatorTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (MultithreadedSimulatorImpl::GetTypeId ());
+  factory.Set ("ThreadCount", UintegerValue (m_threads));
+  factory.Set ("Lookahead", TimeValue (MicroSeconds (1)));
+
+  for (Time stop : {Time (0), MicroSeconds (15)})
+    {
+      std::vector<std::vector<Record> > expected = RunScenario (CreateObject<DefaultSimulatorImpl> (), stop);
+      std::vector<std::vector<Record> > first = RunScenario (factory.Create<SimulatorImpl> (), stop);
+      std::vector<std::vector<Record> > second = RunScenario (factory.Create<SimulatorImpl> (), stop);
+      for (uint32_t i = 0; i < N_CONTEXTS; i++)
+        {
+          // same events run, in the same order from one run to the next
+          NS_TEST_ASSERT_MSG_EQ ((first[i] == second[i]), true, "context " << i << " is not deterministic");
+          NS_TEST_ASSERT_MSG_GT (first[i].size (), 0, "no event in context " << i);
+          std::sort (expected[i].begin (), expected[i].end ());
+          std::sort (first[i].begin (), first[i].end ());
+          NS_TEST_ASSERT_MSG_EQ ((first[i] == expected[i]), true, "wrong events in context " << i);
+          if (!stop.IsZero ())
+            {
+              NS_TEST_ASSERT_MSG_LT (std::get<0> (first[i].back ()), stop.GetTimeStep (), "event after stop");
+            }
+        }
+    }
+
+  // a stop requested by an event in the middle of a window takes effect
+  // at the end of the window, whatever the progress of the other threads
+  Time stop = MicroSeconds (7) + NanoSeconds (300);
+  std::vector<std::vector<Record> > first = RunScenario (factory.Create<SimulatorImpl> (), stop, true);
+  std::vector<std::vector<Record> > second = RunScenario (factory.Create<SimulatorImpl> (), stop, true);
+  for (uint32_t i = 0; i < N_CONTEXTS; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((first[i] == second[i]), true, "context " << i << " is not deterministic after a stop");
+    }
+}
+
+
+/**
+ * \ingroup simulator-tests
+ * Move a context with pending events to another partition, and check that
+ * an event scheduled afterwards at the same time runs after them and is
+ * not reported expired.
+ */
+class MultithreadedSimulatorRepartitionTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorRepartitionTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Record an event.
+   * \param name the name of the event
+   */
+  void Record (char name);
+  /** Record the first event, and schedule another one at the same time. */
+  void First (void);
+
+  std::string m_order;     //!< the names of the events run
+  bool m_expired;          //!< whether the event scheduled by First was reported expired
+};
+
+MultithreadedSimulatorRepartitionTestCase::MultithreadedSimulatorRepartitionTestCase ()
+  : TestCase ("Check the events scheduled after a context moved to another partition"),
+    m_expired (false)
+{}
+
+void
+MultithreadedSimulatorRepartitionTestCase::Record (char name)
+{
+  m_order.push_back (name);
+}
+
+void
+MultithreadedSimulatorRepartitionTestCase::First (void)
+{
+  Record ('A');
+  EventId id = Simulator::ScheduleNow (&MultithreadedSimulatorRepartitionTestCase::Record, this, 'C');
+  m_expired = Simulator::IsExpired (id);
+}
+
+void
+MultithreadedSimulatorRepartitionTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (MultithreadedSimulatorImpl::GetTypeId ());
+  factory.Set ("ThreadCount", UintegerValue (2));
+  factory.Set ("Lookahead", TimeValue (MicroSeconds (1)));
+  Ptr<MultithreadedSimulatorImpl> impl = factory.Create<MultithreadedSimulatorImpl> ();
+  Simulator::SetImplementation (impl);
+
+  // context 1 starts in partition 1, so that its events get uids larger
+  // than the next uid of partition 0
+  Simulator::ScheduleWithContext (1, MicroSeconds (1), &MultithreadedSimulatorRepartitionTestCase::First, this);
+  Simulator::ScheduleWithContext (1, MicroSeconds (1), &MultithreadedSimulatorRepartitionTestCase::Record, this, 'B');
+  impl->SetPartition (1, 0);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_expired, false, "new event reported expired");
+  NS_TEST_EXPECT_MSG_EQ (m_order, "ABC", "same time events out of order");
+}
+
+
+/**
+ * \ingroup simulator-tests
+ * MultithreadedSimulatorImpl test suite.
+ */
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ()
+    : TestSuite ("multithreaded-simulator")
+  {
+    AddTestCase (new MultithreadedSimulatorTestCase (1));
+    AddTestCase (new MultithreadedSimulatorTestCase (2));
+    AddTestCase (new MultithreadedSimulatorTestCase (4));
+    AddTestCase (new MultithreadedSimulatorRepartitionTestCase ());
+  }
+};
+
+/**
+ * \ingroup simulator-tests
+ * MultithreadedSimulatorTestSuite instance variable.
+ */
+static MultithreadedSimulatorTestSuite g_multithreadedSimulatorTestSuite;
+
+
+}    // namespace tests
+
+}  // namespace ns3
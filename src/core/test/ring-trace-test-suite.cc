@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/ring-trace.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <sstream>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * RingTrace test suite.
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+/// Trace point written by the test
+NS_RING_TRACE_DEFINE (g_ringTraceTestPoint, "RingTraceTest::Point", "index,delta,value");
+/// Trace point never enabled
+NS_RING_TRACE_DEFINE (g_ringTraceTestDisabled, "RingTraceTest::Disabled", "index");
+
+/**
+ * \ingroup core-tests
+ * Check the records of the ring trace: arguments, overwriting of the
+ * oldest records and disabled trace points.
+ */
+class RingTraceTestCase : public TestCase
+{
+public:
+  RingTraceTestCase ();
+  virtual void DoRun (void);
+  /**
+   * Write the trace points.
+   * \param [in] index The index of the record.
+   */
+  void Write (uint32_t index);
+
+  uint32_t m_evaluated;  //!< the number of arguments of the disabled point evaluated
+};
+
+RingTraceTestCase::RingTraceTestCase ()
+  : TestCase ("Check the records of the ring trace"),
+    m_evaluated (0)
+{}
+
+void
+RingTraceTestCase::Write (uint32_t index)
+{
+  NS_RING_TRACE (g_ringTraceTestPoint, index, -static_cast<int32_t> (index), index * 0.5);
+  NS_RING_TRACE (g_ringTraceTestDisabled, ++m_evaluated);
+}
+
+void
+RingTraceTestCase::DoRun (void)
+{
+  uint32_t capacity = RingTrace::GetCapacity ();
+  RingTrace::SetCapacity (3);
+  NS_TEST_EXPECT_MSG_EQ (RingTrace::GetCapacity (), 4, "Capacity not rounded up to a power of two");
+  RingTrace::Enable ("RingTraceTest::P*");
+  NS_TEST_EXPECT_MSG_EQ (g_ringTraceTestPoint.IsEnabled (), true, "Trace point not enabled");
+  NS_TEST_EXPECT_MSG_EQ (g_ringTraceTestDisabled.IsEnabled (), false, "Trace point enabled");
+
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (i), &RingTraceTestCase::Write, this, i);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  std::string filename = CreateTempDirFilename ("ring-trace.bin");
+  RingTrace::Dump (filename);
+  RingTrace::Disable ("*");
+  RingTrace::SetCapacity (capacity);
+  NS_TEST_EXPECT_MSG_EQ (m_evaluated, 0, "Arguments of a disabled trace point evaluated");
+
+  // the last 4 records only
+  RingTraceReader reader (filename);
+  RingTraceRecord record;
+  for (uint32_t i = 2; i < 6; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (reader.Read (record), true, "Missing record " << i);
+      NS_TEST_EXPECT_MSG_EQ (reader.GetPointName (record.point), "RingTraceTest::Point", "Unexpected trace point");
+      NS_TEST_EXPECT_MSG_EQ (record.ts, MicroSeconds (i).GetTimeStep (), "Unexpected time");
+      NS_TEST_EXPECT_MSG_EQ (record.context, i, "Unexpected context");
+      NS_TEST_ASSERT_MSG_EQ (+record.nArgs, 3, "Unexpected number of arguments");
+      NS_TEST_EXPECT_MSG_EQ (record.GetType (0), RingTraceRecord::UINT, "Unexpected argument type");
+      NS_TEST_EXPECT_MSG_EQ (record.GetUint (0), i, "Unexpected argument");
+      NS_TEST_EXPECT_MSG_EQ (record.GetType (1), RingTraceRecord::INT, "Unexpected argument type");
+      NS_TEST_EXPECT_MSG_EQ (record.GetInt (1), -static_cast<int64_t> (i), "Unexpected argument");
+      NS_TEST_EXPECT_MSG_EQ (record.GetType (2), RingTraceRecord::DOUBLE, "Unexpected argument type");
+      NS_TEST_EXPECT_MSG_EQ (record.GetDouble (2), i * 0.5, "Unexpected argument");
+      if (i == 5)
+        {
+          std::ostringstream oss;
+          reader.Print (oss, record);
+          NS_TEST_EXPECT_MSG_EQ (oss.str (), "+5e-06s 5 RingTraceTest::Point (index=5, delta=-5, value=2.5)",
+                                 "Unexpected text");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (reader.Read (record), false, "Unexpected record");
+}
+
+/**
+ * \ingroup core-tests
+ * RingTrace test suite.
+ */
+class RingTraceTestSuite : public TestSuite
+{
+public:
+  RingTraceTestSuite ()
+    : TestSuite ("ring-trace")
+  {
+    AddTestCase (new RingTraceTestCase ());
+  }
+};
+
+/**
+ * \ingroup core-tests
+ * RingTraceTestSuite instance variable.
+ */
+static RingTraceTestSuite g_ringTraceTestSuite;
+
+}    // namespace tests
+
+}  // namespace ns3
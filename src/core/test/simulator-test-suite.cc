@@ -24,6 +24,21 @@
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
+#include "ns3/lazy-cancel-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/event-impl.h"
+#include "ns3/make-event.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/config.h"
+#include "ns3/event-trace.h"
+#include "ns3/event-profiler.h"
+
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -531,6 +546,343 @@ SimulatorTemplateTestCase::DoRun (void)
 }
 
 
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check that the LazyCancelScheduler discards the cancelled events
+ * and rebuilds its heap when they dominate.
+ */
+class LazyCancelSchedulerTestCase : public TestCase
+{
+public:
+  LazyCancelSchedulerTestCase ();
+  virtual void DoRun (void);
+  /** Count the events run. */
+  void Count (void);
+
+  uint32_t m_count; //!< number of events run
+};
+
+LazyCancelSchedulerTestCase::LazyCancelSchedulerTestCase ()
+  : TestCase ("Check that the LazyCancelScheduler compacts cancelled events"),
+    m_count (0)
+{}
+
+void
+LazyCancelSchedulerTestCase::Count (void)
+{
+  m_count++;
+}
+
+void
+LazyCancelSchedulerTestCase::DoRun (void)
+{
+  // drive the scheduler directly
+  Ptr<LazyCancelScheduler> scheduler = CreateObject<LazyCancelScheduler> ();
+  scheduler->SetAttribute ("MinCompactionSize", UintegerValue (16));
+  const uint32_t nEvents = 100;
+  std::vector<Scheduler::Event> events;
+  for (uint32_t i = 0; i < nEvents; i++)
+    {
+      Scheduler::Event ev;
+      ev.impl = MakeEvent (&LazyCancelSchedulerTestCase::Count, this);
+      ev.key.m_ts = nEvents - i;
+      ev.key.m_uid = i + 1;
+      ev.key.m_context = 0;
+      scheduler->Insert (ev);
+      events.push_back (ev);
+    }
+  // keep one event out of four alive
+  for (uint32_t i = 0; i < nEvents; i++)
+    {
+      if (i % 4 != 0)
+        {
+          events[i].impl->Cancel ();
+          NS_TEST_EXPECT_MSG_EQ (scheduler->Cancel (events[i]), true, "Cancelled event not taken over");
+        }
+    }
+  LazyCancelScheduler::Stats stats = scheduler->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.live, nEvents / 4, "Unexpected number of live events");
+  NS_TEST_EXPECT_MSG_GT (stats.compactions, 0, "The heap has never been rebuilt");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (stats.dead, stats.live, "Tombstones dominate the heap");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (scheduler->GetDeadRatio (), 0.5, "Tombstones dominate the heap");
+
+  uint64_t lastTs = 0;
+  uint32_t nLive = 0;
+  while (!scheduler->IsEmpty ())
+    {
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      NS_TEST_EXPECT_MSG_EQ (ev.impl->IsCancelled (), false, "Cancelled event returned");
+      NS_TEST_EXPECT_MSG_GT (ev.key.m_ts, lastTs, "Events out of order");
+      NS_TEST_EXPECT_MSG_EQ ((nEvents - ev.key.m_ts) % 4, 0, "Unexpected event");
+      lastTs = ev.key.m_ts;
+      ev.impl->Unref ();
+      nLive++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (nLive, nEvents / 4, "Unexpected number of live events");
+  stats = scheduler->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.dead, 0, "Tombstones left in an empty heap");
+  NS_TEST_EXPECT_MSG_EQ (stats.discarded, nEvents - nEvents / 4, "Tombstones not discarded");
+  scheduler->Dispose ();
+
+  // and through the simulator
+  ObjectFactory factory;
+  factory.SetTypeId (LazyCancelScheduler::GetTypeId ());
+  factory.Set ("MinCompactionSize", UintegerValue (16));
+  Simulator::SetScheduler (factory);
+  std::vector<EventId> ids;
+  for (uint32_t i = 0; i < nEvents; i++)
+    {
+      ids.push_back (Simulator::Schedule (MicroSeconds (i), &LazyCancelSchedulerTestCase::Count, this));
+    }
+  for (uint32_t i = 0; i < nEvents; i++)
+    {
+      if (i % 4 != 0)
+        {
+          ids[i].Cancel ();
+        }
+    }
+  // removing a cancelled event is a no-op
+  Simulator::Remove (ids[1]);
+  m_count = 0;
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_count, nEvents / 4, "Unexpected number of events run");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventCount (), nEvents / 4, "Cancelled events have been run");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check the order of the events returned by a scheduler against a
+ * reference, with a skewed timestamp distribution.
+ */
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param schedulerFactory Scheduler factory.
+   */
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  /** Event never run. */
+  void Dummy (void);
+
+  ObjectFactory m_schedulerFactory; //!< Scheduler factory.
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the order of the events returned by " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{}
+
+void
+SchedulerOrderTestCase::Dummy (void)
+{}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  std::set<Scheduler::Event> reference;
+  uint64_t now = 0;
+  uint32_t uid = 0;
+  for (uint32_t i = 0; i < 20000; i++)
+    {
+      double choice = rng->GetValue ();
+      if (choice < 0.55 || reference.empty ())
+        {
+          // mostly events within a slot time, some much later
+          Scheduler::Event ev;
+          ev.impl = MakeEvent (&SchedulerOrderTestCase::Dummy, this);
+          double delay = rng->GetValue ();
+          ev.key.m_ts = now + (delay < 0.8 ? rng->GetInteger (0, 9) : rng->GetInteger (0, 1000000));
+          ev.key.m_uid = ++uid;
+          ev.key.m_context = 0;
+          scheduler->Insert (ev);
+          reference.insert (ev);
+        }
+      else if (choice < 0.9)
+        {
+          NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), false, "Events lost");
+          Scheduler::Event ev = scheduler->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, reference.begin ()->key.m_uid, "Events out of order");
+          reference.erase (reference.begin ());
+          now = ev.key.m_ts;
+          ev.impl->Unref ();
+        }
+      else
+        {
+          auto it = reference.begin ();
+          std::advance (it, rng->GetInteger (0, reference.size () - 1));
+          Scheduler::Event ev = *it;
+          reference.erase (it);
+          scheduler->Remove (ev);
+          ev.impl->Unref ();
+        }
+    }
+  while (!reference.empty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (scheduler->PeekNext ().key.m_uid, reference.begin ()->key.m_uid, "Events out of order");
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      reference.erase (reference.begin ());
+      ev.impl->Unref ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (scheduler->IsEmpty (), true, "Events left in the scheduler");
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check the trace of the operations on the event list recorded by
+ * the DefaultSimulatorImpl.
+ */
+class EventTraceTestCase : public TestCase
+{
+public:
+  EventTraceTestCase ();
+  virtual void DoRun (void);
+  /** Event doing nothing. */
+  void Dummy (void);
+};
+
+EventTraceTestCase::EventTraceTestCase ()
+  : TestCase ("Check the event trace recorded by the DefaultSimulatorImpl")
+{}
+
+void
+EventTraceTestCase::Dummy (void)
+{}
+
+void
+EventTraceTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("event-trace.bin");
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventTraceFile", StringValue (filename));
+  EventId a = Simulator::Schedule (MicroSeconds (10), &EventTraceTestCase::Dummy, this);
+  EventId b = Simulator::Schedule (MicroSeconds (20), &EventTraceTestCase::Dummy, this);
+  EventId c = Simulator::Schedule (MicroSeconds (30), &EventTraceTestCase::Dummy, this);
+  Simulator::Remove (b);
+  c.Cancel ();
+  Simulator::Run ();
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventTraceFile", StringValue (""));
+
+  // the cancelled event is left in the default scheduler and is run
+  std::vector<std::pair<EventTraceRecord::Op, uint32_t> > expected = {
+    {EventTraceRecord::INSERT, a.GetUid ()},
+    {EventTraceRecord::INSERT, b.GetUid ()},
+    {EventTraceRecord::INSERT, c.GetUid ()},
+    {EventTraceRecord::REMOVE, b.GetUid ()},
+    {EventTraceRecord::CANCEL, c.GetUid ()},
+    {EventTraceRecord::RUN, a.GetUid ()},
+    {EventTraceRecord::RUN, c.GetUid ()}
+  };
+  EventTraceReader reader (filename);
+  EventTraceRecord record;
+  for (const auto &op : expected)
+    {
+      NS_TEST_ASSERT_MSG_EQ (reader.Read (record), true, "Missing record");
+      NS_TEST_EXPECT_MSG_EQ (record.op, op.first, "Unexpected operation");
+      NS_TEST_EXPECT_MSG_EQ (record.uid, op.second, "Unexpected event");
+    }
+  NS_TEST_EXPECT_MSG_EQ (reader.Read (record), false, "Unexpected record");
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check the profile of the event handlers written by the
+ * DefaultSimulatorImpl.
+ */
+class EventProfileTestCase : public TestCase
+{
+public:
+  EventProfileTestCase ();
+  virtual void DoRun (void);
+  /** Event doing nothing. */
+  void Dummy (void);
+  /** Another event doing nothing, with the same signature. */
+  void OtherDummy (void);
+  /**
+   * Event doing nothing, with a different signature.
+   * \param [in] value Unused.
+   */
+  void DummyWithArgument (uint32_t value);
+};
+
+EventProfileTestCase::EventProfileTestCase ()
+  : TestCase ("Check the profile of the event handlers")
+{}
+
+void
+EventProfileTestCase::Dummy (void)
+{}
+
+void
+EventProfileTestCase::OtherDummy (void)
+{}
+
+void
+EventProfileTestCase::DummyWithArgument (uint32_t value)
+{}
+
+void
+EventProfileTestCase::DoRun (void)
+{
+  EventProfiler profiler;
+  profiler.Record (typeid (int), EventImpl::HandlerId (), 1, 10);
+  profiler.Record (typeid (int), EventImpl::HandlerId (), 2, 30);
+  profiler.Record (typeid (double), EventImpl::HandlerId (), 1, 20);
+  std::vector<EventProfiler::Entry> entries = profiler.GetEntries (false);
+  NS_TEST_ASSERT_MSG_EQ (entries.size (), 2, "Unexpected number of handlers");
+  NS_TEST_EXPECT_MSG_EQ (entries[0].handler, "int", "Handlers not sorted by time");
+  NS_TEST_EXPECT_MSG_EQ (entries[0].count, 2, "Unexpected count");
+  NS_TEST_EXPECT_MSG_EQ (entries[0].nanoseconds, 40, "Unexpected time");
+  NS_TEST_EXPECT_MSG_EQ (entries[0].context, Simulator::NO_CONTEXT, "Unexpected context");
+  entries = profiler.GetEntries (true);
+  NS_TEST_ASSERT_MSG_EQ (entries.size (), 3, "Unexpected number of handlers and contexts");
+  NS_TEST_EXPECT_MSG_EQ (entries[0].context, 2, "Handlers not sorted by time");
+  NS_TEST_EXPECT_MSG_EQ (entries[1].handler, "double", "Handlers not sorted by time");
+
+  std::string filename = CreateTempDirFilename ("event-profile.folded");
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventProfileFoldedFile", StringValue (filename));
+  Simulator::Schedule (MicroSeconds (10), &EventProfileTestCase::Dummy, this);
+  Simulator::ScheduleWithContext (3, MicroSeconds (20), &EventProfileTestCase::Dummy, this);
+  Simulator::ScheduleWithContext (3, MicroSeconds (30), &EventProfileTestCase::DummyWithArgument, this, 1);
+  Simulator::ScheduleWithContext (3, MicroSeconds (40), &EventProfileTestCase::OtherDummy, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventProfileFoldedFile", StringValue (""));
+
+  // one line per handler and context
+  std::ifstream is (filename);
+  std::string line;
+  std::set<std::string> stacks;
+  while (std::getline (is, line))
+    {
+      std::size_t space = line.rfind (' ');
+      NS_TEST_ASSERT_MSG_NE (space, std::string::npos, "Invalid line " << line);
+      stacks.insert (line.substr (0, space));
+    }
+  NS_TEST_EXPECT_MSG_EQ (stacks.size (), 4, "Unexpected number of stacks");
+  EventImpl *event = MakeEvent (&EventProfileTestCase::Dummy, this);
+  std::string dummy = EventProfiler::GetHandlerName (typeid (*event), event->GetHandlerId ());
+  event->Unref ();
+  // same EventImpl type, different method
+  event = MakeEvent (&EventProfileTestCase::OtherDummy, this);
+  std::string otherDummy = EventProfiler::GetHandlerName (typeid (*event), event->GetHandlerId ());
+  event->Unref ();
+  NS_TEST_EXPECT_MSG_NE (dummy, otherDummy, "Methods with the same signature share a name");
+  NS_TEST_EXPECT_MSG_EQ (stacks.count ("no-context;" + dummy), 1, "Missing stack");
+  NS_TEST_EXPECT_MSG_EQ (stacks.count ("context-3;" + dummy), 1, "Missing stack");
+  NS_TEST_EXPECT_MSG_EQ (stacks.count ("context-3;" + otherDummy), 1, "Missing stack");
+}
+
 /**
  * \ingroup simulator-tests
  *  
@@ -554,6 +906,21 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (PriorityQueueScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LazyCancelScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new LazyCancelSchedulerTestCase (), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new EventTraceTestCase (), TestCase::QUICK);
+    AddTestCase (new EventProfileTestCase (), TestCase::QUICK);
+
+    for (const std::string &schedulerType : std::vector<std::string> {"ns3::CalendarScheduler", "ns3::HeapScheduler",
+                                                                     "ns3::LadderScheduler", "ns3::LazyCancelScheduler",
+                                                                     "ns3::MapScheduler", "ns3::PriorityQueueScheduler"})
+      {
+        factory.SetTypeId (schedulerType);
+        AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+      }
   }
 };
 
@@ -39,6 +39,7 @@
 
 #include <mpi.h>
 #include <cmath>
+#include <set>
 
 namespace ns3 {
 
@@ -172,6 +173,7 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
   else
     {
       NodeContainer c = NodeContainer::GetGlobal ();
+      std::set<uint32_t> channels;
       for (NodeContainer::Iterator iter = c.Begin (); iter != c.End (); ++iter)
         {
           if ((*iter)->GetSystemId () != MpiInterface::GetSystemId ())
@@ -182,30 +184,24 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
           for (uint32_t i = 0; i < (*iter)->GetNDevices (); ++i)
             {
               Ptr<NetDevice> localNetDevice = (*iter)->GetDevice (i);
-              // only works for p2p links currently
-              if (!localNetDevice->IsPointToPoint ())
-                {
-                  continue;
-                }
               Ptr<Channel> channel = localNetDevice->GetChannel ();
-              if (channel == 0)
+              if (channel == 0 || !channels.insert (channel->GetId ()).second)
                 {
                   continue;
                 }
 
-              // grab the adjacent node
-              Ptr<Node> remoteNode;
-              if (channel->GetDevice (0) == localNetDevice)
+              // p2p links provide their delay, and shared channels
+              // spanning several tasks (e.g., YansWifiRemoteChannel) the
+              // smallest delay to the devices of the other tasks
+              std::string attribute = localNetDevice->IsPointToPoint () ? "Delay" : "Lookahead";
+              struct TypeId::AttributeInformation info;
+              if (!channel->GetInstanceTypeId ().LookupAttributeByName (attribute, &info))
                 {
-                  remoteNode = (channel->GetDevice (1))->GetNode ();
-                }
-              else
-                {
-                  remoteNode = (channel->GetDevice (0))->GetNode ();
+                  continue;
                 }
 
-              // if it's not remote, don't consider it
-              if (remoteNode->GetSystemId () == MpiInterface::GetSystemId ())
+              // if no adjacent node is remote, don't consider it
+              if (MpiInterface::GetRemoteSystemIds (channel).empty ())
                 {
                   continue;
                 }
@@ -214,7 +210,7 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
               // m_lookAhead.  if delay on channel is smaller, make
               // it the new lookAhead.
               TimeValue delay;
-              channel->GetAttribute ("Delay", delay);
+              channel->GetAttribute (attribute, delay);
 
               if (delay.Get () < m_lookAhead)
                 {
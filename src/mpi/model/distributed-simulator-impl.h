@@ -161,8 +161,10 @@ private:
   /**
    * Calculate lookahead constraint based on network latency.
    *
-   * The smallest cross-rank PointToPoint channel delay imposes
-   * a constraint on the conservative PDES time window.  The
+   * The smallest cross-rank PointToPoint channel delay, or
+   * Lookahead of the shared channels spanning several ranks (e.g.,
+   * YansWifiRemoteChannel), imposes a constraint on the
+   * conservative PDES time window.  The
    * user may impose additional constraints on lookahead
    * using the ConstrainLookAhead() method.
    */
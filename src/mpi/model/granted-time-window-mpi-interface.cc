@@ -40,6 +40,7 @@
 #include "ns3/simulator-impl.h"
 #include "ns3/nstime.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 
 #include <mpi.h>
 
@@ -215,6 +216,8 @@ GrantedTimeWindowMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, ui
   std::list<SentBuffer>::reverse_iterator i = g_pendingTx.rbegin (); // Points to the last element
 
   uint32_t serializedSize = p->GetSerializedSize ();
+  NS_ABORT_MSG_IF (serializedSize + 16 > MAX_MPI_MSG_SIZE,
+                   "Packet of " << serializedSize << " bytes too large for an MPI message");
   uint8_t* buffer =  new uint8_t[serializedSize + 16];
   i->SetBuffer (buffer);
   // Add the time, dest node and dest device
@@ -286,6 +289,13 @@ GrantedTimeWindowMpiInterface::ReceiveMessages ()
 
       NS_ASSERT (pNode && pMpiRec);
 
+      // a message sent with a delay below the lookahead, e.g., over a
+      // shared channel whose nodes moved closer, arrives too late
+      NS_ABORT_MSG_IF (rxTime < Simulator::Now (),
+                       "Message for node " << node << " received at " << Simulator::Now ()
+                       << ", after its reception time " << rxTime
+                       << ": a delay between ranks is below the lookahead");
+
       // Schedule the rx event
       Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
                                       &MpiReceiver::Receive, pMpiRec, p);
@@ -42,9 +42,10 @@ namespace ns3 {
 
 /**
  * maximum MPI message size for easy
- * buffer creation
+ * buffer creation, large enough for the A-MPDUs
+ * sent by a YansWifiRemoteChannel
  */
-const uint32_t MAX_MPI_MSG_SIZE = 2000;
+const uint32_t MAX_MPI_MSG_SIZE = 131072;
 
 /**
  * \ingroup mpi
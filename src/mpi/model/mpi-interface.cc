@@ -29,6 +29,8 @@
 #include <ns3/global-value.h>
 #include <ns3/string.h>
 #include <ns3/log.h>
+#include <ns3/net-device.h>
+#include <ns3/node.h>
 
 #include "null-message-mpi-interface.h"
 #include "granted-time-window-mpi-interface.h"
@@ -134,6 +136,21 @@ MpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t node, uint
   g_parallelCommunicationInterface->SendPacket (p, rxTime, node, dev);
 }
 
+std::set<uint32_t>
+MpiInterface::GetRemoteSystemIds (Ptr<Channel> channel)
+{
+  std::set<uint32_t> systemIds;
+  for (std::size_t i = 0; i < channel->GetNDevices (); ++i)
+    {
+      uint32_t systemId = channel->GetDevice (i)->GetNode ()->GetSystemId ();
+      if (systemId != GetSystemId ())
+        {
+          systemIds.insert (systemId);
+        }
+    }
+  return systemIds;
+}
+
 MPI_Comm 
 MpiInterface::GetCommunicator()
 {
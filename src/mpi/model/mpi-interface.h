@@ -29,6 +29,9 @@
 
 #include <ns3/nstime.h>
 #include <ns3/packet.h>
+#include <ns3/channel.h>
+
+#include <set>
 
 #include "mpi.h"
 
@@ -143,6 +146,14 @@ public:
    * Serialize and send a packet to the specified node and net device
    */
   static void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+  /**
+   * \brief Get the ranks of the remote nodes attached to a channel.
+   *
+   * \param channel a channel
+   * \return the system ids of the nodes attached to the channel which
+   *         are not local to this rank
+   */
+  static std::set<uint32_t> GetRemoteSystemIds (Ptr<Channel> channel);
 
   /**
    * \brief Return the communicator used to run ns-3.
@@ -38,6 +38,7 @@
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 
 #include <mpi.h>
 
@@ -92,9 +93,10 @@ private:
 
 /**
  * maximum MPI message size for easy
- * buffer creation
+ * buffer creation, large enough for the A-MPDUs
+ * sent by a YansWifiRemoteChannel
  */
-const uint32_t NULL_MESSAGE_MAX_MPI_MSG_SIZE = 2000;
+const uint32_t NULL_MESSAGE_MAX_MPI_MSG_SIZE = 131072;
 
 NullMessageSentBuffer::NullMessageSentBuffer ()
 {
@@ -273,6 +275,8 @@ NullMessageMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t
 
   uint32_t serializedSize = p->GetSerializedSize ();
   uint32_t bufferSize = serializedSize + ( 2 * sizeof (uint64_t) ) + ( 2 * sizeof (uint32_t) );
+  NS_ABORT_MSG_IF (bufferSize > NULL_MESSAGE_MAX_MPI_MSG_SIZE,
+                   "Packet of " << serializedSize << " bytes too large for an MPI message");
   uint8_t* buffer =  new uint8_t[bufferSize];
   iter->SetBuffer (buffer);
   // Add the time, dest node and dest device
@@ -413,6 +417,13 @@ NullMessageMpiInterface::ReceiveMessages (bool blocking)
                 }
               NS_ASSERT (pNode && pMpiRec);
 
+              // a message sent with a delay below the lookahead, e.g., over a
+              // shared channel whose nodes moved closer, arrives too late
+              NS_ABORT_MSG_IF (rxTime < Simulator::Now (),
+                               "Message for node " << node << " received at " << Simulator::Now ()
+                               << ", after its reception time " << rxTime
+                               << ": a delay between ranks is below the lookahead");
+
               // Schedule the rx event
               Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
                                               &MpiReceiver::Receive, pMpiRec, p);
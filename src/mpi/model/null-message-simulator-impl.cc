@@ -44,6 +44,7 @@
 #include <ns3/log.h>
 
 #include <cmath>
+#include <set>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
@@ -142,6 +143,7 @@ NullMessageSimulatorImpl::CalculateLookAhead (void)
   if (MpiInterface::GetSize () > 1)
     {
       NodeContainer c = NodeContainer::GetGlobal ();
+      std::set<uint32_t> channels;
       for (NodeContainer::Iterator iter = c.Begin (); iter != c.End (); ++iter)
         {
           if ((*iter)->GetSystemId () != MpiInterface::GetSystemId ())
@@ -154,46 +156,44 @@ NullMessageSimulatorImpl::CalculateLookAhead (void)
           for (uint32_t i = 0; i < (*iter)->GetNDevices (); ++i)
             {
               Ptr<NetDevice> localNetDevice = (*iter)->GetDevice (i);
-              // only works for p2p links currently
-              if (!localNetDevice->IsPointToPoint ())
-                {
-                  continue;
-                }
               Ptr<Channel> channel = localNetDevice->GetChannel ();
-              if (channel == 0)
+              if (channel == 0 || !channels.insert (channel->GetId ()).second)
                 {
                   continue;
                 }
 
-              // grab the adjacent node
-              Ptr<Node> remoteNode;
-              if (channel->GetDevice (0) == localNetDevice)
-                {
-                  remoteNode = (channel->GetDevice (1))->GetNode ();
-                }
-              else
+              // p2p links provide their delay, and shared channels
+              // spanning several tasks (e.g., YansWifiRemoteChannel) the
+              // smallest delay to the devices of the other tasks
+              std::string attribute = localNetDevice->IsPointToPoint () ? "Delay" : "Lookahead";
+              struct TypeId::AttributeInformation info;
+              if (!channel->GetInstanceTypeId ().LookupAttributeByName (attribute, &info))
                 {
-                  remoteNode = (channel->GetDevice (0))->GetNode ();
+                  continue;
                 }
 
-              // if it's not remote, don't consider it
-              if (remoteNode->GetSystemId () == MpiInterface::GetSystemId ())
+              // if no adjacent node is remote, don't consider it
+              std::set<uint32_t> remoteSystemIds = MpiInterface::GetRemoteSystemIds (channel);
+              if (remoteSystemIds.empty ())
                 {
                   continue;
                 }
 
+              TimeValue delay;
+              channel->GetAttribute (attribute, delay);
+
               /**
-               * Add this channel to the remote channel bundle from this task to MPI task on other side of the channel.
+               * Add this channel to the remote channel bundles from this task to the MPI tasks on the other side of the channel.
                */
-              Ptr<RemoteChannelBundle> remoteChannelBundle = RemoteChannelBundleManager::Find (remoteNode->GetSystemId ());
-              if (!remoteChannelBundle)
+              for (uint32_t remoteSystemId : remoteSystemIds)
                 {
-                  remoteChannelBundle = RemoteChannelBundleManager::Add (remoteNode->GetSystemId ());
+                  Ptr<RemoteChannelBundle> remoteChannelBundle = RemoteChannelBundleManager::Find (remoteSystemId);
+                  if (!remoteChannelBundle)
+                    {
+                      remoteChannelBundle = RemoteChannelBundleManager::Add (remoteSystemId);
+                    }
+                  remoteChannelBundle->AddChannel (channel, delay.Get ());
                 }
-
-              TimeValue delay;
-              channel->GetAttribute ("Delay", delay);
-              remoteChannelBundle->AddChannel (channel, delay.Get () );
             }
         }
     }
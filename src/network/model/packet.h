@@ -20,6 +20,7 @@
 #ifndef PACKET_H
 #define PACKET_H
 
+#include <atomic>
 #include <stdint.h>
 #include "buffer.h"
 #include "header.h"
@@ -791,7 +792,7 @@ private:
   /* Please see comments above about nix-vector */
   mutable Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  static std::atomic<uint32_t> m_globalUid; //!< Global counter of packets Uid
 };
 
 /**
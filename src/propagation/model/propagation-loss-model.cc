@@ -28,6 +28,7 @@
 #include "ns3/double.h"
 #include "ns3/string.h"
 #include "ns3/pointer.h"
+#include <algorithm>
 #include <cmath>
 
 namespace ns3 {
@@ -824,7 +825,9 @@ MatrixPropagationLossModel::GetTypeId (void)
 }
 
 MatrixPropagationLossModel::MatrixPropagationLossModel ()
-  : PropagationLossModel (), m_default (std::numeric_limits<double>::max ())
+  : PropagationLossModel (),
+    m_default (std::numeric_limits<double>::max ()),
+    m_nIndices (0)
 {
 }
 
@@ -843,16 +846,25 @@ MatrixPropagationLossModel::SetLoss (Ptr<MobilityModel> ma, Ptr<MobilityModel> m
 {
   NS_ASSERT (ma != 0 && mb != 0);
 
-  MobilityPair p = std::make_pair (ma, mb);
-  std::map<MobilityPair, double>::iterator i = m_loss.find (p);
-
-  if (i == m_loss.end ())
+  int32_t ia = GetIndex (ma);
+  int32_t ib = GetIndex (mb);
+  if (ia >= 0 && ib >= 0)
     {
-      m_loss.insert (std::make_pair (p, loss));
+      m_lossMatrix[ia * m_nIndices + ib] = loss;
     }
   else
     {
-      i->second = loss;
+      MobilityPair p = std::make_pair (ma, mb);
+      std::map<MobilityPair, double>::iterator i = m_loss.find (p);
+
+      if (i == m_loss.end ())
+        {
+          m_loss.insert (std::make_pair (p, loss));
+        }
+      else
+        {
+          i->second = loss;
+        }
     }
 
   if (symmetric)
@@ -861,23 +873,135 @@ MatrixPropagationLossModel::SetLoss (Ptr<MobilityModel> ma, Ptr<MobilityModel> m
     }
 }
 
-double 
-MatrixPropagationLossModel::DoCalcRxPower (double txPowerDbm,
-                                           Ptr<MobilityModel> a,
-                                           Ptr<MobilityModel> b) const
+uint32_t
+MatrixPropagationLossModel::AssignIndex (Ptr<MobilityModel> m)
+{
+  NS_ASSERT (m != 0);
+
+  int32_t existing = GetIndex (m);
+  if (existing >= 0)
+    {
+      return existing;
+    }
+
+  uint32_t index = m_nIndices;
+  m_index.insert (std::make_pair (PeekPointer (m), index));
+  ResizeLossMatrix (index + 1);
+
+  // move the losses already set between indexed models into the matrix
+  std::map<MobilityPair, double>::iterator i = m_loss.begin ();
+  while (i != m_loss.end ())
+    {
+      int32_t ia = GetIndex (i->first.first);
+      int32_t ib = GetIndex (i->first.second);
+      if (ia >= 0 && ib >= 0)
+        {
+          m_lossMatrix[ia * m_nIndices + ib] = i->second;
+          i = m_loss.erase (i);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+  return index;
+}
+
+int32_t
+MatrixPropagationLossModel::GetIndex (Ptr<MobilityModel> m) const
+{
+  std::unordered_map<const MobilityModel *, uint32_t>::const_iterator i = m_index.find (PeekPointer (m));
+  if (i == m_index.end ())
+    {
+      return -1;
+    }
+  return i->second;
+}
+
+uint32_t
+MatrixPropagationLossModel::GetNIndices (void) const
+{
+  return m_nIndices;
+}
+
+void
+MatrixPropagationLossModel::ResizeLossMatrix (uint32_t n)
+{
+  std::vector<double> matrix (n * n, std::numeric_limits<double>::quiet_NaN ());
+  for (uint32_t i = 0; i < m_nIndices; ++i)
+    {
+      std::copy (m_lossMatrix.begin () + i * m_nIndices,
+                 m_lossMatrix.begin () + (i + 1) * m_nIndices,
+                 matrix.begin () + i * n);
+    }
+  m_lossMatrix.swap (matrix);
+  m_nIndices = n;
+}
+
+template <typename T>
+void
+MatrixPropagationLossModel::DoSetLossMatrix (const T *loss, uint32_t rows, uint32_t cols)
+{
+  NS_ASSERT_MSG (rows <= m_nIndices && cols <= m_nIndices,
+                 "Loss matrix " << rows << "x" << cols << " exceeds the "
+                 << m_nIndices << " indexed mobility models");
+  if (cols == m_nIndices)
+    {
+      std::copy (loss, loss + rows * cols, m_lossMatrix.begin ());
+      return;
+    }
+  for (uint32_t i = 0; i < rows; ++i)
+    {
+      std::copy (loss + i * cols, loss + (i + 1) * cols, m_lossMatrix.begin () + i * m_nIndices);
+    }
+}
+
+void
+MatrixPropagationLossModel::SetLossMatrix (const float *loss, uint32_t rows, uint32_t cols)
+{
+  DoSetLossMatrix (loss, rows, cols);
+}
+
+void
+MatrixPropagationLossModel::SetLossMatrix (const double *loss, uint32_t rows, uint32_t cols)
 {
+  DoSetLossMatrix (loss, rows, cols);
+}
+
+double
+MatrixPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  if (m_nIndices > 0)
+    {
+      int32_t ia = GetIndex (a);
+      int32_t ib = GetIndex (b);
+      if (ia >= 0 && ib >= 0)
+        {
+          double loss = m_lossMatrix[ia * m_nIndices + ib];
+          return std::isnan (loss) ? m_default : loss;
+        }
+    }
+
   std::map<MobilityPair, double>::const_iterator i = m_loss.find (std::make_pair (a, b));
 
   if (i != m_loss.end ())
     {
-      return txPowerDbm - i->second;
+      return i->second;
     }
   else
     {
-      return txPowerDbm - m_default;
+      return m_default;
     }
 }
 
+double 
+MatrixPropagationLossModel::DoCalcRxPower (double txPowerDbm,
+                                           Ptr<MobilityModel> a,
+                                           Ptr<MobilityModel> b) const
+{
+  return txPowerDbm - GetLoss (a, b);
+}
+
 int64_t
 MatrixPropagationLossModel::DoAssignStreams (int64_t stream)
 {
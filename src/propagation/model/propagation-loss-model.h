@@ -28,6 +28,8 @@
 #include "ns3/object.h"
 #include "ns3/random-variable-stream.h"
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3 {
 
@@ -728,6 +730,56 @@ public:
    */
   void SetDefaultLoss (double defaultLoss);
 
+  /**
+   * \brief Assign a compact index to a mobility model and switch its
+   * links to the dense loss matrix.
+   *
+   * Indices are handed out in call order starting from 0. The loss matrix
+   * grows to cover the new index; its new entries are unset and resolve to
+   * the default loss. Losses previously set with SetLoss between two
+   * indexed models are moved into the matrix. Calling this method again on
+   * an already indexed model returns its existing index.
+   *
+   * The index is keyed on the address of the mobility model, which is not
+   * kept alive by this loss model: the mobility model must outlive its use
+   * by this loss model, as another model allocated at the same address
+   * would inherit its index.
+   *
+   * \param m the mobility model
+   * \return the index of the mobility model in the loss matrix
+   */
+  uint32_t AssignIndex (Ptr<MobilityModel> m);
+
+  /**
+   * \param m the mobility model
+   * \return the index assigned to m by AssignIndex, or -1 if m is not indexed
+   */
+  int32_t GetIndex (Ptr<MobilityModel> m) const;
+
+  /**
+   * \return the number of indexed mobility models
+   */
+  uint32_t GetNIndices (void) const;
+
+  /**
+   * \brief Bulk load the losses between indexed mobility models.
+   *
+   * The matrix is row-major: the entry at row i and column j is the loss
+   * (in dB, positive) from the model with index i to the model with index j.
+   * It overwrites the top-left rows x cols block of the loss matrix, so
+   * passing a GetNIndices () x GetNIndices () matrix replaces every indexed
+   * link in one copy.
+   *
+   * \param loss the row-major loss matrix
+   * \param rows the number of rows (transmitters)
+   * \param cols the number of columns (receivers)
+   */
+  void SetLossMatrix (const float *loss, uint32_t rows, uint32_t cols);
+  /**
+   * \copydoc SetLossMatrix(const float*,uint32_t,uint32_t)
+   */
+  void SetLossMatrix (const double *loss, uint32_t rows, uint32_t cols);
+
 private:
   double DoCalcRxPower (double txPowerDbm,
                         Ptr<MobilityModel> a,
@@ -735,12 +787,42 @@ private:
 
   int64_t DoAssignStreams (int64_t stream) override;
 
+  /**
+   * Get the loss between two mobility models
+   * \param a the source mobility model
+   * \param b the destination mobility model
+   * \return the a -> b path loss in dB
+   */
+  double GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+
+  /**
+   * Grow the dense loss matrix to n x n entries, keeping the existing ones
+   * \param n the new number of indexed mobility models
+   */
+  void ResizeLossMatrix (uint32_t n);
+
+  /**
+   * Copy a row-major loss matrix into the top-left block of the dense
+   * loss matrix
+   * \tparam T the type of the entries
+   * \param loss the row-major loss matrix
+   * \param rows the number of rows (transmitters)
+   * \param cols the number of columns (receivers)
+   */
+  template <typename T>
+  void DoSetLossMatrix (const T *loss, uint32_t rows, uint32_t cols);
+
   double m_default; //!< default loss
 
   /// Typedef: Mobility models pair
   typedef std::pair< Ptr<MobilityModel>, Ptr<MobilityModel> > MobilityPair; 
 
   std::map<MobilityPair, double> m_loss; //!< Propagation loss between pair of nodes
+
+  /// compact index of each indexed mobility model, which must outlive this model
+  std::unordered_map<const MobilityModel *, uint32_t> m_index;
+  uint32_t m_nIndices; //!< number of indexed mobility models
+  std::vector<double> m_lossMatrix; //!< row-major loss between indexed mobility models, NaN if unset
 };
 
 /**
@@ -428,6 +428,93 @@ MatrixPropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup propagation-tests
+ *
+ * \brief MatrixPropagationLossModel indexed (dense matrix) mode Test
+ */
+class MatrixPropagationLossModelIndexedTestCase : public TestCase
+{
+public:
+  MatrixPropagationLossModelIndexedTestCase ();
+  virtual ~MatrixPropagationLossModelIndexedTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MatrixPropagationLossModelIndexedTestCase::MatrixPropagationLossModelIndexedTestCase ()
+  : TestCase ("Test MatrixPropagationLossModel indexed mode")
+{
+}
+
+MatrixPropagationLossModelIndexedTestCase::~MatrixPropagationLossModelIndexedTestCase ()
+{
+}
+
+void
+MatrixPropagationLossModelIndexedTestCase::DoRun (void)
+{
+  Ptr<MobilityModel> m[4];
+  for (int i = 0; i < 4; ++i)
+    {
+      m[i] = CreateObject<ConstantPositionMobilityModel> ();
+    }
+
+  MatrixPropagationLossModel loss;
+  loss.SetDefaultLoss (200);
+  // set before indexing, must be moved into the matrix
+  loss.SetLoss (m[0], m[1], 10);
+
+  NS_TEST_ASSERT_MSG_EQ (loss.AssignIndex (m[0]), 0, "Unexpected index for m0");
+  NS_TEST_ASSERT_MSG_EQ (loss.AssignIndex (m[1]), 1, "Unexpected index for m1");
+  NS_TEST_ASSERT_MSG_EQ (loss.AssignIndex (m[2]), 2, "Unexpected index for m2");
+  NS_TEST_ASSERT_MSG_EQ (loss.AssignIndex (m[1]), 1, "Re-indexing m1 must keep its index");
+  NS_TEST_ASSERT_MSG_EQ (loss.GetNIndices (), 3, "Unexpected number of indices");
+  NS_TEST_ASSERT_MSG_EQ (loss.GetIndex (m[3]), -1, "m3 must not be indexed");
+
+  NS_TEST_ASSERT_MSG_EQ (loss.CalcRxPower (0, m[0], m[1]), -10, "Loss 0 -> 1 incorrect");
+  NS_TEST_ASSERT_MSG_EQ (loss.CalcRxPower (0, m[1], m[0]), -10, "Loss 1 -> 0 incorrect");
+  NS_TEST_ASSERT_MSG_EQ (loss.CalcRxPower (0, m[0], m[2]), -200, "Unset loss must be the default");
+
+  // single pair update on indexed models, and fallback for non indexed ones
+  loss.SetLoss (m[1], m[2], 40, /*symmetric = */ false);
+  loss.SetLoss (m[2], m[3], 50);
+  NS_TEST_ASSERT_MSG_EQ (loss.CalcRxPower (0, m[1], m[2]), -40, "Loss 1 -> 2 incorrect");
+  NS_TEST_ASSERT_MSG_EQ (loss.CalcRxPower (0, m[2], m[1]), -200, "Loss 2 -> 1 incorrect");
+  NS_TEST_ASSERT_MSG_EQ (loss.CalcRxPower (0, m[3], m[2]), -50, "Loss 3 -> 2 incorrect");
+
+  // full bulk load
+  const float full[9] = {0, 1, 2,
+                         3, 4, 5,
+                         6, 7, 8};
+  loss.SetLossMatrix (full, 3, 3);
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      for (uint32_t j = 0; j < 3; ++j)
+        {
+          NS_TEST_ASSERT_MSG_EQ (loss.CalcRxPower (0, m[i], m[j]), -full[i * 3 + j],
+                                 "Loss " << i << " -> " << j << " incorrect");
+        }
+    }
+
+  // partial bulk load of the top-left block
+  const double block[2] = {20, 21};
+  loss.SetLossMatrix (block, 1, 2);
+  NS_TEST_ASSERT_MSG_EQ (loss.CalcRxPower (0, m[0], m[0]), -20, "Loss 0 -> 0 incorrect");
+  NS_TEST_ASSERT_MSG_EQ (loss.CalcRxPower (0, m[0], m[1]), -21, "Loss 0 -> 1 incorrect");
+  NS_TEST_ASSERT_MSG_EQ (loss.CalcRxPower (0, m[0], m[2]), -2, "Loss 0 -> 2 must be untouched");
+  NS_TEST_ASSERT_MSG_EQ (loss.CalcRxPower (0, m[1], m[0]), -3, "Loss 1 -> 0 must be untouched");
+
+  // growing the matrix keeps the existing entries
+  loss.AssignIndex (m[3]);
+  NS_TEST_ASSERT_MSG_EQ (loss.CalcRxPower (0, m[2], m[1]), -7, "Loss 2 -> 1 incorrect after growth");
+  NS_TEST_ASSERT_MSG_EQ (loss.CalcRxPower (0, m[2], m[3]), -50, "Loss 2 -> 3 incorrect after growth");
+  NS_TEST_ASSERT_MSG_EQ (loss.CalcRxPower (0, m[3], m[0]), -200, "Loss 3 -> 0 must be the default");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup propagation-tests
  *
@@ -498,6 +585,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new TwoRayGroundPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new MatrixPropagationLossModelIndexedTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
 }
 
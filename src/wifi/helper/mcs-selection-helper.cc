@@ -0,0 +1,255 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mcs-selection-helper.h"
+#include "ns3/error-rate-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/wifi-utils.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("McsSelectionHelper");
+
+/// Lowest SNR considered by the bisection, in dB
+static const double MCS_SELECTION_MIN_SNR_DB = -20;
+/// Highest SNR considered by the bisection, in dB
+static const double MCS_SELECTION_MAX_SNR_DB = 80;
+/// Number of bisection steps, giving a tolerance of about 1e-4 dB
+static const uint32_t MCS_SELECTION_STEPS = 20;
+
+McsSelectionHelper::McsSelectionHelper ()
+  : m_nbits (0),
+    m_txPowerDbm (0),
+    m_noiseFigureDb (7),
+    m_targetSuccessRate (1 - 1e-5),
+    m_hasFallbackMode (false),
+    m_prepared (false),
+    m_fallbackDataRate (0),
+    m_noiseW (0)
+{
+}
+
+void
+McsSelectionHelper::SetErrorRateModel (Ptr<ErrorRateModel> model)
+{
+  m_errorRateModel = model;
+  m_prepared = false;
+}
+
+void
+McsSelectionHelper::SetModes (const std::vector<WifiMode> &modes)
+{
+  m_modes = modes;
+  m_prepared = false;
+}
+
+void
+McsSelectionHelper::SetTxVector (const WifiTxVector &txVector)
+{
+  m_txVector = txVector;
+  m_prepared = false;
+}
+
+void
+McsSelectionHelper::SetPacketSize (uint32_t size)
+{
+  m_nbits = static_cast<uint64_t> (size) * 8;
+  m_prepared = false;
+}
+
+void
+McsSelectionHelper::SetTxPower (double txPowerDbm)
+{
+  m_txPowerDbm = txPowerDbm;
+}
+
+void
+McsSelectionHelper::SetNoiseFigure (double noiseFigureDb)
+{
+  m_noiseFigureDb = noiseFigureDb;
+  m_prepared = false;
+}
+
+void
+McsSelectionHelper::SetTargetSuccessRate (double successRate)
+{
+  m_targetSuccessRate = successRate;
+  m_prepared = false;
+}
+
+void
+McsSelectionHelper::SetFallbackMode (WifiMode mode)
+{
+  m_fallbackMode = mode;
+  m_hasFallbackMode = true;
+  m_prepared = false;
+}
+
+double
+McsSelectionHelper::GetSuccessRate (std::size_t index, double snr) const
+{
+  WifiTxVector txVector = m_txVector;
+  txVector.SetMode (m_modes[index]);
+  return m_errorRateModel->GetChunkSuccessRate (m_modes[index], txVector, snr, m_nbits);
+}
+
+void
+McsSelectionHelper::Prepare (void)
+{
+  if (m_prepared)
+    {
+      return;
+    }
+  NS_ASSERT_MSG (m_errorRateModel != 0, "No error rate model set");
+  NS_ASSERT_MSG (!m_modes.empty (), "No candidate mode set");
+
+  // same thermal noise as in InterferenceHelper
+  m_noiseW = DbToRatio (m_noiseFigureDb) * BOLTZMANN * 290 * m_txVector.GetChannelWidth () * 1e6;
+
+  m_dataRates.clear ();
+  m_thresholds.clear ();
+  for (std::size_t i = 0; i < m_modes.size (); i++)
+    {
+      WifiTxVector txVector = m_txVector;
+      txVector.SetMode (m_modes[i]);
+      m_dataRates.push_back (m_modes[i].GetDataRate (txVector));
+
+      double low = MCS_SELECTION_MIN_SNR_DB;
+      double high = MCS_SELECTION_MAX_SNR_DB;
+      Threshold threshold;
+      if (GetSuccessRate (i, DbToRatio (high)) < m_targetSuccessRate)
+        {
+          // never meets the target
+          threshold.below = std::numeric_limits<double>::infinity ();
+          threshold.above = std::numeric_limits<double>::infinity ();
+        }
+      else if (GetSuccessRate (i, DbToRatio (low)) >= m_targetSuccessRate)
+        {
+          threshold.below = 0;
+          threshold.above = DbToRatio (low);
+        }
+      else
+        {
+          for (uint32_t step = 0; step < MCS_SELECTION_STEPS; step++)
+            {
+              double mid = (low + high) / 2;
+              if (GetSuccessRate (i, DbToRatio (mid)) >= m_targetSuccessRate)
+                {
+                  high = mid;
+                }
+              else
+                {
+                  low = mid;
+                }
+            }
+          threshold.below = DbToRatio (low);
+          threshold.above = DbToRatio (high);
+        }
+      NS_LOG_DEBUG (m_modes[i] << ": target met above " << RatioToDb (threshold.above) << " dB");
+      m_thresholds.push_back (threshold);
+    }
+
+  m_order.resize (m_modes.size ());
+  for (std::size_t i = 0; i < m_order.size (); i++)
+    {
+      m_order[i] = i;
+    }
+  std::stable_sort (m_order.begin (), m_order.end (),
+                    [this] (std::size_t a, std::size_t b) { return m_dataRates[a] > m_dataRates[b]; });
+  if (!m_hasFallbackMode)
+    {
+      m_fallbackMode = m_modes[m_order.back ()];
+    }
+  WifiTxVector txVector = m_txVector;
+  txVector.SetMode (m_fallbackMode);
+  m_fallbackDataRate = m_fallbackMode.GetDataRate (txVector);
+  m_prepared = true;
+}
+
+bool
+McsSelectionHelper::MeetsTarget (std::size_t index, double snr) const
+{
+  const Threshold &threshold = m_thresholds[index];
+  if (snr >= threshold.above)
+    {
+      return true;
+    }
+  if (snr <= threshold.below)
+    {
+      return false;
+    }
+  return GetSuccessRate (index, snr) >= m_targetSuccessRate;
+}
+
+std::vector<McsSelectionHelper::Selection>
+McsSelectionHelper::Select (const std::vector<double> &gainsDb, uint32_t nSta, uint32_t nAp)
+{
+  NS_LOG_FUNCTION (this << nSta << nAp);
+  NS_ASSERT_MSG (gainsDb.size () == static_cast<std::size_t> (nSta) * nAp, "Wrong size of the gain matrix");
+  NS_ASSERT (nAp > 0);
+  Prepare ();
+
+  std::vector<Selection> selections (nSta);
+  for (uint32_t sta = 0; sta < nSta; sta++)
+    {
+      const double *gains = gainsDb.data () + static_cast<std::size_t> (sta) * nAp;
+      uint32_t ap = std::max_element (gains, gains + nAp) - gains;
+      double snr = DbmToW (m_txPowerDbm + gains[ap]) / m_noiseW;
+
+      selections[sta] = {ap, gains[ap], snr, m_fallbackMode, m_fallbackDataRate};
+      // candidates sorted by decreasing data rate
+      for (std::size_t index : m_order)
+        {
+          if (MeetsTarget (index, snr))
+            {
+              selections[sta].mode = m_modes[index];
+              selections[sta].dataRate = m_dataRates[index];
+              break;
+            }
+        }
+    }
+  return selections;
+}
+
+std::vector<McsSelectionHelper::Selection>
+McsSelectionHelper::Select (Ptr<PropagationLossModel> model,
+                            const NodeContainer &staNodes, const NodeContainer &apNodes)
+{
+  NS_LOG_FUNCTION (this << model);
+  std::vector<Ptr<MobilityModel> > aps;
+  for (uint32_t i = 0; i < apNodes.GetN (); i++)
+    {
+      aps.push_back (apNodes.Get (i)->GetObject<MobilityModel> ());
+    }
+  std::vector<double> gainsDb;
+  gainsDb.reserve (static_cast<std::size_t> (staNodes.GetN ()) * aps.size ());
+  for (uint32_t i = 0; i < staNodes.GetN (); i++)
+    {
+      Ptr<MobilityModel> sta = staNodes.Get (i)->GetObject<MobilityModel> ();
+      for (const auto &ap : aps)
+        {
+          gainsDb.push_back (model->CalcRxPower (0, sta, ap));
+        }
+    }
+  return Select (gainsDb, staNodes.GetN (), apNodes.GetN ());
+}
+
+} //namespace ns3
@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MCS_SELECTION_HELPER_H
+#define MCS_SELECTION_HELPER_H
+
+#include "ns3/wifi-mode.h"
+#include "ns3/wifi-tx-vector.h"
+#include "ns3/node-container.h"
+#include <vector>
+
+namespace ns3 {
+
+class ErrorRateModel;
+class PropagationLossModel;
+
+/**
+ * \brief select the access point and the transmission mode of many stations
+ * from their channel gains.
+ *
+ * Given the channel gains between every station and every access point,
+ * this helper attaches each station to the access point with the highest
+ * gain and selects the highest data rate mode whose chunk success rate, for
+ * packets of the configured size, reaches a target.
+ *
+ * The success rate of each candidate mode only depends on the SNR, so the
+ * helper computes once, by bisection, the SNR above which each mode meets
+ * the target, and a selection then boils down to comparing the SNR of each
+ * station against these thresholds. The error rate model is only queried
+ * again for the SNRs falling within the bisection tolerance of a threshold,
+ * which gives the same result as evaluating every mode for every station,
+ * provided that the success rate increases with the SNR. Selecting again
+ * after the channel gains changed, e.g., when an agent updates a loss
+ * matrix during an episode, is thus cheap.
+ *
+ * \code
+ *     McsSelectionHelper mcs;
+ *     mcs.SetErrorRateModel (CreateObject<PpvErrorRateModel> ());
+ *     mcs.SetModes (modes);
+ *     mcs.SetTxVector (txVector);
+ *     mcs.SetPacketSize (packetSize);
+ *     for (const auto& selection : mcs.Select (lossModel, staNodes, apNodes))
+ *       {
+ *         // use selection.ap and selection.mode
+ *       }
+ * \endcode
+ */
+class McsSelectionHelper
+{
+public:
+  /// The selection for a station
+  struct Selection
+  {
+    uint32_t ap;       //!< index of the access point with the highest gain
+    double gainDb;     //!< channel gain from the station to this access point, in dB
+    double snr;        //!< SNR at the access point, in linear scale
+    WifiMode mode;     //!< the selected mode
+    uint64_t dataRate; //!< data rate of the selected mode, in bps
+  };
+
+  McsSelectionHelper ();
+
+  /**
+   * \param model the error rate model giving the chunk success rates
+   */
+  void SetErrorRateModel (Ptr<ErrorRateModel> model);
+  /**
+   * \param modes the candidate modes
+   */
+  void SetModes (const std::vector<WifiMode> &modes);
+  /**
+   * Set the TXVECTOR of the transmissions, whose channel width also gives
+   * the thermal noise. The mode is replaced by each candidate mode.
+   *
+   * \param txVector the TXVECTOR
+   */
+  void SetTxVector (const WifiTxVector &txVector);
+  /**
+   * \param size the size of the packets, in bytes, including all headers
+   */
+  void SetPacketSize (uint32_t size);
+  /**
+   * \param txPowerDbm the transmit power of the stations, in dBm
+   */
+  void SetTxPower (double txPowerDbm);
+  /**
+   * \param noiseFigureDb the noise figure of the receivers, in dB
+   */
+  void SetNoiseFigure (double noiseFigureDb);
+  /**
+   * \param successRate the minimum chunk success rate of a selected mode
+   */
+  void SetTargetSuccessRate (double successRate);
+  /**
+   * Set the mode selected for the stations for which no candidate mode meets
+   * the target success rate. By default, the candidate mode with the lowest
+   * data rate is selected.
+   *
+   * \param mode the fallback mode, which need not be a candidate mode
+   */
+  void SetFallbackMode (WifiMode mode);
+
+  /**
+   * Select the access point and the mode of each station. If no mode meets
+   * the target success rate, the fallback mode is selected. Among access
+   * points with the same gain, the first one is selected.
+   *
+   * \param gainsDb the channel gains from the stations to the access points
+   *        in dB, nSta rows of nAp values
+   * \param nSta the number of stations
+   * \param nAp the number of access points
+   * \return the selection for each station
+   */
+  std::vector<Selection> Select (const std::vector<double> &gainsDb, uint32_t nSta, uint32_t nAp);
+  /**
+   * Select the access point and the mode of each station, with the channel
+   * gains given by a propagation loss model between the mobility models of
+   * the nodes, from each station to each access point.
+   *
+   * \param model the propagation loss model
+   * \param staNodes the stations
+   * \param apNodes the access points
+   * \return the selection for each station
+   */
+  std::vector<Selection> Select (Ptr<PropagationLossModel> model,
+                                 const NodeContainer &staNodes, const NodeContainer &apNodes);
+
+private:
+  /// SNR range, in linear scale, within which a mode meets the target
+  struct Threshold
+  {
+    double below; //!< the target is not met at or below this SNR
+    double above; //!< the target is met at or above this SNR
+  };
+
+  /**
+   * \param index the index of a candidate mode
+   * \param snr the SNR in linear scale
+   * \return the chunk success rate
+   */
+  double GetSuccessRate (std::size_t index, double snr) const;
+  /// Sort the candidate modes and compute their thresholds, if needed
+  void Prepare (void);
+  /**
+   * \param index the index of a candidate mode
+   * \param snr the SNR in linear scale
+   * \return whether the mode meets the target at this SNR
+   */
+  bool MeetsTarget (std::size_t index, double snr) const;
+
+  Ptr<ErrorRateModel> m_errorRateModel;    //!< error rate model
+  std::vector<WifiMode> m_modes;           //!< candidate modes
+  WifiTxVector m_txVector;                 //!< TXVECTOR of the transmissions
+  uint64_t m_nbits;                        //!< size of the packets in bits
+  double m_txPowerDbm;                     //!< transmit power
+  double m_noiseFigureDb;                  //!< noise figure of the receivers
+  double m_targetSuccessRate;              //!< target chunk success rate
+  bool m_hasFallbackMode;                  //!< whether a fallback mode is set
+  WifiMode m_fallbackMode;                 //!< mode selected if no candidate meets the target
+
+  bool m_prepared;                         //!< whether the members below are up to date
+  std::vector<std::size_t> m_order;        //!< candidate modes by decreasing data rate
+  std::vector<uint64_t> m_dataRates;       //!< data rate of each candidate mode
+  std::vector<Threshold> m_thresholds;     //!< threshold of each candidate mode
+  uint64_t m_fallbackDataRate;             //!< data rate of the fallback mode
+  double m_noiseW;                         //!< noise power
+};
+
+} //namespace ns3
+
+#endif /* MCS_SELECTION_HELPER_H */
@@ -0,0 +1,396 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "wifi-binary-trace-helper.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-psdu.h"
+#include "ns3/wifi-utils.h"
+#include "ns3/ap-wifi-mac.h"
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WifiBinaryTraceHelper");
+
+namespace {
+
+/// The magic string at the start of the trace files
+const char MAGIC[8] = {'N', 'S', '3', 'W', 'I', 'F', 'I', '1'};
+
+} // unnamed namespace
+
+static_assert (sizeof (WifiTraceRecord) == 56, "Unexpected WifiTraceRecord size");
+
+NS_OBJECT_ENSURE_REGISTERED (WifiBinaryTraceSink);
+
+TypeId
+WifiBinaryTraceSink::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::WifiBinaryTraceSink")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<WifiBinaryTraceSink> ()
+    .AddAttribute ("BufferSize",
+                   "The number of records buffered before writing them to the file.",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&WifiBinaryTraceSink::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+WifiBinaryTraceSink::WifiBinaryTraceSink ()
+  : m_bufferSize (4096)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+WifiBinaryTraceSink::~WifiBinaryTraceSink ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+WifiBinaryTraceSink::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  Object::DoDispose ();
+}
+
+void
+WifiBinaryTraceSink::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+  m_os.open (filename.c_str (), std::ios::out | std::ios::binary);
+  NS_ABORT_MSG_UNLESS (m_os.is_open (), "Cannot create the wifi trace file " << filename);
+  m_os.write (MAGIC, sizeof (MAGIC));
+  m_buffer.reserve (m_bufferSize);
+}
+
+void
+WifiBinaryTraceSink::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_os.is_open ())
+    {
+      Flush ();
+      m_os.close ();
+    }
+  m_buffer.clear ();
+}
+
+void
+WifiBinaryTraceSink::Flush (void)
+{
+  NS_LOG_FUNCTION (this << m_buffer.size ());
+  if (m_os.is_open ())
+    {
+      m_os.write (reinterpret_cast<const char *> (m_buffer.data ()),
+                  m_buffer.size () * sizeof (WifiTraceRecord));
+      m_os.flush ();
+    }
+  m_buffer.clear ();
+}
+
+uint32_t
+WifiBinaryTraceSink::AddDevice (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  for (uint32_t i = 0; i < m_devices.size (); i++)
+    {
+      if (m_devices[i].nodeId == device->GetNode ()->GetId ()
+          && m_devices[i].ifIndex == device->GetIfIndex ())
+        {
+          return i;
+        }
+    }
+  m_devices.push_back ({device->GetNode ()->GetId (), device->GetIfIndex ()});
+  return m_devices.size () - 1;
+}
+
+uint64_t
+WifiBinaryTraceSink::ConvertAddress (Mac48Address address)
+{
+  uint8_t buffer[6];
+  address.CopyTo (buffer);
+  uint64_t value = 0;
+  for (uint8_t byte : buffer)
+    {
+      value = (value << 8) | byte;
+    }
+  return value;
+}
+
+WifiTraceRecord
+WifiBinaryTraceSink::MakeRecord (uint32_t device, WifiTraceRecord::Type type) const
+{
+  WifiTraceRecord record;
+  std::memset (&record, 0, sizeof (record));
+  record.ts = Simulator::Now ().GetTimeStep ();
+  record.nodeId = m_devices[device].nodeId;
+  record.deviceId = m_devices[device].ifIndex;
+  record.type = type;
+  return record;
+}
+
+void
+WifiBinaryTraceSink::WritePsdus (WifiTraceRecord &record, const WifiConstPsduMap &psdus)
+{
+  for (const auto &psdu : psdus)
+    {
+      for (const auto &mpdu : *PeekPointer (psdu.second))
+        {
+          const WifiMacHeader &hdr = mpdu->GetHeader ();
+          record.uid = mpdu->GetPacket ()->GetUid ();
+          record.src = ConvertAddress (hdr.GetAddr2 ());
+          record.dst = ConvertAddress (hdr.GetAddr1 ());
+          record.size = mpdu->GetSize ();
+          record.seq = hdr.GetSequenceNumber ();
+          record.frameType = static_cast<uint8_t> (hdr.GetType ());
+          Write (record);
+        }
+    }
+}
+
+void
+WifiBinaryTraceSink::WritePacket (WifiTraceRecord &record, Ptr<const Packet> packet)
+{
+  record.uid = packet->GetUid ();
+  record.size = packet->GetSize ();
+  // LLC/SNAP header (8 bytes) followed by the first 20 bytes of an IPv4
+  // header: read them in place rather than deserializing a copy
+  uint8_t buffer[28];
+  if (packet->CopyData (buffer, sizeof (buffer)) == sizeof (buffer)
+      && buffer[0] == 0xaa && buffer[1] == 0xaa && buffer[2] == 0x03
+      && buffer[6] == 0x08 && buffer[7] == 0x00
+      && (buffer[8] >> 4) == 4)
+    {
+      record.src = Ipv4Address::Deserialize (buffer + 20).Get ();
+      record.dst = Ipv4Address::Deserialize (buffer + 24).Get ();
+    }
+  Write (record);
+}
+
+void
+WifiBinaryTraceSink::PhyTxPsduBegin (uint32_t device, WifiConstPsduMap psdus,
+                                     WifiTxVector txVector, double txPowerW)
+{
+  WifiTraceRecord record = MakeRecord (device, WifiTraceRecord::PHY_TX_BEGIN);
+  record.txPowerDbm = WToDbm (txPowerW);
+  WritePsdus (record, psdus);
+}
+
+void
+WifiBinaryTraceSink::PhyTxPsduEnd (uint32_t device, WifiConstPsduMap psdus)
+{
+  WifiTraceRecord record = MakeRecord (device, WifiTraceRecord::PHY_TX_END);
+  WritePsdus (record, psdus);
+}
+
+void
+WifiBinaryTraceSink::MacRx (uint32_t device, Ptr<const Packet> packet)
+{
+  WifiTraceRecord record = MakeRecord (device, WifiTraceRecord::MAC_RX);
+  WritePacket (record, packet);
+}
+
+void
+WifiBinaryTraceSink::MacRxDrop (uint32_t device, Ptr<const Packet> packet)
+{
+  WifiTraceRecord record = MakeRecord (device, WifiTraceRecord::MAC_RX_DROP);
+  WritePacket (record, packet);
+}
+
+void
+WifiBinaryTraceSink::Association (uint32_t device, uint16_t aid, Mac48Address address)
+{
+  WifiTraceRecord record = MakeRecord (device, WifiTraceRecord::ASSOCIATION);
+  record.src = ConvertAddress (address);
+  record.seq = aid;
+  Write (record);
+}
+
+void
+WifiBinaryTraceSink::Deassociation (uint32_t device, uint16_t aid, Mac48Address address)
+{
+  WifiTraceRecord record = MakeRecord (device, WifiTraceRecord::DEASSOCIATION);
+  record.src = ConvertAddress (address);
+  record.seq = aid;
+  Write (record);
+}
+
+
+WifiBinaryTraceHelper::WifiBinaryTraceHelper ()
+  : m_sink (CreateObject<WifiBinaryTraceSink> ())
+{
+}
+
+void
+WifiBinaryTraceHelper::Open (std::string filename)
+{
+  m_sink->Open (filename);
+  Simulator::ScheduleDestroy (&WifiBinaryTraceSink::Close, m_sink);
+}
+
+void
+WifiBinaryTraceHelper::Close (void)
+{
+  m_sink->Close ();
+}
+
+void
+WifiBinaryTraceHelper::EnablePhyTx (NetDeviceContainer devices)
+{
+  for (auto it = devices.Begin (); it != devices.End (); ++it)
+    {
+      Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (*it);
+      NS_ABORT_MSG_UNLESS (device, "Not a wifi device");
+      uint32_t index = m_sink->AddDevice (device);
+      Ptr<WifiPhy> phy = device->GetPhy ();
+      phy->TraceConnectWithoutContext ("PhyTxPsduBegin",
+                                       MakeCallback (&WifiBinaryTraceSink::PhyTxPsduBegin, m_sink).Bind (index));
+      phy->TraceConnectWithoutContext ("PhyTxPsduEnd",
+                                       MakeCallback (&WifiBinaryTraceSink::PhyTxPsduEnd, m_sink).Bind (index));
+    }
+}
+
+void
+WifiBinaryTraceHelper::EnableMacRx (NetDeviceContainer devices)
+{
+  for (auto it = devices.Begin (); it != devices.End (); ++it)
+    {
+      Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (*it);
+      NS_ABORT_MSG_UNLESS (device, "Not a wifi device");
+      uint32_t index = m_sink->AddDevice (device);
+      Ptr<WifiMac> mac = device->GetMac ();
+      mac->TraceConnectWithoutContext ("MacRx",
+                                       MakeCallback (&WifiBinaryTraceSink::MacRx, m_sink).Bind (index));
+      mac->TraceConnectWithoutContext ("MacRxDrop",
+                                       MakeCallback (&WifiBinaryTraceSink::MacRxDrop, m_sink).Bind (index));
+    }
+}
+
+void
+WifiBinaryTraceHelper::EnableAssociation (NetDeviceContainer devices)
+{
+  for (auto it = devices.Begin (); it != devices.End (); ++it)
+    {
+      Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (*it);
+      NS_ABORT_MSG_UNLESS (device, "Not a wifi device");
+      Ptr<ApWifiMac> mac = DynamicCast<ApWifiMac> (device->GetMac ());
+      NS_ABORT_MSG_UNLESS (mac, "Not an access point");
+      uint32_t index = m_sink->AddDevice (device);
+      mac->TraceConnectWithoutContext ("AssociatedSta",
+                                       MakeCallback (&WifiBinaryTraceSink::Association, m_sink).Bind (index));
+      mac->TraceConnectWithoutContext ("DeAssociatedSta",
+                                       MakeCallback (&WifiBinaryTraceSink::Deassociation, m_sink).Bind (index));
+    }
+}
+
+Ptr<WifiBinaryTraceSink>
+WifiBinaryTraceHelper::GetSink (void) const
+{
+  return m_sink;
+}
+
+
+WifiBinaryTraceReader::WifiBinaryTraceReader (std::string filename)
+{
+  m_is.open (filename.c_str (), std::ios::in | std::ios::binary);
+  NS_ABORT_MSG_UNLESS (m_is.is_open (), "Cannot open the wifi trace file " << filename);
+  char magic[sizeof (MAGIC)];
+  NS_ABORT_MSG_UNLESS (m_is.read (magic, sizeof (magic))
+                       && std::memcmp (magic, MAGIC, sizeof (magic)) == 0,
+                       filename << " is not a wifi trace file");
+}
+
+bool
+WifiBinaryTraceReader::Read (WifiTraceRecord &record)
+{
+  return static_cast<bool> (m_is.read (reinterpret_cast<char *> (&record), sizeof (record)));
+}
+
+Mac48Address
+WifiBinaryTraceReader::GetMacAddress (uint64_t address)
+{
+  uint8_t buffer[6];
+  for (int i = 5; i >= 0; i--)
+    {
+      buffer[i] = address & 0xff;
+      address >>= 8;
+    }
+  Mac48Address mac;
+  mac.CopyFrom (buffer);
+  return mac;
+}
+
+Ipv4Address
+WifiBinaryTraceReader::GetIpv4Address (uint64_t address)
+{
+  return Ipv4Address (static_cast<uint32_t> (address));
+}
+
+void
+WifiBinaryTraceReader::Print (std::ostream &os, const WifiTraceRecord &record)
+{
+  os << TimeStep (record.ts).As (Time::US) << " " << record.nodeId << "/" << record.deviceId << " ";
+  switch (record.type)
+    {
+    case WifiTraceRecord::PHY_TX_BEGIN:
+    case WifiTraceRecord::PHY_TX_END:
+      os << (record.type == WifiTraceRecord::PHY_TX_BEGIN ? "PhyTxBegin" : "PhyTxEnd")
+         << " uid=" << record.uid
+         << " src=" << GetMacAddress (record.src)
+         << " dst=" << GetMacAddress (record.dst)
+         << " size=" << record.size
+         << " seq=" << record.seq
+         << " type=" << +record.frameType;
+      if (record.type == WifiTraceRecord::PHY_TX_BEGIN)
+        {
+          os << " power=" << record.txPowerDbm << "dBm";
+        }
+      break;
+    case WifiTraceRecord::MAC_RX:
+    case WifiTraceRecord::MAC_RX_DROP:
+      os << (record.type == WifiTraceRecord::MAC_RX ? "MacRx" : "MacRxDrop")
+         << " uid=" << record.uid
+         << " src=" << GetIpv4Address (record.src)
+         << " dst=" << GetIpv4Address (record.dst)
+         << " size=" << record.size;
+      break;
+    case WifiTraceRecord::ASSOCIATION:
+    case WifiTraceRecord::DEASSOCIATION:
+      os << (record.type == WifiTraceRecord::ASSOCIATION ? "Association" : "Deassociation")
+         << " aid=" << record.seq
+         << " sta=" << GetMacAddress (record.src);
+      break;
+    default:
+      os << "Unknown type " << +record.type;
+      break;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,347 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WIFI_BINARY_TRACE_HELPER_H
+#define WIFI_BINARY_TRACE_HELPER_H
+
+#include "ns3/object.h"
+#include "ns3/net-device-container.h"
+#include "ns3/mac48-address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/wifi-ppdu.h"
+#include "ns3/wifi-tx-vector.h"
+#include <fstream>
+#include <vector>
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \brief a record of the binary wifi trace.
+ *
+ * The records have a fixed size of 56 bytes and are written in host byte
+ * order. The meaning of the address and number fields depends on the
+ * type of the record:
+ *
+ * - PHY_TX_BEGIN and PHY_TX_END: one record per MPDU; src and dst are the
+ *   transmitter (Addr2) and receiver (Addr1) MAC addresses, size is the
+ *   size of the MPDU, seq its sequence number and frameType its
+ *   WifiMacType. txPowerDbm is only set at the beginning of a
+ *   transmission.
+ * - MAC_RX and MAC_RX_DROP: src and dst are the IPv4 source and
+ *   destination addresses when the packet carries an LLC/SNAP
+ *   encapsulated IPv4 datagram, zero otherwise; size is the size of the
+ *   MSDU.
+ * - ASSOCIATION and DEASSOCIATION: src is the MAC address of the station
+ *   and seq its association ID.
+ *
+ * The MAC addresses are stored in the 48 low order bits, most significant
+ * byte first, and the IPv4 addresses in the 32 low order bits.
+ */
+struct WifiTraceRecord
+{
+  /// The type of a record
+  enum Type : uint8_t
+  {
+    PHY_TX_BEGIN = 0,
+    PHY_TX_END,
+    MAC_RX,
+    MAC_RX_DROP,
+    ASSOCIATION,
+    DEASSOCIATION
+  };
+
+  int64_t ts;          //!< the simulation time, in time steps
+  uint64_t uid;        //!< the uid of the packet
+  uint64_t src;        //!< the source address
+  uint64_t dst;        //!< the destination address
+  double txPowerDbm;   //!< the transmit power, in dBm
+  uint32_t nodeId;     //!< the id of the node
+  uint32_t deviceId;   //!< the index of the device in the node
+  uint32_t size;       //!< the size of the packet, in bytes
+  uint16_t seq;        //!< the sequence number, or the association ID
+  uint8_t type;        //!< the type of the record
+  uint8_t frameType;   //!< the WifiMacType of the MPDU
+};
+
+/**
+ * \brief write the binary wifi trace records to a file.
+ *
+ * The records are buffered in memory and written in blocks of BufferSize
+ * records, when the trace is closed and when the simulator is destroyed.
+ * The file starts with the 8 byte magic string "NS3WIFI1" followed by the
+ * records.
+ *
+ * The trace sinks read the fields of the records from the MAC headers
+ * and the packets without copying them, so that tracing every frame of a
+ * large scenario costs much less than formatting text logs.
+ */
+class WifiBinaryTraceSink : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  WifiBinaryTraceSink ();
+  virtual ~WifiBinaryTraceSink ();
+
+  /**
+   * Create the trace file. Aborts if the file cannot be created.
+   *
+   * \param filename the name of the file
+   */
+  void Open (std::string filename);
+  /**
+   * Write the buffered records and close the file.
+   */
+  void Close (void);
+  /**
+   * Write the buffered records to the file.
+   */
+  void Flush (void);
+  /**
+   * \param record the record to write, with all the fields set
+   */
+  void Write (const WifiTraceRecord &record)
+  {
+    m_buffer.push_back (record);
+    if (m_buffer.size () >= m_bufferSize)
+      {
+        Flush ();
+      }
+  }
+
+  /**
+   * Register a device, to pass its index to the trace sinks below.
+   *
+   * \param device the device
+   * \return the index of the device
+   */
+  uint32_t AddDevice (Ptr<NetDevice> device);
+
+  /**
+   * Trace sink for the PhyTxPsduBegin trace source.
+   *
+   * \param device the index of the device
+   * \param psdus the PSDUs being transmitted
+   * \param txVector the TXVECTOR
+   * \param txPowerW the transmit power in Watts
+   */
+  void PhyTxPsduBegin (uint32_t device, WifiConstPsduMap psdus, WifiTxVector txVector, double txPowerW);
+  /**
+   * Trace sink for the PhyTxPsduEnd trace source.
+   *
+   * \param device the index of the device
+   * \param psdus the PSDUs transmitted
+   */
+  void PhyTxPsduEnd (uint32_t device, WifiConstPsduMap psdus);
+  /**
+   * Trace sink for the MacRx trace source.
+   *
+   * \param device the index of the device
+   * \param packet the packet received
+   */
+  void MacRx (uint32_t device, Ptr<const Packet> packet);
+  /**
+   * Trace sink for the MacRxDrop trace source.
+   *
+   * \param device the index of the device
+   * \param packet the packet dropped
+   */
+  void MacRxDrop (uint32_t device, Ptr<const Packet> packet);
+  /**
+   * Trace sink for the AssociatedSta trace source.
+   *
+   * \param device the index of the device
+   * \param aid the association ID of the station
+   * \param address the address of the station
+   */
+  void Association (uint32_t device, uint16_t aid, Mac48Address address);
+  /**
+   * Trace sink for the DeAssociatedSta trace source.
+   *
+   * \param device the index of the device
+   * \param aid the association ID of the station
+   * \param address the address of the station
+   */
+  void Deassociation (uint32_t device, uint16_t aid, Mac48Address address);
+
+  /**
+   * \param address a MAC address
+   * \return the address, as stored in the records
+   */
+  static uint64_t ConvertAddress (Mac48Address address);
+
+private:
+  void DoDispose (void) override;
+
+  /**
+   * \param device the index of the device
+   * \param type the type of the record
+   * \return a record with the time, node, device and type set
+   *         and the other fields cleared
+   */
+  WifiTraceRecord MakeRecord (uint32_t device, WifiTraceRecord::Type type) const;
+  /**
+   * Write one record per MPDU of the PSDUs.
+   *
+   * \param record the record, with the fields common to the MPDUs set
+   * \param psdus the PSDUs
+   */
+  void WritePsdus (WifiTraceRecord &record, const WifiConstPsduMap &psdus);
+  /**
+   * Write a MAC reception record.
+   *
+   * \param record the record, with the fields common to the packets set
+   * \param packet the packet
+   */
+  void WritePacket (WifiTraceRecord &record, Ptr<const Packet> packet);
+
+  /// The node ID and interface index of a device
+  struct Device
+  {
+    uint32_t nodeId;    //!< the node ID
+    uint32_t ifIndex;   //!< the interface index
+  };
+
+  std::ofstream m_os;                     //!< the trace file
+  std::vector<WifiTraceRecord> m_buffer;  //!< the records not written yet
+  uint32_t m_bufferSize;                  //!< the number of records written at once
+  std::vector<Device> m_devices;          //!< the devices, by index
+};
+
+/**
+ * \brief trace the transmissions, receptions and associations of wifi
+ * devices into a binary file.
+ *
+ * This helper replaces trace sinks that print packet contents as text:
+ * the records are written by a WifiBinaryTraceSink and read back with a
+ * WifiBinaryTraceReader.
+ *
+ * \code
+ *     WifiBinaryTraceHelper trace;
+ *     trace.Open ("wifi-trace.bin");
+ *     trace.EnablePhyTx (staDevices);
+ *     trace.EnableMacRx (apDevices);
+ *     trace.EnableAssociation (apDevices);
+ *     Simulator::Run ();
+ *     Simulator::Destroy (); // closes the trace
+ * \endcode
+ */
+class WifiBinaryTraceHelper
+{
+public:
+  WifiBinaryTraceHelper ();
+
+  /**
+   * Create the trace file. The trace is closed when the simulator is
+   * destroyed.
+   *
+   * \param filename the name of the file
+   */
+  void Open (std::string filename);
+  /**
+   * Write the buffered records and close the file.
+   */
+  void Close (void);
+  /**
+   * Trace the beginning and the end of the MPDU transmissions, from the
+   * PhyTxPsduBegin and PhyTxPsduEnd trace sources.
+   *
+   * \param devices the wifi devices
+   */
+  void EnablePhyTx (NetDeviceContainer devices);
+  /**
+   * Trace the packets received and dropped by the MAC, from the MacRx and
+   * MacRxDrop trace sources.
+   *
+   * \param devices the wifi devices
+   */
+  void EnableMacRx (NetDeviceContainer devices);
+  /**
+   * Trace the associations and deassociations of the stations with the
+   * access points, from the AssociatedSta and DeAssociatedSta trace
+   * sources.
+   *
+   * \param devices the access point devices
+   */
+  void EnableAssociation (NetDeviceContainer devices);
+  /**
+   * \return the trace sink
+   */
+  Ptr<WifiBinaryTraceSink> GetSink (void) const;
+
+private:
+  Ptr<WifiBinaryTraceSink> m_sink;  //!< the trace sink
+};
+
+/**
+ * \brief read the records of a binary wifi trace.
+ *
+ * \code
+ *     WifiBinaryTraceReader reader ("wifi-trace.bin");
+ *     WifiTraceRecord record;
+ *     while (reader.Read (record))
+ *       {
+ *         reader.Print (std::cout, record);
+ *         std::cout << std::endl;
+ *       }
+ * \endcode
+ */
+class WifiBinaryTraceReader
+{
+public:
+  /**
+   * Open a trace. Aborts if the file is not a binary wifi trace.
+   *
+   * \param filename the name of the file
+   */
+  WifiBinaryTraceReader (std::string filename);
+
+  /**
+   * \param record the next record
+   * \return false at the end of the trace
+   */
+  bool Read (WifiTraceRecord &record);
+  /**
+   * Print a record as text: time, node, device, type and the fields
+   * meaningful for the type.
+   *
+   * \param os the output stream
+   * \param record the record
+   */
+  static void Print (std::ostream &os, const WifiTraceRecord &record);
+  /**
+   * \param address a MAC address, as stored in the records
+   * \return the address
+   */
+  static Mac48Address GetMacAddress (uint64_t address);
+  /**
+   * \param address an IPv4 address, as stored in the records
+   * \return the address
+   */
+  static Ipv4Address GetIpv4Address (uint64_t address);
+
+private:
+  std::ifstream m_is;  //!< the trace file
+};
+
+} // namespace ns3
+
+#endif /* WIFI_BINARY_TRACE_HELPER_H */
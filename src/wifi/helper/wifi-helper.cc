@@ -22,6 +22,7 @@
 
 #include "ns3/wifi-net-device.h"
 #include "ns3/ap-wifi-mac.h"
+#include "ns3/sta-wifi-mac.h"
 #include "ns3/ampdu-subframe-header.h"
 #include "ns3/mobility-model.h"
 #include "ns3/log.h"
@@ -1056,4 +1057,23 @@ WifiHelper::AssignStreams (NetDeviceContainer c, int64_t stream)
   return (currentStream - stream);
 }
 
+void
+WifiHelper::Associate (NetDeviceContainer staDevices, NetDeviceContainer apDevices,
+                       const std::vector<uint32_t> &apIndices)
+{
+  NS_ASSERT_MSG (staDevices.GetN () == apIndices.size (), "One AP index is needed per station");
+  for (uint32_t i = 0; i < staDevices.GetN (); i++)
+    {
+      Ptr<WifiNetDevice> staDevice = DynamicCast<WifiNetDevice> (staDevices.Get (i));
+      Ptr<WifiNetDevice> apDevice = DynamicCast<WifiNetDevice> (apDevices.Get (apIndices[i]));
+      NS_ASSERT_MSG (staDevice != 0 && apDevice != 0, "Not a WifiNetDevice");
+      Ptr<StaWifiMac> staMac = DynamicCast<StaWifiMac> (staDevice->GetMac ());
+      Ptr<ApWifiMac> apMac = DynamicCast<ApWifiMac> (apDevice->GetMac ());
+      NS_ABORT_MSG_IF (staMac == 0 || apMac == 0, "Association needs a StaWifiMac and an ApWifiMac");
+      MgtAssocResponseHeader assocResp = apMac->AssociateStation (staMac->GetAddress (),
+                                                                  staMac->GetAssociationRequest ());
+      staMac->SetAssociated (apMac->GetAddress (), apMac->GetBeaconInterval (), assocResp);
+    }
+}
+
 } //namespace ns3
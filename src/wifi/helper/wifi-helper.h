@@ -502,6 +502,22 @@ public:
   */
   int64_t AssignStreams (NetDeviceContainer c, int64_t stream);
 
+  /**
+   * Associate stations with access points without any frame exchange, so
+   * that they are associated from the start of the simulation and do not
+   * scan. This is meant for static topologies and must be called after
+   * Install () and before the simulation starts.
+   *
+   * \param staDevices the devices of the stations (StaWifiMac)
+   * \param apDevices the devices of the access points (ApWifiMac)
+   * \param apIndices the index in apDevices of the access point of each station
+   *
+   * \see ApWifiMac::AssociateStation
+   * \see StaWifiMac::SetAssociated
+   */
+  static void Associate (NetDeviceContainer staDevices, NetDeviceContainer apDevices,
+                         const std::vector<uint32_t> &apIndices);
+
 
 protected:
   ObjectFactory m_stationManager;            ///< station manager
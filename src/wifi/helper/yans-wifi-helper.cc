@@ -30,6 +30,12 @@
 #include "ns3/wifi-net-device.h"
 #include "yans-wifi-helper.h"
 
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
+#include "ns3/yans-wifi-remote-channel.h"
+#endif
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("YansWifiHelper");
@@ -98,7 +104,21 @@ YansWifiChannelHelper::SetPropagationDelay (std::string type,
 Ptr<YansWifiChannel>
 YansWifiChannelHelper::Create (void) const
 {
-  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  Ptr<YansWifiChannel> channel;
+  // If MPI is enabled and the simulation spans several ranks, the PHYs
+  // attached to the channel may belong to nodes of other ranks
+#ifdef NS3_MPI
+  if (MpiInterface::IsEnabled () && MpiInterface::GetSize () > 1)
+    {
+      channel = CreateObject<YansWifiRemoteChannel> ();
+    }
+  else
+    {
+      channel = CreateObject<YansWifiChannel> ();
+    }
+#else
+  channel = CreateObject<YansWifiChannel> ();
+#endif
   Ptr<PropagationLossModel> prev = 0;
   for (std::vector<ObjectFactory>::const_iterator i = m_propagationLoss.begin (); i != m_propagationLoss.end (); ++i)
     {
@@ -162,6 +182,17 @@ YansWifiPhyHelper::Create (Ptr<Node> node, Ptr<WifiNetDevice> device) const
     }
   phy->SetChannel (m_channel);
   phy->SetDevice (device);
+#ifdef NS3_MPI
+  // the messages sent by the other ranks are received by the MpiReceiver
+  // of the device of one of the receivers
+  Ptr<YansWifiRemoteChannel> remoteChannel = DynamicCast<YansWifiRemoteChannel> (m_channel);
+  if (remoteChannel != 0 && device->GetObject<MpiReceiver> () == 0)
+    {
+      Ptr<MpiReceiver> mpiRec = CreateObject<MpiReceiver> ();
+      mpiRec->SetReceiveCallback (MakeCallback (&YansWifiRemoteChannel::ReceiveRemote, remoteChannel));
+      device->AggregateObject (mpiRec);
+    }
+#endif
   return phy;
 }
 
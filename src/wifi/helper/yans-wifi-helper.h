@@ -123,6 +123,8 @@ public:
    * \returns a new channel
    *
    * Create a channel based on the configuration parameters set previously.
+   * If MPI is enabled with several ranks, the channel is a
+   * YansWifiRemoteChannel.
    */
   Ptr<YansWifiChannel> Create (void) const;
 
@@ -813,18 +813,10 @@ ApWifiMac::SendProbeResp (Mac48Address to)
     }
 }
 
-void
-ApWifiMac::SendAssocResp (Mac48Address to, bool success, bool isReassoc)
+MgtAssocResponseHeader
+ApWifiMac::GetAssocResp (Mac48Address to, bool success, bool isReassoc)
 {
   NS_LOG_FUNCTION (this << to << success << isReassoc);
-  WifiMacHeader hdr;
-  hdr.SetType (isReassoc ? WIFI_MAC_MGT_REASSOCIATION_RESPONSE : WIFI_MAC_MGT_ASSOCIATION_RESPONSE);
-  hdr.SetAddr1 (to);
-  hdr.SetAddr2 (GetAddress ());
-  hdr.SetAddr3 (GetAddress ());
-  hdr.SetDsNotFrom ();
-  hdr.SetDsNotTo ();
-  Ptr<Packet> packet = Create<Packet> ();
   MgtAssocResponseHeader assoc;
   StatusCode code;
   if (success)
@@ -895,6 +887,22 @@ ApWifiMac::SendAssocResp (Mac48Address to, bool success, bool isReassoc)
       assoc.SetHeOperation (GetHeOperation ());
       assoc.SetMuEdcaParameterSet (GetMuEdcaParameterSet ());
     }
+  return assoc;
+}
+
+void
+ApWifiMac::SendAssocResp (Mac48Address to, bool success, bool isReassoc)
+{
+  NS_LOG_FUNCTION (this << to << success << isReassoc);
+  WifiMacHeader hdr;
+  hdr.SetType (isReassoc ? WIFI_MAC_MGT_REASSOCIATION_RESPONSE : WIFI_MAC_MGT_ASSOCIATION_RESPONSE);
+  hdr.SetAddr1 (to);
+  hdr.SetAddr2 (GetAddress ());
+  hdr.SetAddr3 (GetAddress ());
+  hdr.SetDsNotFrom ();
+  hdr.SetDsNotTo ();
+  Ptr<Packet> packet = Create<Packet> ();
+  MgtAssocResponseHeader assoc = GetAssocResp (to, success, isReassoc);
   packet->AddHeader (assoc);
 
   if (!GetQosSupported ())
@@ -1123,138 +1131,17 @@ ApWifiMac::Receive (Ptr<WifiMacQueueItem> mpdu)
           if (hdr->IsAssocReq ())
             {
               NS_LOG_DEBUG ("Association request received from " << from);
-              //first, verify that the the station's supported
-              //rate set is compatible with our Basic Rate set
               MgtAssocRequestHeader assocReq;
               packet->PeekHeader (assocReq);
-              CapabilityInformation capabilities = assocReq.GetCapabilities ();
-              GetWifiRemoteStationManager ()->AddSupportedPhyPreamble (from, capabilities.IsShortPreamble ());
-              SupportedRates rates = assocReq.GetSupportedRates ();
-              bool problem = false;
-              if (rates.GetNRates () == 0)
+              if (ReceiveAssocRequest (assocReq, from))
                 {
-                  problem = true;
-                }
-              if (GetHtSupported ())
-                {
-                  //check whether the HT STA supports all MCSs in Basic MCS Set
-                  HtCapabilities htcapabilities = assocReq.GetHtCapabilities ();
-                  if (htcapabilities.IsSupportedMcs (0))
-                    {
-                      for (uint8_t i = 0; i < GetWifiRemoteStationManager ()->GetNBasicMcs (); i++)
-                        {
-                          WifiMode mcs = GetWifiRemoteStationManager ()->GetBasicMcs (i);
-                          if (!htcapabilities.IsSupportedMcs (mcs.GetMcsValue ()))
-                            {
-                              problem = true;
-                              break;
-                            }
-                        }
-                    }
-                }
-              if (GetVhtSupported ())
-                {
-                  //check whether the VHT STA supports all MCSs in Basic MCS Set
-                  VhtCapabilities vhtcapabilities = assocReq.GetVhtCapabilities ();
-                  if (vhtcapabilities.GetVhtCapabilitiesInfo () != 0)
-                    {
-                      for (uint8_t i = 0; i < GetWifiRemoteStationManager ()->GetNBasicMcs (); i++)
-                        {
-                          WifiMode mcs = GetWifiRemoteStationManager ()->GetBasicMcs (i);
-                          if (!vhtcapabilities.IsSupportedTxMcs (mcs.GetMcsValue ()))
-                            {
-                              problem = true;
-                              break;
-                            }
-                        }
-                    }
-                }
-              if (GetHeSupported ())
-                {
-                  //check whether the HE STA supports all MCSs in Basic MCS Set
-                  HeCapabilities hecapabilities = assocReq.GetHeCapabilities ();
-                  if (hecapabilities.GetSupportedMcsAndNss () != 0)
-                    {
-                      for (uint8_t i = 0; i < GetWifiRemoteStationManager ()->GetNBasicMcs (); i++)
-                        {
-                          WifiMode mcs = GetWifiRemoteStationManager ()->GetBasicMcs (i);
-                          if (!hecapabilities.IsSupportedTxMcs (mcs.GetMcsValue ()))
-                            {
-                              problem = true;
-                              break;
-                            }
-                        }
-                    }
-                }
-              if (problem)
-                {
-                  NS_LOG_DEBUG ("One of the Basic Rate set mode is not supported by the station: send association response with an error status");
-                  SendAssocResp (hdr->GetAddr2 (), false, false);
+                  NS_LOG_DEBUG ("Send association response with success status");
+                  SendAssocResp (from, true, false);
                 }
               else
                 {
-                  NS_LOG_DEBUG ("The Basic Rate set modes are supported by the station");
-                  //record all its supported modes in its associated WifiRemoteStation
-                  for (const auto & mode : GetWifiPhy ()->GetModeList ())
-                    {
-                      if (rates.IsSupportedRate (mode.GetDataRate (GetWifiPhy ()->GetChannelWidth ())))
-                        {
-                          GetWifiRemoteStationManager ()->AddSupportedMode (from, mode);
-                        }
-                    }
-                  if (GetErpSupported () && GetWifiRemoteStationManager ()->GetErpOfdmSupported (from) && capabilities.IsShortSlotTime ())
-                    {
-                      GetWifiRemoteStationManager ()->AddSupportedErpSlotTime (from, true);
-                    }
-                  if (GetHtSupported ())
-                    {
-                      HtCapabilities htCapabilities = assocReq.GetHtCapabilities ();
-                      if (htCapabilities.IsSupportedMcs (0))
-                        {
-                          GetWifiRemoteStationManager ()->AddStationHtCapabilities (from, htCapabilities);
-                        }
-                    }
-                  if (GetVhtSupported ())
-                    {
-                      VhtCapabilities vhtCapabilities = assocReq.GetVhtCapabilities ();
-                      //we will always fill in RxHighestSupportedLgiDataRate field at TX, so this can be used to check whether it supports VHT
-                      if (vhtCapabilities.GetRxHighestSupportedLgiDataRate () > 0)
-                        {
-                          GetWifiRemoteStationManager ()->AddStationVhtCapabilities (from, vhtCapabilities);
-                          for (const auto & mcs : GetWifiPhy ()->GetMcsList (WIFI_MOD_CLASS_VHT))
-                            {
-                              if (vhtCapabilities.IsSupportedTxMcs (mcs.GetMcsValue ()))
-                                {
-                                  GetWifiRemoteStationManager ()->AddSupportedMcs (hdr->GetAddr2 (), mcs);
-                                  //here should add a control to add basic MCS when it is implemented
-                                }
-                            }
-                        }
-                    }
-                  if (GetHtSupported ())
-                    {
-                      ExtendedCapabilities extendedCapabilities = assocReq.GetExtendedCapabilities ();
-                      //TODO: to be completed
-                    }
-                  if (GetHeSupported ())
-                    {
-                      HeCapabilities heCapabilities = assocReq.GetHeCapabilities ();
-                      if (heCapabilities.GetSupportedMcsAndNss () != 0)
-                        {
-                          GetWifiRemoteStationManager ()->AddStationHeCapabilities (from, heCapabilities);
-                          for (const auto & mcs : GetWifiPhy ()->GetMcsList (WIFI_MOD_CLASS_HE))
-                            {
-                              if (heCapabilities.IsSupportedTxMcs (mcs.GetMcsValue ()))
-                                {
-                                  GetWifiRemoteStationManager ()->AddSupportedMcs (hdr->GetAddr2 (), mcs);
-                                  //here should add a control to add basic MCS when it is implemented
-                                }
-                            }
-                        }
-                    }
-                  GetWifiRemoteStationManager ()->RecordWaitAssocTxOk (from);
-                  NS_LOG_DEBUG ("Send association response with success status");
-                  SendAssocResp (hdr->GetAddr2 (), true, false);
+                  NS_LOG_DEBUG ("Send association response with an error status");
+                  SendAssocResp (from, false, false);
                 }
               return;
             }
@@ -1430,6 +1317,142 @@ ApWifiMac::Receive (Ptr<WifiMacQueueItem> mpdu)
   WifiMac::Receive (Create<WifiMacQueueItem> (packet, *hdr));
 }
 
+bool
+ApWifiMac::ReceiveAssocRequest (const MgtAssocRequestHeader& assocReq, const Mac48Address& from)
+{
+  NS_LOG_FUNCTION (this << assocReq << from);
+  //first, verify that the the station's supported
+  //rate set is compatible with our Basic Rate set
+  CapabilityInformation capabilities = assocReq.GetCapabilities ();
+  GetWifiRemoteStationManager ()->AddSupportedPhyPreamble (from, capabilities.IsShortPreamble ());
+  SupportedRates rates = assocReq.GetSupportedRates ();
+  bool problem = false;
+  if (rates.GetNRates () == 0)
+    {
+      problem = true;
+    }
+  if (GetHtSupported ())
+    {
+      //check whether the HT STA supports all MCSs in Basic MCS Set
+      HtCapabilities htcapabilities = assocReq.GetHtCapabilities ();
+      if (htcapabilities.IsSupportedMcs (0))
+        {
+          for (uint8_t i = 0; i < GetWifiRemoteStationManager ()->GetNBasicMcs (); i++)
+            {
+              WifiMode mcs = GetWifiRemoteStationManager ()->GetBasicMcs (i);
+              if (!htcapabilities.IsSupportedMcs (mcs.GetMcsValue ()))
+                {
+                  problem = true;
+                  break;
+                }
+            }
+        }
+    }
+  if (GetVhtSupported ())
+    {
+      //check whether the VHT STA supports all MCSs in Basic MCS Set
+      VhtCapabilities vhtcapabilities = assocReq.GetVhtCapabilities ();
+      if (vhtcapabilities.GetVhtCapabilitiesInfo () != 0)
+        {
+          for (uint8_t i = 0; i < GetWifiRemoteStationManager ()->GetNBasicMcs (); i++)
+            {
+              WifiMode mcs = GetWifiRemoteStationManager ()->GetBasicMcs (i);
+              if (!vhtcapabilities.IsSupportedTxMcs (mcs.GetMcsValue ()))
+                {
+                  problem = true;
+                  break;
+                }
+            }
+        }
+    }
+  if (GetHeSupported ())
+    {
+      //check whether the HE STA supports all MCSs in Basic MCS Set
+      HeCapabilities hecapabilities = assocReq.GetHeCapabilities ();
+      if (hecapabilities.GetSupportedMcsAndNss () != 0)
+        {
+          for (uint8_t i = 0; i < GetWifiRemoteStationManager ()->GetNBasicMcs (); i++)
+            {
+              WifiMode mcs = GetWifiRemoteStationManager ()->GetBasicMcs (i);
+              if (!hecapabilities.IsSupportedTxMcs (mcs.GetMcsValue ()))
+                {
+                  problem = true;
+                  break;
+                }
+            }
+        }
+    }
+  if (problem)
+    {
+      NS_LOG_DEBUG ("One of the Basic Rate set mode is not supported by the station");
+      return false;
+    }
+  else
+    {
+      NS_LOG_DEBUG ("The Basic Rate set modes are supported by the station");
+      //record all its supported modes in its associated WifiRemoteStation
+      for (const auto & mode : GetWifiPhy ()->GetModeList ())
+        {
+          if (rates.IsSupportedRate (mode.GetDataRate (GetWifiPhy ()->GetChannelWidth ())))
+            {
+              GetWifiRemoteStationManager ()->AddSupportedMode (from, mode);
+            }
+        }
+      if (GetErpSupported () && GetWifiRemoteStationManager ()->GetErpOfdmSupported (from) && capabilities.IsShortSlotTime ())
+        {
+          GetWifiRemoteStationManager ()->AddSupportedErpSlotTime (from, true);
+        }
+      if (GetHtSupported ())
+        {
+          HtCapabilities htCapabilities = assocReq.GetHtCapabilities ();
+          if (htCapabilities.IsSupportedMcs (0))
+            {
+              GetWifiRemoteStationManager ()->AddStationHtCapabilities (from, htCapabilities);
+            }
+        }
+      if (GetVhtSupported ())
+        {
+          VhtCapabilities vhtCapabilities = assocReq.GetVhtCapabilities ();
+          //we will always fill in RxHighestSupportedLgiDataRate field at TX, so this can be used to check whether it supports VHT
+          if (vhtCapabilities.GetRxHighestSupportedLgiDataRate () > 0)
+            {
+              GetWifiRemoteStationManager ()->AddStationVhtCapabilities (from, vhtCapabilities);
+              for (const auto & mcs : GetWifiPhy ()->GetMcsList (WIFI_MOD_CLASS_VHT))
+                {
+                  if (vhtCapabilities.IsSupportedTxMcs (mcs.GetMcsValue ()))
+                    {
+                      GetWifiRemoteStationManager ()->AddSupportedMcs (from, mcs);
+                      //here should add a control to add basic MCS when it is implemented
+                    }
+                }
+            }
+        }
+      if (GetHtSupported ())
+        {
+          ExtendedCapabilities extendedCapabilities = assocReq.GetExtendedCapabilities ();
+          //TODO: to be completed
+        }
+      if (GetHeSupported ())
+        {
+          HeCapabilities heCapabilities = assocReq.GetHeCapabilities ();
+          if (heCapabilities.GetSupportedMcsAndNss () != 0)
+            {
+              GetWifiRemoteStationManager ()->AddStationHeCapabilities (from, heCapabilities);
+              for (const auto & mcs : GetWifiPhy ()->GetMcsList (WIFI_MOD_CLASS_HE))
+                {
+                  if (heCapabilities.IsSupportedTxMcs (mcs.GetMcsValue ()))
+                    {
+                      GetWifiRemoteStationManager ()->AddSupportedMcs (from, mcs);
+                      //here should add a control to add basic MCS when it is implemented
+                    }
+                }
+            }
+        }
+      GetWifiRemoteStationManager ()->RecordWaitAssocTxOk (from);
+    }
+  return true;
+}
+
 void
 ApWifiMac::DeaggregateAmsduAndForward (Ptr<WifiMacQueueItem> mpdu)
 {
@@ -1501,6 +1524,20 @@ ApWifiMac::GetNextAssociationId (void)
   return 0;
 }
 
+MgtAssocResponseHeader
+ApWifiMac::AssociateStation (Mac48Address sta, const MgtAssocRequestHeader& assocReq)
+{
+  NS_LOG_FUNCTION (this << sta);
+  bool success = ReceiveAssocRequest (assocReq, sta);
+  MgtAssocResponseHeader assocResp = GetAssocResp (sta, success, false);
+  if (success)
+    {
+      NS_LOG_DEBUG ("associated with sta=" << sta);
+      GetWifiRemoteStationManager ()->RecordGotAssocTxOk (sta);
+    }
+  return assocResp;
+}
+
 const std::map<uint16_t, Mac48Address>&
 ApWifiMac::GetStaList (void) const
 {
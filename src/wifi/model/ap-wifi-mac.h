@@ -38,6 +38,8 @@ class HtOperation;
 class VhtOperation;
 class HeOperation;
 class CfParameterSet;
+class MgtAssocRequestHeader;
+class MgtAssocResponseHeader;
 class UniformRandomVariable;
 
 /**
@@ -143,6 +145,17 @@ public:
    * \return the maximum among the values of the Queue Size subfields
    */
   uint8_t GetMaxBufferStatus (Mac48Address address) const;
+  /**
+   * Associate a station without any frame exchange, e.g., to set up a static
+   * topology before the simulation starts. The association request is
+   * processed as if it had been received from the station, and the
+   * association response is deemed acknowledged.
+   *
+   * \param sta the MAC address of the station
+   * \param assocReq the association request of the station
+   * \return the association response to be processed by the station
+   */
+  MgtAssocResponseHeader AssociateStation (Mac48Address sta, const MgtAssocRequestHeader& assocReq);
   Time GetBeaconOffset (void) const;
   void SetBeaconOffset (Time interval);
 private:
@@ -211,6 +224,26 @@ private:
    * \param isReassoc indicates whether it is a reassociation response
    */
   void SendAssocResp (Mac48Address to, bool success, bool isReassoc);
+  /**
+   * Get the association or reassociation response to send to a station. If the
+   * association is successful and the station was not associated, an AID is
+   * allocated to it.
+   *
+   * \param to the address of the STA we are sending an association response to
+   * \param success indicates whether the association was successful or not
+   * \param isReassoc indicates whether it is a reassociation response
+   * \return the association response header
+   */
+  MgtAssocResponseHeader GetAssocResp (Mac48Address to, bool success, bool isReassoc);
+  /**
+   * Check whether the capabilities of a station are compatible with our Basic
+   * Rate set and, if so, record them in the remote station manager.
+   *
+   * \param assocReq the association request received from the station
+   * \param from the address of the station
+   * \return true if the association can be accepted
+   */
+  bool ReceiveAssocRequest (const MgtAssocRequestHeader& assocReq, const Mac48Address& from);
   /**
    * Forward a beacon packet to the beacon special DCF.
    */
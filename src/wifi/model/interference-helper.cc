@@ -24,6 +24,7 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/packet.h"
+#include "ns3/ring-trace.h"
 #include "interference-helper.h"
 #include "wifi-phy.h"
 #include "error-rate-model.h"
@@ -33,6 +34,12 @@
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("InterferenceHelper");
+NS_LOG_HOT_PATH ();
+
+// The calls made by the PHY, to replay them in utils/bench-interference
+NS_RING_TRACE_DEFINE (g_addTrace, "InterferenceHelper::Add", "event,duration,powerW");
+NS_RING_TRACE_DEFINE (g_rxTrace, "InterferenceHelper::NotifyRx", "start,endTime");
+NS_RING_TRACE_DEFINE (g_calculateTrace, "InterferenceHelper::Calculate", "event,windowStart,windowEnd");
 
 /****************************************************************
  *       PHY event class
@@ -139,8 +146,9 @@ std::ostream & operator << (std::ostream &os, const Event &event)
  *       short period of time.
  ****************************************************************/
 
-InterferenceHelper::NiChange::NiChange (double power, Ptr<Event> event)
-  : m_power (power),
+InterferenceHelper::NiChange::NiChange (Time time, double power, Ptr<Event> event)
+  : m_time (time),
+    m_power (power),
     m_event (event)
 {
 }
@@ -150,6 +158,12 @@ InterferenceHelper::NiChange::~NiChange ()
   m_event = 0;
 }
 
+Time
+InterferenceHelper::NiChange::GetTime (void) const
+{
+  return m_time;
+}
+
 double
 InterferenceHelper::NiChange::GetPower (void) const
 {
@@ -191,6 +205,7 @@ InterferenceHelper::Add (Ptr<const WifiPpdu> ppdu, const WifiTxVector& txVector,
 {
   Ptr<Event> event = Create<Event> (ppdu, txVector, duration, std::move (rxPowerW));
   AppendEvent (event, isStartOfdmaRxing);
+  NS_RING_TRACE (g_addTrace, PeekPointer (event), duration, event->GetRxPowerW ());
   return event;
 }
 
@@ -217,6 +232,7 @@ InterferenceHelper::RemoveBands(void)
     }
   m_niChangesPerBand.clear();
   m_firstPowerPerBand.clear();
+  m_payloadPerCache.clear ();
 }
 
 void
@@ -228,7 +244,7 @@ InterferenceHelper::AddBand (WifiSpectrumBand band)
   auto result = m_niChangesPerBand.insert ({band, niChanges});
   NS_ASSERT (result.second);
   // Always have a zero power noise event in the list
-  AddNiChangeEvent (Time (0), NiChange (0.0, 0), result.first);
+  AddNiChangeEvent (NiChange (Time (0), 0.0, 0), result.first);
   m_firstPowerPerBand.insert ({band, 0.0});
 }
 
@@ -263,11 +279,11 @@ InterferenceHelper::GetEnergyDuration (double energyW, WifiSpectrumBand band)
   auto niIt = m_niChangesPerBand.find (band);
   NS_ASSERT (niIt != m_niChangesPerBand.end ());
   auto i = GetPreviousPosition (now, niIt);
-  Time end = i->first;
+  Time end = i->GetTime ();
   for (; i != niIt->second.end (); ++i)
     {
-      double noiseInterferenceW = i->second.GetPower ();
-      end = i->first;
+      double noiseInterferenceW = i->GetPower ();
+      end = i->GetTime ();
       NS_LOG_FUNCTION (this << noiseInterferenceW << " - " << energyW);
       if (noiseInterferenceW < energyW)
         {
@@ -292,26 +308,32 @@ InterferenceHelper::AppendEvent (Ptr<Event> event, bool isStartOfdmaRxing)
       double previousPowerStart = 0;
       double previousPowerEnd = 0;
       auto previousPowerPosition = GetPreviousPosition (event->GetStartTime (), niIt);
-      previousPowerStart = previousPowerPosition->second.GetPower ();
-      previousPowerEnd = GetPreviousPosition (event->GetEndTime (), niIt)->second.GetPower ();
+      previousPowerStart = previousPowerPosition->GetPower ();
+      previousPowerEnd = GetPreviousPosition (event->GetEndTime (), niIt)->GetPower ();
       if (!m_rxing)
         {
+          m_payloadPerCache.clear ();
           m_firstPowerPerBand.find (band)->second = previousPowerStart;
+          // Nothing is being received: drop the changes up to the start of
+          // the new signal, which the next receptions cannot overlap.
           // Always leave the first zero power noise event in the list
-          niIt->second.erase (++(niIt->second.begin ()), ++previousPowerPosition);
+          niIt->second.erase (niIt->second.begin () + 1, ++previousPowerPosition);
         }
       else if (isStartOfdmaRxing)
         {
           //When the first UL-OFDMA payload is received, we need to set m_firstPowerPerBand
           //so that it takes into account interferences that arrived between the start of the
           //UL MU transmission and the start of UL-OFDMA payload.
+          m_payloadPerCache.clear ();
           m_firstPowerPerBand.find (band)->second = previousPowerStart;
         }
-      auto first = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event), niIt);
-      auto last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event), niIt);
-      for (auto i = first; i != last; ++i)
+      // the insertion may reallocate the changes: keep the index of the first one
+      auto first = AddNiChangeEvent (NiChange (event->GetStartTime (), previousPowerStart, event), niIt);
+      std::size_t firstIndex = first - niIt->second.begin ();
+      auto last = AddNiChangeEvent (NiChange (event->GetEndTime (), previousPowerEnd, event), niIt);
+      for (auto i = niIt->second.begin () + firstIndex; i != last; ++i)
         {
-          i->second.AddPower (it.second);
+          i->AddPower (it.second);
         }
     }
 }
@@ -321,6 +343,7 @@ InterferenceHelper::UpdateEvent (Ptr<Event> event, const RxPowerWattPerChannelBa
 {
   NS_LOG_FUNCTION (this << event);
   //This is called for UL MU events, in order to scale power as long as UL MU PPDUs arrive
+  m_payloadPerCache.clear ();
   for (auto const& it : rxPower)
     {
       WifiSpectrumBand band = it.first;
@@ -330,7 +353,7 @@ InterferenceHelper::UpdateEvent (Ptr<Event> event, const RxPowerWattPerChannelBa
       auto last = GetPreviousPosition (event->GetEndTime (), niIt);
       for (auto i = first; i != last; ++i)
         {
-          i->second.AddPower (it.second);
+          i->AddPower (it.second);
         }
     }
     event->UpdateRxPowerW (rxPower);
@@ -340,9 +363,7 @@ double
 InterferenceHelper::CalculateSnr (double signal, double noiseInterference, uint16_t channelWidth, uint8_t nss) const
 {
   NS_LOG_FUNCTION (this << signal << noiseInterference << channelWidth << +nss);
-  //thermal noise at 290K in J/s = W
-  static const double BOLTZMANN = 1.3803e-23;
-  //Nt is the power of thermal noise in W
+  //Nt is the power of thermal noise at 290K in W
   double Nt = BOLTZMANN * 290 * channelWidth * 1e6;
   //receiver noise Floor (W) which accounts for thermal noise and non-idealities of the receiver
   double noiseFloor = m_noiseFigure * Nt;
@@ -364,7 +385,7 @@ InterferenceHelper::CalculateSnr (double signal, double noiseInterference, uint1
 }
 
 double
-InterferenceHelper::CalculateNoiseInterferenceW (Ptr<Event> event, NiChangesPerBand *nis, WifiSpectrumBand band) const
+InterferenceHelper::CalculateNoiseInterferenceW (Ptr<Event> event, NiChangeRange *range, WifiSpectrumBand band) const
 {
   NS_LOG_FUNCTION (this << band.first << band.second);
   auto firstPower_it = m_firstPowerPerBand.find (band);
@@ -372,22 +393,26 @@ InterferenceHelper::CalculateNoiseInterferenceW (Ptr<Event> event, NiChangesPerB
   double noiseInterferenceW = firstPower_it->second;
   auto niIt = m_niChangesPerBand.find (band);
   NS_ASSERT (niIt != m_niChangesPerBand.end ());
-  auto it = niIt->second.find (event->GetStartTime ());
-  for (; it != niIt->second.end () && it->first < Simulator::Now (); ++it)
+  const NiChanges &niChanges = niIt->second;
+  auto start = std::lower_bound (niChanges.begin (), niChanges.end (), event->GetStartTime (),
+                                 [] (const NiChange &change, Time time) { return change.GetTime () < time; });
+  //the power of the last change before now
+  auto it = std::lower_bound (start, niChanges.end (), Simulator::Now (),
+                              [] (const NiChange &change, Time time) { return change.GetTime () < time; });
+  if (it != start)
     {
-      noiseInterferenceW = it->second.GetPower () - event->GetRxPowerW (band);
+      noiseInterferenceW = (it - 1)->GetPower () - event->GetRxPowerW (band);
     }
-  it = niIt->second.find (event->GetStartTime ());
-  NS_ASSERT (it != niIt->second.end ());
-  for (; it != niIt->second.end () && it->second.GetEvent () != event; ++it);
-  NiChanges ni;
-  ni.emplace (event->GetStartTime (), NiChange (0, event));
-  while (++it != niIt->second.end () && it->second.GetEvent () != event)
-    {
-      ni.insert (*it);
-    }
-  ni.emplace (event->GetEndTime (), NiChange (0, event));
-  nis->insert ({band, ni});
+  it = start;
+  NS_ASSERT (it != niChanges.end () && it->GetTime () == event->GetStartTime ());
+  for (; it != niChanges.end () && it->GetEvent () != event; ++it);
+  NS_ASSERT (it != niChanges.end ());
+  range->first = it;
+  it = std::lower_bound (it + 1, niChanges.end (), event->GetEndTime (),
+                         [] (const NiChange &change, Time time) { return change.GetTime () < time; });
+  for (; it != niChanges.end () && it->GetEvent () != event; ++it);
+  NS_ASSERT (it != niChanges.end ());
+  range->last = it;
   NS_ASSERT_MSG (noiseInterferenceW >= 0, "CalculateNoiseInterferenceW returns negative value " << noiseInterferenceW);
   return noiseInterferenceW;
 }
@@ -422,29 +447,58 @@ InterferenceHelper::CalculatePayloadChunkSuccessRate (double snir, Time duration
 
 double
 InterferenceHelper::CalculatePayloadPer (Ptr<const Event> event, uint16_t channelWidth,
-                                         NiChangesPerBand *nis, WifiSpectrumBand band,
+                                         const NiChangeRange &range, WifiSpectrumBand band,
                                          uint16_t staId, std::pair<Time, Time> window) const
 {
   NS_LOG_FUNCTION (this << channelWidth << band.first << band.second << staId << window.first << window.second);
-  double psr = 1.0; /* Packet Success Rate */
-  const auto& niIt = nis->find (band)->second;
-  auto j = niIt.cbegin ();
-  Time previous = j->first;
+  Time now = Simulator::Now ();
   WifiMode payloadMode = event->GetTxVector ().GetMode (staId);
-  Time phyPayloadStart = j->first;
-  if (event->GetPpdu ()->GetType () != WIFI_PPDU_TYPE_UL_MU) //j->first corresponds to the start of the UL-OFDMA payload
+  Time phyPayloadStart = event->GetStartTime ();
+  if (event->GetPpdu ()->GetType () != WIFI_PPDU_TYPE_UL_MU) //the event start corresponds to the start of the UL-OFDMA payload
     {
-      phyPayloadStart = j->first + WifiPhy::CalculatePhyPreambleAndHeaderDuration (event->GetTxVector ());
+      phyPayloadStart += WifiPhy::CalculatePhyPreambleAndHeaderDuration (event->GetTxVector ());
     }
   Time windowStart = phyPayloadStart + window.first;
   Time windowEnd = phyPayloadStart + window.second;
-  double noiseInterferenceW = m_firstPowerPerBand.find (band)->second;
   double powerW = event->GetRxPowerW (band);
-  while (++j != niIt.cend ())
+
+  //Resume the walk of a previous window, skipping the chunks already walked
+  ChunkCursor cursor {0, event->GetStartTime (), m_firstPowerPerBand.find (band)->second, 1.0};
+  bool skipped = false;
+  auto cacheIt = m_payloadPerCache.insert ({{PeekPointer (event), band, staId, channelWidth},
+                                           {event->GetStartTime (), cursor, cursor}});
+  PayloadPerCache &cache = cacheIt.first->second;
+  if (windowStart >= cache.windowStart)
     {
-      Time current = j->first;
+      if (windowStart == cache.windowStart && windowEnd >= cache.computed.previous)
+        {
+          cursor = cache.computed;
+          skipped = true;
+        }
+      else
+        {
+          cursor = cache.skipped;
+        }
+    }
+  NS_ASSERT (range.first + cursor.offset <= range.last);
+  auto j = range.first + cursor.offset;
+  Time previous = cursor.previous;
+  double noiseInterferenceW = cursor.noiseInterferenceW;
+  double psr = cursor.psr; /* Packet Success Rate */
+  bool computed = true;
+  while (j++ != range.last)
+    {
+      Time current = (j == range.last ? event->GetEndTime () : j->GetTime ());
       NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
       NS_ASSERT (current >= previous);
+      if (!skipped && current >= windowStart && previous <= now)
+        {
+          //the walk of the next windows starts here
+          cache.windowStart = windowStart;
+          cache.skipped = {static_cast<std::size_t> (j - 1 - range.first), previous, noiseInterferenceW, 1.0};
+          cache.computed = cache.skipped;
+          skipped = true;
+        }
       double snr = CalculateSnr (powerW, noiseInterferenceW, channelWidth, event->GetTxVector ().GetNss (staId));
       //Case 1: Both previous and current point to the windowed payload
       if (previous >= windowStart)
@@ -458,8 +512,15 @@ InterferenceHelper::CalculatePayloadPer (Ptr<const Event> event, uint16_t channe
           psr *= CalculatePayloadChunkSuccessRate (snr, Min (windowEnd, current) - windowStart, event->GetTxVector (), staId);
           NS_LOG_DEBUG ("previous is before windowed payload and current is in the windowed payload: mode=" << payloadMode << ", psr=" << psr);
         }
-      noiseInterferenceW = j->second.GetPower () - powerW;
-      previous = j->first;
+      noiseInterferenceW = j->GetPower () - powerW;
+      previous = current;
+      //the chunks which end before the end of the window and now are not
+      //clipped by the window and no new change may split them
+      computed = computed && current <= Min (windowEnd, now);
+      if (skipped && computed)
+        {
+          cache.computed = {static_cast<std::size_t> (j - range.first), previous, noiseInterferenceW, psr};
+        }
       if (previous > windowEnd)
         {
           NS_LOG_DEBUG ("Stop: new previous=" << previous << " after time window end=" << windowEnd);
@@ -471,14 +532,13 @@ InterferenceHelper::CalculatePayloadPer (Ptr<const Event> event, uint16_t channe
 }
 
 double
-InterferenceHelper::CalculatePhyHeaderSectionPsr (Ptr<const Event> event, NiChangesPerBand *nis,
+InterferenceHelper::CalculatePhyHeaderSectionPsr (Ptr<const Event> event, const NiChangeRange &range,
                                                   uint16_t channelWidth, WifiSpectrumBand band,
                                                   PhyEntity::PhyHeaderSections phyHeaderSections) const
 {
   NS_LOG_FUNCTION (this << band.first << band.second);
   double psr = 1.0; /* Packet Success Rate */
-  auto niIt = nis->find (band)->second;
-  auto j = niIt.begin ();
+  auto j = range.first;
 
   NS_ASSERT (!phyHeaderSections.empty ());
   Time stopLastSection = Seconds (0);
@@ -487,12 +547,12 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr (Ptr<const Event> event, NiChan
       stopLastSection = Max (stopLastSection, section.second.first.second);
     }
 
-  Time previous = j->first;
+  Time previous = event->GetStartTime ();
   double noiseInterferenceW = m_firstPowerPerBand.find (band)->second;
   double powerW = event->GetRxPowerW (band);
-  while (++j != niIt.end ())
+  while (j++ != range.last)
     {
-      Time current = j->first;
+      Time current = (j == range.last ? event->GetEndTime () : j->GetTime ());
       NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
       NS_ASSERT (current >= previous);
       double snr = CalculateSnr (powerW, noiseInterferenceW, channelWidth, 1);
@@ -512,8 +572,8 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr (Ptr<const Event> event, NiChan
                 }
             }
         }
-      noiseInterferenceW = j->second.GetPower () - powerW;
-      previous = j->first;
+      noiseInterferenceW = j->GetPower () - powerW;
+      previous = current;
       if (previous > stopLastSection)
         {
           NS_LOG_DEBUG ("Stop: new previous=" << previous << " after stop of last section=" << stopLastSection);
@@ -524,16 +584,15 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr (Ptr<const Event> event, NiChan
 }
 
 double
-InterferenceHelper::CalculatePhyHeaderPer (Ptr<const Event> event, NiChangesPerBand *nis,
+InterferenceHelper::CalculatePhyHeaderPer (Ptr<const Event> event, const NiChangeRange &range,
                                            uint16_t channelWidth, WifiSpectrumBand band,
                                            WifiPpduField header) const
 {
   NS_LOG_FUNCTION (this << band.first << band.second << header);
-  auto niIt = nis->find (band)->second;
   auto phyEntity = WifiPhy::GetStaticPhyEntity (event->GetTxVector ().GetModulationClass ());
 
   PhyEntity::PhyHeaderSections sections;
-  for (const auto & section : phyEntity->GetPhyHeaderSections (event->GetTxVector (), niIt.begin ()->first))
+  for (const auto & section : phyEntity->GetPhyHeaderSections (event->GetTxVector (), event->GetStartTime ()))
     {
       if (section.first == header)
         {
@@ -544,7 +603,7 @@ InterferenceHelper::CalculatePhyHeaderPer (Ptr<const Event> event, NiChangesPerB
   double psr = 1.0;
   if (!sections.empty () > 0)
     {
-      psr = CalculatePhyHeaderSectionPsr (event, nis, channelWidth, band, sections);
+      psr = CalculatePhyHeaderSectionPsr (event, range, channelWidth, band, sections);
     }
   return 1 - psr;
 }
@@ -554,8 +613,9 @@ InterferenceHelper::CalculatePayloadSnrPer (Ptr<Event> event, uint16_t channelWi
                                             uint16_t staId, std::pair<Time, Time> relativeMpduStartStop) const
 {
   NS_LOG_FUNCTION (this << channelWidth << band.first << band.second << staId << relativeMpduStartStop.first << relativeMpduStartStop.second);
-  NiChangesPerBand ni;
-  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni, band);
+  NS_RING_TRACE (g_calculateTrace, PeekPointer (event), relativeMpduStartStop.first, relativeMpduStartStop.second);
+  NiChangeRange range;
+  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &range, band);
   double snr = CalculateSnr (event->GetRxPowerW (band),
                              noiseInterferenceW,
                              channelWidth,
@@ -564,7 +624,7 @@ InterferenceHelper::CalculatePayloadSnrPer (Ptr<Event> event, uint16_t channelWi
   /* calculate the SNIR at the start of the MPDU (located through windowing) and accumulate
    * all SNIR changes in the SNIR vector.
    */
-  double per = CalculatePayloadPer (event, channelWidth, &ni, band, staId, relativeMpduStartStop);
+  double per = CalculatePayloadPer (event, channelWidth, range, band, staId, relativeMpduStartStop);
 
   return PhyEntity::SnrPer (snr, per);
 }
@@ -572,8 +632,8 @@ InterferenceHelper::CalculatePayloadSnrPer (Ptr<Event> event, uint16_t channelWi
 double
 InterferenceHelper::CalculateSnr (Ptr<Event> event, uint16_t channelWidth, uint8_t nss, WifiSpectrumBand band) const
 {
-  NiChangesPerBand ni;
-  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni, band);
+  NiChangeRange range;
+  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &range, band);
   double snr = CalculateSnr (event->GetRxPowerW (band),
                              noiseInterferenceW,
                              channelWidth,
@@ -586,8 +646,8 @@ InterferenceHelper::CalculatePhyHeaderSnrPer (Ptr<Event> event, uint16_t channel
                                               WifiPpduField header) const
 {
   NS_LOG_FUNCTION (this << band.first << band.second << header);
-  NiChangesPerBand ni;
-  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni, band);
+  NiChangeRange range;
+  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &range, band);
   double snr = CalculateSnr (event->GetRxPowerW (band),
                              noiseInterferenceW,
                              channelWidth,
@@ -596,7 +656,7 @@ InterferenceHelper::CalculatePhyHeaderSnrPer (Ptr<Event> event, uint16_t channel
   /* calculate the SNIR at the start of the PHY header and accumulate
    * all SNIR changes in the SNIR vector.
    */
-  double per = CalculatePhyHeaderPer (event, &ni, channelWidth, band, header);
+  double per = CalculatePhyHeaderPer (event, range, channelWidth, band, header);
   
   return PhyEntity::SnrPer (snr, per);
 }
@@ -608,16 +668,18 @@ InterferenceHelper::EraseEvents (void)
     {
       niIt->second.clear ();
       // Always have a zero power noise event in the list
-      AddNiChangeEvent (Time (0), NiChange (0.0, 0), niIt);
+      AddNiChangeEvent (NiChange (Time (0), 0.0, 0), niIt);
       m_firstPowerPerBand.at (niIt->first) = 0.0;
     }
+  m_payloadPerCache.clear ();
   m_rxing = false;
 }
 
 InterferenceHelper::NiChanges::iterator
 InterferenceHelper::GetNextPosition (Time moment, NiChangesPerBand::iterator niIt)
 {
-  return niIt->second.upper_bound (moment);
+  return std::upper_bound (niIt->second.begin (), niIt->second.end (), moment,
+                           [] (Time time, const NiChange &change) { return time < change.GetTime (); });
 }
 
 InterferenceHelper::NiChanges::iterator
@@ -631,15 +693,18 @@ InterferenceHelper::GetPreviousPosition (Time moment, NiChangesPerBand::iterator
 }
 
 InterferenceHelper::NiChanges::iterator
-InterferenceHelper::AddNiChangeEvent (Time moment, NiChange change, NiChangesPerBand::iterator niIt)
+InterferenceHelper::AddNiChangeEvent (NiChange change, NiChangesPerBand::iterator niIt)
 {
-  return niIt->second.insert (GetNextPosition (moment, niIt), std::make_pair (moment, change));
+  // the new signals start now, so the insertion point is close to the end
+  // and only the ends of the signals on the air are moved
+  return niIt->second.insert (GetNextPosition (change.GetTime (), niIt), change);
 }
 
 void
 InterferenceHelper::NotifyRxStart ()
 {
   NS_LOG_FUNCTION (this);
+  NS_RING_TRACE (g_rxTrace, true, Simulator::Now ());
   m_rxing = true;
 }
 
@@ -647,14 +712,16 @@ void
 InterferenceHelper::NotifyRxEnd (Time endTime)
 {
   NS_LOG_FUNCTION (this << endTime);
+  NS_RING_TRACE (g_rxTrace, false, endTime);
   m_rxing = false;
+  m_payloadPerCache.clear ();
   //Update m_firstPowerPerBand for frame capture
   for (auto niIt = m_niChangesPerBand.begin(); niIt != m_niChangesPerBand.end(); ++niIt)
     {
       NS_ASSERT (niIt->second.size () > 1);
       auto it = GetPreviousPosition (endTime, niIt);
       it--;
-      m_firstPowerPerBand.find (niIt->first)->second = it->second.GetPower ();
+      m_firstPowerPerBand.find (niIt->first)->second = it->GetPower ();
     }
 }
 
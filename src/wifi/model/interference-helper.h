@@ -22,6 +22,7 @@
 #define INTERFERENCE_HELPER_H
 
 #include "phy-entity.h"
+#include <tuple>
 
 namespace ns3 {
 
@@ -317,11 +318,18 @@ public:
     /**
      * Create a NiChange at the given time and the amount of NI change.
      *
+     * \param time the time of the change
      * \param power the power in watts
      * \param event causes this NI change
      */
-    NiChange (double power, Ptr<Event> event);
+    NiChange (Time time, double power, Ptr<Event> event);
     ~NiChange ();
+    /**
+     * Return the time of the change
+     *
+     * \return the time of the change
+     */
+    Time GetTime (void) const;
     /**
      * Return the power
      *
@@ -343,20 +351,77 @@ public:
 
 
 private:
+    Time m_time; ///< time of the change
     double m_power; ///< power in watts
     Ptr<Event> m_event; ///< event
   };
 
   /**
-   * typedef for a multimap of NiChange
+   * The ledger of the NI changes of a band: the start and the end of every
+   * signal, ordered by time (changes at the same time in insertion order).
+   * The power of a change is the total power received from the change
+   * until the next one, i.e., the prefix sum of the powers of the signals
+   * which started and ended before it.
+   *
+   * The changes are stored contiguously and located by binary search.
+   * The changes older than the start of the oldest signal which may still
+   * be received are dropped as new signals arrive, so that the ledger only
+   * holds a few changes beyond those of the signals on the air.
    */
-  typedef std::multimap<Time, NiChange> NiChanges;
+  typedef std::vector<NiChange> NiChanges;
 
   /**
    * Map of NiChanges per band
    */
   typedef std::map <WifiSpectrumBand, NiChanges> NiChangesPerBand;
 
+  /**
+   * The NI changes of a band while an event is on the air.
+   */
+  struct NiChangeRange
+  {
+    NiChanges::const_iterator first; //!< the change at the start of the event
+    NiChanges::const_iterator last;  //!< the change at the end of the event
+  };
+
+  /**
+   * A position in the walk along the chunks of an event.
+   */
+  struct ChunkCursor
+  {
+    std::size_t offset;        //!< the offset from the start of the event of the change before the next chunk
+    Time previous;             //!< the start of the next chunk
+    double noiseInterferenceW; //!< the noise and interference power during the next chunk
+    double psr;                //!< the success rate of the chunks of the window before the next chunk
+  };
+
+  /**
+   * The chunks of the payload of an event already walked by
+   * CalculatePayloadPer. The PHY computes the PER of the MPDUs of an
+   * A-MPDU one after the other, at the end of each MPDU: the walk for an
+   * MPDU resumes before its first chunk, where the walk for the previous
+   * MPDU left it, and the walk for a window computed again with a later
+   * end resumes after its last chunk which may not change anymore.
+   *
+   * The cursors are offsets from the start of the event, which stay valid
+   * while the event is received: the new changes are inserted after the
+   * current time and the ledger is only pruned between receptions. The
+   * entries are dropped when the ledger is pruned, the reception ends or
+   * the powers of the past changes are updated.
+   */
+  struct PayloadPerCache
+  {
+    Time windowStart;     //!< the start of the window of the cursors
+    ChunkCursor skipped;  //!< the cursor before the first chunk of the window
+    ChunkCursor computed; //!< the cursor after the last chunk of the window which may not change
+  };
+
+  /**
+   * The event, band, station ID and channel width of a payload PER
+   * computation
+   */
+  typedef std::tuple<const Event *, WifiSpectrumBand, uint16_t, uint16_t> PayloadPerCacheKey;
+
   /**
    * Append the given Event.
    *
@@ -369,55 +434,57 @@ private:
    * Calculate noise and interference power in W.
    *
    * \param event the event
-   * \param nis the NiChanges
+   * \param range the NI changes of the band while the event is on the air
    * \param band the band
    *
    * \return noise and interference power
    */
-  double CalculateNoiseInterferenceW (Ptr<Event> event, NiChangesPerBand *nis, WifiSpectrumBand band) const;
+  double CalculateNoiseInterferenceW (Ptr<Event> event, NiChangeRange *range, WifiSpectrumBand band) const;
   /**
    * Calculate the error rate of the given PHY payload only in the provided time
    * window (thus enabling per MPDU PER information). The PHY payload can be divided into
    * multiple chunks (e.g. due to interference from other transmissions).
+   * The walk along the chunks resumes from a previous window of the same
+   * payload when possible (see PayloadPerCache).
    *
    * \param event the event
    * \param channelWidth the channel width used to transmit the PSDU (in MHz)
-   * \param nis the NiChanges
+   * \param range the NI changes of the band while the event is on the air
    * \param band identify the band used by the PSDU
    * \param staId the station ID of the PSDU (only used for MU)
    * \param window time window (pair of start and end times) of PHY payload to focus on
    *
    * \return the error rate of the payload
    */
-  double CalculatePayloadPer (Ptr<const Event> event, uint16_t channelWidth, NiChangesPerBand *nis, WifiSpectrumBand band,
+  double CalculatePayloadPer (Ptr<const Event> event, uint16_t channelWidth, const NiChangeRange &range, WifiSpectrumBand band,
                               uint16_t staId, std::pair<Time, Time> window) const;
   /**
    * Calculate the error rate of the PHY header. The PHY header
    * can be divided into multiple chunks (e.g. due to interference from other transmissions).
    *
    * \param event the event
-   * \param nis the NiChanges
+   * \param range the NI changes of the band while the event is on the air
    * \param channelWidth the channel width (in MHz) for header measurement
    * \param band the band
    * \param header the PHY header to consider
    *
    * \return the error rate of the HT PHY header
    */
-  double CalculatePhyHeaderPer (Ptr<const Event> event, NiChangesPerBand *nis,
+  double CalculatePhyHeaderPer (Ptr<const Event> event, const NiChangeRange &range,
                                 uint16_t channelWidth, WifiSpectrumBand band,
                                 WifiPpduField header) const;
   /**
    * Calculate the success rate of the PHY header sections for the provided event.
    *
    * \param event the event
-   * \param nis the NiChanges
+   * \param range the NI changes of the band while the event is on the air
    * \param channelWidth the channel width (in MHz) for header measurement
    * \param band the band
    * \param phyHeaderSections the map of PHY header sections (\see PhyEntity::PhyHeaderSections)
    *
    * \return the success rate of the PHY header sections
    */
-  double CalculatePhyHeaderSectionPsr (Ptr<const Event> event, NiChangesPerBand *nis,
+  double CalculatePhyHeaderSectionPsr (Ptr<const Event> event, const NiChangeRange &range,
                                        uint16_t channelWidth, WifiSpectrumBand band,
                                        PhyEntity::PhyHeaderSections phyHeaderSections) const;
 
@@ -427,6 +494,7 @@ private:
   NiChangesPerBand m_niChangesPerBand;                     //!< NI Changes for each band
   std::map <WifiSpectrumBand, double> m_firstPowerPerBand; //!< first power of each band in watts
   bool m_rxing;                                            //!< flag whether it is in receiving state
+  mutable std::map<PayloadPerCacheKey, PayloadPerCache> m_payloadPerCache; //!< the payload chunks walked per event
 
   /**
    * Returns an iterator to the first NiChange that is later than moment
@@ -449,12 +517,11 @@ private:
    * Add NiChange to the list at the appropriate position and
    * return the iterator of the new event.
    *
-   * \param moment time to check from
    * \param change the NiChange to add
    * \param niIt iterator of the band to check
    * \returns the iterator of the new event
    */
-  NiChanges::iterator AddNiChangeEvent (Time moment, NiChange change, NiChangesPerBand::iterator niIt);
+  NiChanges::iterator AddNiChangeEvent (NiChange change, NiChangesPerBand::iterator niIt);
 };
 
 } //namespace ns3
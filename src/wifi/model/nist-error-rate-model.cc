@@ -28,6 +28,7 @@
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("NistErrorRateModel");
+NS_LOG_HOT_PATH ();
 
 NS_OBJECT_ENSURE_REGISTERED (NistErrorRateModel);
 
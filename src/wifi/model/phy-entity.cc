@@ -69,7 +69,7 @@ std::ostream & operator << (std::ostream &os, const PhyEntity::PhyFieldRxStatus
  *       Abstract base class for PHY entities
  *******************************************************/
 
-uint64_t PhyEntity::m_globalPpduUid = 0;
+std::atomic<uint64_t> PhyEntity::m_globalPpduUid (0);
 
 PhyEntity::~PhyEntity ()
 {
@@ -360,7 +360,7 @@ PhyEntity::DoEndReceiveField (WifiPpduField field, Ptr<Event> event)
 }
 
 void
-PhyEntity::StartReceivePreamble (Ptr<WifiPpdu> ppdu, RxPowerWattPerChannelBand& rxPowersW,
+PhyEntity::StartReceivePreamble (Ptr<const WifiPpdu> ppdu, RxPowerWattPerChannelBand& rxPowersW,
                                  Time rxDuration)
 {
   //The total RX power corresponds to the maximum over all the bands
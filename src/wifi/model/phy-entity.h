@@ -33,6 +33,7 @@
 #include "ns3/simple-ref-count.h"
 #include "ns3/nstime.h"
 #include "ns3/wifi-spectrum-value-helper.h"
+#include <atomic>
 #include <list>
 #include <map>
 #include <tuple>
@@ -354,11 +355,11 @@ public:
    * This method triggers the start of the preamble detection period (\see
    * StartPreambleDetectionPeriod) if the PHY can process the PPDU.
    *
-   * \param ppdu the arriving PPDU
+   * \param ppdu the arriving PPDU, shared with the other receivers of the transmission
    * \param rxPowersW the receive power in W per band
    * \param rxDuration the duration of the PPDU
    */
-  virtual void StartReceivePreamble (Ptr<WifiPpdu> ppdu, RxPowerWattPerChannelBand& rxPowersW,
+  virtual void StartReceivePreamble (Ptr<const WifiPpdu> ppdu, RxPowerWattPerChannelBand& rxPowersW,
                                      Time rxDuration);
   /**
    * Start receiving a given field.
@@ -806,7 +807,7 @@ protected:
   std::map<UidStaIdPair, std::vector<bool> > m_statusPerMpduMap; //!< Map of the current reception status per MPDU that is filled in as long as MPDUs are being processed by the PHY in case of an A-MPDU
   std::map<UidStaIdPair, SignalNoiseDbm> m_signalNoiseMap; //!< Map of the latest signal power and noise power in dBm (noise power includes the noise figure)
 
-  static uint64_t m_globalPpduUid; //!< Global counter of the PPDU UID
+  static std::atomic<uint64_t> m_globalPpduUid; //!< Global counter of the PPDU UID
 }; //class PhyEntity
 
 /**
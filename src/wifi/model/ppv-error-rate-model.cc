@@ -1,5 +1,10 @@
 #include <cmath>
 #include "ns3/log.h"
+#include "ns3/ring-trace.h"
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
 #include "ppv-error-rate-model.h"
 #include "wifi-utils.h"
 #include "wifi-tx-vector.h"
@@ -8,9 +13,18 @@
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PpvErrorRateModel");
+NS_LOG_HOT_PATH ();
+
+/// Trace point of the chunk success rates
+NS_RING_TRACE_DEFINE (g_chunkTrace, "PpvErrorRateModel::DoGetChunkSuccessRate", "snr,nbits,psr");
 
 NS_OBJECT_ENSURE_REGISTERED (PpvErrorRateModel);
 
+/// largest magnitude of the normal cumulative distribution table argument
+static const double PPV_CDF_TABLE_MAX_Z = 10.0;
+/// step of the normal cumulative distribution table
+static const double PPV_CDF_TABLE_STEP = 0.005;
+
 TypeId
 PpvErrorRateModel::GetTypeId (void)
 {
@@ -18,48 +32,188 @@ PpvErrorRateModel::GetTypeId (void)
     .SetParent<ErrorRateModel> ()
     .SetGroupName ("Wifi")
     .AddConstructor<PpvErrorRateModel> ()
+    .AddAttribute ("Tabulated",
+                   "Read the success rate from precomputed tables instead of evaluating it for each chunk.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PpvErrorRateModel::m_tabulated),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TableMinSnr",
+                   "The lowest SNR (dB) of the tables, chunks below are evaluated exactly.",
+                   DoubleValue (-5.0),
+                   MakeDoubleAccessor (&PpvErrorRateModel::m_minSnrDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("TableMaxSnr",
+                   "The highest SNR (dB) of the tables, chunks above are evaluated exactly.",
+                   DoubleValue (35.0),
+                   MakeDoubleAccessor (&PpvErrorRateModel::m_maxSnrDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("TableSnrResolution",
+                   "The SNR step (dB) of the tables.",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&PpvErrorRateModel::m_snrResolution),
+                   MakeDoubleChecker<double> (1e-3))
   ;
   return tid;
 }
 
 PpvErrorRateModel::PpvErrorRateModel ()
+  : m_nSnr (0)
 {
 }
 
 double
-PpvErrorRateModel::DoGetChunkSuccessRate (WifiMode mode, const WifiTxVector& txVector, double snr, uint64_t nbits, uint8_t numRxAntennas, WifiPpduField field, uint16_t staId) const
+PpvErrorRateModel::CalculateSuccessRate (double snr, uint64_t nbits, double hzPerBit)
 {
-  NS_LOG_FUNCTION (this << mode << txVector << snr << nbits << +numRxAntennas << field << staId);
-  uint64_t phyRate = mode.GetPhyRate (txVector, staId);
-  double B = txVector.GetChannelWidth ()*1e6;
-  double D = ((double) nbits)/((double) phyRate);
-  if(B==0){
-    B=1e6;
-  }
+  double DB = ((double) nbits) * hzPerBit;
   if(nbits == 0){
     nbits = 100*8;
   }
   double cd = 1.-1./((1+snr)*(1+snr));
-  double nu = - (double)(nbits) * log(2) + D*B*log(1+snr);
-  double de = sqrt(D*B*cd);
+  double nu = - (double)(nbits) * log(2) + DB*log(1+snr);
+  double de = sqrt(DB*cd);
   double error = 1./2.*erfc(nu/de/sqrt(2));
-//  NS_LOG_UNCOND(error <<",  " << Simulator::Now().GetMicroSeconds()<<", " << nbits);
-//
-//  NS_LOG_UNCOND(cd <<"," << nu <<"," <<de <<"," << error <<"," <<cd <<",");
-//    NS_LOG_UNCOND(D <<"," << B<< ":"<< nu/de/sqrt(2));
-//    NS_LOG_UNCOND(-(double)(nbits) <<"," << D*B*log(1+snr));
-//    if(error>0.5)
-//      NS_LOG_UNCOND(nu << "," << de << "," << error);
-//  if (nu == 0. and de ==0.){
-//        NS_LOG_UNCOND (this << mode << txVector << snr << nbits << +numRxAntennas << field << staId);
-//        NS_LOG_UNCOND (snr <<":" << nbits <<":" << field <<":" << staId);
-//        NS_LOG_UNCOND (B <<":" << D);
-//        NS_LOG_UNCOND (nu <<"//" << de);
-//        NS_LOG_UNCOND (field);
-//  }
+  return 1.-error;
+}
+
+double
+PpvErrorRateModel::GetHzPerBit (WifiMode mode, const WifiTxVector& txVector, uint16_t staId)
+{
+  uint64_t phyRate = mode.GetPhyRate (txVector, staId);
+  double B = txVector.GetChannelWidth ()*1e6;
+  if(B==0){
+    B=1e6;
+  }
+  return B / ((double) phyRate);
+}
 
+double
+PpvErrorRateModel::LookupNormalCdf (double z)
+{
+  static const std::vector<double> table = [] ()
+    {
+      std::size_t n = static_cast<std::size_t> (std::round (2 * PPV_CDF_TABLE_MAX_Z / PPV_CDF_TABLE_STEP)) + 1;
+      std::vector<double> cdf (n);
+      for (std::size_t k = 0; k < n; k++)
+        {
+          cdf[k] = 0.5 * erfc ((PPV_CDF_TABLE_MAX_Z - k * PPV_CDF_TABLE_STEP) / sqrt (2));
+        }
+      return cdf;
+    } ();
+  double x = (z + PPV_CDF_TABLE_MAX_Z) / PPV_CDF_TABLE_STEP;
+  if (x <= 0)
+    {
+      return 0;
+    }
+  if (x >= table.size () - 1)
+    {
+      return 1;
+    }
+  std::size_t k = static_cast<std::size_t> (x);
+  return table[k] + (x - k) * (table[k + 1] - table[k]);
+}
 
-  return 1.-error;
+bool
+PpvErrorRateModel::FindSnr (double snr, std::size_t &index, double &weight) const
+{
+  if (m_nSnr == 0 || snr <= 0)
+    {
+      return false;
+    }
+  double x = (10.0 * std::log10 (snr) - m_minSnrDb) / m_snrResolution;
+  if (x < 0 || x >= m_nSnr - 1)
+    {
+      return false;
+    }
+  index = static_cast<std::size_t> (x);
+  weight = x - index;
+  return true;
+}
+
+const std::vector<double> &
+PpvErrorRateModel::GetTable (WifiMode mode, const WifiTxVector& txVector) const
+{
+  // some PHYs take the rate from the mode of the TXVECTOR rather than from the chunk mode
+  uint64_t txModeUid = txVector.GetModeInitialized () ? txVector.GetMode ().GetUid () + 1 : 0;
+  uint64_t key = (static_cast<uint64_t> (mode.GetUid ()) << 48)
+    | ((txModeUid & 0xffff) << 32)
+    | (static_cast<uint64_t> (txVector.GetChannelWidth ()) << 16)
+    | (static_cast<uint64_t> (txVector.GetGuardInterval () & 0x0fff) << 4)
+    | (txVector.GetNss () & 0x0f);
+  auto it = m_tables.find (key);
+  if (it != m_tables.end ())
+    {
+      return it->second;
+    }
+
+  if (m_nSnr == 0)
+    {
+      NS_ABORT_MSG_IF (m_maxSnrDb <= m_minSnrDb, "TableMaxSnr must be higher than TableMinSnr");
+      m_nSnr = static_cast<std::size_t> (std::floor ((m_maxSnrDb - m_minSnrDb) / m_snrResolution)) + 1;
+    }
+  NS_LOG_DEBUG ("building the table of " << mode << " with " << m_nSnr << " entries");
+  double hzPerBit = GetHzPerBit (mode, txVector, SU_STA_ID);
+  std::vector<double> table (m_nSnr);
+  for (std::size_t i = 0; i < m_nSnr; i++)
+    {
+      // Q (sqrt (n) * g) is the error rate of n bits
+      double snr = std::pow (10.0, (m_minSnrDb + i * m_snrResolution) / 10.0);
+      double cd = 1.-1./((1+snr)*(1+snr));
+      table[i] = (hzPerBit*log(1+snr) - log(2)) / sqrt(hzPerBit*cd);
+    }
+  return m_tables.emplace (key, std::move (table)).first->second;
+}
+
+double
+PpvErrorRateModel::DoGetChunkSuccessRate (WifiMode mode, const WifiTxVector& txVector, double snr, uint64_t nbits, uint8_t numRxAntennas, WifiPpduField field, uint16_t staId) const
+{
+  NS_LOG_FUNCTION (this << mode << txVector << snr << nbits << +numRxAntennas << field << staId);
+  double psr;
+  std::size_t i;
+  double w;
+  if (m_tabulated && nbits > 0 && !txVector.IsMu () && FindSnr (snr, i, w))
+    {
+      const std::vector<double> &table = GetTable (mode, txVector);
+      double margin = table[i] + w * (table[i + 1] - table[i]);
+      psr = LookupNormalCdf (sqrt ((double) nbits) * margin);
+    }
+  else
+    {
+      psr = CalculateSuccessRate (snr, nbits, GetHzPerBit (mode, txVector, staId));
+    }
+  NS_RING_TRACE (g_chunkTrace, snr, nbits, psr);
+  return psr;
+}
+
+void
+PpvErrorRateModel::GetChunkSuccessRates (const std::vector<WifiMode> &modes, const WifiTxVector& txVector,
+                                         double snr, uint64_t nbits, std::vector<double> &successRates) const
+{
+  NS_LOG_FUNCTION (this << modes.size () << txVector << snr << nbits);
+  successRates.resize (modes.size ());
+  std::size_t i = 0;
+  double w = 0;
+  bool inTable = false;
+  double sqrtBits = sqrt ((double) nbits);
+  WifiTxVector modeTxVector = txVector;
+  for (std::size_t k = 0; k < modes.size (); k++)
+    {
+      modeTxVector.SetMode (modes[k]);
+      if (m_tabulated && nbits > 0 && !txVector.IsMu ())
+        {
+          const std::vector<double> &table = GetTable (modes[k], modeTxVector);
+          if (k == 0)
+            {
+              // the SNR range is known once the first table is built
+              inTable = FindSnr (snr, i, w);
+            }
+          if (inTable)
+            {
+              successRates[k] = LookupNormalCdf (sqrtBits * (table[i] + w * (table[i + 1] - table[i])));
+              continue;
+            }
+        }
+      successRates[k] = CalculateSuccessRate (snr, nbits, GetHzPerBit (modes[k], modeTxVector, SU_STA_ID));
+    }
 }
 
 } //namespace ns3
@@ -1,10 +1,29 @@
 #ifndef PPV_ERROR_RATE_MODEL_H
 #define PPV_ERROR_RATE_MODEL_H
 
+#include <unordered_map>
+#include <vector>
 #include "error-rate-model.h"
 
 namespace ns3 {
 
+/**
+ * \ingroup wifi
+ * \brief Error rate model based on the finite blocklength normal
+ * approximation (Polyanskiy, Poor, Verdu).
+ *
+ * The error rate of a chunk of n bits is Q (sqrt (n) * g (snr)), where the
+ * normalized margin g only depends on the SNR and on the spectral
+ * efficiency of the mode. When the Tabulated attribute is set, g is read
+ * from a table precomputed for each mode every TableSnrResolution dB
+ * between TableMinSnr and TableMaxSnr, and Q from a table of the normal
+ * distribution shared by all the models, both linearly interpolated, so
+ * that no log, erfc or PHY rate computation is left on the receive path.
+ * The table of a (mode, TXVECTOR mode, channel width, guard interval,
+ * number of spatial streams) is built the first time it is used, so the
+ * table attributes must be set before the model is used. Chunks outside of
+ * the SNR range and MU transmissions are evaluated exactly.
+ */
 class PpvErrorRateModel : public ErrorRateModel
 {
 public:
@@ -12,10 +31,71 @@ public:
 
     PpvErrorRateModel ();
 
+  /**
+   * Compute the success rate of the same chunk for several modes, e.g., to
+   * pick the fastest mode that reaches a target success rate. The table
+   * position of the SNR is computed once for all the modes.
+   *
+   * \param modes the Wi-Fi modes to evaluate
+   * \param txVector TXVECTOR providing the channel width, guard interval and
+   *        number of spatial streams, its mode is set to each of the modes
+   * \param snr the SNR of the chunk (linear scale)
+   * \param nbits the number of bits in the chunk
+   * \param successRates the success rate of each mode, resized to the number of modes
+   */
+  void GetChunkSuccessRates (const std::vector<WifiMode> &modes, const WifiTxVector& txVector,
+                             double snr, uint64_t nbits, std::vector<double> &successRates) const;
+
 
 private:
   double DoGetChunkSuccessRate (WifiMode mode, const WifiTxVector& txVector, double snr, uint64_t nbits,
                                 uint8_t numRxAntennas, WifiPpduField field, uint16_t staId) const override;
+
+  /**
+   * \param snr the SNR (linear scale)
+   * \param nbits the number of bits
+   * \param hzPerBit the channel width divided by the PHY rate of the mode
+   * \return the success rate given by the closed form expression
+   */
+  static double CalculateSuccessRate (double snr, uint64_t nbits, double hzPerBit);
+
+  /**
+   * \param mode the Wi-Fi mode
+   * \param txVector the TXVECTOR
+   * \param staId the station ID for MU
+   * \return the channel width divided by the PHY rate of the mode
+   */
+  static double GetHzPerBit (WifiMode mode, const WifiTxVector& txVector, uint16_t staId);
+
+  /**
+   * \param z the argument
+   * \return the standard normal cumulative distribution at z, interpolated
+   *         from a table
+   */
+  static double LookupNormalCdf (double z);
+
+  /**
+   * \param snr the SNR (linear scale)
+   * \param index the index of the table entry below the SNR
+   * \param weight the interpolation weight of the entry above the SNR
+   * \return true if the SNR lies within the tables
+   */
+  bool FindSnr (double snr, std::size_t &index, double &weight) const;
+
+  /**
+   * \param mode the Wi-Fi mode
+   * \param txVector the TXVECTOR
+   * \return the normalized margin table of the mode, built if needed
+   */
+  const std::vector<double> & GetTable (WifiMode mode, const WifiTxVector& txVector) const;
+
+  bool m_tabulated;            //!< read the success rate from the tables
+  double m_minSnrDb;           //!< lowest SNR of the tables (dB)
+  double m_maxSnrDb;           //!< highest SNR of the tables (dB)
+  double m_snrResolution;      //!< SNR step of the tables (dB)
+  mutable std::size_t m_nSnr;  //!< number of entries of the tables, 0 until one is built
+  /// normalized margin tables, by mode key
+  mutable std::unordered_map<uint64_t, std::vector<double>> m_tables;
 };
 
 } //namespace ns3
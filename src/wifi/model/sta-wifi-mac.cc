@@ -29,6 +29,8 @@
 #include "mgt-headers.h"
 #include "snr-tag.h"
 #include "wifi-net-device.h"
+#include "twt-schedule-manager.h"
+#include "ns3/pointer.h"
 #include "ns3/ht-configuration.h"
 #include "ns3/he-configuration.h"
 
@@ -92,6 +94,14 @@ StaWifiMac::GetTypeId (void)
                    TimeValue (MilliSeconds (0)),
                    MakeTimeAccessor (&StaWifiMac::m_twtperiodicity),
                                       MakeTimeChecker ())
+    .AddAttribute ("TwtScheduleManager",
+                   "If set, the TWT schedule given by the twt* attributes is "
+                   "registered with this manager, which drives the service periods "
+                   "of all its stations with a single timer, instead of being "
+                   "scheduled by this station.",
+                   PointerValue (),
+                   MakePointerAccessor (&StaWifiMac::m_twtScheduleManager),
+                   MakePointerChecker<TwtScheduleManager> ())
     .AddAttribute ("scanningstartoffset",
                  "scanningstartoffset",
                 TimeValue (MilliSeconds (0)),
@@ -130,11 +140,28 @@ void
 StaWifiMac::DoInitialize (void)
 {
   NS_LOG_FUNCTION (this);
-  Simulator::Schedule (m_scanningstartoffset,&StaWifiMac::StartScanning, this);
+  // no scanning if the association was installed by SetAssociated
+  if (!IsAssociated ())
+    {
+      Simulator::Schedule (m_scanningstartoffset,&StaWifiMac::StartScanning, this);
+    }
   StartTWT ();
 
 }
 
+void
+StaWifiMac::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_twtScheduleManager != 0)
+    {
+      // the manager holds a reference to this MAC
+      m_twtScheduleManager->RemoveSchedule (this, false);
+      m_twtScheduleManager = 0;
+    }
+  WifiMac::DoDispose ();
+}
+
 StaWifiMac::~StaWifiMac ()
 {
   NS_LOG_FUNCTION (this);
@@ -220,6 +247,51 @@ StaWifiMac::SendProbeRequest (void)
     }
 }
 
+MgtAssocRequestHeader
+StaWifiMac::GetAssociationRequest (void) const
+{
+  MgtAssocRequestHeader assoc;
+  assoc.SetSsid (GetSsid ());
+  assoc.SetSupportedRates (GetSupportedRates ());
+  assoc.SetCapabilities (GetCapabilities ());
+  assoc.SetListenInterval (0);
+  if (GetHtSupported ())
+    {
+      assoc.SetExtendedCapabilities (GetExtendedCapabilities ());
+      assoc.SetHtCapabilities (GetHtCapabilities ());
+    }
+  if (GetVhtSupported ())
+    {
+      assoc.SetVhtCapabilities (GetVhtCapabilities ());
+    }
+  if (GetHeSupported ())
+    {
+      assoc.SetHeCapabilities (GetHeCapabilities ());
+    }
+  return assoc;
+}
+
+void
+StaWifiMac::SetAssociated (Mac48Address apAddr, Time beaconInterval, MgtAssocResponseHeader assocResp)
+{
+  NS_LOG_FUNCTION (this << apAddr << beaconInterval << assocResp);
+  NS_ABORT_MSG_IF (!assocResp.GetStatusCode ().IsSuccess (), "Association refused by " << apAddr);
+  m_candidateAps.clear ();
+  m_probeRequestEvent.Cancel ();
+  m_waitBeaconEvent.Cancel ();
+  m_assocRequestEvent.Cancel ();
+  SetBssid (apAddr);
+  SetState (ASSOCIATED);
+  m_aid = assocResp.GetAssociationId ();
+  NS_LOG_DEBUG ("association installed with " << apAddr << ", AID " << m_aid);
+  UpdateApInfoFromAssocResp (assocResp, apAddr);
+  RestartBeaconWatchdog (beaconInterval * m_maxMissedBeacons);
+  if (!m_linkUp.IsNull ())
+    {
+      m_linkUp ();
+    }
+}
+
 void
 StaWifiMac::SendAssociationRequest (bool isReassoc)
 {
@@ -234,25 +306,7 @@ StaWifiMac::SendAssociationRequest (bool isReassoc)
   Ptr<Packet> packet = Create<Packet> ();
   if (!isReassoc)
     {
-      MgtAssocRequestHeader assoc;
-      assoc.SetSsid (GetSsid ());
-      assoc.SetSupportedRates (GetSupportedRates ());
-      assoc.SetCapabilities (GetCapabilities ());
-      assoc.SetListenInterval (0);
-      if (GetHtSupported ())
-        {
-          assoc.SetExtendedCapabilities (GetExtendedCapabilities ());
-          assoc.SetHtCapabilities (GetHtCapabilities ());
-        }
-      if (GetVhtSupported ())
-        {
-          assoc.SetVhtCapabilities (GetVhtCapabilities ());
-        }
-      if (GetHeSupported ())
-        {
-          assoc.SetHeCapabilities (GetHeCapabilities ());
-        }
-      packet->AddHeader (assoc);
+      packet->AddHeader (GetAssociationRequest ());
     }
   else
     {
@@ -1222,6 +1276,16 @@ StaWifiMac::NotifyChannelSwitching (void)
 void
 StaWifiMac::StartTWT(void) {
     NS_LOG_FUNCTION (this);
+    if (m_twtScheduleManager != 0)
+      {
+        // the schedule may already have been set through the manager
+        if (m_twtduration.IsStrictlyPositive () && !m_twtScheduleManager->HasSchedule (this))
+          {
+            m_twtScheduleManager->SetSchedule (this, {m_twtstarttime, m_twtoffset,
+                                                      m_twtduration, m_twtperiodicity});
+          }
+        return;
+      }
     if(m_twtduration.IsStrictlyPositive()){
 //        NS_LOG_UNCOND("start twt");
         Simulator::Schedule(m_twtstarttime-Seconds(0.1),&WifiMac::NotifyTWTSleep,this);
@@ -34,6 +34,7 @@ namespace ns3  {
 
 class SupportedRates;
 class CapabilityInformation;
+class TwtScheduleManager;
 
 /**
  * \ingroup wifi
@@ -151,6 +152,26 @@ public:
    */
   uint16_t GetAssociationId (void) const;
 
+  /**
+   * Return the association request this station sends to an AP.
+   *
+   * \return the association request
+   */
+  MgtAssocRequestHeader GetAssociationRequest (void) const;
+  /**
+   * Install the association with an AP without any frame exchange, e.g., to
+   * set up a static topology before the simulation starts. The association
+   * response is processed as if it had been received from the AP, and no
+   * scanning is performed when the MAC is initialized afterwards.
+   *
+   * \param apAddr the MAC address of the AP, which is also the BSSID
+   * \param beaconInterval the beacon interval of the AP
+   * \param assocResp the association response of the AP
+   *
+   * \see ApWifiMac::AssociateStation
+   */
+  void SetAssociated (Mac48Address apAddr, Time beaconInterval, MgtAssocResponseHeader assocResp);
+
   void NotifyChannelSwitching (void) override;
 
 private:
@@ -320,6 +341,7 @@ private:
   void PhyCapabilitiesChanged (void);
 
   void DoInitialize (void) override;
+  void DoDispose (void) override;
 
     void StartTWT(void);
     void ScheduleTWT(void);
@@ -348,6 +370,7 @@ private:
     Time m_twtoffset;    ///< m_twtoffset
     Time m_twtduration;  ///< m_twtduration
     Time m_twtperiodicity;  ///< m_twtperiodicity
+  Ptr<TwtScheduleManager> m_twtScheduleManager; ///< shared TWT scheduler, if any
 
 
   TracedCallback<Mac48Address> m_assocLogger;   ///< association logger
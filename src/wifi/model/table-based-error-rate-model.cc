@@ -39,6 +39,7 @@ static const double TABLED_BASED_ERROR_MODEL_PRECISION = 1e-5; //!< precision fo
 NS_OBJECT_ENSURE_REGISTERED (TableBasedErrorRateModel);
 
 NS_LOG_COMPONENT_DEFINE ("TableBasedErrorRateModel");
+NS_LOG_HOT_PATH ();
 
 TypeId
 TableBasedErrorRateModel::GetTypeId (void)
@@ -0,0 +1,312 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "twt-schedule-manager.h"
+#include "wifi-mac.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TwtScheduleManager");
+
+NS_OBJECT_ENSURE_REGISTERED (TwtScheduleManager);
+
+/// Stations go to sleep this long before the start time of their schedule
+static const Time TWT_FIRST_SLEEP_ADVANCE = MilliSeconds (100);
+
+TypeId
+TwtScheduleManager::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TwtScheduleManager")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<TwtScheduleManager> ()
+    .AddTraceSource ("StateChange",
+                     "A station was put to sleep or woken up.",
+                     MakeTraceSourceAccessor (&TwtScheduleManager::m_stateChangeTrace),
+                     "ns3::TwtScheduleManager::StateChangeCallback")
+  ;
+  return tid;
+}
+
+TwtScheduleManager::TwtScheduleManager ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TwtScheduleManager::~TwtScheduleManager ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+void
+TwtScheduleManager::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_timer.Cancel ();
+  m_entries.clear ();
+  m_entryOf.clear ();
+  m_freeEntries.clear ();
+  m_boundaries = decltype (m_boundaries) ();
+  Object::DoDispose ();
+}
+
+bool
+TwtScheduleManager::Boundary::operator> (const Boundary &other) const
+{
+  if (time != other.time)
+    {
+      return time > other.time;
+    }
+  if (type != other.type)
+    {
+      return type > other.type;
+    }
+  return entry > other.entry;
+}
+
+void
+TwtScheduleManager::SetSchedule (Ptr<WifiMac> mac, const Schedule &schedule)
+{
+  NS_LOG_FUNCTION (this << mac << schedule.start << schedule.offset
+                        << schedule.duration << schedule.periodicity);
+  DoSetSchedule (mac, schedule);
+  Rearm ();
+}
+
+void
+TwtScheduleManager::SetSchedules (const std::vector<Ptr<WifiMac> > &macs,
+                                  const std::vector<Schedule> &schedules)
+{
+  NS_LOG_FUNCTION (this << macs.size ());
+  NS_ASSERT_MSG (macs.size () == schedules.size (), "One schedule is needed per station");
+  for (std::size_t i = 0; i < macs.size (); i++)
+    {
+      DoSetSchedule (macs[i], schedules[i]);
+    }
+  Rearm ();
+}
+
+void
+TwtScheduleManager::RemoveSchedule (Ptr<WifiMac> mac, bool wakeUp)
+{
+  NS_LOG_FUNCTION (this << mac << wakeUp);
+  auto it = m_entryOf.find (PeekPointer (mac));
+  if (it == m_entryOf.end ())
+    {
+      return;
+    }
+  Entry &entry = m_entries[it->second];
+  if (wakeUp)
+    {
+      SetSleeping (entry, false);
+    }
+  // pending boundaries of the station become stale
+  entry.generation++;
+  entry.mac = nullptr;
+  m_freeEntries.push_back (it->second);
+  m_entryOf.erase (it);
+  Rearm ();
+}
+
+bool
+TwtScheduleManager::HasSchedule (Ptr<WifiMac> mac) const
+{
+  return m_entryOf.find (PeekPointer (mac)) != m_entryOf.end ();
+}
+
+std::size_t
+TwtScheduleManager::GetNSchedules (void) const
+{
+  return m_entryOf.size ();
+}
+
+void
+TwtScheduleManager::DoSetSchedule (Ptr<WifiMac> mac, const Schedule &schedule)
+{
+  NS_ASSERT (mac != nullptr);
+  NS_ASSERT_MSG (!schedule.offset.IsStrictlyNegative () && !schedule.periodicity.IsStrictlyNegative (),
+                 "Invalid TWT schedule");
+  if (!schedule.duration.IsStrictlyPositive ())
+    {
+      RemoveSchedule (mac);
+      return;
+    }
+
+  std::size_t index;
+  auto it = m_entryOf.find (PeekPointer (mac));
+  if (it != m_entryOf.end ())
+    {
+      index = it->second;
+      m_entries[index].generation++;
+    }
+  else if (!m_freeEntries.empty ())
+    {
+      index = m_freeEntries.back ();
+      m_freeEntries.pop_back ();
+      m_entries[index].generation++;
+      m_entries[index].sleeping = false;
+      m_entryOf[PeekPointer (mac)] = index;
+    }
+  else
+    {
+      index = m_entries.size ();
+      m_entries.push_back (Entry {nullptr, Schedule (), 0, false});
+      m_entryOf[PeekPointer (mac)] = index;
+    }
+  Entry &entry = m_entries[index];
+  entry.mac = mac;
+  entry.schedule = schedule;
+
+  // queue the next boundaries and put the station in the state the new
+  // schedule gives at the current time
+  Time now = Simulator::Now ();
+  Time firstSleep = schedule.start - TWT_FIRST_SLEEP_ADVANCE;
+  uint64_t nAwake = QueueNext (index, AWAKE, now);
+  uint64_t nSleep = QueueNext (index, SLEEP, now);
+  if (firstSleep > now)
+    {
+      Queue (index, FIRST_SLEEP, 0);
+      SetSleeping (entry, false);
+    }
+  else
+    {
+      // awake if more service periods have started than ended
+      SetSleeping (entry, nAwake <= nSleep);
+    }
+}
+
+uint64_t
+TwtScheduleManager::QueueNext (std::size_t index, BoundaryType type, Time now)
+{
+  const Schedule &schedule = m_entries[index].schedule;
+  Time first = schedule.start + schedule.offset;
+  if (type == SLEEP)
+    {
+      first += schedule.duration;
+    }
+  uint64_t period = 0;
+  if (first <= now)
+    {
+      period = schedule.periodicity.IsZero () ? 1
+        : (now - first).GetTimeStep () / schedule.periodicity.GetTimeStep () + 1;
+    }
+  Queue (index, type, period);
+  return period;
+}
+
+void
+TwtScheduleManager::Queue (std::size_t index, BoundaryType type, uint64_t period)
+{
+  const Entry &entry = m_entries[index];
+  const Schedule &schedule = entry.schedule;
+  Time time;
+  switch (type)
+    {
+    case FIRST_SLEEP:
+      time = schedule.start - TWT_FIRST_SLEEP_ADVANCE;
+      break;
+    case AWAKE:
+    case SLEEP:
+      if (schedule.periodicity.IsZero () && period > 0)
+        {
+          // single service period
+          return;
+        }
+      time = schedule.start + schedule.periodicity * period + schedule.offset;
+      if (type == SLEEP)
+        {
+          time += schedule.duration;
+        }
+      break;
+    }
+  m_boundaries.push (Boundary {time, type, index, entry.generation, period});
+}
+
+void
+TwtScheduleManager::SetSleeping (Entry &entry, bool sleeping)
+{
+  if (entry.sleeping == sleeping)
+    {
+      return;
+    }
+  NS_LOG_DEBUG ("TWT " << (sleeping ? "sleep" : "awake") << " for " << entry.mac);
+  entry.sleeping = sleeping;
+  m_stateChangeTrace (entry.mac, sleeping);
+  if (sleeping)
+    {
+      entry.mac->NotifyTWTSleep ();
+    }
+  else
+    {
+      entry.mac->NotifyTWTAwake ();
+    }
+}
+
+bool
+TwtScheduleManager::IsCurrent (const Boundary &boundary) const
+{
+  return m_entries[boundary.entry].generation == boundary.generation;
+}
+
+void
+TwtScheduleManager::Rearm (void)
+{
+  while (!m_boundaries.empty () && !IsCurrent (m_boundaries.top ()))
+    {
+      m_boundaries.pop ();
+    }
+  if (m_boundaries.empty ())
+    {
+      m_timer.Cancel ();
+      return;
+    }
+  Time next = m_boundaries.top ().time;
+  Time now = Simulator::Now ();
+  if (m_timer.IsRunning () && now + Simulator::GetDelayLeft (m_timer) == next)
+    {
+      return;
+    }
+  m_timer.Cancel ();
+  m_timer = Simulator::Schedule (next - now, &TwtScheduleManager::Expire, this);
+}
+
+void
+TwtScheduleManager::Expire (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  // boundaries pop sorted by type, so that all the stations going to sleep
+  // do so before any station wakes up
+  while (!m_boundaries.empty () && m_boundaries.top ().time <= now)
+    {
+      Boundary boundary = m_boundaries.top ();
+      m_boundaries.pop ();
+      if (!IsCurrent (boundary))
+        {
+          continue;
+        }
+      if (boundary.type != FIRST_SLEEP)
+        {
+          Queue (boundary.entry, boundary.type, boundary.period + 1);
+        }
+      SetSleeping (m_entries[boundary.entry], boundary.type != AWAKE);
+    }
+  Rearm ();
+}
+
+} //namespace ns3
@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TWT_SCHEDULE_MANAGER_H
+#define TWT_SCHEDULE_MANAGER_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-callback.h"
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+class WifiMac;
+
+/**
+ * \ingroup wifi
+ *
+ * \brief Drive the TWT service periods of many stations with a single timer.
+ *
+ * The manager holds the TWT schedule of every registered station in one
+ * table and keeps a single timer armed at the next wake or sleep boundary
+ * of any station. When the timer expires, all the stations whose service
+ * period starts or ends at that time are woken up or put to sleep in a
+ * batch, so the number of pending events does not grow with the number
+ * of stations, and stations sharing the same boundaries cost one event.
+ *
+ * A schedule follows the semantics of the StaWifiMac TWT attributes: the
+ * station goes to sleep 100 ms before the start time, then for every
+ * k >= 0 it is awake from start + k * periodicity + offset for the
+ * duration of the service period. A null periodicity gives a single
+ * service period, and a null duration removes the schedule and wakes the
+ * station up.
+ *
+ * Schedules can be replaced at any time, e.g., by a new action of a gym
+ * agent: the station is immediately put in the state its new schedule
+ * gives at the current time. When both a station goes to sleep and
+ * another one wakes up at the same time, sleeps are applied first.
+ */
+class TwtScheduleManager : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * The TWT schedule of a station.
+   */
+  struct Schedule
+  {
+    Time start;       //!< absolute time of the first period
+    Time offset;      //!< offset of the service period in each period
+    Time duration;    //!< duration of the service period
+    Time periodicity; //!< TWT period
+  };
+
+  TwtScheduleManager ();
+  virtual ~TwtScheduleManager ();
+
+  /**
+   * Set or replace the schedule of a station.
+   *
+   * \param mac the MAC of the station
+   * \param schedule the TWT schedule
+   */
+  void SetSchedule (Ptr<WifiMac> mac, const Schedule &schedule);
+  /**
+   * Set or replace the schedules of several stations at once.
+   *
+   * \param macs the MACs of the stations
+   * \param schedules the TWT schedule of each station
+   */
+  void SetSchedules (const std::vector<Ptr<WifiMac> > &macs, const std::vector<Schedule> &schedules);
+  /**
+   * Remove the schedule of a station.
+   *
+   * \param mac the MAC of the station
+   * \param wakeUp whether to wake the station up if it is sleeping, which
+   *        must be false if the MAC is being disposed of
+   */
+  void RemoveSchedule (Ptr<WifiMac> mac, bool wakeUp = true);
+  /**
+   * \param mac the MAC of a station
+   * \return true if the station has a schedule
+   */
+  bool HasSchedule (Ptr<WifiMac> mac) const;
+  /**
+   * \return the number of stations with a schedule
+   */
+  std::size_t GetNSchedules (void) const;
+
+  /**
+   * TracedCallback signature for TWT state changes.
+   *
+   * \param mac the MAC of the station
+   * \param sleeping true if the station goes to sleep, false if it wakes up
+   */
+  typedef void (* StateChangeCallback)(Ptr<WifiMac> mac, bool sleeping);
+
+protected:
+  void DoDispose (void) override;
+
+private:
+  /// Kind of boundary, sleeps sort before wake-ups at the same time
+  enum BoundaryType : uint8_t
+  {
+    FIRST_SLEEP = 0, //!< sleep before the start time
+    SLEEP,           //!< end of a service period
+    AWAKE            //!< start of a service period
+  };
+
+  /// A pending boundary of a station
+  struct Boundary
+  {
+    Time time;           //!< time of the boundary
+    BoundaryType type;   //!< kind of boundary
+    std::size_t entry;   //!< index of the station in the table
+    uint32_t generation; //!< generation of the schedule of the station
+    uint64_t period;     //!< index of the TWT period of the boundary
+
+    /**
+     * \param other the other boundary
+     * \return true if this boundary comes after the other one
+     */
+    bool operator> (const Boundary &other) const;
+  };
+
+  /// A station in the table
+  struct Entry
+  {
+    Ptr<WifiMac> mac;    //!< MAC of the station, null if the entry is free
+    Schedule schedule;   //!< TWT schedule of the station
+    uint32_t generation; //!< incremented each time the schedule is replaced
+    bool sleeping;       //!< whether the manager has put the station to sleep
+  };
+
+  /**
+   * Replace the schedule of a station without rearming the timer.
+   *
+   * \param mac the MAC of the station
+   * \param schedule the TWT schedule
+   */
+  void DoSetSchedule (Ptr<WifiMac> mac, const Schedule &schedule);
+  /**
+   * Queue the first boundary of the given type at or after the current
+   * time.
+   *
+   * \param index the index of the station in the table
+   * \param type the kind of boundary, SLEEP or AWAKE
+   * \param now the current time
+   * \return the index of the period of the queued boundary, which is also
+   *         the number of such boundaries that are in the past
+   */
+  uint64_t QueueNext (std::size_t index, BoundaryType type, Time now);
+  /**
+   * Queue a boundary of a station.
+   *
+   * \param index the index of the station in the table
+   * \param type the kind of boundary
+   * \param period the index of the TWT period
+   */
+  void Queue (std::size_t index, BoundaryType type, uint64_t period);
+  /**
+   * Put a station in the given state, if it is not already in it.
+   *
+   * \param entry the station
+   * \param sleeping the new state
+   */
+  void SetSleeping (Entry &entry, bool sleeping);
+  /**
+   * \param boundary a boundary from the queue
+   * \return true if the schedule of the station has not been replaced since
+   */
+  bool IsCurrent (const Boundary &boundary) const;
+  /// Arm the timer at the earliest pending boundary
+  void Rearm (void);
+  /// Apply all the boundaries that expire now
+  void Expire (void);
+
+  std::vector<Entry> m_entries;                                 //!< table of the stations
+  std::unordered_map<const WifiMac *, std::size_t> m_entryOf;   //!< index of each station in the table
+  std::vector<std::size_t> m_freeEntries;                       //!< free indices of the table
+  std::priority_queue<Boundary, std::vector<Boundary>, std::greater<Boundary> > m_boundaries; //!< pending boundaries
+  EventId m_timer;                                              //!< timer of the earliest boundary
+
+  TracedCallback<Ptr<WifiMac>, bool> m_stateChangeTrace;       //!< TWT state change trace source
+};
+
+} //namespace ns3
+
+#endif /* TWT_SCHEDULE_MANAGER_H */
@@ -30,6 +30,7 @@
 #include "amsdu-subframe-header.h"
 #include "qos-utils.h"
 #include <list>
+#include <map>
 
 namespace ns3 {
 
@@ -206,6 +207,30 @@ private:
 
   friend class WifiMacQueue;  // to set queue AC and iterator information
 
+  /**
+   * An intrusive list of queued MPDUs, kept by a WifiMacQueue in addition to
+   * the FIFO list of all the queued MPDUs. The items of a list appear in the
+   * same relative order as in the FIFO list.
+   */
+  struct List
+  {
+    WifiMacQueueItem *head {nullptr};  //!< first item of the list
+    WifiMacQueueItem *tail {nullptr};  //!< last item of the list
+    uint32_t nPackets {0};             //!< number of items in the list
+    uint32_t nBytes {0};               //!< sum of the sizes of the items in the list
+  };
+
+  /// Links of this MPDU in one of the intrusive lists of the queue it is stored into
+  struct Hook
+  {
+    List *list {nullptr};              //!< the list this MPDU belongs to, if any
+    WifiMacQueueItem *prev {nullptr};  //!< previous item of the list
+    WifiMacQueueItem *next {nullptr};  //!< next item of the list
+  };
+
+  /// Queued MPDUs sorted by increasing timestamp
+  typedef std::multimap<Time, WifiMacQueueItem *> ExpiryIndex;
+
   Ptr<const Packet> m_packet;                   //!< The packet (MSDU or A-MSDU) contained in this queue item
   WifiMacHeader m_header;                       //!< Wifi MAC header associated with the packet
   Time m_tstamp;                                //!< timestamp when the packet arrived at the queue
@@ -213,6 +238,9 @@ private:
   ConstIterator m_queueIt;                      //!< Queue iterator pointing to this MPDU, if queued
   AcIndex m_queueAc;                            //!< AC associated with the queue this MPDU is stored into
   bool m_inFlight;                              //!< whether the MPDU is in flight
+  Hook m_addrHook;                              //!< links in the list of Data frames sent to Addr1
+  Hook m_tidHook;                               //!< links in the list of QoS Data frames sent to Addr1 with the same TID
+  ExpiryIndex::iterator m_expiryIt;             //!< entry of this MPDU in the expiry index, if queued
 };
 
 /**
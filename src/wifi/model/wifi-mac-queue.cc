@@ -50,6 +50,14 @@ WifiMacQueue::GetTypeId (void)
                    TimeValue (MilliSeconds (500)),
                    MakeTimeAccessor (&WifiMacQueue::SetMaxDelay),
                    MakeTimeChecker ())
+    .AddAttribute ("ExpiryGranularity",
+                   "If strictly positive, packets whose lifetime expired are dropped together "
+                   "at multiples of this interval and their lifetime is not checked when they "
+                   "are accessed. If null, expired packets are dropped when accessed.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&WifiMacQueue::SetExpiryGranularity,
+                                     &WifiMacQueue::GetExpiryGranularity),
+                   MakeTimeChecker (Seconds (0)))
     .AddAttribute ("DropPolicy", "Upon enqueue with full queue, drop oldest (DropOldest) or newest (DropNewest) packet",
                    EnumValue (DROP_OLDEST),
                    MakeEnumAccessor (&WifiMacQueue::m_dropPolicy),
@@ -71,19 +79,36 @@ WifiMacQueue::WifiMacQueue (AcIndex ac)
 WifiMacQueue::~WifiMacQueue ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_nQueuedPackets.clear ();
-  m_nQueuedBytes.clear ();
+}
+
+void
+WifiMacQueue::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_expiryEvent.Cancel ();
+  for (auto it = begin (); it != end (); it++)
+    {
+      (*it)->m_addrHook = {};
+      (*it)->m_tidHook = {};
+    }
+  m_addrLists.clear ();
+  m_tidLists.clear ();
+  m_expiryIndex.clear ();
+  Queue<WifiMacQueueItem>::DoDispose ();
+}
+
+bool
+WifiMacQueue::IsStale (const WifiMacQueueItem *item, const Time& now) const
+{
+  return m_expiryGranularity.IsZero () && now > item->GetTimeStamp () + m_maxDelay;
 }
 
 bool
 WifiMacQueue::TtlExceeded (ConstIterator &it, const Time& now)
 {
-  if (now > (*it)->GetTimeStamp () + m_maxDelay)
+  if (IsStale (PeekPointer (*it), now))
     {
-      NS_LOG_DEBUG ("Removing packet that stayed in the queue for too long (" <<
-                    now - (*it)->GetTimeStamp () << ")");
-      auto curr = it++;
-      m_traceExpired (DoRemove (curr));
+      Expire (it, now);
       return true;
     }
   return false;
@@ -93,8 +118,63 @@ bool
 WifiMacQueue::TtlExceeded (Ptr<const WifiMacQueueItem> item, const Time& now)
 {
   NS_ASSERT (item != nullptr && item->IsQueued ());
-  auto it = item->m_queueIt;
-  return TtlExceeded (it, now);
+  if (now > item->GetTimeStamp () + m_maxDelay)
+    {
+      auto it = item->m_queueIt;
+      Expire (it, now);
+      return true;
+    }
+  return false;
+}
+
+void
+WifiMacQueue::Expire (ConstIterator &it, const Time& now)
+{
+  NS_LOG_DEBUG ("Removing packet that stayed in the queue for too long (" <<
+                now - (*it)->GetTimeStamp () << ")");
+  auto curr = it++;
+  m_traceExpired (DoRemove (curr));
+}
+
+void
+WifiMacQueue::RemoveExpired (const Time& now)
+{
+  while (!m_expiryIndex.empty () && now > m_expiryIndex.begin ()->first + m_maxDelay)
+    {
+      ConstIterator it = m_expiryIndex.begin ()->second->m_queueIt;
+      Expire (it, now);
+    }
+}
+
+void
+WifiMacQueue::ScheduleExpiry (void)
+{
+  if (m_expiryGranularity.IsZero () || m_expiryIndex.empty ())
+    {
+      return;
+    }
+
+  // an item expires when the current time exceeds the sum of its timestamp
+  // and the max delay, hence it is dropped at the first tick after such sum
+  int64_t granularity = m_expiryGranularity.GetTimeStep ();
+  int64_t lifetimeEnd = (m_expiryIndex.begin ()->first + m_maxDelay).GetTimeStep ();
+  Time tick = TimeStep ((lifetimeEnd / granularity + 1) * granularity);
+
+  if (m_expiryEvent.IsRunning () && m_expiryEvent.GetTs () <= static_cast<uint64_t> (tick.GetTimeStep ()))
+    {
+      return;
+    }
+  m_expiryEvent.Cancel ();
+  m_expiryEvent = Simulator::Schedule (Max (tick - Simulator::Now (), Time (0)),
+                                       &WifiMacQueue::ExpireBatch, this);
+}
+
+void
+WifiMacQueue::ExpireBatch (void)
+{
+  NS_LOG_FUNCTION (this);
+  RemoveExpired (Simulator::Now ());
+  ScheduleExpiry ();
 }
 
 void
@@ -102,6 +182,8 @@ WifiMacQueue::SetMaxDelay (Time delay)
 {
   NS_LOG_FUNCTION (this << delay);
   m_maxDelay = delay;
+  m_expiryEvent.Cancel ();
+  ScheduleExpiry ();
 }
 
 Time
@@ -110,6 +192,22 @@ WifiMacQueue::GetMaxDelay (void) const
   return m_maxDelay;
 }
 
+void
+WifiMacQueue::SetExpiryGranularity (Time granularity)
+{
+  NS_LOG_FUNCTION (this << granularity);
+  NS_ABORT_MSG_IF (granularity.IsStrictlyNegative (), "The expiry granularity cannot be negative");
+  m_expiryGranularity = granularity;
+  m_expiryEvent.Cancel ();
+  ScheduleExpiry ();
+}
+
+Time
+WifiMacQueue::GetExpiryGranularity (void) const
+{
+  return m_expiryGranularity;
+}
+
 bool
 WifiMacQueue::Enqueue (Ptr<WifiMacQueueItem> item)
 {
@@ -139,20 +237,17 @@ WifiMacQueue::Insert (ConstIterator pos, Ptr<WifiMacQueueItem> item)
       return DoEnqueue (pos, item);
     }
 
-  // the queue is full; scan the list in the attempt to remove stale packets
-  ConstIterator it = begin ();
+  // the queue is full; remove the oldest packet if it is stale
   const Time now = Simulator::Now ();
-  while (it != end ())
+  if (!m_expiryIndex.empty ())
     {
-      if (it == pos && TtlExceeded (it, now))
-        {
-          return DoEnqueue (it, item);
-        }
+      ConstIterator it = m_expiryIndex.begin ()->second->m_queueIt;
+      bool atPos = (it == pos);
       if (TtlExceeded (it, now))
         {
-          return DoEnqueue (pos, item);
+          // it now points to the item following the removed one
+          return DoEnqueue (atPos ? it : pos, item);
         }
-      it++;
     }
 
   // the queue is still full, remove the oldest item if the policy is drop oldest
@@ -213,7 +308,7 @@ WifiMacQueue::Peek (void) const
     {
       // skip packets that stayed in the queue for too long. They will be
       // actually removed from the queue by the next call to a non-const method
-      if (now <= (*it)->GetTimeStamp () + m_maxDelay)
+      if (!IsStale (PeekPointer (*it), now))
         {
           return DoPeek (it);
         }
@@ -228,13 +323,29 @@ WifiMacQueue::PeekByAddress (Mac48Address dest, Ptr<const WifiMacQueueItem> item
   NS_LOG_FUNCTION (this << dest << item);
   NS_ASSERT (item == nullptr || item->IsQueued ());
 
-  ConstIterator it = (item != nullptr ? std::next (item->m_queueIt) : begin ());
   const Time now = Simulator::Now ();
+  auto listIt = m_addrLists.find (dest);
+  if (listIt == m_addrLists.end ())
+    {
+      NS_LOG_DEBUG ("No packet for the given destination");
+      return nullptr;
+    }
+  if (item == nullptr)
+    {
+      return PeekList (listIt->second.head, &WifiMacQueueItem::m_addrHook, now);
+    }
+  if (item->m_addrHook.list == &listIt->second)
+    {
+      return PeekList (item->m_addrHook.next, &WifiMacQueueItem::m_addrHook, now);
+    }
+
+  // the given item is not in the list, hence look for its successor in the list
+  ConstIterator it = std::next (item->m_queueIt);
   while (it != end ())
     {
       // skip packets that stayed in the queue for too long. They will be
       // actually removed from the queue by the next call to a non-const method
-      if (now <= (*it)->GetTimeStamp () + m_maxDelay)
+      if (!IsStale (PeekPointer (*it), now))
         {
           if (((*it)->GetHeader ().IsData () || (*it)->GetHeader ().IsQosData ())
               && (*it)->GetDestinationAddress () == dest)
@@ -260,7 +371,7 @@ WifiMacQueue::PeekByTid (uint8_t tid, Ptr<const WifiMacQueueItem> item) const
     {
       // skip packets that stayed in the queue for too long. They will be
       // actually removed from the queue by the next call to a non-const method
-      if (now <= (*it)->GetTimeStamp () + m_maxDelay)
+      if (!IsStale (PeekPointer (*it), now))
         {
           if ((*it)->GetHeader ().IsQosData () && (*it)->GetHeader ().GetQosTid () == tid)
             {
@@ -279,13 +390,29 @@ WifiMacQueue::PeekByTidAndAddress (uint8_t tid, Mac48Address dest, Ptr<const Wif
   NS_LOG_FUNCTION (this << +tid << dest << item);
   NS_ASSERT (item == nullptr || item->IsQueued ());
 
-  ConstIterator it = (item != nullptr ? std::next (item->m_queueIt) : begin ());
   const Time now = Simulator::Now ();
+  auto listIt = m_tidLists.find ({dest, tid});
+  if (listIt == m_tidLists.end ())
+    {
+      NS_LOG_DEBUG ("No packet for the given destination and TID");
+      return nullptr;
+    }
+  if (item == nullptr)
+    {
+      return PeekList (listIt->second.head, &WifiMacQueueItem::m_tidHook, now);
+    }
+  if (item->m_tidHook.list == &listIt->second)
+    {
+      return PeekList (item->m_tidHook.next, &WifiMacQueueItem::m_tidHook, now);
+    }
+
+  // the given item is not in the list, hence look for its successor in the list
+  ConstIterator it = std::next (item->m_queueIt);
   while (it != end ())
     {
       // skip packets that stayed in the queue for too long. They will be
       // actually removed from the queue by the next call to a non-const method
-      if (now <= (*it)->GetTimeStamp () + m_maxDelay)
+      if (!IsStale (PeekPointer (*it), now))
         {
           if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
               && (*it)->GetHeader ().GetQosTid () == tid)
@@ -299,6 +426,24 @@ WifiMacQueue::PeekByTidAndAddress (uint8_t tid, Mac48Address dest, Ptr<const Wif
   return nullptr;
 }
 
+Ptr<const WifiMacQueueItem>
+WifiMacQueue::PeekList (const WifiMacQueueItem *item, WifiMacQueueItem::Hook WifiMacQueueItem::*hook,
+                        const Time& now) const
+{
+  while (item != nullptr)
+    {
+      // skip packets that stayed in the queue for too long. They will be
+      // actually removed from the queue by the next call to a non-const method
+      if (!IsStale (item, now))
+        {
+          return *item->m_queueIt;
+        }
+      item = (item->*hook).next;
+    }
+  NS_LOG_DEBUG ("The queue is empty");
+  return nullptr;
+}
+
 Ptr<const WifiMacQueueItem>
 WifiMacQueue::PeekFirstAvailable (const Ptr<QosBlockedDestinations> blockedPackets,
                                   Ptr<const WifiMacQueueItem> item) const
@@ -312,7 +457,7 @@ WifiMacQueue::PeekFirstAvailable (const Ptr<QosBlockedDestinations> blockedPacke
     {
       // skip packets that stayed in the queue for too long. They will be
       // actually removed from the queue by the next call to a non-const method
-      if (now <= (*it)->GetTimeStamp () + m_maxDelay)
+      if (!IsStale (PeekPointer (*it), now))
         {
           if (!(*it)->GetHeader ().IsQosData () || !blockedPackets
               || !blockedPackets->IsBlocked ((*it)->GetHeader ().GetAddr1 (), (*it)->GetHeader ().GetQosTid ()))
@@ -349,7 +494,7 @@ WifiMacQueue::Remove (Ptr<const WifiMacQueueItem> item, bool removeExpired)
   NS_LOG_FUNCTION (this << item << removeExpired);
   NS_ASSERT (item != 0 && item->IsQueued ());
 
-  if (!removeExpired)
+  if (!removeExpired || !m_expiryGranularity.IsZero ())
     {
       ConstIterator next = std::next (item->m_queueIt);
       DoRemove (item->m_queueIt);
@@ -387,8 +532,9 @@ WifiMacQueue::Replace (Ptr<const WifiMacQueueItem> currentItem, Ptr<WifiMacQueue
   NS_ASSERT (!newItem->IsQueued ());
 
   auto pos = std::next (currentItem->m_queueIt);
+  Place place {currentItem->m_addrHook, currentItem->m_tidHook};
   DoDequeue (currentItem->m_queueIt);
-  bool ret = Insert (pos, newItem);
+  bool ret = DoEnqueue (pos, newItem, &place);
   // The size of a WifiMacQueue is measured as number of packets. We dequeued
   // one packet, so there is certainly room for inserting one packet
   NS_ABORT_IF (!ret);
@@ -399,21 +545,13 @@ WifiMacQueue::GetNPacketsByAddress (Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
 
-  uint32_t nPackets = 0;
-  const Time now = Simulator::Now ();
-
-  for (ConstIterator it = begin (); it != end (); )
+  if (m_expiryGranularity.IsZero ())
     {
-      if (!TtlExceeded (it, now))
-        {
-          if ((*it)->GetHeader ().IsData () && (*it)->GetDestinationAddress () == dest)
-            {
-              nPackets++;
-            }
-
-          it++;
-        }
+      RemoveExpired (Simulator::Now ());
     }
+
+  auto it = m_addrLists.find (dest);
+  uint32_t nPackets = (it != m_addrLists.end () ? it->second.nPackets : 0);
   NS_LOG_DEBUG ("returns " << nPackets);
   return nPackets;
 }
@@ -422,22 +560,13 @@ uint32_t
 WifiMacQueue::GetNPacketsByTidAndAddress (uint8_t tid, Mac48Address dest)
 {
   NS_LOG_FUNCTION (this << dest);
-  uint32_t nPackets = 0;
-  const Time now = Simulator::Now ();
 
-  for (ConstIterator it = begin (); it != end (); )
+  if (m_expiryGranularity.IsZero ())
     {
-      if (!TtlExceeded (it, now))
-        {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
-              && (*it)->GetHeader ().GetQosTid () == tid)
-            {
-              nPackets++;
-            }
-
-          it++;
-        }
+      RemoveExpired (Simulator::Now ());
     }
+
+  uint32_t nPackets = GetNPackets (tid, dest);
   NS_LOG_DEBUG ("returns " << nPackets);
   return nPackets;
 }
@@ -464,15 +593,10 @@ uint32_t
 WifiMacQueue::GetNPackets (void)
 {
   NS_LOG_FUNCTION (this);
-  const Time now = Simulator::Now ();
-
   // remove packets that stayed in the queue for too long
-  for (ConstIterator it = begin (); it != end (); )
+  if (m_expiryGranularity.IsZero ())
     {
-      if (!TtlExceeded (it, now))
-        {
-          it++;
-        }
+      RemoveExpired (Simulator::Now ());
     }
   return QueueBase::GetNPackets ();
 }
@@ -481,15 +605,10 @@ uint32_t
 WifiMacQueue::GetNBytes (void)
 {
   NS_LOG_FUNCTION (this);
-  const Time now = Simulator::Now ();
-
   // remove packets that stayed in the queue for too long
-  for (ConstIterator it = begin (); it != end (); )
+  if (m_expiryGranularity.IsZero ())
     {
-      if (!TtlExceeded (it, now))
-        {
-          it++;
-        }
+      RemoveExpired (Simulator::Now ());
     }
   return QueueBase::GetNBytes ();
 }
@@ -497,49 +616,35 @@ WifiMacQueue::GetNBytes (void)
 uint32_t
 WifiMacQueue::GetNPackets (uint8_t tid, Mac48Address dest) const
 {
-  WifiAddressTidPair addressTidPair (dest, tid);
-  auto it = m_nQueuedPackets.find (addressTidPair);
-  if (it == m_nQueuedPackets.end ())
+  auto it = m_tidLists.find ({dest, tid});
+  if (it == m_tidLists.end ())
     {
       return 0;
     }
-  return m_nQueuedPackets.at (addressTidPair);
+  return it->second.nPackets;
 }
 
 uint32_t
 WifiMacQueue::GetNBytes (uint8_t tid, Mac48Address dest) const
 {
-  WifiAddressTidPair addressTidPair (dest, tid);
-  auto it = m_nQueuedBytes.find (addressTidPair);
-  if (it == m_nQueuedBytes.end ())
+  auto it = m_tidLists.find ({dest, tid});
+  if (it == m_tidLists.end ())
     {
       return 0;
     }
-  return m_nQueuedBytes.at (addressTidPair);
+  return it->second.nBytes;
 }
 
 bool
-WifiMacQueue::DoEnqueue (ConstIterator pos, Ptr<WifiMacQueueItem> item)
+WifiMacQueue::DoEnqueue (ConstIterator pos, Ptr<WifiMacQueueItem> item, const Place *place)
 {
   Iterator ret;
   if (Queue<WifiMacQueueItem>::DoEnqueue (pos, item, ret))
     {
-      // update statistics about queued packets
-      if (item->GetHeader ().IsQosData ())
-        {
-          WifiAddressTidPair addressTidPair (item->GetHeader ().GetAddr1 (), item->GetHeader ().GetQosTid ());
-          auto it = m_nQueuedPackets.find (addressTidPair);
-          if (it == m_nQueuedPackets.end ())
-            {
-              m_nQueuedPackets[addressTidPair] = 0;
-              m_nQueuedBytes[addressTidPair] = 0;
-            }
-          m_nQueuedPackets[addressTidPair]++;
-          m_nQueuedBytes[addressTidPair] += item->GetSize ();
-        }
       // set item's information about its position in the queue
       item->m_queueAc = m_ac;
       item->m_queueIt = ret;
+      AddToIndexes (PeekPointer (item), place);
       return true;
     }
   return false;
@@ -550,19 +655,13 @@ WifiMacQueue::DoDequeue (ConstIterator pos)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<WifiMacQueueItem> item = Queue<WifiMacQueueItem>::DoDequeue (pos);
-
-  if (item != 0 && item->GetHeader ().IsQosData ())
+  if (pos != end ())
     {
-      WifiAddressTidPair addressTidPair (item->GetHeader ().GetAddr1 (), item->GetHeader ().GetQosTid ());
-      NS_ASSERT (m_nQueuedPackets.find (addressTidPair) != m_nQueuedPackets.end ());
-      NS_ASSERT (m_nQueuedPackets[addressTidPair] >= 1);
-      NS_ASSERT (m_nQueuedBytes[addressTidPair] >= item->GetSize ());
-
-      m_nQueuedPackets[addressTidPair]--;
-      m_nQueuedBytes[addressTidPair] -= item->GetSize ();
+      RemoveFromIndexes (PeekPointer (*pos));
     }
 
+  Ptr<WifiMacQueueItem> item = Queue<WifiMacQueueItem>::DoDequeue (pos);
+
   if (item != 0)
     {
       NS_ASSERT (item->IsQueued ());
@@ -575,19 +674,13 @@ WifiMacQueue::DoDequeue (ConstIterator pos)
 Ptr<WifiMacQueueItem>
 WifiMacQueue::DoRemove (ConstIterator pos)
 {
-  Ptr<WifiMacQueueItem> item = Queue<WifiMacQueueItem>::DoRemove (pos);
-
-  if (item != 0 && item->GetHeader ().IsQosData ())
+  if (pos != end ())
     {
-      WifiAddressTidPair addressTidPair (item->GetHeader ().GetAddr1 (), item->GetHeader ().GetQosTid ());
-      NS_ASSERT (m_nQueuedPackets.find (addressTidPair) != m_nQueuedPackets.end ());
-      NS_ASSERT (m_nQueuedPackets[addressTidPair] >= 1);
-      NS_ASSERT (m_nQueuedBytes[addressTidPair] >= item->GetSize ());
-
-      m_nQueuedPackets[addressTidPair]--;
-      m_nQueuedBytes[addressTidPair] -= item->GetSize ();
+      RemoveFromIndexes (PeekPointer (*pos));
     }
 
+  Ptr<WifiMacQueueItem> item = Queue<WifiMacQueueItem>::DoRemove (pos);
+
   if (item != 0)
     {
       NS_ASSERT (item->IsQueued ());
@@ -597,4 +690,104 @@ WifiMacQueue::DoRemove (ConstIterator pos)
   return item;
 }
 
+void
+WifiMacQueue::AddToIndexes (WifiMacQueueItem *item, const Place *place)
+{
+  const WifiMacHeader &hdr = item->GetHeader ();
+
+  if (hdr.IsData ())
+    {
+      WifiMacQueueItem::List &list = m_addrLists[hdr.GetAddr1 ()];
+      Link (list, &WifiMacQueueItem::m_addrHook, item,
+            FindNextInList (item, list, &WifiMacQueueItem::m_addrHook,
+                            place != nullptr ? &place->addr : nullptr));
+    }
+  if (hdr.IsQosData ())
+    {
+      WifiMacQueueItem::List &list = m_tidLists[{hdr.GetAddr1 (), hdr.GetQosTid ()}];
+      Link (list, &WifiMacQueueItem::m_tidHook, item,
+            FindNextInList (item, list, &WifiMacQueueItem::m_tidHook,
+                            place != nullptr ? &place->tid : nullptr));
+    }
+
+  // timestamps are mostly non-decreasing in enqueue order, hence try the end first
+  item->m_expiryIt = m_expiryIndex.emplace_hint (m_expiryIndex.end (), item->GetTimeStamp (), item);
+  if (item->m_expiryIt == m_expiryIndex.begin ())
+    {
+      ScheduleExpiry ();
+    }
+}
+
+WifiMacQueueItem*
+WifiMacQueue::FindNextInList (const WifiMacQueueItem *item, const WifiMacQueueItem::List &list,
+                              WifiMacQueueItem::Hook WifiMacQueueItem::*hook,
+                              const WifiMacQueueItem::Hook *hint) const
+{
+  ConstIterator it = std::next (item->m_queueIt);
+
+  if (it == end ())
+    {
+      return nullptr;
+    }
+  if (item->m_queueIt == begin ())
+    {
+      return list.head;
+    }
+  if (hint != nullptr && hint->list == &list)
+    {
+      // the item took the place of an item of the same list
+      return hint->next;
+    }
+
+  while (it != end () && (PeekPointer (*it)->*hook).list != &list)
+    {
+      it++;
+    }
+  return (it != end () ? PeekPointer (*it) : nullptr);
+}
+
+void
+WifiMacQueue::Link (WifiMacQueueItem::List &list, WifiMacQueueItem::Hook WifiMacQueueItem::*hook,
+                    WifiMacQueueItem *item, WifiMacQueueItem *next)
+{
+  WifiMacQueueItem::Hook &itemHook = item->*hook;
+  NS_ASSERT (itemHook.list == nullptr);
+  NS_ASSERT (next == nullptr || (next->*hook).list == &list);
+
+  WifiMacQueueItem *prev = (next != nullptr ? (next->*hook).prev : list.tail);
+  itemHook = {&list, prev, next};
+  (prev != nullptr ? (prev->*hook).next : list.head) = item;
+  (next != nullptr ? (next->*hook).prev : list.tail) = item;
+  list.nPackets++;
+  list.nBytes += item->GetSize ();
+}
+
+void
+WifiMacQueue::Unlink (WifiMacQueueItem::Hook WifiMacQueueItem::*hook, WifiMacQueueItem *item)
+{
+  WifiMacQueueItem::Hook &itemHook = item->*hook;
+  if (itemHook.list == nullptr)
+    {
+      return;
+    }
+
+  WifiMacQueueItem::List &list = *itemHook.list;
+  NS_ASSERT (list.nPackets >= 1);
+  NS_ASSERT (list.nBytes >= item->GetSize ());
+
+  (itemHook.prev != nullptr ? (itemHook.prev->*hook).next : list.head) = itemHook.next;
+  (itemHook.next != nullptr ? (itemHook.next->*hook).prev : list.tail) = itemHook.prev;
+  list.nPackets--;
+  list.nBytes -= item->GetSize ();
+  itemHook = {};
+}
+
+void
+WifiMacQueue::RemoveFromIndexes (WifiMacQueueItem *item)
+{
+  Unlink (&WifiMacQueueItem::m_addrHook, item);
+  Unlink (&WifiMacQueueItem::m_tidHook, item);
+  m_expiryIndex.erase (item->m_expiryIt);
+}
+
 } //namespace ns3
@@ -26,6 +26,7 @@
 
 #include "wifi-mac-queue-item.h"
 #include "ns3/queue.h"
+#include "ns3/event-id.h"
 #include <unordered_map>
 #include "qos-utils.h"
 #include <functional>
@@ -56,6 +57,19 @@ extern template class Queue<WifiMacQueueItem>;
  * to verify whether or not it should be dropped. If
  * dot11EDCATableMSDULifetime has elapsed, it is dropped.
  * Otherwise, it is returned to the caller.
+ *
+ * Besides the FIFO list of all the queued items, the queue keeps an intrusive
+ * list of the Data frames sent to each receiver address, an intrusive list of
+ * the QoS Data frames sent to each (receiver address, TID) pair and an index
+ * of the queued items sorted by timestamp. Looking up the frames sent to a
+ * given receiver (and TID) therefore only visits such frames, and expired
+ * frames are found without scanning the whole queue.
+ *
+ * If the ExpiryGranularity attribute is strictly positive, the lifetime of
+ * the frames is not checked when they are accessed. Instead, the frames whose
+ * lifetime expired are dropped together at the next multiple of the expiry
+ * granularity, so that the queue size and the drop counters are up to date
+ * even if the queue is not accessed.
  */
 class WifiMacQueue : public Queue<WifiMacQueueItem>
 {
@@ -101,6 +115,21 @@ public:
    */
   Time GetMaxDelay (void) const;
 
+  /**
+   * Set the interval between the instants at which expired packets are dropped.
+   * A null interval disables the bulk removal of expired packets, which are
+   * then removed when accessed.
+   *
+   * \param granularity the interval between drops of expired packets
+   */
+  void SetExpiryGranularity (Time granularity);
+  /**
+   * Return the interval between the instants at which expired packets are dropped.
+   *
+   * \return the interval between drops of expired packets
+   */
+  Time GetExpiryGranularity (void) const;
+
   /**
    * Enqueue the given Wifi MAC queue item at the <i>end</i> of the queue.
    *
@@ -225,6 +254,7 @@ public:
    * Actually, the given item is dequeued and the transformed item is enqueued in
    * its place. In this way, statistics about queue size (in terms of bytes) are
    * correctly updated.
+   * The given function must not modify the queue.
    *
    * \internal
    * If this method needs to be overloaded, we can use SFINAE to help in overload
@@ -247,7 +277,8 @@ public:
 
   /**
    * Return the number of packets having destination address specified by
-   * <i>dest</i>. The complexity is linear in the size of the queue.
+   * <i>dest</i>. Expired packets are removed from the queue first; apart from
+   * that, the complexity in the average case is constant.
    *
    * \param dest the given destination
    *
@@ -256,8 +287,9 @@ public:
   uint32_t GetNPacketsByAddress (Mac48Address dest);
   /**
    * Return the number of QoS packets having TID equal to <i>tid</i> and
-   * destination address equal to <i>dest</i>.  The complexity is linear in
-   * the size of the queue.
+   * destination address equal to <i>dest</i>. Expired packets are removed
+   * from the queue first; apart from that, the complexity in the average case
+   * is constant.
    *
    * \param tid the given TID
    * \param dest the given destination
@@ -314,7 +346,8 @@ public:
 
   /**
    * Remove the given item if it has been in the queue for too long. Return true
-   * if the item is removed, false otherwise.
+   * if the item is removed, false otherwise. The lifetime of the item is checked
+   * even if expired packets are dropped in batches.
    *
    * \param item the item whose lifetime is checked
    * \param now a copy of Simulator::Now()
@@ -322,11 +355,21 @@ public:
    */
   bool TtlExceeded (Ptr<const WifiMacQueueItem> item, const Time& now);
 
+protected:
+  void DoDispose (void) override;
+
 private:
+  /// Links of a dequeued item, used to enqueue another item in its place
+  struct Place
+  {
+    WifiMacQueueItem::Hook addr;  //!< links in the list of frames sent to the same receiver
+    WifiMacQueueItem::Hook tid;   //!< links in the list of frames sent to the same receiver with the same TID
+  };
+
   /**
    * Remove the item pointed to by the iterator <i>it</i> if it has been in the
-   * queue for too long. If the item is removed, the iterator is updated to
-   * point to the item that followed the erased one.
+   * queue for too long and lifetime is checked on access. If the item is removed,
+   * the iterator is updated to point to the item that followed the erased one.
    *
    * \param it an iterator pointing to the item
    * \param now a copy of Simulator::Now()
@@ -334,6 +377,109 @@ private:
    */
   inline bool TtlExceeded (ConstIterator &it, const Time& now);
 
+  /**
+   * Return true if the given item has to be skipped by the methods accessing the
+   * queue because it has been in the queue for too long. This is never the case
+   * when expired packets are dropped in batches.
+   *
+   * \param item the item
+   * \param now a copy of Simulator::Now()
+   * \return true if the item is stale
+   */
+  inline bool IsStale (const WifiMacQueueItem *item, const Time& now) const;
+
+  /**
+   * Drop the expired item pointed to by the iterator <i>it</i> and update the
+   * iterator to point to the item that followed the erased one.
+   *
+   * \param it an iterator pointing to the item
+   * \param now a copy of Simulator::Now()
+   */
+  void Expire (ConstIterator &it, const Time& now);
+
+  /**
+   * Make sure that an event is scheduled to drop the oldest item at the first
+   * multiple of the expiry granularity following the end of its lifetime.
+   */
+  void ScheduleExpiry (void);
+
+  /**
+   * Drop all the items whose lifetime expired and schedule the next drop.
+   */
+  void ExpireBatch (void);
+
+  /**
+   * Remove all the items whose lifetime expired, starting from the oldest one.
+   *
+   * \param now a copy of Simulator::Now()
+   */
+  void RemoveExpired (const Time& now);
+
+  /**
+   * Search, starting from the given item, the first queued item that has not
+   * expired and belongs to the list linked through the given hook.
+   *
+   * \param item the item from which the search starts (null to return null)
+   * \param hook the hook linking the items of the list
+   * \param now a copy of Simulator::Now()
+   * \return the item found, or a null pointer if no such item exists
+   */
+  Ptr<const WifiMacQueueItem> PeekList (const WifiMacQueueItem *item,
+                                        WifiMacQueueItem::Hook WifiMacQueueItem::*hook,
+                                        const Time& now) const;
+
+  /**
+   * Add the given item, which has just been inserted in the FIFO list, to the
+   * lists it belongs to and to the expiry index.
+   *
+   * \param item the item
+   * \param place the links of the item previously stored in the same position
+   *              of the FIFO list, if any
+   */
+  void AddToIndexes (WifiMacQueueItem *item, const Place *place);
+
+  /**
+   * Return the item before which the given item, which has just been inserted
+   * in the FIFO list, has to be linked in the given list.
+   *
+   * \param item the item
+   * \param list the list
+   * \param hook the hook linking the items of the list
+   * \param hint the links of the item previously stored in the same position
+   *             of the FIFO list, if any
+   * \return the next item in the list, or a null pointer to append to the list
+   */
+  WifiMacQueueItem* FindNextInList (const WifiMacQueueItem *item, const WifiMacQueueItem::List &list,
+                                    WifiMacQueueItem::Hook WifiMacQueueItem::*hook,
+                                    const WifiMacQueueItem::Hook *hint) const;
+
+  /**
+   * Link the given item in the given list before the given next item.
+   *
+   * \param list the list
+   * \param hook the hook linking the items of the list
+   * \param item the item to link
+   * \param next the item before which the given item is linked (null to append)
+   */
+  static void Link (WifiMacQueueItem::List &list, WifiMacQueueItem::Hook WifiMacQueueItem::*hook,
+                    WifiMacQueueItem *item, WifiMacQueueItem *next);
+
+  /**
+   * Unlink the given item from the list it belongs to, if any.
+   *
+   * \param hook the hook linking the items of the list
+   * \param item the item to unlink
+   */
+  static void Unlink (WifiMacQueueItem::Hook WifiMacQueueItem::*hook, WifiMacQueueItem *item);
+
+  /**
+   * Remove the given item, which is about to leave the FIFO list, from the
+   * lists it belongs to and from the expiry index.
+   *
+   * \param item the item
+   */
+  void RemoveFromIndexes (WifiMacQueueItem *item);
+
   /**
    * Enqueue the given Wifi MAC queue item before the given position.
    *
@@ -349,9 +495,11 @@ private:
    *
    * \param pos the position before where the item will be inserted
    * \param item the item to enqueue
+   * \param place the links of the item that was dequeued from the given
+   *              position, if the item takes its place
    * \return true if success, false if the packet has been dropped.
    */
-  bool DoEnqueue (ConstIterator pos, Ptr<WifiMacQueueItem> item);
+  bool DoEnqueue (ConstIterator pos, Ptr<WifiMacQueueItem> item, const Place *place = nullptr);
   /**
    * Wrapper for the DoDequeue method provided by the base class that additionally
    * resets the iterator field of the item and updates internal statistics, if
@@ -372,13 +520,16 @@ private:
   Ptr<WifiMacQueueItem> DoRemove (ConstIterator pos);
 
   Time m_maxDelay;                          //!< Time to live for packets in the queue
+  Time m_expiryGranularity;                 //!< interval between drops of expired packets (0 to check on access)
+  EventId m_expiryEvent;                    //!< event dropping the expired packets
   DropPolicy m_dropPolicy;                  //!< Drop behavior of queue
   AcIndex m_ac;                             //!< the access category
 
-  /// Per (MAC address, TID) pair queued packets
-  std::unordered_map<WifiAddressTidPair, uint32_t, WifiAddressTidHash> m_nQueuedPackets;
-  /// Per (MAC address, TID) pair queued bytes
-  std::unordered_map<WifiAddressTidPair, uint32_t, WifiAddressTidHash> m_nQueuedBytes;
+  /// Per MAC address list of queued Data frames
+  std::unordered_map<Mac48Address, WifiMacQueueItem::List, WifiAddressHash> m_addrLists;
+  /// Per (MAC address, TID) pair list of queued QoS Data frames
+  std::unordered_map<WifiAddressTidPair, WifiMacQueueItem::List, WifiAddressTidHash> m_tidLists;
+  WifiMacQueueItem::ExpiryIndex m_expiryIndex;  //!< queued items sorted by timestamp
 
   /// Traced callback: fired when a packet is dropped due to lifetime expiration
   TracedCallback<Ptr<const WifiMacQueueItem> > m_traceExpired;
@@ -404,10 +555,11 @@ WifiMacQueue::Transform (Ptr<const WifiMacQueueItem> item, CALLABLE func)
   NS_ASSERT (*item->m_queueIt == item);
 
   auto pos = std::next (item->m_queueIt);
+  Place place {item->m_addrHook, item->m_tidHook};
   Ptr<WifiMacQueueItem> mpdu = DoDequeue (item->m_queueIt);
   NS_ASSERT (mpdu != nullptr);
   func (mpdu);     // python bindings scanning does not like std::invoke (func, mpdu);
-  bool ret = Insert (pos, mpdu);
+  bool ret = DoEnqueue (pos, mpdu, &place);
   // The size of a WifiMacQueue is measured as number of packets. We dequeued
   // one packet, so there is certainly room for inserting one packet
   NS_ABORT_IF (!ret);
@@ -264,6 +264,11 @@ WifiPhy::GetTypeId (void)
                      "has been completely transmitted over the channel.",
                      MakeTraceSourceAccessor (&WifiPhy::m_phyTxEndTrace),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("PhyTxPsduEnd",
+                     "Trace source indicating a PSDU "
+                     "has been completely transmitted over the channel medium",
+                     MakeTraceSourceAccessor (&WifiPhy::m_phyTxPsduEndTrace),
+                     "ns3::WifiPhy::PsduTxEndCallback")
     .AddTraceSource ("PhyTxDrop",
                      "Trace source indicating a packet "
                      "has been dropped by the device during transmission",
@@ -1375,6 +1380,10 @@ WifiPhy::NotifyTxEnd (WifiConstPsduMap psdus)
             }
         }
     }
+  if (!m_phyTxPsduEndTrace.IsEmpty ())
+    {
+      m_phyTxPsduEndTrace (psdus);
+    }
 }
 
 void
@@ -1618,7 +1627,7 @@ WifiPhy::Reset (void)
 }
 
 void
-WifiPhy::StartReceivePreamble (Ptr<WifiPpdu> ppdu, RxPowerWattPerChannelBand& rxPowersW, Time rxDuration)
+WifiPhy::StartReceivePreamble (Ptr<const WifiPpdu> ppdu, RxPowerWattPerChannelBand& rxPowersW, Time rxDuration)
 {
   WifiModulationClass modulation = ppdu->GetTxVector ().GetModulationClass ();
   auto it = m_phyEntities.find (modulation);
@@ -99,11 +99,11 @@ public:
   /**
    * Start receiving the PHY preamble of a PPDU (i.e. the first bit of the preamble has arrived).
    *
-   * \param ppdu the arriving PPDU
+   * \param ppdu the arriving PPDU, shared with the other receivers of the transmission
    * \param rxPowersW the receive power in W per band
    * \param rxDuration the duration of the PPDU
    */
-  void StartReceivePreamble (Ptr<WifiPpdu> ppdu, RxPowerWattPerChannelBand& rxPowersW, Time rxDuration);
+  void StartReceivePreamble (Ptr<const WifiPpdu> ppdu, RxPowerWattPerChannelBand& rxPowersW, Time rxDuration);
 
   /**
    * Reset PHY at the end of the packet under reception after it has failed the PHY header.
@@ -524,7 +524,7 @@ public:
    */
   void NotifyTxBegin (WifiConstPsduMap psdus, double txPowerW);
   /**
-   * Public method used to fire a PhyTxEnd trace.
+   * Public method used to fire the PhyTxEnd and PhyTxPsduEnd traces.
    * Implemented for encapsulation purposes.
    *
    * \param psdus the PSDUs being transmitted (only one unless DL MU transmission)
@@ -669,6 +669,13 @@ public:
    */
   typedef void (* PsduTxBeginCallback)(WifiConstPsduMap psduMap, WifiTxVector txVector, double txPowerW);
 
+  /**
+   * TracedCallback signature for the end of PSDU transmissions.
+   *
+   * \param psduMap the PSDU map transmitted
+   */
+  typedef void (* PsduTxEndCallback)(WifiConstPsduMap psduMap);
+
   /**
    * TracedCallback signature for PhyRxBegin trace source.
    *
@@ -1260,6 +1267,13 @@ private:
    * \see class CallBackTraceSource
    */
   TracedCallback<Ptr<const Packet> > m_phyTxEndTrace;
+  /**
+   * The trace source fired when a PSDU map ends the transmission process on
+   * the medium.
+   *
+   * \see class CallBackTraceSource
+   */
+  TracedCallback<WifiConstPsduMap> m_phyTxPsduEndTrace;
 
   /**
    * The trace source fired when the PHY layer drops a packet as it tries
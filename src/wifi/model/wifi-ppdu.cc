@@ -20,6 +20,7 @@
 
 #include "wifi-ppdu.h"
 #include "wifi-psdu.h"
+#include "wifi-mac-queue-item.h"
 #include "ns3/log.h"
 #include "ns3/packet.h"
 
@@ -132,6 +133,12 @@ WifiPpdu::GetUid (void) const
   return m_uid;
 }
 
+void
+WifiPpdu::SetUid (uint64_t uid)
+{
+  m_uid = uid;
+}
+
 WifiPreamble
 WifiPpdu::GetPreamble (void) const
 {
@@ -183,6 +190,35 @@ WifiPpdu::Copy (void) const
   return Create<WifiPpdu> (GetPsdu (), GetTxVector ());
 }
 
+Ptr<WifiPpdu>
+WifiPpdu::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<WifiPpdu> copy = Copy ();
+  for (auto & psdu : copy->m_psdus)
+    {
+      std::vector<Ptr<WifiMacQueueItem>> mpdus;
+      for (const auto & mpdu : *psdu.second)
+        {
+          // packets share their buffers with their copies, so serialize them
+          Ptr<const Packet> packet = mpdu->GetPacket ();
+          std::vector<uint8_t> buffer (packet->GetSerializedSize ());
+          packet->Serialize (buffer.data (), buffer.size ());
+          mpdus.push_back (Create<WifiMacQueueItem> (Create<Packet> (buffer.data (), buffer.size (), true),
+                                                     mpdu->GetHeader (), mpdu->GetTimeStamp ()));
+        }
+      if (mpdus.size () > 1)
+        {
+          psdu.second = Create<WifiPsdu> (mpdus);
+        }
+      else
+        {
+          psdu.second = Create<WifiPsdu> (mpdus.front (), psdu.second->IsSingle ());
+        }
+    }
+  return copy;
+}
+
 std::ostream & operator << (std::ostream &os, const Ptr<const WifiPpdu> &ppdu)
 {
   ppdu->Print (os);
@@ -47,6 +47,13 @@ typedef std::unordered_map <uint16_t /* STA-ID */, Ptr<const WifiPsdu> /* PSDU *
  *
  * WifiPpdu stores a preamble, a modulation class, PHY headers and a PSDU.
  * This class should be subclassed for each amendment.
+ *
+ * The channels deliver the same PPDU instance to all the receivers of a
+ * transmission, so a PPDU must not be modified once it has been handed
+ * to the channel. Per-receiver state, such as the RX power, is kept by
+ * the receivers, and a transmitter that needs to alter the PPDU for part
+ * of its transmission (e.g., the OFDMA portion of an HE TB PPDU) sends a
+ * Copy of it.
  */
 class WifiPpdu : public SimpleRefCount<WifiPpdu>
 {
@@ -136,6 +143,12 @@ public:
    * \return the UID of the PPDU
    */
   uint64_t GetUid (void) const;
+  /**
+   * Set the UID of the PPDU, e.g., to the UID of the PPDU this PPDU was
+   * rebuilt from after being received from another MPI rank.
+   * \param uid the UID of the PPDU
+   */
+  void SetUid (uint64_t uid);
 
   /**
    * Get the preamble of the PPDU.
@@ -153,6 +166,18 @@ public:
    * \return a Ptr to a copy of this instance.
    */
   virtual Ptr<WifiPpdu> Copy (void) const;
+  /**
+   * \brief Copy this instance along with the packets it carries.
+   *
+   * The copy shares no reference counted object with this instance,
+   * hence it can be handed over to another thread, e.g., to receivers
+   * in another partition of a MultithreadedSimulatorImpl. Later changes
+   * to this instance (e.g., a truncated transmission) are not reflected
+   * in the copy.
+   *
+   * \return a Ptr to a deep copy of this instance.
+   */
+  Ptr<WifiPpdu> DeepCopy (void) const;
 
   /**
    * Return the PPDU type (\see WifiPpduType)
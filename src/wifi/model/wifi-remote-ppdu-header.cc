@@ -0,0 +1,401 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "wifi-remote-ppdu-header.h"
+#include "wifi-psdu.h"
+#include "wifi-mac-queue-item.h"
+#include "he/he-ppdu.h"
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WifiRemotePpduHeader");
+
+NS_OBJECT_ENSURE_REGISTERED (WifiRemotePpduHeader);
+
+/**
+ * \param mode a WifiMode
+ * \return the number of bytes needed to serialize the mode
+ */
+static uint32_t
+GetModeSerializedSize (WifiMode mode)
+{
+  return 1 + mode.GetUniqueName ().size ();
+}
+
+/**
+ * Serialize a WifiMode as its unique name, the uids of the modes
+ * depending on the order in which they were created.
+ *
+ * \param i the buffer iterator
+ * \param mode the WifiMode
+ */
+static void
+SerializeMode (Buffer::Iterator &i, WifiMode mode)
+{
+  std::string name = mode.GetUniqueName ();
+  NS_ASSERT (name.size () <= 0xff);
+  i.WriteU8 (static_cast<uint8_t> (name.size ()));
+  i.Write (reinterpret_cast<const uint8_t *> (name.data ()), name.size ());
+}
+
+/**
+ * \param i the buffer iterator
+ * \return the deserialized WifiMode
+ */
+static WifiMode
+DeserializeMode (Buffer::Iterator &i)
+{
+  std::string name (i.ReadU8 (), '\0');
+  i.Read (reinterpret_cast<uint8_t *> (&name[0]), name.size ());
+  return WifiMode (name);
+}
+
+TypeId
+WifiRemotePpduHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::WifiRemotePpduHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<WifiRemotePpduHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+WifiRemotePpduHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+WifiRemotePpduHeader::WifiRemotePpduHeader ()
+  : m_sender (0),
+    m_uid (0),
+    m_txPsdFlag (0)
+{
+}
+
+WifiRemotePpduHeader::~WifiRemotePpduHeader ()
+{
+}
+
+void
+WifiRemotePpduHeader::SetPpdu (Ptr<const WifiPpdu> ppdu)
+{
+  NS_LOG_FUNCTION (this << ppdu);
+  m_uid = ppdu->GetUid ();
+  m_txVector = ppdu->GetTxVector ();
+  m_txDuration = ppdu->GetTxDuration ();
+  Ptr<const HePpdu> hePpdu = DynamicCast<const HePpdu> (ppdu);
+  m_txPsdFlag = (hePpdu != 0) ? hePpdu->GetTxPsdFlag () : 0;
+  m_psdus.clear ();
+  WifiConstPsduMap psdus;
+  if (m_txVector.IsDlMu ())
+    {
+      NS_ASSERT (hePpdu != 0);
+      for (const auto & userInfo : m_txVector.GetHeMuUserInfoMap ())
+        {
+          Ptr<const WifiPsdu> psdu = hePpdu->GetPsdu (0, userInfo.first);
+          if (psdu != 0)
+            {
+              psdus.insert ({userInfo.first, psdu});
+            }
+        }
+    }
+  else
+    {
+      psdus.insert ({m_txVector.IsUlMu () ? ppdu->GetStaId () : SU_STA_ID, ppdu->GetPsdu ()});
+    }
+  for (const auto & psdu : psdus)
+    {
+      Psdu serialized;
+      serialized.staId = psdu.first;
+      serialized.isSingle = psdu.second->IsSingle ();
+      for (const auto & mpdu : *psdu.second)
+        {
+          Mpdu m;
+          m.header = mpdu->GetHeader ();
+          m.timestamp = mpdu->GetTimeStamp ();
+          Ptr<const Packet> packet = mpdu->GetPacket ();
+          m.packet.resize (packet->GetSerializedSize ());
+          packet->Serialize (m.packet.data (), m.packet.size ());
+          serialized.mpdus.push_back (std::move (m));
+        }
+      m_psdus.push_back (std::move (serialized));
+    }
+}
+
+uint64_t
+WifiRemotePpduHeader::GetUid (void) const
+{
+  return m_uid;
+}
+
+WifiTxVector
+WifiRemotePpduHeader::GetTxVector (void) const
+{
+  return m_txVector;
+}
+
+Time
+WifiRemotePpduHeader::GetTxDuration (void) const
+{
+  return m_txDuration;
+}
+
+uint8_t
+WifiRemotePpduHeader::GetTxPsdFlag (void) const
+{
+  return m_txPsdFlag;
+}
+
+WifiConstPsduMap
+WifiRemotePpduHeader::GetPsdus (void) const
+{
+  WifiConstPsduMap psdus;
+  for (const auto & psdu : m_psdus)
+    {
+      std::vector<Ptr<WifiMacQueueItem>> mpdus;
+      for (const auto & mpdu : psdu.mpdus)
+        {
+          Ptr<Packet> packet = Create<Packet> (mpdu.packet.data (), mpdu.packet.size (), true);
+          mpdus.push_back (Create<WifiMacQueueItem> (packet, mpdu.header, mpdu.timestamp));
+        }
+      NS_ASSERT (!mpdus.empty ());
+      if (mpdus.size () > 1)
+        {
+          psdus.insert ({psdu.staId, Create<WifiPsdu> (mpdus)});
+        }
+      else
+        {
+          psdus.insert ({psdu.staId, Create<WifiPsdu> (mpdus.front (), psdu.isSingle)});
+        }
+    }
+  return psdus;
+}
+
+void
+WifiRemotePpduHeader::SetSender (uint32_t index)
+{
+  m_sender = index;
+}
+
+uint32_t
+WifiRemotePpduHeader::GetSender (void) const
+{
+  return m_sender;
+}
+
+void
+WifiRemotePpduHeader::AddReceiver (uint32_t index, Time delay, double rxPowerDbm)
+{
+  m_receivers.push_back ({index, delay, rxPowerDbm});
+}
+
+void
+WifiRemotePpduHeader::ClearReceivers (void)
+{
+  m_receivers.clear ();
+}
+
+const std::vector<WifiRemotePpduHeader::Receiver> &
+WifiRemotePpduHeader::GetReceivers (void) const
+{
+  return m_receivers;
+}
+
+uint32_t
+WifiRemotePpduHeader::GetSerializedSize (void) const
+{
+  // sender, UID, TX duration, PSD flag
+  uint32_t size = 4 + 8 + 8 + 1;
+  // TXVECTOR: preamble, channel width, guard interval, nTx, Ness, flags,
+  // BSS color, length, TX power level
+  size += 1 + 2 + 2 + 1 + 1 + 1 + 1 + 2 + 1;
+  if (m_txVector.IsMu ())
+    {
+      size += 2;
+      for (const auto & userInfo : m_txVector.GetHeMuUserInfoMap ())
+        {
+          // STA-ID, RU type, RU index, primary 80 MHz, MCS, Nss
+          size += 2 + 1 + 2 + 1 + GetModeSerializedSize (userInfo.second.mcs) + 1;
+        }
+    }
+  else
+    {
+      size += GetModeSerializedSize (m_txVector.GetMode ()) + 1;
+    }
+  size += 2;
+  for (const auto & psdu : m_psdus)
+    {
+      size += 2 + 1 + 2;
+      for (const auto & mpdu : psdu.mpdus)
+        {
+          size += mpdu.header.GetSerializedSize () + 8 + 4 + mpdu.packet.size ();
+        }
+    }
+  size += 4 + m_receivers.size () * (4 + 8 + 8);
+  return size;
+}
+
+void
+WifiRemotePpduHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  i.WriteHtonU32 (m_sender);
+  i.WriteHtonU64 (m_uid);
+  i.WriteHtonU64 (m_txDuration.GetTimeStep ());
+  i.WriteU8 (m_txPsdFlag);
+
+  i.WriteU8 (m_txVector.GetPreambleType ());
+  i.WriteHtonU16 (m_txVector.GetChannelWidth ());
+  i.WriteHtonU16 (m_txVector.GetGuardInterval ());
+  i.WriteU8 (m_txVector.GetNTx ());
+  i.WriteU8 (m_txVector.GetNess ());
+  i.WriteU8 ((m_txVector.IsAggregation () ? 1 : 0)
+             | (m_txVector.IsStbc () ? 2 : 0)
+             | (m_txVector.IsLdpc () ? 4 : 0));
+  i.WriteU8 (m_txVector.GetBssColor ());
+  i.WriteHtonU16 (m_txVector.GetLength ());
+  i.WriteU8 (m_txVector.GetTxPowerLevel ());
+  if (m_txVector.IsMu ())
+    {
+      const WifiTxVector::HeMuUserInfoMap &userInfos = m_txVector.GetHeMuUserInfoMap ();
+      i.WriteHtonU16 (userInfos.size ());
+      for (const auto & userInfo : userInfos)
+        {
+          i.WriteHtonU16 (userInfo.first);
+          i.WriteU8 (userInfo.second.ru.GetRuType ());
+          i.WriteHtonU16 (userInfo.second.ru.GetIndex ());
+          i.WriteU8 (userInfo.second.ru.GetPrimary80MHz () ? 1 : 0);
+          SerializeMode (i, userInfo.second.mcs);
+          i.WriteU8 (userInfo.second.nss);
+        }
+    }
+  else
+    {
+      SerializeMode (i, m_txVector.GetMode ());
+      i.WriteU8 (m_txVector.GetNss ());
+    }
+
+  i.WriteHtonU16 (m_psdus.size ());
+  for (const auto & psdu : m_psdus)
+    {
+      i.WriteHtonU16 (psdu.staId);
+      i.WriteU8 (psdu.isSingle ? 1 : 0);
+      i.WriteHtonU16 (psdu.mpdus.size ());
+      for (const auto & mpdu : psdu.mpdus)
+        {
+          mpdu.header.Serialize (i);
+          i.Next (mpdu.header.GetSerializedSize ());
+          i.WriteHtonU64 (mpdu.timestamp.GetTimeStep ());
+          i.WriteHtonU32 (mpdu.packet.size ());
+          i.Write (mpdu.packet.data (), mpdu.packet.size ());
+        }
+    }
+
+  i.WriteHtonU32 (m_receivers.size ());
+  for (const auto & receiver : m_receivers)
+    {
+      uint64_t rxPower;
+      std::memcpy (&rxPower, &receiver.rxPowerDbm, sizeof (rxPower));
+      i.WriteHtonU32 (receiver.index);
+      i.WriteHtonU64 (receiver.delay.GetTimeStep ());
+      i.WriteHtonU64 (rxPower);
+    }
+}
+
+uint32_t
+WifiRemotePpduHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_sender = i.ReadNtohU32 ();
+  m_uid = i.ReadNtohU64 ();
+  m_txDuration = TimeStep (i.ReadNtohU64 ());
+  m_txPsdFlag = i.ReadU8 ();
+
+  m_txVector = WifiTxVector ();
+  m_txVector.SetPreambleType (static_cast<WifiPreamble> (i.ReadU8 ()));
+  m_txVector.SetChannelWidth (i.ReadNtohU16 ());
+  m_txVector.SetGuardInterval (i.ReadNtohU16 ());
+  m_txVector.SetNTx (i.ReadU8 ());
+  m_txVector.SetNess (i.ReadU8 ());
+  uint8_t flags = i.ReadU8 ();
+  m_txVector.SetAggregation (flags & 1);
+  m_txVector.SetStbc (flags & 2);
+  m_txVector.SetLdpc (flags & 4);
+  m_txVector.SetBssColor (i.ReadU8 ());
+  m_txVector.SetLength (i.ReadNtohU16 ());
+  m_txVector.SetTxPowerLevel (i.ReadU8 ());
+  if (m_txVector.IsMu ())
+    {
+      uint16_t nUsers = i.ReadNtohU16 ();
+      for (uint16_t u = 0; u < nUsers; u++)
+        {
+          uint16_t staId = i.ReadNtohU16 ();
+          HeRu::RuType ruType = static_cast<HeRu::RuType> (i.ReadU8 ());
+          std::size_t index = i.ReadNtohU16 ();
+          bool primary80MHz = (i.ReadU8 () != 0);
+          WifiMode mcs = DeserializeMode (i);
+          uint8_t nss = i.ReadU8 ();
+          m_txVector.SetHeMuUserInfo (staId, {HeRu::RuSpec (ruType, index, primary80MHz), mcs, nss});
+        }
+    }
+  else
+    {
+      m_txVector.SetMode (DeserializeMode (i));
+      m_txVector.SetNss (i.ReadU8 ());
+    }
+
+  m_psdus.resize (i.ReadNtohU16 ());
+  for (auto & psdu : m_psdus)
+    {
+      psdu.staId = i.ReadNtohU16 ();
+      psdu.isSingle = (i.ReadU8 () != 0);
+      psdu.mpdus.resize (i.ReadNtohU16 ());
+      for (auto & mpdu : psdu.mpdus)
+        {
+          i.Next (mpdu.header.Deserialize (i));
+          mpdu.timestamp = TimeStep (i.ReadNtohU64 ());
+          mpdu.packet.resize (i.ReadNtohU32 ());
+          i.Read (mpdu.packet.data (), mpdu.packet.size ());
+        }
+    }
+
+  m_receivers.resize (i.ReadNtohU32 ());
+  for (auto & receiver : m_receivers)
+    {
+      receiver.index = i.ReadNtohU32 ();
+      receiver.delay = TimeStep (i.ReadNtohU64 ());
+      uint64_t rxPower = i.ReadNtohU64 ();
+      std::memcpy (&receiver.rxPowerDbm, &rxPower, sizeof (rxPower));
+    }
+  return i.GetDistanceFrom (start);
+}
+
+void
+WifiRemotePpduHeader::Print (std::ostream &os) const
+{
+  os << "sender=" << m_sender << ", uid=" << m_uid
+     << ", txVector=" << m_txVector
+     << ", duration=" << m_txDuration.As (Time::NS)
+     << ", PSDUs=" << m_psdus.size ()
+     << ", receivers=" << m_receivers.size ();
+}
+
+} //namespace ns3
@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WIFI_REMOTE_PPDU_HEADER_H
+#define WIFI_REMOTE_PPDU_HEADER_H
+
+#include "ns3/header.h"
+#include "ns3/nstime.h"
+#include "wifi-tx-vector.h"
+#include "wifi-ppdu.h"
+#include "wifi-mac-header.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ * \brief Header carrying a PPDU to the receivers of another MPI rank
+ *
+ * When the PHYs attached to a YansWifiChannel run on several MPI ranks,
+ * the transmissions are delivered to the receivers of another rank as a
+ * message which holds the serialized PPDU (i.e., its TXVECTOR, UID and
+ * PSDUs) along with the index in the channel of the sender and, for each
+ * receiver of that rank, its index in the channel, its propagation delay
+ * relative to the earliest reception and its RX power. The PPDU is then
+ * rebuilt by the PHY entity of the copy of the sender on the receiving
+ * rank.
+ */
+class WifiRemotePpduHeader : public Header
+{
+public:
+  WifiRemotePpduHeader ();
+  virtual ~WifiRemotePpduHeader ();
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TypeId GetInstanceTypeId (void) const override;
+  void Print (std::ostream &os) const override;
+  uint32_t GetSerializedSize (void) const override;
+  void Serialize (Buffer::Iterator start) const override;
+  uint32_t Deserialize (Buffer::Iterator start) override;
+
+  /** A receiver of the PPDU. */
+  struct Receiver
+  {
+    uint32_t index;    //!< the index of the receiver in the channel
+    Time delay;        //!< the reception time, relative to the earliest reception
+    double rxPowerDbm; //!< the RX power (dBm)
+  };
+
+  /**
+   * Set the PPDU, whose PSDUs are serialized right away.
+   *
+   * \param ppdu the PPDU
+   */
+  void SetPpdu (Ptr<const WifiPpdu> ppdu);
+  /**
+   * \return the UID of the PPDU
+   */
+  uint64_t GetUid (void) const;
+  /**
+   * \return the TXVECTOR of the PPDU
+   */
+  WifiTxVector GetTxVector (void) const;
+  /**
+   * \return the transmission duration of the PPDU
+   */
+  Time GetTxDuration (void) const;
+  /**
+   * \return the transmit power spectral density flag of the PPDU if it
+   *         is an HE PPDU, zero otherwise (see HePpdu::TxPsdFlag)
+   */
+  uint8_t GetTxPsdFlag (void) const;
+  /**
+   * Build new PSDUs from the serialized PSDUs. The PSDUs share no
+   * packet with those of the PPDU passed to SetPpdu.
+   *
+   * \return the PSDUs of the PPDU
+   */
+  WifiConstPsduMap GetPsdus (void) const;
+
+  /**
+   * \param index the index of the sender in the channel
+   */
+  void SetSender (uint32_t index);
+  /**
+   * \return the index of the sender in the channel
+   */
+  uint32_t GetSender (void) const;
+  /**
+   * Add a receiver of the PPDU.
+   *
+   * \param index the index of the receiver in the channel
+   * \param delay the reception time, relative to the earliest reception
+   * \param rxPowerDbm the RX power (dBm)
+   */
+  void AddReceiver (uint32_t index, Time delay, double rxPowerDbm);
+  /**
+   * Remove the receivers of the PPDU, e.g., to send it to another rank.
+   */
+  void ClearReceivers (void);
+  /**
+   * \return the receivers of the PPDU
+   */
+  const std::vector<Receiver> & GetReceivers (void) const;
+
+private:
+  /** A serialized MPDU. */
+  struct Mpdu
+  {
+    WifiMacHeader header;           //!< the MAC header
+    Time timestamp;                 //!< the timestamp of the MPDU
+    std::vector<uint8_t> packet;    //!< the serialized packet
+  };
+  /** A serialized PSDU. */
+  struct Psdu
+  {
+    uint16_t staId;                 //!< the station ID of the PSDU
+    bool isSingle;                  //!< whether the PSDU is a single MPDU
+    std::vector<Mpdu> mpdus;        //!< the MPDUs
+  };
+
+  uint32_t m_sender;                //!< the index of the sender
+  uint64_t m_uid;                   //!< the UID of the PPDU
+  WifiTxVector m_txVector;          //!< the TXVECTOR of the PPDU
+  Time m_txDuration;                //!< the transmission duration of the PPDU
+  uint8_t m_txPsdFlag;              //!< the transmit PSD flag of an HE PPDU
+  std::vector<Psdu> m_psdus;        //!< the PSDUs of the PPDU
+  std::vector<Receiver> m_receivers; //!< the receivers of the PPDU
+};
+
+} //namespace ns3
+
+#endif /* WIFI_REMOTE_PPDU_HEADER_H */
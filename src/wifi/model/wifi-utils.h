@@ -127,6 +127,9 @@ void AddWifiMacTrailer (Ptr<Packet> packet);
  */
 uint32_t GetSize (Ptr<const Packet> packet, const WifiMacHeader *hdr, bool isAmpdu);
 
+/// Boltzmann constant, in J/K, for the thermal noise of the receivers
+const double BOLTZMANN = 1.3803e-23;
+
 /// Size of the space of sequence numbers
 const uint16_t SEQNO_SPACE_SIZE = 4096;
 
@@ -28,6 +28,7 @@
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("YansErrorRateModel");
+NS_LOG_HOT_PATH ();
 
 NS_OBJECT_ENSURE_REGISTERED (YansErrorRateModel);
 
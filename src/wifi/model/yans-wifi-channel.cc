@@ -19,8 +19,12 @@
  */
 
 #include "ns3/simulator.h"
+#include "ns3/multithreaded-simulator-impl.h"
 #include "ns3/log.h"
+#include "ns3/ring-trace.h"
+#include "ns3/abort.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
 #include "ns3/wifi-net-device.h"
 #include "ns3/node.h"
 #include "ns3/propagation-loss-model.h"
@@ -35,6 +39,12 @@
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("YansWifiChannel");
+NS_LOG_HOT_PATH ();
+
+/// Trace point of the PPDUs sent on the channel
+NS_RING_TRACE_DEFINE (g_sendTrace, "YansWifiChannel::Send", "uid,txPowerDbm");
+/// Trace point of the PPDUs received from the channel, before the RX sensitivity check
+NS_RING_TRACE_DEFINE (g_receiveTrace, "YansWifiChannel::Receive", "uid,rxPowerDbm");
 
 NS_OBJECT_ENSURE_REGISTERED (YansWifiChannel);
 
@@ -53,11 +63,21 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("ReceiverCulling",
+                   "Only deliver PPDUs to the receivers whose RX power, at the maximum TX power of the sender, "
+                   "is not below their RX sensitivity. Requires a deterministic propagation loss model.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::SetReceiverCulling,
+                                        &YansWifiChannel::GetReceiverCulling),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_culling (false),
+    m_neighborsUpdateScheduled (false),
+    m_nTracked (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -73,6 +93,7 @@ YansWifiChannel::SetPropagationLossModel (const Ptr<PropagationLossModel> loss)
 {
   NS_LOG_FUNCTION (this << loss);
   m_loss = loss;
+  InvalidateNeighbors ();
 }
 
 void
@@ -86,46 +107,252 @@ void
 YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double txPowerDbm) const
 {
   NS_LOG_FUNCTION (this << sender << ppdu << txPowerDbm);
+  NS_RING_TRACE (g_sendTrace, ppdu->GetUid (), txPowerDbm);
+  MultithreadedSimulatorImpl *simulator = MultithreadedSimulatorImpl::GetRunning ();
+  if (simulator != 0)
+    {
+      SendToPartitions (simulator, sender, ppdu, txPowerDbm);
+      return;
+    }
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  if (m_culling)
     {
-      if (sender != (*i))
+      std::size_t senderIndex = m_phyIndex.at (PeekPointer (sender));
+      if (senderIndex < m_neighborsValid.size () && m_neighborsValid[senderIndex]
+          && txPowerDbm <= m_neighborsTxPowerDbm[senderIndex])
         {
-          //For now don't account for inter channel interference nor channel bonding
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          for (const Neighbor &neighbor : m_neighbors[senderIndex])
             {
-              continue;
+              SendTo (sender, senderMobility, neighbor.index, ppdu, txPowerDbm, &neighbor.lossDb);
+            }
+          return;
+        }
+    }
+  for (std::size_t i = 0; i < m_phyList.size (); i++)
+    {
+      if (sender != m_phyList[i])
+        {
+          SendTo (sender, senderMobility, i, ppdu, txPowerDbm, 0);
+        }
+    }
+}
+
+void
+YansWifiChannel::SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, std::size_t index,
+                         Ptr<const WifiPpdu> ppdu, double txPowerDbm, const double *lossDb) const
+{
+  Ptr<YansWifiPhy> receiver = m_phyList[index];
+  //For now don't account for inter channel interference nor channel bonding
+  if (receiver->GetChannelNumber () != sender->GetChannelNumber ())
+    {
+      return;
+    }
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ();
+  Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  double rxPowerDbm = (lossDb != 0) ? txPowerDbm - *lossDb
+                                    : m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+  NS_LOG_WARN("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  Deliver (index, ppdu, delay, rxPowerDbm);
+}
+
+void
+YansWifiChannel::Deliver (std::size_t index, Ptr<const WifiPpdu> ppdu, Time delay, double rxPowerDbm) const
+{
+  Ptr<YansWifiPhy> receiver = m_phyList[index];
+  Simulator::ScheduleWithContext (GetNodeId (receiver),
+                                  delay, &YansWifiChannel::Receive,
+                                  PeekPointer (receiver), ppdu, rxPowerDbm);
+}
+
+void
+YansWifiChannel::SendToPartitions (MultithreadedSimulatorImpl *simulator, Ptr<YansWifiPhy> sender,
+                                   Ptr<const WifiPpdu> ppdu, double txPowerDbm) const
+{
+  NS_ABORT_MSG_IF (m_links.size () != m_phyList.size (),
+                   "YansWifiChannel::GetLookahead must be called before running a MultithreadedSimulatorImpl");
+  uint32_t current = simulator->GetCurrentPartition ();
+  std::vector<Ptr<const WifiPpdu> > copies (simulator->GetNPartitions ());
+  for (const Link &link : m_links[m_phyIndex.at (PeekPointer (sender))])
+    {
+      //For now don't account for inter channel interference nor channel bonding
+      if (link.receiver->GetChannelNumber () != sender->GetChannelNumber ())
+        {
+          continue;
+        }
+      Ptr<const WifiPpdu> copy = ppdu;
+      uint32_t partition = simulator->GetPartition (link.node);
+      if (partition != current)
+        {
+          // the PPDU must not be shared with the receivers of another partition
+          if (copies[partition] == 0)
+            {
+              copies[partition] = ppdu->DeepCopy ();
             }
+          copy = copies[partition];
+        }
+      Simulator::ScheduleWithContext (link.node, link.delay, &YansWifiChannel::Receive,
+                                      link.receiver, copy, txPowerDbm - link.lossDb);
+    }
+}
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_WARN("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<WifiPpdu> copy = ppdu->Copy ();
-          Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
+Time
+YansWifiChannel::GetLookahead (void)
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<MultithreadedSimulatorImpl> simulator = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  Time lookahead = Time::Max ();
+  m_links.assign (m_phyList.size (), std::vector<Link> ());
+  for (std::size_t i = 0; i < m_phyList.size (); i++)
+    {
+      Ptr<MobilityModel> senderMobility = m_phyList[i]->GetMobility ();
+      NS_ASSERT (senderMobility != 0);
+      uint32_t senderNode = GetNodeId (m_phyList[i]);
+      for (std::size_t j = 0; j < m_phyList.size (); j++)
+        {
+          if (j == i)
             {
-              dstNode = 0xffffffff;
+              continue;
             }
-          else
+          Ptr<MobilityModel> receiverMobility = m_phyList[j]->GetMobility ();
+          Link link;
+          link.receiver = PeekPointer (m_phyList[j]);
+          link.node = GetNodeId (m_phyList[j]);
+          link.delay = m_delay->GetDelay (senderMobility, receiverMobility);
+          link.lossDb = -m_loss->CalcRxPower (0, senderMobility, receiverMobility);
+          m_links[i].push_back (link);
+          if (link.node != senderNode
+              && (simulator == 0 || simulator->GetPartition (link.node) != simulator->GetPartition (senderNode)))
             {
-              dstNode = dstNetDevice->GetNode ()->GetId ();
+              lookahead = std::min (lookahead, link.delay);
             }
+        }
+    }
+  NS_LOG_DEBUG ("lookahead " << lookahead);
+  return lookahead;
+}
+
+std::size_t
+YansWifiChannel::GetPhyIndex (Ptr<YansWifiPhy> phy) const
+{
+  return m_phyIndex.at (PeekPointer (phy));
+}
+
+Ptr<YansWifiPhy>
+YansWifiChannel::GetPhy (std::size_t index) const
+{
+  return m_phyList.at (index);
+}
+
+Ptr<PropagationDelayModel>
+YansWifiChannel::GetPropagationDelayModel (void) const
+{
+  return m_delay;
+}
+
+uint32_t
+YansWifiChannel::GetNodeId (Ptr<YansWifiPhy> phy)
+{
+  Ptr<NetDevice> device = phy->GetDevice ();
+  return (device == 0) ? 0xffffffff : device->GetNode ()->GetId ();
+}
+
+void
+YansWifiChannel::SetReceiverCulling (bool culling)
+{
+  NS_LOG_FUNCTION (this << culling);
+  m_culling = culling;
+  ScheduleNeighborsUpdate ();
+}
+
+bool
+YansWifiChannel::GetReceiverCulling (void) const
+{
+  return m_culling;
+}
+
+void
+YansWifiChannel::ScheduleNeighborsUpdate (void)
+{
+  if (m_culling && !m_neighborsUpdateScheduled)
+    {
+      m_neighborsUpdateScheduled = true;
+      Simulator::ScheduleNow (&YansWifiChannel::UpdateNeighbors, this);
+    }
+}
+
+void
+YansWifiChannel::UpdateNeighbors (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_neighborsUpdateScheduled = false;
+  if (!m_culling)
+    {
+      return;
+    }
+  // PHYs may get their mobility model after having been added to the channel
+  for (; m_nTracked < m_phyList.size (); m_nTracked++)
+    {
+      Ptr<MobilityModel> mobility = m_phyList[m_nTracked]->GetMobility ();
+      NS_ASSERT (mobility != 0);
+      mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&YansWifiChannel::CourseChanged, this));
+    }
+  m_neighbors.resize (m_phyList.size ());
+  m_neighborsValid.resize (m_phyList.size (), false);
+  m_neighborsTxPowerDbm.resize (m_phyList.size ());
 
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm);
+  for (std::size_t senderIndex = 0; senderIndex < m_phyList.size (); senderIndex++)
+    {
+      if (m_neighborsValid[senderIndex])
+        {
+          continue;
+        }
+      Ptr<YansWifiPhy> sender = m_phyList[senderIndex];
+      NS_LOG_DEBUG ("building the neighbor list of " << sender);
+      std::vector<Neighbor> &neighbors = m_neighbors[senderIndex];
+      neighbors.clear ();
+      Ptr<MobilityModel> senderMobility = sender->GetMobility ();
+      double maxTxPowerDbm = std::max (sender->GetTxPowerStart (), sender->GetTxPowerEnd ()) + sender->GetTxGain ();
+      for (std::size_t i = 0; i < m_phyList.size (); i++)
+        {
+          Ptr<YansWifiPhy> receiver = m_phyList[i];
+          if (receiver == sender)
+            {
+              continue;
+            }
+          double lossDb = -m_loss->CalcRxPower (0, senderMobility, receiver->GetMobility ());
+          if (maxTxPowerDbm - lossDb + receiver->GetRxGain () >= receiver->GetRxSensitivity ())
+            {
+              neighbors.push_back ({i, lossDb});
+            }
         }
+      m_neighborsValid[senderIndex] = true;
+      m_neighborsTxPowerDbm[senderIndex] = maxTxPowerDbm;
+      NS_LOG_DEBUG (neighbors.size () << " neighbors out of " << m_phyList.size () - 1 << " receivers");
     }
 }
 
 void
-YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<WifiPpdu> ppdu, double rxPowerDbm)
+YansWifiChannel::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  InvalidateNeighbors ();
+}
+
+void
+YansWifiChannel::InvalidateNeighbors (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_neighborsValid.assign (m_neighborsValid.size (), false);
+  ScheduleNeighborsUpdate ();
+}
+
+void
+YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<const WifiPpdu> ppdu, double rxPowerDbm)
 {
   NS_LOG_FUNCTION (phy << ppdu << rxPowerDbm);
+  NS_RING_TRACE (g_receiveTrace, ppdu->GetUid (), rxPowerDbm);
   // Do no further processing if signal is too weak
   // Current implementation assumes constant RX power over the PPDU duration
   if ((rxPowerDbm + phy->GetRxGain ()) < phy->GetRxSensitivity ())
@@ -155,7 +382,9 @@ void
 YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
 {
   NS_LOG_FUNCTION (this << phy);
+  m_phyIndex[PeekPointer (phy)] = m_phyList.size ();
   m_phyList.push_back (phy);
+  ScheduleNeighborsUpdate ();
 }
 
 int64_t
@@ -21,17 +21,22 @@
 #ifndef YANS_WIFI_CHANNEL_H
 #define YANS_WIFI_CHANNEL_H
 
+#include <unordered_map>
+#include <vector>
 #include "ns3/channel.h"
+#include "ns3/nstime.h"
 
 namespace ns3 {
 
 class NetDevice;
 class PropagationLossModel;
 class PropagationDelayModel;
+class MobilityModel;
 class YansWifiPhy;
 class Packet;
 class Time;
 class WifiPpdu;
+class MultithreadedSimulatorImpl;
 
 /**
  * \brief a channel to interconnect ns3::YansWifiPhy objects.
@@ -41,6 +46,29 @@ class WifiPpdu;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * When the ReceiverCulling attribute is set, the channel keeps for each
+ * sender the list of the receivers that can sense its transmissions, i.e.,
+ * whose RX power at the maximum TX power of the sender is not below their
+ * RX sensitivity, and only delivers PPDUs to them, since weaker signals
+ * are discarded on reception anyway. The losses are cached in the lists,
+ * so this requires a deterministic propagation loss model, and
+ * InvalidateNeighbors must be called whenever its losses change. The lists
+ * are built in an event scheduled when a PHY is added, and built again in
+ * an event scheduled when they are invalidated; the PPDUs sent before,
+ * within the same time step, are delivered to all the receivers.
+ *
+ * With a MultithreadedSimulatorImpl, the PHYs attached to the channel may
+ * run in different partitions. GetLookahead must then be called before
+ * the simulation runs: it freezes the propagation delays and losses
+ * between the PHYs, which the channel uses instead of the mobility and
+ * propagation models (which are not thread-safe) while the simulation
+ * runs. The receivers in another partition than the sender get their own
+ * deep copy of the PPDU, posted to the mailbox of their partition. Hence,
+ * while such a simulation runs, the course changes of the nodes are
+ * ignored, a random propagation loss model (e.g., with fading) keeps the
+ * loss it drew for each pair of PHYs in GetLookahead, and receiver culling
+ * is not applied.
  */
 class YansWifiChannel : public Channel
 {
@@ -83,7 +111,7 @@ public:
    * attempts to deliver the PPDU to all other YansWifiPhy objects
    * on the channel (except for the sender).
    */
-  void Send (Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double txPowerDbm) const;
+  virtual void Send (Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double txPowerDbm) const;
 
   /**
    * Assign a fixed random variable stream number to the random variables
@@ -96,12 +124,60 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * Discard the neighbor lists used for receiver culling, e.g., after the
+   * losses of the propagation loss model, the RX sensitivity, the RX gain
+   * or the maximum TX power of a PHY have been changed, and schedule their
+   * update. Position changes are tracked automatically.
+   */
+  void InvalidateNeighbors (void);
 
-private:
   /**
-   * A vector of pointers to YansWifiPhy.
+   * Compute the propagation delays and losses between the PHYs, and
+   * freeze them for the runs of a MultithreadedSimulatorImpl. The nodes
+   * must not move afterwards.
+   *
+   * \return the smallest propagation delay between PHYs of nodes in
+   *         different partitions of the MultithreadedSimulatorImpl, or
+   *         between PHYs of different nodes with another simulator
+   *         implementation, to be used as lookahead; Time::Max () if there
+   *         is no such pair of PHYs
    */
-  typedef std::vector<Ptr<YansWifiPhy> > PhyList;
+  Time GetLookahead (void);
+
+
+protected:
+  /**
+   * Deliver a PPDU to a receiver, i.e., schedule the arrival of its first
+   * bit. This method is called by Send for each receiver of the PPDU.
+   *
+   * \param index the index of the receiver in the PHY list
+   * \param ppdu the PPDU being sent
+   * \param delay the propagation delay from the sender
+   * \param rxPowerDbm the RX power of the PPDU (dBm)
+   */
+  virtual void Deliver (std::size_t index, Ptr<const WifiPpdu> ppdu, Time delay, double rxPowerDbm) const;
+
+  /**
+   * \param phy a PHY attached to the channel
+   * \return the index of the PHY in the PHY list
+   */
+  std::size_t GetPhyIndex (Ptr<YansWifiPhy> phy) const;
+  /**
+   * \param index an index in the PHY list
+   * \return the PHY at this index
+   */
+  Ptr<YansWifiPhy> GetPhy (std::size_t index) const;
+  /**
+   * \return the propagation delay model
+   */
+  Ptr<PropagationDelayModel> GetPropagationDelayModel (void) const;
+
+  /**
+   * \param phy a PHY attached to the channel
+   * \return the id of the node of the PHY, or 0xffffffff if it has none
+   */
+  static uint32_t GetNodeId (Ptr<YansWifiPhy> phy);
 
   /**
    * This method is scheduled by Send for each associated YansWifiPhy.
@@ -109,14 +185,103 @@ private:
    * bit of the PPDU has arrived.
    *
    * \param receiver the device to which the packet is destined
-   * \param ppdu the PPDU being sent
+   * \param ppdu the PPDU being sent, shared by all the receivers of a partition
    * \param txPowerDbm the TX power associated to the packet being sent (dBm)
    */
-  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<WifiPpdu> ppdu, double txPowerDbm);
+  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<const WifiPpdu> ppdu, double txPowerDbm);
+
+private:
+  /**
+   * A vector of pointers to YansWifiPhy.
+   */
+  typedef std::vector<Ptr<YansWifiPhy> > PhyList;
+
+  /**
+   * A receiver that can sense the transmissions of a sender.
+   */
+  struct Neighbor
+  {
+    std::size_t index; //!< index of the receiver in the PHY list
+    double lossDb;     //!< propagation loss from the sender (dB)
+  };
+
+  /**
+   * A receiver of a sender, for the runs of a MultithreadedSimulatorImpl.
+   */
+  struct Link
+  {
+    YansWifiPhy *receiver; //!< the receiver, held by the PHY list
+    uint32_t node;         //!< the node id of the receiver
+    Time delay;            //!< propagation delay from the sender
+    double lossDb;         //!< propagation loss from the sender (dB)
+  };
+
+  /**
+   * Send a PPDU to a receiver, unless it is on another channel.
+   *
+   * \param sender the PHY object from which the packet is originating
+   * \param senderMobility the mobility model of the sender
+   * \param index the index of the receiver in the PHY list
+   * \param ppdu the PPDU to send
+   * \param txPowerDbm the TX power associated to the packet, in dBm
+   * \param lossDb the propagation loss to the receiver (dB) cached in the
+   *        neighbor list of the sender, or 0 to query the propagation loss model
+   */
+  void SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, std::size_t index,
+               Ptr<const WifiPpdu> ppdu, double txPowerDbm, const double *lossDb) const;
+
+  /**
+   * Send a PPDU while a MultithreadedSimulatorImpl runs, without touching
+   * the reference counts of the objects of other partitions.
+   *
+   * \param simulator the running simulator
+   * \param sender the PHY object from which the packet is originating
+   * \param ppdu the PPDU to send
+   * \param txPowerDbm the TX power associated to the packet, in dBm
+   */
+  void SendToPartitions (MultithreadedSimulatorImpl *simulator, Ptr<YansWifiPhy> sender,
+                         Ptr<const WifiPpdu> ppdu, double txPowerDbm) const;
+
+  /**
+   * \param culling whether to only deliver PPDUs to the neighbors of the sender
+   */
+  void SetReceiverCulling (bool culling);
+  /**
+   * \return whether PPDUs are only delivered to the neighbors of the sender
+   */
+  bool GetReceiverCulling (void) const;
+
+  /**
+   * Schedule UpdateNeighbors now, if receiver culling is enabled and no
+   * update is pending.
+   */
+  void ScheduleNeighborsUpdate (void);
+  /**
+   * Track the course changes of the PHYs added since the last update, and
+   * build the neighbor lists that are out of date, i.e., the lists of the
+   * receivers whose RX power, at the maximum TX power of the sender, is not
+   * below their RX sensitivity.
+   */
+  void UpdateNeighbors (void);
+  /**
+   * Invalidate the neighbor lists when a PHY moves.
+   *
+   * \param mobility the mobility model of the PHY
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility);
 
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+
+  bool m_culling;                      //!< only deliver PPDUs to the neighbors of the sender
+  std::vector<std::vector<Neighbor> > m_neighbors; //!< neighbor lists, by index of the sender
+  std::vector<bool> m_neighborsValid;              //!< whether the neighbor list of a sender is up to date
+  std::vector<double> m_neighborsTxPowerDbm;       //!< TX power (dBm) the neighbor list of a sender was built for
+  bool m_neighborsUpdateScheduled;                 //!< whether UpdateNeighbors is scheduled
+  std::unordered_map<const YansWifiPhy *, std::size_t> m_phyIndex; //!< index of each PHY in the PHY list
+  std::size_t m_nTracked;              //!< number of PHYs whose course changes are tracked
+  std::vector<std::vector<Link> > m_links; //!< receivers frozen by GetLookahead, by index of the sender
 };
 
 } //namespace ns3
@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/node.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/mobility-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/mpi-interface.h"
+#include "yans-wifi-remote-channel.h"
+#include "yans-wifi-phy.h"
+#include "wifi-remote-ppdu-header.h"
+#include "wifi-psdu.h"
+#include "phy-entity.h"
+#include "he/he-ppdu.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("YansWifiRemoteChannel");
+
+NS_OBJECT_ENSURE_REGISTERED (YansWifiRemoteChannel);
+
+TypeId
+YansWifiRemoteChannel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::YansWifiRemoteChannel")
+    .SetParent<YansWifiChannel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<YansWifiRemoteChannel> ()
+    .AddAttribute ("Lookahead",
+                   "The smallest propagation delay between the PHYs of this rank and those of the other ranks.",
+                   TypeId::ATTR_GET,
+                   TimeValue (Time::Max ()),
+                   MakeTimeAccessor (&YansWifiRemoteChannel::GetRemoteLookahead),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+YansWifiRemoteChannel::YansWifiRemoteChannel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+YansWifiRemoteChannel::~YansWifiRemoteChannel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+YansWifiRemoteChannel::GetSystemId (Ptr<YansWifiPhy> phy)
+{
+  return phy->GetDevice ()->GetNode ()->GetSystemId ();
+}
+
+void
+YansWifiRemoteChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double txPowerDbm) const
+{
+  NS_LOG_FUNCTION (this << sender << ppdu << txPowerDbm);
+  m_remoteReceivers.resize (MpiInterface::GetSize ());
+  // collect the receivers of the other ranks
+  YansWifiChannel::Send (sender, ppdu, txPowerDbm);
+
+  WifiRemotePpduHeader header;
+  bool serialized = false;
+  for (uint32_t systemId = 0; systemId < m_remoteReceivers.size (); systemId++)
+    {
+      std::vector<RemoteReceiver> &receivers = m_remoteReceivers[systemId];
+      if (receivers.empty ())
+        {
+          continue;
+        }
+      if (!serialized)
+        {
+          header.SetSender (GetPhyIndex (sender));
+          header.SetPpdu (ppdu);
+          serialized = true;
+        }
+      const RemoteReceiver *first = &receivers.front ();
+      for (const RemoteReceiver &receiver : receivers)
+        {
+          if (receiver.delay < first->delay)
+            {
+              first = &receiver;
+            }
+        }
+      header.ClearReceivers ();
+      for (const RemoteReceiver &receiver : receivers)
+        {
+          header.AddReceiver (receiver.index, receiver.delay - first->delay, receiver.rxPowerDbm);
+        }
+      Ptr<Packet> packet = Create<Packet> ();
+      packet->AddHeader (header);
+      Ptr<NetDevice> device = GetPhy (first->index)->GetDevice ();
+      NS_LOG_DEBUG ("send PPDU " << ppdu->GetUid () << " to " << receivers.size ()
+                    << " receivers of rank " << systemId);
+      MpiInterface::SendPacket (packet, Simulator::Now () + first->delay,
+                                device->GetNode ()->GetId (), device->GetIfIndex ());
+      receivers.clear ();
+    }
+}
+
+void
+YansWifiRemoteChannel::Deliver (std::size_t index, Ptr<const WifiPpdu> ppdu, Time delay, double rxPowerDbm) const
+{
+  uint32_t systemId = GetSystemId (GetPhy (index));
+  if (systemId == MpiInterface::GetSystemId ())
+    {
+      YansWifiChannel::Deliver (index, ppdu, delay, rxPowerDbm);
+      return;
+    }
+  m_remoteReceivers[systemId].push_back ({index, delay, rxPowerDbm});
+}
+
+void
+YansWifiRemoteChannel::ReceiveRemote (Ptr<Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+  WifiRemotePpduHeader header;
+  packet->RemoveHeader (header);
+  NS_LOG_DEBUG ("received " << header);
+
+  // rebuild the PPDU as the sender did
+  Ptr<YansWifiPhy> sender = GetPhy (header.GetSender ());
+  WifiTxVector txVector = header.GetTxVector ();
+  Ptr<WifiPpdu> ppdu = sender->GetPhyEntity (txVector.GetModulationClass ())
+    ->BuildPpdu (header.GetPsdus (), txVector, header.GetTxDuration ());
+  ppdu->SetUid (header.GetUid ());
+  Ptr<HePpdu> hePpdu = DynamicCast<HePpdu> (ppdu);
+  if (hePpdu != 0)
+    {
+      hePpdu->SetTxPsdFlag (static_cast<HePpdu::TxPsdFlag> (header.GetTxPsdFlag ()));
+    }
+
+  uint32_t context = Simulator::GetContext ();
+  for (const WifiRemotePpduHeader::Receiver &receiver : header.GetReceivers ())
+    {
+      Ptr<YansWifiPhy> phy = GetPhy (receiver.index);
+      NS_ASSERT (GetSystemId (phy) == MpiInterface::GetSystemId ());
+      uint32_t node = GetNodeId (phy);
+      if (receiver.delay.IsZero () && node == context)
+        {
+          // the receiver the message was sent to
+          Receive (phy, ppdu, receiver.rxPowerDbm);
+        }
+      else
+        {
+          Simulator::ScheduleWithContext (node, receiver.delay, &YansWifiChannel::Receive,
+                                          PeekPointer (phy), ppdu, receiver.rxPowerDbm);
+        }
+    }
+}
+
+Time
+YansWifiRemoteChannel::GetRemoteLookahead (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<PropagationDelayModel> delayModel = GetPropagationDelayModel ();
+  uint32_t localSystemId = MpiInterface::GetSystemId ();
+  Time lookahead = Time::Max ();
+  for (std::size_t i = 0; i < GetNDevices (); i++)
+    {
+      Ptr<YansWifiPhy> local = GetPhy (i);
+      if (GetSystemId (local) != localSystemId)
+        {
+          continue;
+        }
+      for (std::size_t j = 0; j < GetNDevices (); j++)
+        {
+          Ptr<YansWifiPhy> remote = GetPhy (j);
+          if (GetSystemId (remote) == localSystemId)
+            {
+              continue;
+            }
+          lookahead = std::min (lookahead, delayModel->GetDelay (local->GetMobility (), remote->GetMobility ()));
+        }
+    }
+  NS_LOG_DEBUG ("lookahead " << lookahead);
+  return lookahead;
+}
+
+} //namespace ns3
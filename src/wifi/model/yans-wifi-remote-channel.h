@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This object connects YansWifiPhy objects of nodes which are not all
+// local to this simulator object. It delivers the transmissions to the
+// receivers of the other ranks with MPI Send operations.
+
+#ifndef YANS_WIFI_REMOTE_CHANNEL_H
+#define YANS_WIFI_REMOTE_CHANNEL_H
+
+#include "yans-wifi-channel.h"
+#include <vector>
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \ingroup wifi
+ *
+ * \brief A YansWifiChannel spanning several MPI ranks
+ *
+ * As with the other distributed channels, every rank builds the whole
+ * topology, hence holds a copy of every PHY attached to the channel, with
+ * the same index in the PHY list on all the ranks; only the nodes whose
+ * system id is that of the rank run. The channel delivers the
+ * transmissions to the local receivers as a YansWifiChannel does, and
+ * sends a single message to each other rank with receivers of a
+ * transmission, which carries the serialized PPDU along with the delay and
+ * RX power of each receiver of that rank (see WifiRemotePpduHeader). The
+ * message is received by the MpiReceiver of the device of the earliest
+ * receiver, which rebuilds the PPDU with the copy of the sender and
+ * schedules its reception by the receivers of its rank.
+ *
+ * The Lookahead attribute, used by the distributed simulator
+ * implementations to synchronize the ranks, is the smallest propagation
+ * delay between the PHYs of this rank and those of the other ranks. It
+ * is only read when the simulation starts, hence mobile nodes are not
+ * supported unless they never get closer to the nodes of other ranks
+ * than the closest nodes were then: a rank receiving a message after its
+ * reception time aborts the simulation. The losses and delays are computed
+ * by the rank of the sender with its copies of the mobility models of
+ * the remote receivers.
+ */
+class YansWifiRemoteChannel : public YansWifiChannel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  YansWifiRemoteChannel ();
+  virtual ~YansWifiRemoteChannel ();
+
+  void Send (Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double txPowerDbm) const override;
+
+  /**
+   * \return the smallest propagation delay between the PHYs of the nodes
+   *         of this rank and the PHYs of the nodes of the other ranks, or
+   *         Time::Max () if there is no such pair of PHYs
+   */
+  Time GetRemoteLookahead (void) const;
+
+  /**
+   * Receive a message sent by another rank, and schedule the reception
+   * of the PPDU it carries by the receivers of this rank.
+   *
+   * \param packet the message
+   */
+  void ReceiveRemote (Ptr<Packet> packet);
+
+protected:
+  void Deliver (std::size_t index, Ptr<const WifiPpdu> ppdu, Time delay, double rxPowerDbm) const override;
+
+private:
+  /** A receiver of another rank. */
+  struct RemoteReceiver
+  {
+    std::size_t index; //!< the index of the receiver in the PHY list
+    Time delay;        //!< the propagation delay from the sender
+    double rxPowerDbm; //!< the RX power (dBm)
+  };
+
+  /**
+   * \param phy a PHY attached to the channel
+   * \return the system id of the node of the PHY
+   */
+  static uint32_t GetSystemId (Ptr<YansWifiPhy> phy);
+
+  /** The receivers of the transmission being sent, by system id. */
+  mutable std::vector<std::vector<RemoteReceiver> > m_remoteReceivers;
+};
+
+} //namespace ns3
+
+#endif /* YANS_WIFI_REMOTE_CHANNEL_H */
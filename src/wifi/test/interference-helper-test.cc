@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/interference-helper.h"
+#include "ns3/nist-error-rate-model.h"
+#include "ns3/ofdm-phy.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-ppdu.h"
+#include "ns3/wifi-psdu.h"
+#include "ns3/wifi-utils.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Incremental computation of the PER of the MPDUs of an A-MPDU
+ *
+ * A signal of ten 100 us MPDUs is received while interferers keep
+ * starting and ending. An InterferenceHelper computes the PER of each
+ * MPDU at its end, as the PHY does, and the PER of the whole payload at
+ * the end of every MPDU, before all the interferers overlapping it have
+ * arrived. Another InterferenceHelper, fed with the same signals,
+ * computes the same PERs at the end of the signal, starting each walk
+ * from the start of the signal: the PERs must be the same.
+ */
+class InterferenceHelperIncrementalPerTest : public TestCase
+{
+public:
+  InterferenceHelperIncrementalPerTest ();
+
+private:
+  void DoRun (void) override;
+  /**
+   * Add a signal to both interference helpers.
+   * \param duration the duration of the signal
+   * \param powerDbm the power of the signal, in dBm
+   */
+  void AddSignal (Time duration, double powerDbm);
+  /**
+   * Compute the PERs of an MPDU and of the whole payload.
+   * \param mpdu the index of the MPDU
+   */
+  void EndOfMpdu (uint32_t mpdu);
+  /**
+   * Compare the PERs with those of the reference.
+   */
+  void CheckPers (void);
+
+  static const uint32_t N_MPDUS = 10; //!< the number of MPDUs
+  static const WifiSpectrumBand BAND; //!< the band of the signals
+
+  InterferenceHelper m_incremental;  //!< computes the PERs as the signal is received
+  InterferenceHelper m_reference;    //!< computes the PERs at the end
+  Ptr<Event> m_incrementalEvent;     //!< the received signal
+  Ptr<Event> m_referenceEvent;       //!< the received signal
+  WifiTxVector m_txVector;           //!< the TXVECTOR of the signals
+  Time m_mpduDuration;               //!< the duration of an MPDU
+  std::vector<double> m_mpduPers;    //!< the PER of each MPDU
+  double m_payloadPer;               //!< the last PER of the whole payload
+};
+
+const WifiSpectrumBand InterferenceHelperIncrementalPerTest::BAND = std::make_pair (0, 0);
+
+InterferenceHelperIncrementalPerTest::InterferenceHelperIncrementalPerTest ()
+  : TestCase ("Check the incremental computation of the PER of the MPDUs of an A-MPDU"),
+    m_mpduDuration (MicroSeconds (100)),
+    m_payloadPer (0)
+{
+}
+
+void
+InterferenceHelperIncrementalPerTest::AddSignal (Time duration, double powerDbm)
+{
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  Ptr<WifiPpdu> ppdu = Create<WifiPpdu> (Create<WifiPsdu> (Create<Packet> (1000), hdr), m_txVector);
+  RxPowerWattPerChannelBand rxPowerW {{BAND, DbmToW (powerDbm)}};
+  RxPowerWattPerChannelBand referenceRxPowerW {{BAND, DbmToW (powerDbm)}};
+  Ptr<Event> event = m_incremental.Add (ppdu, m_txVector, duration, rxPowerW);
+  Ptr<Event> referenceEvent = m_reference.Add (ppdu, m_txVector, duration, referenceRxPowerW);
+  if (!m_incrementalEvent)
+    {
+      m_incrementalEvent = event;
+      m_referenceEvent = referenceEvent;
+      m_incremental.NotifyRxStart ();
+      m_reference.NotifyRxStart ();
+    }
+}
+
+void
+InterferenceHelperIncrementalPerTest::EndOfMpdu (uint32_t mpdu)
+{
+  m_mpduPers.push_back (m_incremental.CalculatePayloadSnrPer (m_incrementalEvent, 20, BAND, SU_STA_ID,
+                                                              std::make_pair (mpdu * m_mpduDuration, (mpdu + 1) * m_mpduDuration)).per);
+  // the whole payload, with another channel width not to disturb the walk of the MPDUs
+  m_payloadPer = m_incremental.CalculatePayloadSnrPer (m_incrementalEvent, 40, BAND, SU_STA_ID,
+                                                       std::make_pair (Seconds (0), N_MPDUS * m_mpduDuration)).per;
+}
+
+void
+InterferenceHelperIncrementalPerTest::DoRun (void)
+{
+  m_txVector = WifiTxVector (OfdmPhy::GetOfdmRate54Mbps (), 0, WIFI_PREAMBLE_LONG, 800, 1, 1, 0, 20, false);
+  for (InterferenceHelper *interference : {&m_incremental, &m_reference})
+    {
+      interference->SetNoiseFigure (DbToRatio (7));
+      interference->SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+      interference->AddBand (BAND);
+    }
+
+  Time payloadStart = WifiPhy::CalculatePhyPreambleAndHeaderDuration (m_txVector);
+  AddSignal (payloadStart + N_MPDUS * m_mpduDuration, -60);
+  for (uint32_t i = 0; i < 27; i++)
+    {
+      Simulator::Schedule (MicroSeconds (5 + 37 * i), &InterferenceHelperIncrementalPerTest::AddSignal, this,
+                           MicroSeconds (150), -96 + 2.0 * (i % 5));
+    }
+  for (uint32_t mpdu = 0; mpdu < N_MPDUS; mpdu++)
+    {
+      Simulator::Schedule (payloadStart + (mpdu + 1) * m_mpduDuration, &InterferenceHelperIncrementalPerTest::EndOfMpdu, this, mpdu);
+    }
+  // after the end of the last MPDU
+  Simulator::Schedule (payloadStart + N_MPDUS * m_mpduDuration, &InterferenceHelperIncrementalPerTest::CheckPers, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+InterferenceHelperIncrementalPerTest::CheckPers (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_mpduPers.size (), N_MPDUS, "Missing MPDUs");
+  double minPer = 1;
+  double maxPer = 0;
+  // the MPDUs in reverse order, so that every walk starts from the start of the signal
+  for (uint32_t mpdu = N_MPDUS; mpdu-- > 0; )
+    {
+      double per = m_reference.CalculatePayloadSnrPer (m_referenceEvent, 20, BAND, SU_STA_ID,
+                                                       std::make_pair (mpdu * m_mpduDuration, (mpdu + 1) * m_mpduDuration)).per;
+      NS_TEST_EXPECT_MSG_EQ_TOL (m_mpduPers[mpdu], per, 1e-12, "Unexpected PER of MPDU " << mpdu);
+      minPer = std::min (minPer, per);
+      maxPer = std::max (maxPer, per);
+    }
+  NS_TEST_EXPECT_MSG_GT (maxPer, minPer, "The interferers do not change the PER of the MPDUs");
+  double per = m_reference.CalculatePayloadSnrPer (m_referenceEvent, 40, BAND, SU_STA_ID,
+                                                   std::make_pair (Seconds (0), N_MPDUS * m_mpduDuration)).per;
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_payloadPer, per, 1e-12, "Unexpected PER of the payload");
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Incremental A-MPDU PER Test Suite
+ */
+class InterferenceHelperIncrementalPerTestSuite : public TestSuite
+{
+public:
+  InterferenceHelperIncrementalPerTestSuite ();
+};
+
+InterferenceHelperIncrementalPerTestSuite::InterferenceHelperIncrementalPerTestSuite ()
+  : TestSuite ("wifi-incremental-per", UNIT)
+{
+  AddTestCase (new InterferenceHelperIncrementalPerTest, TestCase::QUICK);
+}
+
+static InterferenceHelperIncrementalPerTestSuite g_interferenceHelperIncrementalPerTestSuite; ///< the test suite
@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/twt-schedule-manager.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
+using namespace ns3;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Make sure that the TWT schedule manager wakes up and puts to sleep
+ * its stations at the boundaries of their service periods.
+ *
+ * Stations 0 and 1 have the same periodic schedule and station 2 has a
+ * single service period. The schedule of station 1 is removed while it
+ * sleeps, which must wake it up and stop its service periods.
+ */
+class TwtScheduleManagerTestCase : public TestCase
+{
+public:
+  TwtScheduleManagerTestCase ();
+
+private:
+  void DoRun (void) override;
+
+  /**
+   * Callback when a station is put to sleep or woken up
+   * \param mac the MAC of the station
+   * \param sleeping whether the station is put to sleep
+   */
+  void StateChange (Ptr<WifiMac> mac, bool sleeping);
+
+  std::vector<Ptr<WifiMac> > m_macs;                            ///< MACs of the stations
+  std::vector<std::vector<std::pair<Time, bool> > > m_changes;  ///< state changes per station
+};
+
+TwtScheduleManagerTestCase::TwtScheduleManagerTestCase ()
+  : TestCase ("Test case for the TWT schedule manager")
+{
+}
+
+void
+TwtScheduleManagerTestCase::StateChange (Ptr<WifiMac> mac, bool sleeping)
+{
+  auto it = std::find (m_macs.begin (), m_macs.end (), mac);
+  NS_ASSERT (it != m_macs.end ());
+  m_changes.at (it - m_macs.begin ()).push_back ({Simulator::Now (), sleeping});
+}
+
+void
+TwtScheduleManagerTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  MobilityHelper mobility;
+  mobility.Install (nodes);
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy;
+  phy.SetChannel (channel.Create ());
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_STANDARD_80211ax);
+  Ptr<TwtScheduleManager> manager = CreateObject<TwtScheduleManager> ();
+  WifiMacHelper mac;
+  mac.SetType ("ns3::StaWifiMac",
+               "TwtScheduleManager", PointerValue (manager));
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      m_macs.push_back (DynamicCast<WifiNetDevice> (devices.Get (i))->GetMac ());
+    }
+  m_changes.resize (3);
+  manager->TraceConnectWithoutContext ("StateChange",
+                                       MakeCallback (&TwtScheduleManagerTestCase::StateChange, this));
+
+  // stations 0 and 1 share their boundaries, station 2 has a single
+  // service period
+  TwtScheduleManager::Schedule periodic {Seconds (1), Seconds (0), MilliSeconds (10), MilliSeconds (100)};
+  TwtScheduleManager::Schedule single {Seconds (1), MilliSeconds (50), MilliSeconds (10), Seconds (0)};
+  manager->SetSchedules (m_macs, {periodic, periodic, single});
+  NS_TEST_ASSERT_MSG_EQ (manager->GetNSchedules (), 3, "Unexpected number of schedules");
+
+  // removing the schedule of station 1 while it sleeps wakes it up
+  TwtScheduleManager::Schedule none {Seconds (0), Seconds (0), Seconds (0), Seconds (0)};
+  Simulator::Schedule (MilliSeconds (1150), &TwtScheduleManager::SetSchedule, manager, m_macs[1], none);
+
+  Simulator::Stop (MilliSeconds (1250));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (manager->GetNSchedules (), 2, "Unexpected number of schedules");
+  NS_TEST_ASSERT_MSG_EQ (manager->HasSchedule (m_macs[1]), false, "Station 1 should have no schedule");
+
+  std::vector<std::pair<Time, bool> > expected0 = {{MilliSeconds (900), true}, {MilliSeconds (1000), false},
+                                                   {MilliSeconds (1010), true}, {MilliSeconds (1100), false},
+                                                   {MilliSeconds (1110), true}, {MilliSeconds (1200), false},
+                                                   {MilliSeconds (1210), true}};
+  std::vector<std::pair<Time, bool> > expected1 (expected0.begin (), expected0.begin () + 5);
+  expected1.push_back ({MilliSeconds (1150), false});
+  std::vector<std::pair<Time, bool> > expected2 = {{MilliSeconds (900), true}, {MilliSeconds (1050), false},
+                                                   {MilliSeconds (1060), true}};
+  std::vector<std::vector<std::pair<Time, bool> > > expected = {expected0, expected1, expected2};
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_changes[i].size (), expected[i].size (),
+                             "Unexpected number of state changes for station " << i);
+      for (std::size_t j = 0; j < std::min (m_changes[i].size (), expected[i].size ()); j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_changes[i][j].first, expected[i][j].first,
+                                 "Unexpected time of state change " << j << " for station " << i);
+          NS_TEST_EXPECT_MSG_EQ (m_changes[i][j].second, expected[i][j].second,
+                                 "Unexpected state change " << j << " for station " << i);
+        }
+    }
+
+  Simulator::Destroy ();
+  m_macs.clear ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief TWT schedule manager Test Suite
+ */
+class TwtScheduleManagerTestSuite : public TestSuite
+{
+public:
+  TwtScheduleManagerTestSuite ();
+};
+
+TwtScheduleManagerTestSuite::TwtScheduleManagerTestSuite ()
+  : TestSuite ("wifi-twt-schedule-manager", UNIT)
+{
+  AddTestCase (new TwtScheduleManagerTestCase, TestCase::QUICK);
+}
+
+static TwtScheduleManagerTestSuite g_twtScheduleManagerTestSuite; ///< the test suite
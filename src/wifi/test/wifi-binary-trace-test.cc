@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/wifi-binary-trace-helper.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+
+#include <cstring>
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Make sure that the binary wifi trace records the transmissions,
+ * receptions and associations.
+ *
+ * A station is associated with an access point while the trace is enabled,
+ * then sends an IPv4 datagram to the access point. The trace must hold
+ * the association, the beginning and the end of the transmission of the
+ * data frame by the station and its reception by the access point, with
+ * the addresses of the frame and of the datagram.
+ */
+class WifiBinaryTraceTestCase : public TestCase
+{
+public:
+  WifiBinaryTraceTestCase ();
+
+private:
+  void DoRun (void) override;
+};
+
+WifiBinaryTraceTestCase::WifiBinaryTraceTestCase ()
+  : TestCase ("Test case for the binary wifi trace")
+{
+}
+
+void
+WifiBinaryTraceTestCase::DoRun (void)
+{
+  NodeContainer apNodes;
+  apNodes.Create (1);
+  NodeContainer staNodes;
+  staNodes.Create (1);
+  MobilityHelper mobility;
+  mobility.Install (apNodes);
+  mobility.Install (staNodes);
+
+  YansWifiPhyHelper phy;
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  phy.SetChannel (channel.Create ());
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_STANDARD_80211a);
+  WifiMacHelper mac;
+  mac.SetType ("ns3::ApWifiMac", "BeaconGeneration", BooleanValue (false));
+  NetDeviceContainer apDevices = wifi.Install (phy, mac, apNodes);
+  mac.SetType ("ns3::StaWifiMac");
+  NetDeviceContainer staDevices = wifi.Install (phy, mac, staNodes);
+
+  std::string filename = CreateTempDirFilename ("wifi-trace.bin");
+  WifiBinaryTraceHelper trace;
+  trace.Open (filename);
+  trace.EnablePhyTx (staDevices);
+  trace.EnableMacRx (apDevices);
+  trace.EnableAssociation (apDevices);
+  WifiHelper::Associate (staDevices, apDevices, {0});
+
+  // a bare IPv4 header, from 10.0.0.2 to 10.0.0.1
+  uint8_t datagram[100] = {0x45};
+  uint8_t addresses[8] = {10, 0, 0, 2, 10, 0, 0, 1};
+  std::memcpy (datagram + 12, addresses, sizeof (addresses));
+  Ptr<Packet> packet = Create<Packet> (datagram, sizeof (datagram));
+  Ptr<WifiNetDevice> sender = DynamicCast<WifiNetDevice> (staDevices.Get (0));
+  Simulator::Schedule (MilliSeconds (10), &WifiNetDevice::Send, sender, packet,
+                       apDevices.Get (0)->GetAddress (), 0x0800);
+  Simulator::Stop (MilliSeconds (20));
+  Simulator::Run ();
+  // the devices lose their MAC when they are disposed
+  Mac48Address staAddress = Mac48Address::ConvertFrom (staDevices.Get (0)->GetAddress ());
+  Mac48Address apAddress = Mac48Address::ConvertFrom (apDevices.Get (0)->GetAddress ());
+  Simulator::Destroy ();
+
+  uint64_t sta = WifiBinaryTraceSink::ConvertAddress (staAddress);
+  uint64_t ap = WifiBinaryTraceSink::ConvertAddress (apAddress);
+  NS_TEST_EXPECT_MSG_EQ (WifiBinaryTraceReader::GetMacAddress (sta), staAddress, "Unexpected address conversion");
+
+  WifiBinaryTraceReader reader (filename);
+  WifiTraceRecord record;
+  std::vector<WifiTraceRecord> records;
+  while (reader.Read (record))
+    {
+      records.push_back (record);
+    }
+  NS_TEST_ASSERT_MSG_EQ (records.size (), 4, "Unexpected number of records");
+
+  NS_TEST_EXPECT_MSG_EQ (+records[0].type, WifiTraceRecord::ASSOCIATION, "Unexpected type");
+  NS_TEST_EXPECT_MSG_EQ (records[0].ts, 0, "Unexpected time");
+  NS_TEST_EXPECT_MSG_EQ (records[0].nodeId, apNodes.Get (0)->GetId (), "Unexpected node");
+  NS_TEST_EXPECT_MSG_EQ (records[0].seq, 1, "Unexpected AID");
+  NS_TEST_EXPECT_MSG_EQ (records[0].src, sta, "Unexpected station");
+
+  for (uint32_t i = 1; i <= 2; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (+records[i].type, (i == 1 ? WifiTraceRecord::PHY_TX_BEGIN : WifiTraceRecord::PHY_TX_END),
+                             "Unexpected type");
+      NS_TEST_EXPECT_MSG_EQ (records[i].nodeId, staNodes.Get (0)->GetId (), "Unexpected node");
+      NS_TEST_EXPECT_MSG_EQ (records[i].uid, packet->GetUid (), "Unexpected packet");
+      NS_TEST_EXPECT_MSG_EQ (records[i].src, sta, "Unexpected transmitter");
+      NS_TEST_EXPECT_MSG_EQ (records[i].dst, ap, "Unexpected receiver");
+      // MAC header (24 bytes), LLC/SNAP header (8 bytes), datagram and FCS (4 bytes)
+      NS_TEST_EXPECT_MSG_EQ (records[i].size, 24 + 8 + sizeof (datagram) + 4, "Unexpected size");
+      NS_TEST_EXPECT_MSG_EQ (+records[i].frameType, WIFI_MAC_DATA, "Unexpected frame type");
+    }
+  NS_TEST_EXPECT_MSG_GT (records[1].ts, MilliSeconds (10).GetTimeStep (), "Unexpected time");
+  NS_TEST_EXPECT_MSG_GT (records[2].ts, records[1].ts, "Unexpected time");
+  NS_TEST_EXPECT_MSG_EQ_TOL (records[1].txPowerDbm, 10, 1e-9, "Unexpected transmit power");
+
+  NS_TEST_EXPECT_MSG_EQ (+records[3].type, WifiTraceRecord::MAC_RX, "Unexpected type");
+  NS_TEST_EXPECT_MSG_EQ (records[3].nodeId, apNodes.Get (0)->GetId (), "Unexpected node");
+  NS_TEST_EXPECT_MSG_EQ (records[3].uid, packet->GetUid (), "Unexpected packet");
+  NS_TEST_EXPECT_MSG_EQ (records[3].size, 8 + sizeof (datagram), "Unexpected size");
+  NS_TEST_EXPECT_MSG_EQ (WifiBinaryTraceReader::GetIpv4Address (records[3].src), Ipv4Address ("10.0.0.2"),
+                         "Unexpected source");
+  NS_TEST_EXPECT_MSG_EQ (WifiBinaryTraceReader::GetIpv4Address (records[3].dst), Ipv4Address ("10.0.0.1"),
+                         "Unexpected destination");
+  std::ostringstream oss;
+  WifiBinaryTraceReader::Print (oss, records[3]);
+  std::string text = oss.str ();
+  NS_TEST_EXPECT_MSG_EQ (text.substr (text.find (" MacRx")),
+                         " MacRx uid=" + std::to_string (packet->GetUid ()) + " src=10.0.0.2 dst=10.0.0.1 size=108",
+                         "Unexpected text " << text);
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Binary wifi trace Test Suite
+ */
+class WifiBinaryTraceTestSuite : public TestSuite
+{
+public:
+  WifiBinaryTraceTestSuite ();
+};
+
+WifiBinaryTraceTestSuite::WifiBinaryTraceTestSuite ()
+  : TestSuite ("wifi-binary-trace", UNIT)
+{
+  AddTestCase (new WifiBinaryTraceTestCase, TestCase::QUICK);
+}
+
+static WifiBinaryTraceTestSuite g_wifiBinaryTraceTestSuite; ///< the test suite
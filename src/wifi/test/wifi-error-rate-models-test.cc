@@ -27,7 +27,14 @@
 #include "ns3/wifi-phy.h"
 #include "ns3/wifi-utils.h"
 #include "ns3/table-based-error-rate-model.h"
+#include "ns3/ppv-error-rate-model.h"
+#include "ns3/boolean.h"
+#include "ns3/mcs-selection-helper.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/node.h"
 #include "ns3/he-phy.h" //includes HT and VHT
+#include <algorithm>
 
 using namespace ns3;
 
@@ -1527,6 +1534,201 @@ TableBasedErrorRateTestCase::DoRun (void)
     }
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Check that the tabulated PPV error rate model matches the closed form
+ */
+class PpvErrorRateTabulatedTestCase : public TestCase
+{
+public:
+  PpvErrorRateTabulatedTestCase ();
+  virtual ~PpvErrorRateTabulatedTestCase ();
+
+private:
+  void DoRun (void) override;
+};
+
+PpvErrorRateTabulatedTestCase::PpvErrorRateTabulatedTestCase ()
+  : TestCase ("Tabulated PPV error rate model")
+{
+}
+
+PpvErrorRateTabulatedTestCase::~PpvErrorRateTabulatedTestCase ()
+{
+}
+
+void
+PpvErrorRateTabulatedTestCase::DoRun (void)
+{
+  Ptr<PpvErrorRateModel> exact = CreateObject<PpvErrorRateModel> ();
+  Ptr<PpvErrorRateModel> tabulated = CreateObject<PpvErrorRateModel> ();
+  tabulated->SetAttribute ("Tabulated", BooleanValue (true));
+
+  std::vector<WifiMode> modes {WifiMode ("OfdmRate6Mbps"), WifiMode ("OfdmRate18Mbps"),
+                               WifiMode ("OfdmRate36Mbps"), WifiMode ("OfdmRate54Mbps")};
+  WifiTxVector txVector;
+  txVector.SetChannelWidth (20);
+  std::vector<double> successRates;
+
+  for (uint64_t nbits : {80, 1000, 12000, 65535 * 8})
+    {
+      for (double snr = -4.987; snr <= 34; snr += 0.131)
+        {
+          double snrLinear = std::pow (10.0, snr / 10.0);
+          tabulated->GetChunkSuccessRates (modes, txVector, snrLinear, nbits, successRates);
+          for (std::size_t k = 0; k < modes.size (); k++)
+            {
+              txVector.SetMode (modes[k]);
+              double expected = exact->GetChunkSuccessRate (modes[k], txVector, snrLinear, nbits);
+              double ps = tabulated->GetChunkSuccessRate (modes[k], txVector, snrLinear, nbits);
+              NS_TEST_ASSERT_MSG_EQ_TOL (ps, expected, 1e-3, "Tabulated success rate of " << modes[k]
+                                         << " at " << snr << " dB for " << nbits << " bits");
+              NS_TEST_ASSERT_MSG_EQ (ps, successRates[k], "Batch and single success rates differ");
+            }
+        }
+    }
+
+  // outside of the tables, the closed form is used
+  txVector.SetMode (modes[0]);
+  double snrLinear = std::pow (10.0, -20.0 / 10.0);
+  NS_TEST_ASSERT_MSG_EQ (tabulated->GetChunkSuccessRate (modes[0], txVector, snrLinear, 1000),
+                         exact->GetChunkSuccessRate (modes[0], txVector, snrLinear, 1000),
+                         "SNR below the tables must be evaluated exactly");
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Check that the MCS selection helper gives the same access points and
+ * modes as evaluating every mode for every station
+ */
+class McsSelectionHelperTestCase : public TestCase
+{
+public:
+  McsSelectionHelperTestCase ();
+  virtual ~McsSelectionHelperTestCase ();
+
+private:
+  void DoRun (void) override;
+};
+
+McsSelectionHelperTestCase::McsSelectionHelperTestCase ()
+  : TestCase ("MCS selection helper")
+{
+}
+
+McsSelectionHelperTestCase::~McsSelectionHelperTestCase ()
+{
+}
+
+void
+McsSelectionHelperTestCase::DoRun (void)
+{
+  Ptr<NistErrorRateModel> model = CreateObject<NistErrorRateModel> ();
+  std::vector<WifiMode> modes;
+  for (const auto& name : {"OfdmRate54Mbps", "OfdmRate6Mbps", "OfdmRate12Mbps", "OfdmRate9Mbps",
+                           "OfdmRate24Mbps", "OfdmRate18Mbps", "OfdmRate36Mbps", "OfdmRate48Mbps"})
+    {
+      modes.push_back (WifiMode (name));
+    }
+  WifiTxVector txVector;
+  txVector.SetChannelWidth (20);
+  uint32_t packetSize = 1000;
+  double txPowerDbm = 16;
+  double noiseFigureDb = 7;
+  double target = 1 - 1e-5;
+
+  McsSelectionHelper helper;
+  helper.SetErrorRateModel (model);
+  helper.SetModes (modes);
+  helper.SetTxVector (txVector);
+  helper.SetPacketSize (packetSize);
+  helper.SetTxPower (txPowerDbm);
+  helper.SetNoiseFigure (noiseFigureDb);
+  helper.SetTargetSuccessRate (target);
+
+  uint32_t nSta = 200;
+  uint32_t nAp = 3;
+  double noiseW = DbToRatio (noiseFigureDb) * BOLTZMANN * 290 * 20e6;
+  // select twice, as if the losses were changed during an episode
+  for (double offset : {0.0, 7.3})
+    {
+      std::vector<double> gains;
+      for (uint32_t sta = 0; sta < nSta; sta++)
+        {
+          for (uint32_t ap = 0; ap < nAp; ap++)
+            {
+              gains.push_back (-110 + offset + std::fmod (sta * 0.37 + ap * 11.1, 45.0));
+            }
+        }
+      std::vector<McsSelectionHelper::Selection> selections = helper.Select (gains, nSta, nAp);
+      NS_TEST_ASSERT_MSG_EQ (selections.size (), nSta, "One selection per station expected");
+
+      for (uint32_t sta = 0; sta < nSta; sta++)
+        {
+          uint32_t bestAp = 0;
+          for (uint32_t ap = 1; ap < nAp; ap++)
+            {
+              if (gains[sta * nAp + ap] > gains[sta * nAp + bestAp])
+                {
+                  bestAp = ap;
+                }
+            }
+          double snr = DbmToW (txPowerDbm + gains[sta * nAp + bestAp]) / noiseW;
+          WifiMode bestMode = WifiMode ("OfdmRate6Mbps");
+          uint64_t bestRate = 0;
+          for (const auto& mode : modes)
+            {
+              txVector.SetMode (mode);
+              uint64_t rate = mode.GetDataRate (txVector);
+              if (rate > bestRate && model->GetChunkSuccessRate (mode, txVector, snr, packetSize * 8) >= target)
+                {
+                  bestRate = rate;
+                  bestMode = mode;
+                }
+            }
+          NS_TEST_ASSERT_MSG_EQ (selections[sta].ap, bestAp, "Wrong AP for station " << sta);
+          NS_TEST_ASSERT_MSG_EQ (selections[sta].mode, bestMode, "Wrong mode for station " << sta
+                                 << " at " << RatioToDb (snr) << " dB");
+        }
+    }
+
+  // a station out of coverage gets the fallback mode, even if not a candidate
+  WifiMode fallback ("OfdmRate9Mbps");
+  modes.erase (std::remove (modes.begin (), modes.end (), fallback), modes.end ());
+  helper.SetModes (modes);
+  helper.SetFallbackMode (fallback);
+  std::vector<double> gains (2, -200);
+  std::vector<McsSelectionHelper::Selection> selections = helper.Select (gains, 1, 2);
+  NS_TEST_ASSERT_MSG_EQ (selections[0].ap, 0, "Ties should go to the first AP");
+  NS_TEST_ASSERT_MSG_EQ (selections[0].mode, fallback, "Fallback mode expected");
+  NS_TEST_ASSERT_MSG_EQ (selections[0].dataRate, 9000000, "Wrong data rate of the fallback mode");
+
+  // the gains of a loss model are taken in the uplink direction, from the
+  // station to the access points, even when the losses are asymmetric
+  NodeContainer staNodes (1);
+  NodeContainer apNodes (2);
+  NodeContainer nodes (staNodes, apNodes);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      nodes.Get (i)->AggregateObject (CreateObject<ConstantPositionMobilityModel> ());
+    }
+  Ptr<MobilityModel> sta = staNodes.Get (0)->GetObject<MobilityModel> ();
+  Ptr<MobilityModel> ap0 = apNodes.Get (0)->GetObject<MobilityModel> ();
+  Ptr<MobilityModel> ap1 = apNodes.Get (1)->GetObject<MobilityModel> ();
+  Ptr<MatrixPropagationLossModel> lossModel = CreateObject<MatrixPropagationLossModel> ();
+  lossModel->SetLoss (sta, ap0, 60, false);
+  lossModel->SetLoss (ap0, sta, 100, false);
+  lossModel->SetLoss (sta, ap1, 80, false);
+  lossModel->SetLoss (ap1, sta, 50, false);
+  selections = helper.Select (lossModel, staNodes, apNodes);
+  NS_TEST_ASSERT_MSG_EQ (selections[0].ap, 0, "The AP with the highest uplink gain should be selected");
+  NS_TEST_ASSERT_MSG_EQ_TOL (selections[0].gainDb, -60, 1e-9, "Wrong uplink gain");
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -1545,6 +1747,8 @@ WifiErrorRateModelsTestSuite::WifiErrorRateModelsTestSuite ()
   AddTestCase (new WifiErrorRateModelsTestCaseDsss, TestCase::QUICK);
   AddTestCase (new WifiErrorRateModelsTestCaseNist, TestCase::QUICK);
   AddTestCase (new WifiErrorRateModelsTestCaseMimo, TestCase::QUICK);
+  AddTestCase (new PpvErrorRateTabulatedTestCase, TestCase::QUICK);
+  AddTestCase (new McsSelectionHelperTestCase, TestCase::QUICK);
   AddTestCase (new TableBasedErrorRateTestCase ("DefaultTableBasedHtMcs0-1458bytes", HtPhy::GetHtMcs0 (), 1458), TestCase::QUICK);
   AddTestCase (new TableBasedErrorRateTestCase ("DefaultTableBasedHtMcs0-32bytes", HtPhy::GetHtMcs0 (), 32), TestCase::QUICK);
   AddTestCase (new TableBasedErrorRateTestCase ("DefaultTableBasedHtMcs0-1000bytes", HtPhy::GetHtMcs0 (), 1000), TestCase::QUICK);
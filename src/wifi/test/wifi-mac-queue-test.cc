@@ -107,6 +107,334 @@ WifiMacQueueDropOldestTest::DoRun ()
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Test the per-receiver and per-(receiver, TID) indexes of the queue.
+ *
+ * Data frames sent to a few receivers with a few TIDs are interleaved with
+ * management frames, then some are pushed to the front, replaced or let expire.
+ * Every time, the items returned by PeekByAddress and PeekByTidAndAddress and
+ * the per-receiver counts are compared to those obtained by scanning the queue.
+ */
+class WifiMacQueueIndexTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  WifiMacQueueIndexTest ();
+
+  void DoRun () override;
+
+private:
+  /**
+   * Create an MPDU and enqueue it.
+   *
+   * \param receiver the index of the receiver (a management frame if negative)
+   * \param tid the TID
+   * \param size the size of the payload
+   * \param front whether to push the MPDU to the front of the queue
+   */
+  void Enqueue (int receiver, uint8_t tid, uint32_t size, bool front = false);
+  /**
+   * Compare the indexes of the queue to the result of a scan of the queue.
+   *
+   * \param step a description of the last operation
+   */
+  void Check (std::string step);
+  /**
+   * Replace the MPDU at the given position (ignoring management frames) of the
+   * queue with an MPDU sent to the given receiver.
+   *
+   * \param index the position of the MPDU to replace
+   * \param receiver the index of the new receiver
+   */
+  void Replace (std::size_t index, int receiver);
+  /**
+   * Trace sink for the Expired trace source.
+   *
+   * \param item the expired MPDU
+   */
+  void Expired (Ptr<const WifiMacQueueItem> item);
+
+  Ptr<WifiMacQueue> m_queue;          ///< the queue under test
+  std::vector<Mac48Address> m_addrs;  ///< receiver addresses
+  uint32_t m_nExpired;                ///< number of expired MPDUs
+};
+
+WifiMacQueueIndexTest::WifiMacQueueIndexTest ()
+  : TestCase ("Test per-receiver and per-TID queue indexes"),
+    m_nExpired (0)
+{
+}
+
+void
+WifiMacQueueIndexTest::Enqueue (int receiver, uint8_t tid, uint32_t size, bool front)
+{
+  WifiMacHeader header;
+  if (receiver < 0)
+    {
+      header.SetType (WIFI_MAC_MGT_ACTION);
+      header.SetAddr1 (m_addrs.at (0));
+    }
+  else
+    {
+      header.SetType (WIFI_MAC_QOSDATA);
+      header.SetAddr1 (m_addrs.at (receiver));
+      header.SetQosTid (tid);
+    }
+  auto item = Create<WifiMacQueueItem> (Create<Packet> (size), header);
+  bool ret = (front ? m_queue->PushFront (item) : m_queue->Enqueue (item));
+  NS_TEST_ASSERT_MSG_EQ (ret, true, "MPDU not enqueued");
+}
+
+void
+WifiMacQueueIndexTest::Check (std::string step)
+{
+  const Time now = Simulator::Now ();
+  const Time maxDelay = m_queue->GetMaxDelay ();
+
+  for (const auto &addr : m_addrs)
+    {
+      std::vector<Ptr<const WifiMacQueueItem>> expected;
+      for (auto it = m_queue->begin (); it != m_queue->end (); it++)
+        {
+          if ((*it)->GetHeader ().IsData () && (*it)->GetHeader ().GetAddr1 () == addr
+              && now <= (*it)->GetTimeStamp () + maxDelay)
+            {
+              expected.push_back (*it);
+            }
+        }
+      std::size_t n = 0;
+      for (auto item = m_queue->PeekByAddress (addr); item != nullptr;
+           item = m_queue->PeekByAddress (addr, item), n++)
+        {
+          NS_TEST_ASSERT_MSG_LT (n, expected.size (), step << ": too many MPDUs for " << addr);
+          NS_TEST_EXPECT_MSG_EQ (item, expected[n], step << ": unexpected MPDU for " << addr);
+        }
+      NS_TEST_EXPECT_MSG_EQ (n, expected.size (), step << ": too few MPDUs for " << addr);
+
+      for (uint8_t tid = 0; tid < 2; tid++)
+        {
+          std::vector<Ptr<const WifiMacQueueItem>> expectedTid;
+          uint32_t nBytes = 0;
+          for (const auto &item : expected)
+            {
+              if (item->GetHeader ().GetQosTid () == tid)
+                {
+                  expectedTid.push_back (item);
+                  nBytes += item->GetSize ();
+                }
+            }
+          n = 0;
+          for (auto item = m_queue->PeekByTidAndAddress (tid, addr); item != nullptr;
+               item = m_queue->PeekByTidAndAddress (tid, addr, item), n++)
+            {
+              NS_TEST_ASSERT_MSG_LT (n, expectedTid.size (), step << ": too many MPDUs for TID " << +tid);
+              NS_TEST_EXPECT_MSG_EQ (item, expectedTid[n], step << ": unexpected MPDU for TID " << +tid);
+            }
+          NS_TEST_EXPECT_MSG_EQ (n, expectedTid.size (), step << ": too few MPDUs for TID " << +tid);
+          // the following calls remove expired MPDUs, hence the counts match
+          NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (tid, addr), expectedTid.size (),
+                                 step << ": unexpected number of MPDUs for TID " << +tid);
+          NS_TEST_EXPECT_MSG_EQ (m_queue->GetNBytes (tid, addr), nBytes,
+                                 step << ": unexpected number of bytes for TID " << +tid);
+        }
+      NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByAddress (addr), expected.size (),
+                             step << ": unexpected number of MPDUs for " << addr);
+    }
+}
+
+void
+WifiMacQueueIndexTest::Replace (std::size_t index, int receiver)
+{
+  auto it = m_queue->begin ();
+  for (std::size_t n = 0; it != m_queue->end (); it++)
+    {
+      if ((*it)->GetHeader ().IsData () && n++ == index)
+        {
+          break;
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ ((it != m_queue->end ()), true, "MPDU to replace not found");
+
+  WifiMacHeader header = (*it)->GetHeader ();
+  header.SetAddr1 (m_addrs.at (receiver));
+  auto item = Create<WifiMacQueueItem> ((*it)->GetPacket (), header, (*it)->GetTimeStamp ());
+  m_queue->Replace (*it, item);
+}
+
+void
+WifiMacQueueIndexTest::Expired (Ptr<const WifiMacQueueItem> item)
+{
+  m_nExpired++;
+}
+
+void
+WifiMacQueueIndexTest::DoRun ()
+{
+  m_queue = CreateObject<WifiMacQueue> (AC_BE);
+  m_queue->SetMaxSize (QueueSize ("100p"));
+  m_queue->SetMaxDelay (MilliSeconds (10));
+  m_queue->TraceConnectWithoutContext ("Expired", MakeCallback (&WifiMacQueueIndexTest::Expired, this));
+  for (uint8_t i = 1; i <= 3; i++)
+    {
+      m_addrs.push_back (Mac48Address (("00:00:00:00:00:0" + std::to_string (i)).c_str ()));
+    }
+
+  for (uint32_t i = 0; i < 24; i++)
+    {
+      Enqueue (i % 7 == 6 ? -1 : i % 3, (i / 3) % 2, 100 + i);
+    }
+  Check ("Enqueue");
+
+  Enqueue (1, 1, 50, true);
+  Enqueue (-1, 0, 60, true);
+  Check ("PushFront");
+
+  Replace (3, 2);   // different receiver
+  Replace (10, 1);  // same receiver
+  Check ("Replace");
+
+  // transform an MPDU in the middle of the queue, as done by A-MSDU aggregation
+  auto mpdu = m_queue->PeekByTidAndAddress (1, m_addrs.at (0));
+  auto msdu = m_queue->PeekByTidAndAddress (1, m_addrs.at (0), mpdu);
+  m_queue->DequeueIfQueued (msdu);
+  m_queue->Transform (mpdu, [&msdu](Ptr<WifiMacQueueItem> amsdu)
+                            {
+                              amsdu->Aggregate (msdu);
+                            });
+  Check ("Transform");
+
+  Simulator::Schedule (MilliSeconds (5), [this] ()
+                       {
+                         for (uint32_t i = 0; i < 12; i++)
+                           {
+                             Enqueue (i % 3, i % 2, 200 + i);
+                           }
+                         Check ("Enqueue later");
+                       });
+  Simulator::Schedule (MilliSeconds (12), [this] ()
+                       {
+                         Check ("Expiry");
+                         NS_TEST_EXPECT_MSG_GT (m_nExpired, 0, "No MPDU expired");
+                         NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPackets (), 12, "Unexpected number of MPDUs");
+                       });
+  Simulator::Run ();
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Test the removal of expired MPDUs in batches.
+ *
+ * With a max delay of 10 ms and an expiry granularity of 2 ms, three MPDUs
+ * enqueued at time 0 must stay in the queue (and be returned by Peek) until
+ * 12 ms, when they are dropped together, while two MPDUs enqueued at 3 ms must
+ * be dropped at 14 ms, even if the queue is not accessed in the meantime.
+ */
+class WifiMacQueueBulkExpiryTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  WifiMacQueueBulkExpiryTest ();
+
+  void DoRun () override;
+
+private:
+  /**
+   * Enqueue the given number of MPDUs.
+   *
+   * \param n the number of MPDUs
+   */
+  void Enqueue (uint32_t n);
+  /**
+   * Check the number of MPDUs in the queue and the number of expired MPDUs.
+   *
+   * \param nQueued the expected number of MPDUs in the queue
+   * \param nExpired the expected number of expired MPDUs
+   */
+  void Check (uint32_t nQueued, uint32_t nExpired);
+  /**
+   * Trace sink for the Expired trace source.
+   *
+   * \param item the expired MPDU
+   */
+  void Expired (Ptr<const WifiMacQueueItem> item);
+
+  Ptr<WifiMacQueue> m_queue;  ///< the queue under test
+  uint32_t m_nExpired;        ///< number of expired MPDUs
+};
+
+WifiMacQueueBulkExpiryTest::WifiMacQueueBulkExpiryTest ()
+  : TestCase ("Test removal of expired MPDUs in batches"),
+    m_nExpired (0)
+{
+}
+
+void
+WifiMacQueueBulkExpiryTest::Enqueue (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      WifiMacHeader header;
+      header.SetType (WIFI_MAC_QOSDATA);
+      header.SetAddr1 (Mac48Address ("00:00:00:00:00:01"));
+      header.SetQosTid (0);
+      m_queue->Enqueue (Create<WifiMacQueueItem> (Create<Packet> (100), header));
+    }
+}
+
+void
+WifiMacQueueBulkExpiryTest::Check (uint32_t nQueued, uint32_t nExpired)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_nExpired, nExpired, "Unexpected number of expired MPDUs at "
+                         << Simulator::Now ().As (Time::MS));
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetTotalDroppedPackets (), nExpired, "Unexpected number of dropped MPDUs at "
+                         << Simulator::Now ().As (Time::MS));
+  // the lifetime of the MPDUs is not checked on access
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPackets (), nQueued, "Unexpected number of MPDUs at "
+                         << Simulator::Now ().As (Time::MS));
+  NS_TEST_EXPECT_MSG_EQ ((m_queue->Peek () != nullptr), (nQueued > 0), "Unexpected result of Peek at "
+                         << Simulator::Now ().As (Time::MS));
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (0, Mac48Address ("00:00:00:00:00:01")),
+                         nQueued, "Unexpected number of MPDUs for the receiver at "
+                         << Simulator::Now ().As (Time::MS));
+}
+
+void
+WifiMacQueueBulkExpiryTest::Expired (Ptr<const WifiMacQueueItem> item)
+{
+  m_nExpired++;
+}
+
+void
+WifiMacQueueBulkExpiryTest::DoRun ()
+{
+  m_queue = CreateObject<WifiMacQueue> (AC_BE);
+  m_queue->SetMaxSize (QueueSize ("100p"));
+  m_queue->SetMaxDelay (MilliSeconds (10));
+  m_queue->SetExpiryGranularity (MilliSeconds (2));
+  m_queue->TraceConnectWithoutContext ("Expired", MakeCallback (&WifiMacQueueBulkExpiryTest::Expired, this));
+
+  Enqueue (3);
+  Simulator::Schedule (MilliSeconds (3), &WifiMacQueueBulkExpiryTest::Enqueue, this, 2);
+  Simulator::Schedule (MicroSeconds (11500), &WifiMacQueueBulkExpiryTest::Check, this, 5, 0);
+  Simulator::Schedule (MicroSeconds (12500), &WifiMacQueueBulkExpiryTest::Check, this, 2, 3);
+  Simulator::Schedule (MicroSeconds (13500), &WifiMacQueueBulkExpiryTest::Check, this, 2, 3);
+  Simulator::Schedule (MicroSeconds (14500), &WifiMacQueueBulkExpiryTest::Check, this, 0, 5);
+  Simulator::Run ();
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -123,6 +451,8 @@ WifiMacQueueTestSuite::WifiMacQueueTestSuite ()
   : TestSuite ("wifi-mac-queue", UNIT)
 {
   AddTestCase (new WifiMacQueueDropOldestTest, TestCase::QUICK);
+  AddTestCase (new WifiMacQueueIndexTest, TestCase::QUICK);
+  AddTestCase (new WifiMacQueueBulkExpiryTest, TestCase::QUICK);
 }
 
 static WifiMacQueueTestSuite g_wifiMacQueueTestSuite; ///< the test suite
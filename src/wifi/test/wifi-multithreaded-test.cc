@@ -0,0 +1,339 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-utils.h"
+#include "ns3/wifi-psdu.h"
+#include "ns3/wifi-mac-queue-item.h"
+#include "ns3/ht-phy.h"
+#include "ns3/ht-ppdu.h"
+#include "ns3/he-phy.h"
+#include "ns3/he-ppdu.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/mobility-model.h"
+#include "ns3/packet.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Make sure that the deep copy of a PPDU, handed over to the
+ * receivers in another partition of a MultithreadedSimulatorImpl, carries
+ * the same MPDUs as the original one without sharing any of its objects.
+ */
+class WifiPpduDeepCopyTestCase : public TestCase
+{
+public:
+  WifiPpduDeepCopyTestCase ();
+
+private:
+  void DoRun (void) override;
+
+  /**
+   * Make a deep copy of a PPDU and check it.
+   * \param ppdu the PPDU
+   * \param staIds the STA-IDs of the PSDUs of the PPDU
+   */
+  void CheckDeepCopy (Ptr<const WifiPpdu> ppdu, const std::vector<uint16_t> &staIds);
+  /**
+   * \param payloadSize the size of the payload
+   * \param seqNumber the sequence number
+   * \return a QoS data MPDU
+   */
+  Ptr<WifiMacQueueItem> CreateMpdu (uint32_t payloadSize, uint16_t seqNumber) const;
+};
+
+WifiPpduDeepCopyTestCase::WifiPpduDeepCopyTestCase ()
+  : TestCase ("Test case for the deep copy of the PPDUs")
+{
+}
+
+Ptr<WifiMacQueueItem>
+WifiPpduDeepCopyTestCase::CreateMpdu (uint32_t payloadSize, uint16_t seqNumber) const
+{
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  hdr.SetAddr1 (Mac48Address ("00:00:00:00:00:01"));
+  hdr.SetAddr2 (Mac48Address ("00:00:00:00:00:02"));
+  hdr.SetQosTid (0);
+  hdr.SetSequenceNumber (seqNumber);
+  std::vector<uint8_t> payload (payloadSize);
+  for (uint32_t i = 0; i < payloadSize; i++)
+    {
+      payload[i] = static_cast<uint8_t> (i + seqNumber);
+    }
+  return Create<WifiMacQueueItem> (Create<Packet> (payload.data (), payloadSize), hdr, MicroSeconds (seqNumber));
+}
+
+void
+WifiPpduDeepCopyTestCase::CheckDeepCopy (Ptr<const WifiPpdu> ppdu, const std::vector<uint16_t> &staIds)
+{
+  Ptr<const WifiPpdu> copy = ppdu->DeepCopy ();
+  NS_TEST_ASSERT_MSG_NE (PeekPointer (copy), PeekPointer (ppdu), "The PPDU must be copied");
+  NS_TEST_EXPECT_MSG_EQ (copy->GetUid (), ppdu->GetUid (), "Unexpected UID");
+  NS_TEST_EXPECT_MSG_EQ (copy->GetType (), ppdu->GetType (), "Unexpected PPDU type");
+  NS_TEST_EXPECT_MSG_EQ (copy->GetTxDuration (), ppdu->GetTxDuration (), "Unexpected TX duration");
+  NS_TEST_EXPECT_MSG_EQ (copy->GetModulation (), ppdu->GetModulation (), "Unexpected modulation");
+
+  for (uint16_t staId : staIds)
+    {
+      Ptr<const WifiPsdu> original = (staId == SU_STA_ID) ? ppdu->GetPsdu ()
+                                                           : DynamicCast<const HePpdu> (ppdu)->GetPsdu (0, staId);
+      Ptr<const WifiPsdu> copied = (staId == SU_STA_ID) ? copy->GetPsdu ()
+                                                         : DynamicCast<const HePpdu> (copy)->GetPsdu (0, staId);
+      NS_TEST_ASSERT_MSG_NE (copied, 0, "Missing PSDU for STA-ID " << staId);
+      NS_TEST_EXPECT_MSG_NE (PeekPointer (copied), PeekPointer (original), "PSDUs must not be shared");
+      NS_TEST_EXPECT_MSG_EQ (copied->IsSingle (), original->IsSingle (), "Unexpected single MPDU flag");
+      NS_TEST_ASSERT_MSG_EQ (copied->GetNMpdus (), original->GetNMpdus (), "Unexpected number of MPDUs");
+      NS_TEST_EXPECT_MSG_EQ (copied->GetSize (), original->GetSize (), "Unexpected PSDU size");
+      for (std::size_t i = 0; i < original->GetNMpdus (); i++)
+        {
+          NS_TEST_EXPECT_MSG_NE (PeekPointer (*(copied->begin () + i)), PeekPointer (*(original->begin () + i)),
+                                 "MPDUs must not be shared");
+          Ptr<const Packet> packet = copied->GetPayload (i);
+          Ptr<const Packet> expectedPacket = original->GetPayload (i);
+          NS_TEST_EXPECT_MSG_NE (PeekPointer (packet), PeekPointer (expectedPacket), "Packets must not be shared");
+          NS_TEST_EXPECT_MSG_EQ (packet->GetUid (), expectedPacket->GetUid (), "Unexpected packet UID");
+          NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), expectedPacket->GetSize (), "Unexpected payload size");
+          std::vector<uint8_t> data (packet->GetSize ());
+          std::vector<uint8_t> expectedData (expectedPacket->GetSize ());
+          packet->CopyData (data.data (), data.size ());
+          expectedPacket->CopyData (expectedData.data (), expectedData.size ());
+          NS_TEST_EXPECT_MSG_EQ ((data == expectedData), true, "Unexpected payload");
+          NS_TEST_EXPECT_MSG_EQ (copied->GetHeader (i).GetSequenceNumber (),
+                                 original->GetHeader (i).GetSequenceNumber (), "Unexpected MAC header");
+          NS_TEST_EXPECT_MSG_EQ (copied->GetTimeStamp (i), original->GetTimeStamp (i), "Unexpected timestamp");
+        }
+    }
+}
+
+void
+WifiPpduDeepCopyTestCase::DoRun (void)
+{
+  // HT PPDU carrying an A-MPDU
+  std::vector<Ptr<WifiMacQueueItem>> mpdus {CreateMpdu (1000, 1), CreateMpdu (300, 2)};
+  WifiTxVector txVector;
+  txVector.SetMode (HtPhy::GetHtMcs7 ());
+  txVector.SetPreambleType (WIFI_PREAMBLE_HT_MF);
+  txVector.SetChannelWidth (20);
+  txVector.SetGuardInterval (400);
+  txVector.SetNss (1);
+  txVector.SetAggregation (true);
+  CheckDeepCopy (Create<HtPpdu> (Create<WifiPsdu> (mpdus), txVector, MicroSeconds (400), WIFI_PHY_BAND_5GHZ, 42),
+                 {SU_STA_ID});
+
+  // HE MU PPDU carrying a single MPDU and an A-MPDU
+  WifiTxVector muTxVector;
+  muTxVector.SetPreambleType (WIFI_PREAMBLE_HE_MU);
+  muTxVector.SetChannelWidth (40);
+  muTxVector.SetGuardInterval (800);
+  muTxVector.SetHeMuUserInfo (1, {{HeRu::RU_106_TONE, 1, true}, HePhy::GetHeMcs5 (), 1});
+  muTxVector.SetHeMuUserInfo (2, {{HeRu::RU_242_TONE, 2, true}, HePhy::GetHeMcs5 (), 1});
+  WifiConstPsduMap psdus;
+  psdus.insert ({1, Create<WifiPsdu> (CreateMpdu (500, 3), true)});
+  psdus.insert ({2, Create<WifiPsdu> (std::vector<Ptr<WifiMacQueueItem>> {CreateMpdu (200, 4), CreateMpdu (700, 5)})});
+  CheckDeepCopy (Create<HePpdu> (psdus, muTxVector, MicroSeconds (500), WIFI_PHY_BAND_5GHZ, 43,
+                                 HePpdu::PSD_NON_HE_TB, 0),
+                 {1, 2});
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Make sure that a YansWifiChannel shared by the partitions of a
+ * MultithreadedSimulatorImpl delivers the PPDUs with the delays and losses
+ * frozen by GetLookahead, in the partition of each receiver.
+ *
+ * Four ad hoc stations are laid out on a line, at 0, 10, 100 and 130 m,
+ * stations 0 and 1 running in partition 0 and stations 2 and 3 in
+ * partition 1, so that the lookahead is the propagation delay over the 90 m
+ * between stations 1 and 2. The losses are raised after GetLookahead,
+ * which must not affect the broadcast then sent by station 0.
+ */
+class YansWifiChannelPartitionsTestCase : public TestCase
+{
+public:
+  YansWifiChannelPartitionsTestCase ();
+
+private:
+  void DoRun (void) override;
+
+  /**
+   * Callback when a PPDU is being received
+   * \param context the index of the receiving station
+   * \param p the packet
+   * \param rxPowersW the received power per channel band in watts
+   */
+  void RxBegin (std::string context, Ptr<const Packet> p, RxPowerWattPerChannelBand rxPowersW);
+  /**
+   * Send a broadcast packet
+   * \param dev the sending device
+   */
+  void SendBroadcast (Ptr<WifiNetDevice> dev);
+
+  Ptr<MultithreadedSimulatorImpl> m_impl; ///< the simulator
+  std::vector<uint32_t> m_rxBegin;        ///< number of PPDUs received per station
+  std::vector<uint32_t> m_misplaced;      ///< number of PPDUs received in the wrong partition per station
+  std::vector<int64_t> m_rxTime;          ///< time of the last reception per station
+  std::vector<double> m_rxPowerDbm;       ///< RX power of the last reception per station (dBm)
+};
+
+YansWifiChannelPartitionsTestCase::YansWifiChannelPartitionsTestCase ()
+  : TestCase ("Test case for YansWifiChannel with a multithreaded simulator")
+{
+}
+
+void
+YansWifiChannelPartitionsTestCase::RxBegin (std::string context, Ptr<const Packet> p, RxPowerWattPerChannelBand rxPowersW)
+{
+  // each station is only touched by the thread of its partition
+  std::size_t station = std::stoul (context);
+  m_rxBegin.at (station)++;
+  if (m_impl->GetCurrentPartition () != station / 2)
+    {
+      m_misplaced.at (station)++;
+    }
+  m_rxTime.at (station) = Simulator::Now ().GetTimeStep ();
+  m_rxPowerDbm.at (station) = WToDbm (rxPowersW.begin ()->second);
+}
+
+void
+YansWifiChannelPartitionsTestCase::SendBroadcast (Ptr<WifiNetDevice> dev)
+{
+  dev->Send (Create<Packet> (100), dev->GetBroadcast (), 1);
+}
+
+void
+YansWifiChannelPartitionsTestCase::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (MultithreadedSimulatorImpl::GetTypeId ());
+  factory.Set ("ThreadCount", UintegerValue (2));
+  m_impl = factory.Create<MultithreadedSimulatorImpl> ();
+  Simulator::SetImplementation (m_impl);
+
+  NodeContainer nodes;
+  nodes.Create (4);
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  for (double x : {0.0, 10.0, 100.0, 130.0})
+    {
+      positions->Add (Vector (x, 0, 0));
+    }
+  mobility.SetPositionAllocator (positions);
+  mobility.Install (nodes);
+
+  Ptr<MatrixPropagationLossModel> loss = CreateObject<MatrixPropagationLossModel> ();
+  loss->SetDefaultLoss (50);
+  Ptr<ConstantSpeedPropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel> ();
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationLossModel (loss);
+  channel->SetPropagationDelayModel (delay);
+
+  YansWifiPhyHelper phy;
+  phy.SetChannel (channel);
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+  m_rxBegin.assign (4, 0);
+  m_misplaced.assign (4, 0);
+  m_rxTime.assign (4, 0);
+  m_rxPowerDbm.assign (4, 0);
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      m_impl->SetPartition (nodes.Get (i)->GetId (), i / 2);
+      DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ()->TraceConnect ("PhyRxBegin", std::to_string (i),
+                                                                              MakeCallback (&YansWifiChannelPartitionsTestCase::RxBegin, this));
+    }
+
+  std::vector<Ptr<MobilityModel>> mobilities;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      mobilities.push_back (nodes.Get (i)->GetObject<MobilityModel> ());
+    }
+  Time lookahead = channel->GetLookahead ();
+  NS_TEST_ASSERT_MSG_EQ (lookahead, delay->GetDelay (mobilities[1], mobilities[2]),
+                         "The lookahead must be the delay between the closest stations of different partitions");
+  m_impl->SetAttribute ("Lookahead", TimeValue (lookahead));
+  // the losses frozen by GetLookahead are used while the simulation runs
+  loss->SetDefaultLoss (200);
+
+  Ptr<WifiNetDevice> sender = DynamicCast<WifiNetDevice> (devices.Get (0));
+  // the devices and mobility models are disposed of by Simulator::Destroy
+  double expectedRxPowerDbm = sender->GetPhy ()->GetTxPowerStart () - 50;
+  std::vector<Time> expectedOffsets;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      expectedOffsets.push_back (delay->GetDelay (mobilities[0], mobilities[i])
+                                 - delay->GetDelay (mobilities[0], mobilities[1]));
+    }
+  Simulator::ScheduleWithContext (nodes.Get (0)->GetId (), Seconds (1),
+                                  &YansWifiChannelPartitionsTestCase::SendBroadcast, this, sender);
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_impl = 0;
+
+  NS_TEST_EXPECT_MSG_EQ (m_rxBegin.at (0), 0, "The sender must not receive its own PPDUs");
+  for (uint32_t i = 1; i < 4; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_rxBegin.at (i), 1, "Station " << i << " must receive the broadcast");
+      NS_TEST_EXPECT_MSG_EQ (m_misplaced.at (i), 0, "Station " << i << " must receive in its own partition");
+      NS_TEST_EXPECT_MSG_EQ_TOL (m_rxPowerDbm.at (i), expectedRxPowerDbm, 1e-6,
+                                 "Station " << i << " must receive with the frozen loss");
+      NS_TEST_EXPECT_MSG_EQ (m_rxTime.at (i) - m_rxTime.at (1), expectedOffsets[i].GetTimeStep (),
+                             "Station " << i << " must receive after the propagation delay");
+    }
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Multithreaded simulation Test Suite
+ */
+class WifiMultithreadedTestSuite : public TestSuite
+{
+public:
+  WifiMultithreadedTestSuite ();
+};
+
+WifiMultithreadedTestSuite::WifiMultithreadedTestSuite ()
+  : TestSuite ("wifi-multithreaded", UNIT)
+{
+  AddTestCase (new WifiPpduDeepCopyTestCase, TestCase::QUICK);
+  AddTestCase (new YansWifiChannelPartitionsTestCase, TestCase::QUICK);
+}
+
+static WifiMultithreadedTestSuite g_wifiMultithreadedTestSuite; ///< the test suite
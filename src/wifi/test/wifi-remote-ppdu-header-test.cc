@@ -0,0 +1,206 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/wifi-remote-ppdu-header.h"
+#include "ns3/wifi-psdu.h"
+#include "ns3/wifi-mac-queue-item.h"
+#include "ns3/ht-phy.h"
+#include "ns3/ht-ppdu.h"
+#include "ns3/he-phy.h"
+#include "ns3/he-ppdu.h"
+#include "ns3/packet.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Make sure that the PPDUs sent to another MPI rank in a
+ * WifiRemotePpduHeader are received unchanged.
+ *
+ * An HT PPDU carrying an A-MPDU and an HE MU PPDU carrying a PSDU for
+ * each of two stations are serialized in a packet along with their
+ * receivers, and the deserialized TXVECTOR, UID, receivers and MPDUs are
+ * compared with the original ones.
+ */
+class WifiRemotePpduHeaderTestCase : public TestCase
+{
+public:
+  WifiRemotePpduHeaderTestCase ();
+
+private:
+  void DoRun (void) override;
+
+  /**
+   * Serialize a PPDU in a packet, deserialize it and check the result.
+   * \param ppdu the PPDU
+   */
+  void CheckPpdu (Ptr<const WifiPpdu> ppdu);
+  /**
+   * \param payloadSize the size of the payload
+   * \param seqNumber the sequence number
+   * \return a QoS data MPDU
+   */
+  Ptr<WifiMacQueueItem> CreateMpdu (uint32_t payloadSize, uint16_t seqNumber) const;
+};
+
+WifiRemotePpduHeaderTestCase::WifiRemotePpduHeaderTestCase ()
+  : TestCase ("Test case for the serialization of the PPDUs sent to another MPI rank")
+{
+}
+
+Ptr<WifiMacQueueItem>
+WifiRemotePpduHeaderTestCase::CreateMpdu (uint32_t payloadSize, uint16_t seqNumber) const
+{
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  hdr.SetAddr1 (Mac48Address ("00:00:00:00:00:01"));
+  hdr.SetAddr2 (Mac48Address ("00:00:00:00:00:02"));
+  hdr.SetQosTid (0);
+  hdr.SetSequenceNumber (seqNumber);
+  std::vector<uint8_t> payload (payloadSize);
+  for (uint32_t i = 0; i < payloadSize; i++)
+    {
+      payload[i] = static_cast<uint8_t> (i + seqNumber);
+    }
+  return Create<WifiMacQueueItem> (Create<Packet> (payload.data (), payloadSize), hdr, MicroSeconds (seqNumber));
+}
+
+void
+WifiRemotePpduHeaderTestCase::CheckPpdu (Ptr<const WifiPpdu> ppdu)
+{
+  WifiRemotePpduHeader header;
+  header.SetSender (3);
+  header.SetPpdu (ppdu);
+  header.AddReceiver (1, NanoSeconds (10), -60.5);
+  header.AddReceiver (7, Time (0), -81.25);
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (header);
+
+  WifiRemotePpduHeader received;
+  packet->RemoveHeader (received);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 0, "The whole header must be deserialized");
+  NS_TEST_EXPECT_MSG_EQ (received.GetSender (), 3, "Unexpected sender");
+  NS_TEST_EXPECT_MSG_EQ (received.GetUid (), ppdu->GetUid (), "Unexpected UID");
+  NS_TEST_EXPECT_MSG_EQ (received.GetTxDuration (), ppdu->GetTxDuration (), "Unexpected TX duration");
+  NS_TEST_ASSERT_MSG_EQ (received.GetReceivers ().size (), 2, "Unexpected number of receivers");
+  NS_TEST_EXPECT_MSG_EQ (received.GetReceivers ()[0].index, 1, "Unexpected receiver");
+  NS_TEST_EXPECT_MSG_EQ (received.GetReceivers ()[0].delay, NanoSeconds (10), "Unexpected delay");
+  NS_TEST_EXPECT_MSG_EQ (received.GetReceivers ()[0].rxPowerDbm, -60.5, "Unexpected RX power");
+  NS_TEST_EXPECT_MSG_EQ (received.GetReceivers ()[1].index, 7, "Unexpected receiver");
+  NS_TEST_EXPECT_MSG_EQ (received.GetReceivers ()[1].rxPowerDbm, -81.25, "Unexpected RX power");
+
+  WifiTxVector txVector = ppdu->GetTxVector ();
+  WifiTxVector receivedTxVector = received.GetTxVector ();
+  NS_TEST_EXPECT_MSG_EQ (receivedTxVector.GetPreambleType (), txVector.GetPreambleType (), "Unexpected preamble");
+  NS_TEST_EXPECT_MSG_EQ (receivedTxVector.GetChannelWidth (), txVector.GetChannelWidth (), "Unexpected channel width");
+  NS_TEST_EXPECT_MSG_EQ (receivedTxVector.GetGuardInterval (), txVector.GetGuardInterval (), "Unexpected guard interval");
+  NS_TEST_EXPECT_MSG_EQ (receivedTxVector.IsAggregation (), txVector.IsAggregation (), "Unexpected aggregation");
+  NS_TEST_EXPECT_MSG_EQ (receivedTxVector.GetBssColor (), txVector.GetBssColor (), "Unexpected BSS color");
+  if (txVector.IsMu ())
+    {
+      NS_TEST_EXPECT_MSG_EQ ((receivedTxVector.GetHeMuUserInfoMap () == txVector.GetHeMuUserInfoMap ()), true,
+                             "Unexpected HE MU user info");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (receivedTxVector.GetMode (), txVector.GetMode (), "Unexpected mode");
+      NS_TEST_EXPECT_MSG_EQ (+receivedTxVector.GetNss (), +txVector.GetNss (), "Unexpected number of spatial streams");
+    }
+
+  WifiConstPsduMap psdus = received.GetPsdus ();
+  std::size_t nPsdus = 0;
+  for (const auto & psdu : psdus)
+    {
+      Ptr<const WifiPsdu> expected = (psdu.first == SU_STA_ID) ? ppdu->GetPsdu ()
+                                                                : DynamicCast<const HePpdu> (ppdu)->GetPsdu (0, psdu.first);
+      NS_TEST_ASSERT_MSG_NE (expected, 0, "Unexpected STA-ID " << psdu.first);
+      NS_TEST_EXPECT_MSG_EQ (psdu.second->IsSingle (), expected->IsSingle (), "Unexpected single MPDU flag");
+      NS_TEST_ASSERT_MSG_EQ (psdu.second->GetNMpdus (), expected->GetNMpdus (), "Unexpected number of MPDUs");
+      NS_TEST_EXPECT_MSG_EQ (psdu.second->GetSize (), expected->GetSize (), "Unexpected PSDU size");
+      for (std::size_t i = 0; i < expected->GetNMpdus (); i++)
+        {
+          Ptr<const Packet> packet = psdu.second->GetPayload (i);
+          Ptr<const Packet> expectedPacket = expected->GetPayload (i);
+          NS_TEST_EXPECT_MSG_NE (PeekPointer (packet), PeekPointer (expectedPacket), "Packets must not be shared");
+          NS_TEST_EXPECT_MSG_EQ (packet->GetUid (), expectedPacket->GetUid (), "Unexpected packet UID");
+          NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), expectedPacket->GetSize (), "Unexpected payload size");
+          std::vector<uint8_t> data (packet->GetSize ());
+          std::vector<uint8_t> expectedData (expectedPacket->GetSize ());
+          packet->CopyData (data.data (), data.size ());
+          expectedPacket->CopyData (expectedData.data (), expectedData.size ());
+          NS_TEST_EXPECT_MSG_EQ ((data == expectedData), true, "Unexpected payload");
+          NS_TEST_EXPECT_MSG_EQ (psdu.second->GetHeader (i).GetSequenceNumber (),
+                                 expected->GetHeader (i).GetSequenceNumber (), "Unexpected MAC header");
+          NS_TEST_EXPECT_MSG_EQ (psdu.second->GetAddr1 (), expected->GetAddr1 (), "Unexpected receiver address");
+        }
+      nPsdus++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (nPsdus, (txVector.IsDlMu () ? txVector.GetHeMuUserInfoMap ().size () : 1),
+                         "Unexpected number of PSDUs");
+}
+
+void
+WifiRemotePpduHeaderTestCase::DoRun (void)
+{
+  // HT PPDU carrying an A-MPDU
+  std::vector<Ptr<WifiMacQueueItem>> mpdus {CreateMpdu (1000, 1), CreateMpdu (300, 2)};
+  Ptr<WifiPsdu> psdu = Create<WifiPsdu> (mpdus);
+  WifiTxVector txVector;
+  txVector.SetMode (HtPhy::GetHtMcs7 ());
+  txVector.SetPreambleType (WIFI_PREAMBLE_HT_MF);
+  txVector.SetChannelWidth (20);
+  txVector.SetGuardInterval (400);
+  txVector.SetNss (1);
+  txVector.SetAggregation (true);
+  CheckPpdu (Create<HtPpdu> (psdu, txVector, MicroSeconds (400), WIFI_PHY_BAND_5GHZ, 42));
+
+  // HE MU PPDU carrying a PSDU for each of two stations
+  WifiTxVector muTxVector;
+  muTxVector.SetPreambleType (WIFI_PREAMBLE_HE_MU);
+  muTxVector.SetChannelWidth (40);
+  muTxVector.SetGuardInterval (800);
+  muTxVector.SetBssColor (5);
+  muTxVector.SetHeMuUserInfo (1, {{HeRu::RU_106_TONE, 1, true}, HePhy::GetHeMcs5 (), 1});
+  muTxVector.SetHeMuUserInfo (2, {{HeRu::RU_242_TONE, 2, true}, HePhy::GetHeMcs5 (), 1});
+  WifiConstPsduMap psdus;
+  psdus.insert ({1, Create<WifiPsdu> (CreateMpdu (500, 3), true)});
+  psdus.insert ({2, Create<WifiPsdu> (std::vector<Ptr<WifiMacQueueItem>> {CreateMpdu (200, 4), CreateMpdu (700, 5)})});
+  CheckPpdu (Create<HePpdu> (psdus, muTxVector, MicroSeconds (500), WIFI_PHY_BAND_5GHZ, 43,
+                             HePpdu::PSD_NON_HE_TB, 0));
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Remote PPDU header Test Suite
+ */
+class WifiRemotePpduHeaderTestSuite : public TestSuite
+{
+public:
+  WifiRemotePpduHeaderTestSuite ();
+};
+
+WifiRemotePpduHeaderTestSuite::WifiRemotePpduHeaderTestSuite ()
+  : TestSuite ("wifi-remote-ppdu-header", UNIT)
+{
+  AddTestCase (new WifiRemotePpduHeaderTestCase, TestCase::QUICK);
+}
+
+static WifiRemotePpduHeaderTestSuite g_wifiRemotePpduHeaderTestSuite; ///< the test suite
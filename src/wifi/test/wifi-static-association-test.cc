@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/ap-wifi-mac.h"
+#include "ns3/sta-wifi-mac.h"
+#include "ns3/wifi-remote-station-manager.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/config.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Make sure that stations can be associated with access points
+ * without any frame exchange.
+ *
+ * Three stations are associated with two access points before the
+ * simulation starts. The association state must be installed on both sides,
+ * the stations must not scan nor send association requests, and a station
+ * must be able to send a data frame to its access point right away.
+ */
+class StaticAssociationTestCase : public TestCase
+{
+public:
+  StaticAssociationTestCase ();
+
+private:
+  void DoRun (void) override;
+
+  /**
+   * Callback when a station associates
+   * \param context the context
+   * \param bssid the BSSID of the access point
+   */
+  void StaAssoc (std::string context, Mac48Address bssid);
+  /**
+   * Callback when an access point associates a station
+   * \param context the context
+   * \param aid the AID of the station
+   * \param address the address of the station
+   */
+  void ApAssoc (std::string context, uint16_t aid, Mac48Address address);
+  /**
+   * Callback when an access point receives a packet
+   * \param context the context
+   * \param p the packet
+   */
+  void ApRx (std::string context, Ptr<const Packet> p);
+
+  uint32_t m_staAssoc {0}; ///< number of associations seen by the stations
+  uint32_t m_apAssoc {0};  ///< number of associations seen by the access points
+  uint32_t m_apRx {0};     ///< number of packets received by the access points
+};
+
+StaticAssociationTestCase::StaticAssociationTestCase ()
+  : TestCase ("Test case for static association of stations")
+{
+}
+
+void
+StaticAssociationTestCase::StaAssoc (std::string context, Mac48Address bssid)
+{
+  m_staAssoc++;
+}
+
+void
+StaticAssociationTestCase::ApAssoc (std::string context, uint16_t aid, Mac48Address address)
+{
+  m_apAssoc++;
+}
+
+void
+StaticAssociationTestCase::ApRx (std::string context, Ptr<const Packet> p)
+{
+  m_apRx++;
+}
+
+void
+StaticAssociationTestCase::DoRun (void)
+{
+  NodeContainer apNodes;
+  apNodes.Create (2);
+  NodeContainer staNodes;
+  staNodes.Create (3);
+  MobilityHelper mobility;
+  mobility.Install (apNodes);
+  mobility.Install (staNodes);
+
+  YansWifiPhyHelper phy;
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  phy.SetChannel (channel.Create ());
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_STANDARD_80211n);
+  WifiMacHelper mac;
+  mac.SetType ("ns3::ApWifiMac");
+  NetDeviceContainer apDevices = wifi.Install (phy, mac, apNodes);
+  mac.SetType ("ns3::StaWifiMac");
+  NetDeviceContainer staDevices = wifi.Install (phy, mac, staNodes);
+
+  Config::Connect ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::StaWifiMac/Assoc",
+                   MakeCallback (&StaticAssociationTestCase::StaAssoc, this));
+  WifiHelper::Associate (staDevices, apDevices, {0, 1, 0});
+  Config::Connect ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::ApWifiMac/AssociatedSta",
+                   MakeCallback (&StaticAssociationTestCase::ApAssoc, this));
+  Config::Connect ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::ApWifiMac/MacRx",
+                   MakeCallback (&StaticAssociationTestCase::ApRx, this));
+
+  NS_TEST_ASSERT_MSG_EQ (m_staAssoc, 3, "All the stations should be associated");
+  std::vector<uint32_t> apIndices = {0, 1, 0};
+  std::vector<uint16_t> aids = {1, 1, 2};
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<StaWifiMac> staMac = DynamicCast<StaWifiMac> (DynamicCast<WifiNetDevice> (staDevices.Get (i))->GetMac ());
+      Ptr<ApWifiMac> apMac = DynamicCast<ApWifiMac> (DynamicCast<WifiNetDevice> (apDevices.Get (apIndices[i]))->GetMac ());
+      NS_TEST_ASSERT_MSG_EQ (staMac->IsAssociated (), true, "Station " << i << " should be associated");
+      NS_TEST_ASSERT_MSG_EQ (staMac->GetBssid (), apMac->GetAddress (), "Wrong BSSID for station " << i);
+      NS_TEST_ASSERT_MSG_EQ (staMac->GetAssociationId (), aids[i], "Wrong AID for station " << i);
+      NS_TEST_ASSERT_MSG_EQ (apMac->GetAssociationId (staMac->GetAddress ()), aids[i], "Wrong AID at the AP for station " << i);
+      NS_TEST_ASSERT_MSG_EQ (apMac->GetWifiRemoteStationManager ()->IsAssociated (staMac->GetAddress ()), true,
+                             "Station " << i << " should be associated at the AP");
+      NS_TEST_ASSERT_MSG_EQ (staMac->GetWifiRemoteStationManager ()->GetHtSupported (apMac->GetAddress ()), true,
+                             "The HT capabilities of the AP should be known by station " << i);
+    }
+
+  Ptr<WifiNetDevice> sender = DynamicCast<WifiNetDevice> (staDevices.Get (2));
+  Simulator::Schedule (MilliSeconds (10), &WifiNetDevice::Send, sender, Create<Packet> (100),
+                       apDevices.Get (0)->GetAddress (), 1);
+
+  Simulator::Stop (MilliSeconds (500));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_staAssoc, 3, "The stations should not associate again");
+  NS_TEST_ASSERT_MSG_EQ (m_apAssoc, 0, "No association request should be processed by the APs");
+  NS_TEST_ASSERT_MSG_EQ (m_apRx, 1, "The data frame should be received by the AP");
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Static association Test Suite
+ */
+class StaticAssociationTestSuite : public TestSuite
+{
+public:
+  StaticAssociationTestSuite ();
+};
+
+StaticAssociationTestSuite::StaticAssociationTestSuite ()
+  : TestSuite ("wifi-static-association", UNIT)
+{
+  AddTestCase (new StaticAssociationTestCase, TestCase::QUICK);
+}
+
+static StaticAssociationTestSuite g_staticAssociationTestSuite; ///< the test suite
@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/mobility-model.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Make sure that a channel culling the receivers still delivers PPDUs
+ * to the reachable receivers, and follows the loss changes.
+ *
+ * Three ad hoc stations share a YansWifiChannel with receiver culling and a
+ * matrix propagation loss model. Station 0 broadcasts a packet, which only
+ * station 1 can hear. The loss between stations 0 and 2 is then lowered and
+ * the neighbor lists are invalidated, so that the next broadcast is heard
+ * by both stations.
+ */
+class YansWifiChannelCullingTestCase : public TestCase
+{
+public:
+  YansWifiChannelCullingTestCase ();
+
+private:
+  void DoRun (void) override;
+
+  /**
+   * Callback when a PPDU is being received
+   * \param context the index of the receiving station
+   * \param p the packet
+   * \param rxPowersW the received power per channel band in watts
+   */
+  void RxBegin (std::string context, Ptr<const Packet> p, RxPowerWattPerChannelBand rxPowersW);
+  /**
+   * Send a broadcast packet
+   * \param dev the sending device
+   */
+  void SendBroadcast (Ptr<WifiNetDevice> dev);
+
+  std::vector<uint32_t> m_rxBegin; ///< number of PPDUs received per station
+};
+
+YansWifiChannelCullingTestCase::YansWifiChannelCullingTestCase ()
+  : TestCase ("Test case for receiver culling in YansWifiChannel")
+{
+}
+
+void
+YansWifiChannelCullingTestCase::RxBegin (std::string context, Ptr<const Packet> p, RxPowerWattPerChannelBand rxPowersW)
+{
+  m_rxBegin.at (std::stoul (context))++;
+}
+
+void
+YansWifiChannelCullingTestCase::SendBroadcast (Ptr<WifiNetDevice> dev)
+{
+  dev->Send (Create<Packet> (100), dev->GetBroadcast (), 1);
+}
+
+void
+YansWifiChannelCullingTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  MobilityHelper mobility;
+  mobility.Install (nodes);
+
+  Ptr<MatrixPropagationLossModel> loss = CreateObject<MatrixPropagationLossModel> ();
+  loss->SetDefaultLoss (200);
+  loss->SetLoss (nodes.Get (0)->GetObject<MobilityModel> (), nodes.Get (1)->GetObject<MobilityModel> (), 50);
+
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetAttribute ("ReceiverCulling", BooleanValue (true));
+  channel->SetPropagationLossModel (loss);
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+
+  YansWifiPhyHelper phy;
+  phy.SetChannel (channel);
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+  m_rxBegin.assign (3, 0);
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ()->TraceConnect ("PhyRxBegin", std::to_string (i),
+                                                                              MakeCallback (&YansWifiChannelCullingTestCase::RxBegin, this));
+    }
+
+  Ptr<WifiNetDevice> sender = DynamicCast<WifiNetDevice> (devices.Get (0));
+  Simulator::Schedule (Seconds (1), &YansWifiChannelCullingTestCase::SendBroadcast, this, sender);
+  Simulator::Schedule (Seconds (1.5), &MatrixPropagationLossModel::SetLoss, loss,
+                       nodes.Get (0)->GetObject<MobilityModel> (), nodes.Get (2)->GetObject<MobilityModel> (), 50, true);
+  Simulator::Schedule (Seconds (1.5), &YansWifiChannel::InvalidateNeighbors, channel);
+  Simulator::Schedule (Seconds (2), &YansWifiChannelCullingTestCase::SendBroadcast, this, sender);
+  // without invalidation, the losses cached in the neighbor lists are used
+  Simulator::Schedule (Seconds (2.5), &MatrixPropagationLossModel::SetLoss, loss,
+                       nodes.Get (0)->GetObject<MobilityModel> (), nodes.Get (1)->GetObject<MobilityModel> (), 200, true);
+  Simulator::Schedule (Seconds (2.7), &YansWifiChannelCullingTestCase::SendBroadcast, this, sender);
+
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_rxBegin.at (0), 0, "The sender must not receive its own PPDUs");
+  NS_TEST_ASSERT_MSG_EQ (m_rxBegin.at (1), 3, "Station 1 must receive the broadcasts with the cached loss");
+  NS_TEST_ASSERT_MSG_EQ (m_rxBegin.at (2), 2, "Station 2 must only receive the broadcasts sent after the loss change");
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief YansWifiChannel receiver culling Test Suite
+ */
+class YansWifiChannelCullingTestSuite : public TestSuite
+{
+public:
+  YansWifiChannelCullingTestSuite ();
+};
+
+YansWifiChannelCullingTestSuite::YansWifiChannelCullingTestSuite ()
+  : TestSuite ("wifi-channel-culling", UNIT)
+{
+  AddTestCase (new YansWifiChannelCullingTestCase, TestCase::QUICK);
+}
+
+static YansWifiChannelCullingTestSuite g_yansWifiChannelCullingTestSuite; ///< the test suite
@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+std::string g_me;
+
+/// Number of injected events run, only updated by the simulator thread
+uint64_t g_received = 0;
+/// Number of events to inject
+uint64_t g_total = 0;
+/// Set when the simulation runs, to start the producers
+std::atomic<bool> g_go {false};
+/// Wall clock time at which the producers were started
+std::chrono::steady_clock::time_point g_start;
+
+/// Event injected by the producers
+void
+Received (void)
+{
+  g_received++;
+}
+
+/// Keep the simulation running until all the injected events have run
+void
+Poll (void)
+{
+  if (g_received < g_total)
+    {
+      Simulator::Schedule (NanoSeconds (1), &Poll);
+    }
+}
+
+/// Start the producers
+void
+Start (void)
+{
+  g_start = std::chrono::steady_clock::now ();
+  g_go.store (true, std::memory_order_release);
+  Poll ();
+}
+
+/**
+ * Inject events from a thread other than the simulator thread.
+ * \param [in] context The context of the events.
+ * \param [in] count The number of events to inject.
+ * \param [out] seconds The wall clock time spent injecting the events.
+ */
+void
+Produce (uint32_t context, uint64_t count, double *seconds)
+{
+  while (!g_go.load (std::memory_order_acquire))
+    {
+      std::this_thread::yield ();
+    }
+  auto start = std::chrono::steady_clock::now ();
+  for (uint64_t i = 0; i < count; i++)
+    {
+      Simulator::ScheduleWithContext (context, Seconds (0), &Received);
+    }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - start;
+  *seconds = elapsed.count ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t producers = 4;
+  uint64_t events = 1000000;
+  uint32_t runs = 1;
+  bool realtime = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the injection of events with Simulator::ScheduleWithContext\n"
+             "by threads other than the simulator thread.\n"
+             "\n"
+             "Each producer thread schedules its events as fast as it can, while\n"
+             "the simulator thread runs them. The producer rate is the number of\n"
+             "events scheduled per second by a producer; the total rate is the\n"
+             "number of injected events run per second by the simulator.");
+  cmd.AddValue ("producers", "number of producer threads (default 4)", producers);
+  cmd.AddValue ("events", "number of events per producer (default 1E6)", events);
+  cmd.AddValue ("runs", "number of runs (default 1)", runs);
+  cmd.AddValue ("realtime", "use the RealtimeSimulatorImpl", realtime);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  if (realtime)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::RealtimeSimulatorImpl"));
+    }
+  StringValue impl;
+  GlobalValue::GetValueByName ("SimulatorImplementationType", impl);
+  LOGME ("simulator: " << impl.Get ());
+  LOGME ("producers: " << producers);
+  LOGME ("events per producer: " << events);
+
+  LOG ("");
+  LOG (std::left << std::setw (8) << "Run #"
+       << std::setw (14) << "Time (s)"
+       << std::setw (14) << "Total (ev/s)"
+       << std::setw (14) << "Producer (ev/s)");
+  for (uint32_t run = 0; run < runs; run++)
+    {
+      g_received = 0;
+      g_total = producers * events;
+      g_go = false;
+      std::vector<double> seconds (producers);
+      std::vector<std::thread> threads;
+      for (uint32_t i = 0; i < producers; i++)
+        {
+          threads.emplace_back (&Produce, i, events, &seconds[i]);
+        }
+      Simulator::Schedule (Seconds (0), &Start);
+      Simulator::Run ();
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - g_start;
+      double producerRate = 0;
+      for (uint32_t i = 0; i < producers; i++)
+        {
+          threads[i].join ();
+          producerRate += events / seconds[i] / producers;
+        }
+      Simulator::Destroy ();
+      LOG (std::left << std::setw (8) << run
+           << std::setw (14) << elapsed.count ()
+           << std::setw (14) << g_total / elapsed.count ()
+           << std::setw (14) << producerRate);
+    }
+
+  return 0;
+}
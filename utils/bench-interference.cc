@@ -0,0 +1,536 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+std::string g_me;
+
+/// An operation of a receiver on its noise and interference ledger
+struct Op
+{
+  /// The type of operation
+  enum Type
+  {
+    ADD,        ///< a signal arrives
+    RX_START,   ///< the receiver starts to record the signals
+    RX_END,     ///< the receiver ends a reception
+    CALCULATE   ///< the receiver computes the chunks of a signal
+  };
+  Type type;       ///< the type of operation
+  int64_t now;     ///< the time of the operation
+  uint64_t event;  ///< the signal, for ADD and CALCULATE
+  int64_t a;       ///< the duration (ADD), end time (RX_END) or window start (CALCULATE)
+  int64_t b;       ///< the window end (CALCULATE)
+  double powerW;   ///< the power of the signal (ADD)
+};
+
+/// The operations of a receiver
+typedef std::vector<Op> OpTrace;
+
+/**
+ * Read the operations of a receiver from a ring trace recorded with the
+ * InterferenceHelper::* trace points enabled.
+ *
+ * \param filename the ring trace file
+ * \param context the context of the receiver, or Simulator::NO_CONTEXT
+ *        for the receiver with the most operations
+ * \return the operations
+ */
+OpTrace
+ReadOps (std::string filename, uint32_t context)
+{
+  RingTraceReader reader (filename);
+  std::map<uint32_t, OpTrace> traces;
+  RingTraceRecord record;
+  while (reader.Read (record))
+    {
+      std::string name = reader.GetPointName (record.point);
+      Op op = {Op::ADD, record.ts, 0, 0, 0, 0};
+      if (name == "InterferenceHelper::Add")
+        {
+          op = {Op::ADD, record.ts, record.GetUint (0), record.GetInt (1), 0, record.GetDouble (2)};
+        }
+      else if (name == "InterferenceHelper::NotifyRx")
+        {
+          op = {record.GetUint (0) ? Op::RX_START : Op::RX_END, record.ts, 0, record.GetInt (1), 0, 0};
+        }
+      else if (name == "InterferenceHelper::Calculate")
+        {
+          op = {Op::CALCULATE, record.ts, record.GetUint (0), record.GetInt (1), record.GetInt (2), 0};
+        }
+      else
+        {
+          continue;
+        }
+      traces[record.context].push_back (op);
+    }
+  if (context == Simulator::NO_CONTEXT)
+    {
+      std::size_t size = 0;
+      for (const auto &trace : traces)
+        {
+          if (trace.second.size () > size)
+            {
+              size = trace.second.size ();
+              context = trace.first;
+            }
+        }
+    }
+  LOGME ("found " << traces[context].size () << " operations of context " << context << " in " << filename);
+  return traces[context];
+}
+
+/**
+ * Generate the operations of a receiver in a dense channel: signals of
+ * 100 us to 2 ms arrive as a Poisson process, and the receiver receives
+ * the first signal which arrives while it is idle. At the end of a
+ * reception, the chunks of each of its MPDUs are computed.
+ *
+ * \param signals the number of signals
+ * \param load the mean number of signals on the air
+ * \param mpdus the number of MPDUs per reception
+ * \return the operations
+ */
+OpTrace
+MakeOps (uint32_t signals, double load, uint32_t mpdus)
+{
+  Ptr<UniformRandomVariable> duration = CreateObject<UniformRandomVariable> ();
+  duration->SetAttribute ("Min", DoubleValue (100e3));
+  duration->SetAttribute ("Max", DoubleValue (2000e3));
+  Ptr<ExponentialRandomVariable> interval = CreateObject<ExponentialRandomVariable> ();
+  interval->SetAttribute ("Mean", DoubleValue (1050e3 / load));
+  Ptr<UniformRandomVariable> power = CreateObject<UniformRandomVariable> ();
+  power->SetAttribute ("Min", DoubleValue (1e-12));
+  power->SetAttribute ("Max", DoubleValue (1e-9));
+
+  OpTrace ops;
+  int64_t now = 0;
+  bool rxing = false;
+  uint64_t rxEvent = 0;
+  int64_t rxEnd = 0;
+  auto endReception = [&] ()
+    {
+      int64_t length = (rxEnd - ops[rxEvent - 1].now) / mpdus;
+      for (uint32_t i = 0; i < mpdus; i++)
+        {
+          ops.push_back ({Op::CALCULATE, rxEnd, rxEvent, i * length, (i + 1) * length, 0});
+        }
+      ops.push_back ({Op::RX_END, rxEnd, 0, rxEnd, 0, 0});
+      rxing = false;
+    };
+  for (uint32_t i = 0; i < signals; i++)
+    {
+      now += static_cast<int64_t> (interval->GetValue ());
+      if (rxing && rxEnd <= now)
+        {
+          endReception ();
+        }
+      int64_t length = static_cast<int64_t> (duration->GetValue ());
+      // the signals are identified by the index of their ADD operation plus one
+      uint64_t event = ops.size () + 1;
+      ops.push_back ({Op::ADD, now, event, length, 0, power->GetValue ()});
+      if (!rxing)
+        {
+          ops.push_back ({Op::RX_START, now, 0, 0, 0, 0});
+          rxing = true;
+          rxEvent = event;
+          rxEnd = now + length;
+        }
+    }
+  if (rxing)
+    {
+      endReception ();
+    }
+  return ops;
+}
+
+/// A change of the noise and interference power
+struct Change
+{
+  int64_t time;    ///< the time of the change
+  double power;    ///< the total power from the change on
+  uint64_t event;  ///< the signal starting or ending
+};
+
+/**
+ * The ledger of InterferenceHelper, as a multimap of the changes (the
+ * original implementation) or as a sorted vector. The operations are
+ * those of InterferenceHelper for a single band, and Calculate returns
+ * a checksum of the SINR of the chunks of a signal.
+ */
+template <bool FLAT>
+class Ledger
+{
+public:
+  Ledger ()
+  {
+    Insert ({0, 0, 0});
+  }
+  /**
+   * \param event the signal
+   * \param start the start of the signal
+   * \param end the end of the signal
+   * \param powerW the power of the signal
+   */
+  void Add (uint64_t event, int64_t start, int64_t end, double powerW)
+  {
+    auto previous = Previous (start);
+    double powerStart = Power (previous);
+    double powerEnd = Power (Previous (end));
+    if (!m_rxing)
+      {
+        m_firstPower = powerStart;
+        Erase (++previous);
+      }
+    auto first = Insert ({start, powerStart, event});
+    std::size_t firstIndex = Index (first);
+    auto last = Insert ({end, powerEnd, event});
+    for (auto i = At (firstIndex); i != last; ++i)
+      {
+        AddPower (i, powerW);
+      }
+  }
+  /// Start to record the signals
+  void NotifyRxStart (void)
+  {
+    m_rxing = true;
+  }
+  /// \param endTime the end of the reception
+  void NotifyRxEnd (int64_t endTime)
+  {
+    m_rxing = false;
+    auto it = Previous (endTime);
+    if (Index (it) > 0)
+      {
+        --it;
+      }
+    m_firstPower = Power (it);
+  }
+  /**
+   * \param event the signal
+   * \param start the start of the signal
+   * \param end the end of the signal
+   * \param powerW the power of the signal
+   * \param now the current time
+   * \param windowStart the start of the window, relative to the start
+   * \param windowEnd the end of the window, relative to the start
+   * \return the checksum of the chunks of the window
+   */
+  double Calculate (uint64_t event, int64_t start, int64_t end, double powerW,
+                    int64_t now, int64_t windowStart, int64_t windowEnd) const;
+  /// \return the number of changes
+  std::size_t GetSize (void) const
+  {
+    return m_changes.size ();
+  }
+
+private:
+  /// The container of the changes
+  typedef typename std::conditional<FLAT, std::vector<Change>, std::multimap<int64_t, Change> >::type Changes;
+  /// An iterator of the changes
+  typedef typename Changes::iterator Iterator;
+
+  /// \param time a time \return the first change after the time
+  Iterator Next (int64_t time)
+  {
+    if constexpr (FLAT)
+      {
+        return std::upper_bound (m_changes.begin (), m_changes.end (), time,
+                                 [] (int64_t t, const Change &c) { return t < c.time; });
+      }
+    else
+      {
+        return m_changes.upper_bound (time);
+      }
+  }
+  /// \param time a time \return the last change at or before the time
+  Iterator Previous (int64_t time)
+  {
+    return --Next (time);
+  }
+  /// \param change the change \return its position
+  Iterator Insert (const Change &change)
+  {
+    if constexpr (FLAT)
+      {
+        return m_changes.insert (Next (change.time), change);
+      }
+    else
+      {
+        return m_changes.insert (Next (change.time), {change.time, change});
+      }
+  }
+  /// \param last the end of the changes to erase, after the first one
+  void Erase (Iterator last)
+  {
+    m_changes.erase (++m_changes.begin (), last);
+  }
+  /// \param it a change \return its index
+  std::size_t Index (Iterator it)
+  {
+    return std::distance (m_changes.begin (), it);
+  }
+  /// \param index an index \return the change at the index
+  Iterator At (std::size_t index)
+  {
+    return std::next (m_changes.begin (), index);
+  }
+  /// \param it a change \return its power
+  static double Power (Iterator it)
+  {
+    if constexpr (FLAT)
+      {
+        return it->power;
+      }
+    else
+      {
+        return it->second.power;
+      }
+  }
+  /// \param it a change \param powerW the power to add
+  static void AddPower (Iterator it, double powerW)
+  {
+    if constexpr (FLAT)
+      {
+        it->power += powerW;
+      }
+    else
+      {
+        it->second.power += powerW;
+      }
+  }
+
+  Changes m_changes;        ///< the changes
+  double m_firstPower {0};  ///< the power before the received signal
+  bool m_rxing {false};     ///< whether a signal is received
+};
+
+template <bool FLAT>
+double
+Ledger<FLAT>::Calculate (uint64_t event, int64_t start, int64_t end, double powerW,
+                         int64_t now, int64_t windowStart, int64_t windowEnd) const
+{
+  double checksum = 0;
+  double noise = m_firstPower;
+  if constexpr (FLAT)
+    {
+      // walk the changes in place
+      auto first = std::lower_bound (m_changes.begin (), m_changes.end (), start,
+                                     [] (const Change &c, int64_t t) { return c.time < t; });
+      for (auto it = first; it != m_changes.end () && it->time < now; ++it)
+        {
+          noise = it->power - powerW;
+        }
+      auto it = first;
+      for (; it != m_changes.end () && it->event != event; ++it);
+      auto last = it;
+      while (last != m_changes.end () && ++last != m_changes.end () && last->event != event);
+      if (it == m_changes.end () || last == m_changes.end ())
+        {
+          return 0;
+        }
+      int64_t previous = start;
+      noise = m_firstPower;
+      while (it++ != last)
+        {
+          int64_t current = it == last ? end : it->time;
+          int64_t from = std::max (previous, start + windowStart);
+          int64_t to = std::min (current, start + windowEnd);
+          if (to > from)
+            {
+              checksum += (to - from) * powerW / (noise + 1e-13);
+            }
+          noise = it->power - powerW;
+          previous = current;
+        }
+    }
+  else
+    {
+      // copy the changes of the signal, as the original implementation
+      auto first = m_changes.find (start);
+      for (auto it = first; it != m_changes.end () && it->first < now; ++it)
+        {
+          noise = it->second.power - powerW;
+        }
+      auto it = first;
+      for (; it != m_changes.end () && it->second.event != event; ++it);
+      if (it == m_changes.end ())
+        {
+          return 0;
+        }
+      std::multimap<int64_t, Change> ni;
+      ni.emplace (start, Change {start, 0, event});
+      while (++it != m_changes.end () && it->second.event != event)
+        {
+          ni.insert (*it);
+        }
+      if (it == m_changes.end ())
+        {
+          return 0;
+        }
+      ni.emplace (end, Change {end, 0, event});
+      auto j = ni.begin ();
+      int64_t previous = start;
+      noise = m_firstPower;
+      while (++j != ni.end ())
+        {
+          int64_t current = j->first;
+          int64_t from = std::max (previous, start + windowStart);
+          int64_t to = std::min (current, start + windowEnd);
+          if (to > from)
+            {
+              checksum += (to - from) * powerW / (noise + 1e-13);
+            }
+          noise = j->second.power - powerW;
+          previous = current;
+        }
+    }
+  return checksum;
+}
+
+/// Result of the replay of the operations
+struct ReplayResult
+{
+  double seconds;       ///< replay duration
+  double checksum;      ///< sum of the checksums of the chunks
+  std::size_t changes;  ///< the maximum number of changes in the ledger
+};
+
+/**
+ * Replay the operations of a receiver against a ledger.
+ *
+ * \tparam FLAT whether to use the flat ledger
+ * \param ops the operations
+ * \return the result of the replay
+ */
+template <bool FLAT>
+ReplayResult
+Replay (const OpTrace &ops)
+{
+  /// A signal on the air
+  struct Signal
+  {
+    int64_t start;  ///< the start of the signal
+    int64_t end;    ///< the end of the signal
+    double powerW;  ///< the power of the signal
+  };
+  std::unordered_map<uint64_t, Signal> signals;
+  Ledger<FLAT> ledger;
+  ReplayResult result = {0, 0, 0};
+  auto start = std::chrono::steady_clock::now ();
+  for (const Op &op : ops)
+    {
+      switch (op.type)
+        {
+        case Op::ADD:
+          signals[op.event] = {op.now, op.now + op.a, op.powerW};
+          ledger.Add (op.event, op.now, op.now + op.a, op.powerW);
+          result.changes = std::max (result.changes, ledger.GetSize ());
+          break;
+        case Op::RX_START:
+          ledger.NotifyRxStart ();
+          break;
+        case Op::RX_END:
+          ledger.NotifyRxEnd (op.a);
+          break;
+        case Op::CALCULATE:
+          {
+            auto it = signals.find (op.event);
+            if (it != signals.end ())
+              {
+                const Signal &signal = it->second;
+                result.checksum += ledger.Calculate (op.event, signal.start, signal.end, signal.powerW,
+                                                     op.now, op.a, op.b);
+              }
+          }
+          break;
+        }
+    }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - start;
+  result.seconds = elapsed.count ();
+  return result;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string traceFile = "";
+  uint32_t context = Simulator::NO_CONTEXT;
+  uint32_t signals = 100000;
+  double load = 50;
+  uint32_t mpdus = 16;
+  uint32_t runs = 1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the noise and interference ledger of InterferenceHelper,\n"
+             "as a sorted vector of changes against the multimap it replaced.\n"
+             "\n"
+             "The operations of a receiver (signal arrivals, start and end of\n"
+             "receptions, payload PER computations) are either read from a\n"
+             "ring trace, recorded with RingTrace::Enable (\"InterferenceHelper::*\")\n"
+             "and given by the --trace=\"<filename>\" argument, or generated for\n"
+             "a receiver in a dense channel.\n"
+             "\n"
+             "For each ledger, the time per operation, the maximum number of\n"
+             "changes held and a checksum of the computed chunks, which must be\n"
+             "the same for both ledgers, are reported.");
+  cmd.AddValue ("trace",   "ring trace of InterferenceHelper operations",                 traceFile);
+  cmd.AddValue ("context", "context of the receiver in the trace (default the busiest)", context);
+  cmd.AddValue ("signals", "number of generated signals (default 1E5)",                  signals);
+  cmd.AddValue ("load",    "mean number of generated signals on the air (default 50)",   load);
+  cmd.AddValue ("mpdus",   "number of MPDUs per generated reception (default 16)",       mpdus);
+  cmd.AddValue ("runs",    "number of runs per ledger (default 1)",                      runs);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  OpTrace ops = traceFile.empty () ? MakeOps (signals, load, mpdus) : ReadOps (traceFile, context);
+  LOGME ("operations: " << ops.size ());
+
+  LOG ("");
+  LOG (std::left << std::setw (12) << "Ledger"
+       << std::setw (8) << "Run #"
+       << std::setw (14) << "Time (s)"
+       << std::setw (14) << "Per op (ns)"
+       << std::setw (12) << "Changes"
+       << "Checksum");
+  for (uint32_t run = 0; run < runs; run++)
+    {
+      for (bool flat : {false, true})
+        {
+          ReplayResult result = flat ? Replay<true> (ops) : Replay<false> (ops);
+          LOG (std::left << std::setw (12) << (flat ? "vector" : "multimap")
+               << std::setw (8) << run
+               << std::setw (14) << result.seconds
+               << std::setw (14) << result.seconds * 1e9 / ops.size ()
+               << std::setw (12) << result.changes
+               << std::setprecision (12) << result.checksum << std::setprecision (6));
+        }
+    }
+
+  return 0;
+}
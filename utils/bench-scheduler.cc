@@ -0,0 +1,414 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using namespace ns3;
+
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+std::string g_me;
+
+/**
+ * \return the number of bytes currently allocated from the heap, or 0 if
+ *         the C library cannot tell
+ */
+std::size_t
+GetHeapInUse (void)
+{
+#if defined (__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 info = mallinfo2 ();
+  return info.uordblks + info.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+/// An event of a trace
+struct TraceRecord
+{
+  uint64_t now;  ///< time at which the event is scheduled, in ns
+  uint64_t ts;   ///< time at which the event expires, in ns
+};
+
+/// An event trace
+typedef std::vector<TraceRecord> Trace;
+
+/**
+ * Read an ascii trace with one "<now> <ts>" pair of times in ns per line,
+ * in the order the events were scheduled. Lines starting with '#' are
+ * ignored.
+ *
+ * \param filename the trace file, or "-" for standard input
+ * \return the trace
+ */
+Trace
+ReadTrace (std::string filename)
+{
+  std::ifstream file;
+  std::istream *input = &std::cin;
+  if (filename != "-")
+    {
+      file.open (filename.c_str ());
+      if (!file.is_open ())
+        {
+          NS_FATAL_ERROR ("Cannot open " << filename);
+        }
+      input = &file;
+    }
+  Trace trace;
+  std::string line;
+  while (std::getline (*input, line))
+    {
+      if (line.empty () || line[0] == '#')
+        {
+          continue;
+        }
+      std::istringstream iss (line);
+      TraceRecord record;
+      if (iss >> record.now >> record.ts)
+        {
+          trace.push_back (record);
+        }
+    }
+  LOGME ("found " << trace.size () << " events in " << filename);
+  return trace;
+}
+
+/**
+ * Generate a trace in which each expired event schedules a new one.
+ *
+ * Delays are either exponential with a mean of 100 ns, or skewed: most
+ * events are scheduled within a 9 us slot, the others are periodic events
+ * from 100 ms to 1 s in the future.
+ *
+ * \param population number of events initially scheduled
+ * \param total number of events in the trace
+ * \param skewed whether to use the skewed distribution
+ * \return the trace
+ */
+Trace
+MakeTrace (uint32_t population, uint32_t total, bool skewed)
+{
+  Ptr<ExponentialRandomVariable> exponential = CreateObject<ExponentialRandomVariable> ();
+  exponential->SetAttribute ("Mean", DoubleValue (100));
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  auto delay = [&] () -> uint64_t
+    {
+      if (!skewed)
+        {
+          return static_cast<uint64_t> (exponential->GetValue ());
+        }
+      if (uniform->GetValue () < 0.9)
+        {
+          return uniform->GetInteger (0, 9000);
+        }
+      return 100000000 * uniform->GetInteger (1, 10);
+    };
+
+  Trace trace;
+  std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t> > pending;
+  for (uint32_t i = 0; i < population && i < total; i++)
+    {
+      TraceRecord record = {0, delay ()};
+      trace.push_back (record);
+      pending.push (record.ts);
+    }
+  while (trace.size () < total)
+    {
+      uint64_t now = pending.top ();
+      pending.pop ();
+      TraceRecord record = {now, now + delay ()};
+      trace.push_back (record);
+      pending.push (record.ts);
+    }
+  return trace;
+}
+
+/// A trace of operations on the event list
+typedef std::vector<EventTraceRecord> OpTrace;
+
+/**
+ * Convert a trace of event times to operations on the event list: before
+ * an event is inserted, the events which expire before it is scheduled
+ * are run.
+ *
+ * \param trace the trace of event times
+ * \return the operations
+ */
+OpTrace
+ToOps (const Trace &trace)
+{
+  typedef std::pair<uint64_t, uint32_t> Key;
+  std::priority_queue<Key, std::vector<Key>, std::greater<Key> > pending;
+  OpTrace ops;
+  uint32_t uid = 0;
+  for (const TraceRecord &record : trace)
+    {
+      while (!pending.empty () && pending.top ().first < record.now)
+        {
+          ops.push_back ({EventTraceRecord::RUN, 0, pending.top ().second, pending.top ().first, pending.top ().first});
+          pending.pop ();
+        }
+      ops.push_back ({EventTraceRecord::INSERT, 0, ++uid, record.now, record.ts});
+      pending.push (Key (record.ts, uid));
+    }
+  return ops;
+}
+
+/**
+ * Read a binary trace recorded by DefaultSimulatorImpl.
+ *
+ * \param filename the trace file
+ * \return the operations
+ */
+OpTrace
+ReadOps (std::string filename)
+{
+  EventTraceReader reader (filename);
+  OpTrace ops;
+  EventTraceRecord record;
+  while (reader.Read (record))
+    {
+      ops.push_back (record);
+    }
+  LOGME ("found " << ops.size () << " operations in " << filename);
+  return ops;
+}
+
+/// Result of the replay of a trace
+struct ReplayResult
+{
+  double seconds;      ///< replay duration
+  uint64_t ops;        ///< number of scheduler operations
+  std::size_t memory;  ///< peak memory allocated by the scheduler, in bytes
+  uint64_t mismatches; ///< events run out of the recorded order
+};
+
+/**
+ * Replay a trace of operations against a scheduler.
+ *
+ * The heap usage is sampled before each operation when measuring the
+ * memory, which would distort the replay duration, hence the memory and
+ * the duration are measured by separate replays.
+ *
+ * \param factory the scheduler factory
+ * \param trace the operations
+ * \param measureMemory whether to measure the peak memory rather than the duration
+ * \return the result of the replay
+ */
+ReplayResult
+Replay (ObjectFactory factory, const OpTrace &trace, bool measureMemory)
+{
+  // one event per uid, as some schedulers look at the cancelled state of
+  // the events
+  std::unordered_map<uint32_t, std::size_t> indices;
+  std::vector<std::size_t> traceIndices;
+  traceIndices.reserve (trace.size ());
+  for (const EventTraceRecord &record : trace)
+    {
+      traceIndices.push_back (indices.emplace (record.uid, indices.size ()).first->second);
+    }
+  std::vector<Ptr<EventImpl> > events;
+  events.reserve (indices.size ());
+  for (std::size_t i = 0; i < indices.size (); i++)
+    {
+      events.push_back (Ptr<EventImpl> (MakeEvent ([] () {}), false));
+    }
+  std::vector<bool> takenOver (indices.size (), false);
+
+  Ptr<Scheduler> scheduler = factory.Create<Scheduler> ();
+  std::size_t baseline = GetHeapInUse ();
+  std::size_t peak = baseline;
+
+  ReplayResult result = {0, 0, 0, 0};
+  auto start = std::chrono::steady_clock::now ();
+  for (std::size_t i = 0; i < trace.size (); i++)
+    {
+      if (measureMemory)
+        {
+          peak = std::max (peak, GetHeapInUse ());
+        }
+      const EventTraceRecord &record = trace[i];
+      std::size_t index = traceIndices[i];
+      Scheduler::Event ev;
+      ev.impl = PeekPointer (events[index]);
+      ev.key.m_ts = record.ts;
+      ev.key.m_uid = record.uid;
+      ev.key.m_context = record.context;
+      switch (record.op)
+        {
+        case EventTraceRecord::INSERT:
+          scheduler->Insert (ev);
+          break;
+        case EventTraceRecord::RUN:
+          if (takenOver[index])
+            {
+              continue;
+            }
+          while (!scheduler->IsEmpty ())
+            {
+              Scheduler::Event next = scheduler->RemoveNext ();
+              result.ops++;
+              if (next.key.m_uid == record.uid)
+                {
+                  break;
+                }
+              if (!next.impl->IsCancelled ())
+                {
+                  result.mismatches++;
+                  break;
+                }
+              // a cancelled event, not taken over by the recording scheduler
+            }
+          continue;
+        case EventTraceRecord::REMOVE:
+          scheduler->Remove (ev);
+          ev.impl->Cancel ();
+          break;
+        case EventTraceRecord::CANCEL:
+          ev.impl->Cancel ();
+          // the scheduler takes over the reference of the event list
+          ev.impl->Ref ();
+          takenOver[index] = scheduler->Cancel (ev);
+          if (!takenOver[index])
+            {
+              ev.impl->Unref ();
+            }
+          break;
+        }
+      result.ops++;
+    }
+  if (measureMemory)
+    {
+      peak = std::max (peak, GetHeapInUse ());
+    }
+  while (!scheduler->IsEmpty ())
+    {
+      scheduler->RemoveNext ();
+      result.ops++;
+    }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - start;
+  result.seconds = elapsed.count ();
+  result.memory = peak - baseline;
+  scheduler->Dispose ();
+  return result;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string filename = "";
+  std::string traceFile = "";
+  std::string schedulers = "";
+  bool skewed = false;
+  uint32_t pop = 100000;
+  uint32_t total = 1000000;
+  uint32_t runs = 1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark all the schedulers by replaying an event trace.\n"
+             "\n"
+             "The trace is either a binary trace of the operations on the\n"
+             "event list, recorded by setting the EventTraceFile attribute of\n"
+             "ns3::DefaultSimulatorImpl and given by the --trace=\"<filename>\"\n"
+             "argument, or an ascii file, given by the --file=\"<filename>\"\n"
+             "argument (\"-\" for standard input), with one\n"
+             "\"<schedule time> <expiration time>\" pair of times in ns per\n"
+             "line, in the order the events are scheduled, or generated with\n"
+             "an exponential or skewed distribution of the event delays.\n"
+             "\n"
+             "For each scheduler, the time per operation on the event list\n"
+             "and the peak memory allocated by the scheduler, measured by a\n"
+             "separate replay (only with the GNU C library), are reported.");
+  cmd.AddValue ("trace",  "binary trace of event list operations",          traceFile);
+  cmd.AddValue ("file",   "file of event times",                            filename);
+  cmd.AddValue ("skewed", "generate skewed rather than exponential delays", skewed);
+  cmd.AddValue ("pop",    "generated event population size (default 1E5)", pop);
+  cmd.AddValue ("total",  "total number of generated events (default 1E6)", total);
+  cmd.AddValue ("runs",   "number of runs per scheduler (default 1)",       runs);
+  cmd.AddValue ("schedulers", "comma separated scheduler TypeIds (default all but ns3::ListScheduler)",
+                schedulers);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  std::vector<std::string> types;
+  if (schedulers.empty ())
+    {
+      for (uint32_t i = 0; i < TypeId::GetRegisteredN (); i++)
+        {
+          TypeId tid = TypeId::GetRegistered (i);
+          if (tid.IsChildOf (Scheduler::GetTypeId ()) && tid.HasConstructor ()
+              && tid != TypeId::LookupByName ("ns3::ListScheduler"))
+            {
+              types.push_back (tid.GetName ());
+            }
+        }
+    }
+  else
+    {
+      std::istringstream iss (schedulers);
+      std::string type;
+      while (std::getline (iss, type, ','))
+        {
+          types.push_back (type);
+        }
+    }
+
+  OpTrace trace;
+  if (!traceFile.empty ())
+    {
+      trace = ReadOps (traceFile);
+    }
+  else
+    {
+      trace = ToOps (filename.empty () ? MakeTrace (pop, total, skewed) : ReadTrace (filename));
+    }
+
+  LOG (std::left << std::setw (28) << "Scheduler" << std::setw (6) << "Run"
+       << std::setw (14) << "Time (s)" << std::setw (14) << "Ops" << std::setw (14) << "Per op (ns)"
+       << std::setw (14) << "Memory (kB)" << "Mismatches");
+  for (const std::string &type : types)
+    {
+      ObjectFactory factory (type);
+      std::size_t memory = Replay (factory, trace, true).memory;
+      for (uint32_t run = 0; run < runs; run++)
+        {
+          ReplayResult result = Replay (factory, trace, false);
+          result.memory = memory;
+          LOG (std::left << std::setw (28) << type << std::setw (6) << run
+               << std::setw (14) << result.seconds << std::setw (14) << result.ops
+               << std::setw (14) << 1e9 * result.seconds / result.ops
+               << std::setw (14) << result.memory / 1024.0 << result.mismatches);
+        }
+    }
+  return 0;
+}
@@ -205,6 +205,8 @@ int main (int argc, char *argv[])
 
   bool schedCal           = false;
   bool schedHeap          = false;
+  bool schedLadder        = false;
+  bool schedLazy          = false;
   bool schedList          = false;
   bool schedMap           = true;
   bool schedPriorityQueue = false;
@@ -227,6 +229,8 @@ int main (int argc, char *argv[])
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("calrev", "reverse ordering in the CalendarScheduler", calRev);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
+  cmd.AddValue ("lazy",  "use LazyCancelScheduler",       schedLazy);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
   cmd.AddValue ("pri",   "use PriorityQueue",             schedPriorityQueue);
@@ -250,6 +254,14 @@ int main (int argc, char *argv[])
     {
       factory.SetTypeId ("ns3::HeapScheduler");
     }
+  if (schedLadder)
+    {
+      factory.SetTypeId ("ns3::LadderScheduler");
+    }
+  if (schedLazy)
+    {
+      factory.SetTypeId ("ns3::LazyCancelScheduler");
+    }
   if (schedList)
     {
       factory.SetTypeId ("ns3::ListScheduler");